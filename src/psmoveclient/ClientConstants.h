@@ -18,6 +18,18 @@
 // The max length of the service version string
 #define PSMOVESERVICE_MAX_VERSION_STRING_LEN 32
 
+// The max number of optical tracking stages in the service metrics, see TrackingStageProfiler.h in PSMoveService
+#define PSMOVESERVICE_MAX_METRICS_STAGE_COUNT 8
+
+// The max length of a tracking stage name in the service metrics
+#define PSMOVESERVICE_MAX_METRICS_STAGE_NAME_LEN 16
+
+// The max number of client connections in the service metrics
+#define PSMOVESERVICE_MAX_METRICS_CONNECTION_COUNT 8
+
+// The number of duration histogram buckets in the service metrics, see ServiceMetrics.h in PSMoveService
+#define PSMOVESERVICE_METRICS_HISTOGRAM_BUCKET_COUNT 20
+
 // Defines a standard _PAUSE function
 #if __cplusplus >= 199711L  // if C++11
     #include <thread>
@@ -1,5 +1,6 @@
 //-- includes -----
 #include "ClientLog.h"
+#include "AsyncLogWriter.h"
 
 //-- globals -----
 e_log_severity_level g_min_log_level;
@@ -10,13 +11,52 @@ std::ostream g_normal_logger(std::cout.rdbuf());
 // Null stream eats the log
 NullStream<char> g_null_logger;
 
+// Writes the log lines to the normal logger from a background thread
+AsyncLogWriter *g_log_writer = nullptr;
+
 //-- public implementation -----
 void log_init(e_log_severity_level min_log_level)
 {
+    log_dispose();
+
     g_min_log_level= min_log_level;
+
+    g_log_writer = new AsyncLogWriter(false);
+    g_log_writer->addStream(&g_normal_logger);
+    g_log_writer->start();
+}
+
+void log_dispose()
+{
+    // Writes out any queued lines before returning
+    if (g_log_writer != nullptr)
+    {
+        g_log_writer->stop();
+        delete g_log_writer;
+        g_log_writer = nullptr;
+    }
 }
 
 bool log_can_emit_level(e_log_severity_level level)
 {
     return (level >= g_min_log_level);
 }
+
+void log_write_line(e_log_severity_level level, const std::string &line)
+{
+    if (g_log_writer != nullptr)
+    {
+        std::string queued_line = line;
+
+        g_log_writer->push(std::chrono::system_clock::now(), queued_line, level >= _log_severity_level_error);
+    }
+    else
+    {
+        // Logging before startup or after shutdown goes straight to the normal logger
+        g_normal_logger << line;
+        if (line.empty() || line.back() != '\n')
+        {
+            g_normal_logger << '\n';
+        }
+    }
+}
@@ -6,6 +6,8 @@
 #include <streambuf>
 #include <ostream>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 //-- constants -----
 enum e_log_severity_level
@@ -50,17 +52,59 @@ PSM_CPP_PUBLIC_CLASS extern NullStream<char> g_null_logger;
 
 //-- interface -----
 PSM_CPP_PRIVATE_FUNCTION(void) log_init(e_log_severity_level level);
+PSM_CPP_PRIVATE_FUNCTION(void) log_dispose();
 PSM_CPP_PUBLIC_FUNCTION(bool) log_can_emit_level(e_log_severity_level level);
+PSM_CPP_PUBLIC_FUNCTION(void) log_write_line(e_log_severity_level level, const std::string &line);
+
+//-- definitions -----
+/// Accumulates a single log line and hands it off to the log writer thread when destroyed.
+/// Only ever constructed by the logging macros after the severity check passed,
+/// so disabled log lines never get formatted.
+class ClientLoggerStream
+{
+public:
+    ClientLoggerStream(e_log_severity_level level) : m_lineBuffer(), m_level(level) {}
+    ~ClientLoggerStream() { log_write_line(m_level, m_lineBuffer.str()); }
+
+    // accepts just about anything
+    template<class T>
+    ClientLoggerStream &operator<<(const T &x)
+    {
+        m_lineBuffer << x;
+        return *this;
+    }
+
+    // stream manipulators like std::endl
+    ClientLoggerStream &operator<<(std::ostream &(*manipulator)(std::ostream &))
+    {
+        m_lineBuffer << manipulator;
+        return *this;
+    }
+
+private:
+    std::ostringstream m_lineBuffer;
+    e_log_severity_level m_level;
+};
+
+// Turns a ClientLoggerStream expression into void, so both sides of the macro's ?: match
+class ClientLoggerStreamVoidify
+{
+public:
+    void operator&(const ClientLoggerStream &) {}
+};
 
 //-- macros -----
-#define SELECT_LOG_STREAM(level) (log_can_emit_level(level) ? g_normal_logger : g_null_logger)
-
-#define CLIENT_LOG_TRACE(function_name) SELECT_LOG_STREAM(_log_severity_level_trace) << "[TRACE] " << function_name << " - "
-#define CLIENT_LOG_DEBUG(function_name) SELECT_LOG_STREAM(_log_severity_level_debug) << "[DEBUG] " << function_name << " - "
-#define CLIENT_LOG_INFO(function_name) SELECT_LOG_STREAM(_log_severity_level_info) << "[INFO] " << function_name << " - "
-#define CLIENT_LOG_WARNING(function_name) SELECT_LOG_STREAM(_log_severity_level_warning) << "[WARN] " << function_name << " - "
-#define CLIENT_LOG_ERROR(function_name) SELECT_LOG_STREAM(_log_severity_level_error) << "[ERROR] " << function_name << " - "
-#define CLIENT_LOG_FATAL(function_name) SELECT_LOG_STREAM(_log_severity_level_fatal) << "[FATAL] " << function_name << " - "
+// The severity check short-circuits the whole expression,
+// so none of the streamed arguments are evaluated for disabled levels.
+#define SELECT_LOG_STREAM(level, tag, function_name) \
+    !log_can_emit_level(level) ? (void)0 : ClientLoggerStreamVoidify() & ClientLoggerStream(level) << tag << function_name << " - "
+
+#define CLIENT_LOG_TRACE(function_name) SELECT_LOG_STREAM(_log_severity_level_trace, "[TRACE] ", function_name)
+#define CLIENT_LOG_DEBUG(function_name) SELECT_LOG_STREAM(_log_severity_level_debug, "[DEBUG] ", function_name)
+#define CLIENT_LOG_INFO(function_name) SELECT_LOG_STREAM(_log_severity_level_info, "[INFO] ", function_name)
+#define CLIENT_LOG_WARNING(function_name) SELECT_LOG_STREAM(_log_severity_level_warning, "[WARN] ", function_name)
+#define CLIENT_LOG_ERROR(function_name) SELECT_LOG_STREAM(_log_severity_level_error, "[ERROR] ", function_name)
+#define CLIENT_LOG_FATAL(function_name) SELECT_LOG_STREAM(_log_severity_level_fatal, "[FATAL] ", function_name)
 
 #endif  // CLIENT_LOG_H
 
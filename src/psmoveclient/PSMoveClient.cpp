@@ -628,6 +628,9 @@ void PSMoveClient::shutdown()
 
     // No more pending requests
     m_pending_request_map.clear();
+
+    // Write out any queued log lines and stop the log writer thread
+    log_dispose();
 }
 
 // -- System Requests ----
@@ -644,6 +647,19 @@ PSMRequestID PSMoveClient::get_service_version()
     return request->request_id();
 }
 
+PSMRequestID PSMoveClient::get_service_metrics()
+{
+    CLIENT_LOG_INFO("get_service_metrics") << "requesting service metrics" << std::endl;
+
+    // Tell the psmove service that we want its metrics
+    RequestPtr request(new PSMoveProtocol::Request());
+    request->set_type(PSMoveProtocol::Request_RequestType_GET_SERVICE_METRICS);
+
+    m_request_manager->send_request(request);
+
+    return request->request_id();
+}
+
 // -- ClientPSMoveAPI Requests -----
 bool PSMoveClient::allocate_controller_listener(PSMControllerID ControllerID)
 {
@@ -942,7 +958,7 @@ PSMRequestID PSMoveClient::get_tracker_list()
     return request->request_id();
 }
 
-PSMRequestID PSMoveClient::start_tracker_data_stream(PSMTrackerID tracker_id)
+PSMRequestID PSMoveClient::start_tracker_data_stream(PSMTrackerID tracker_id, unsigned int flags)
 {
     CLIENT_LOG_INFO("start_tracker_data_stream") << "requesting tracker stream start for TrackerID: " << tracker_id << std::endl;
 
@@ -951,6 +967,11 @@ PSMRequestID PSMoveClient::start_tracker_data_stream(PSMTrackerID tracker_id)
     request->set_type(PSMoveProtocol::Request_RequestType_START_TRACKER_DATA_STREAM);
     request->mutable_request_start_tracker_data_stream()->set_tracker_id(tracker_id);
 
+    if ((flags & PSMTrackerStreamFlags_disableDebugOverlay) > 0)
+    {
+        request->mutable_request_start_tracker_data_stream()->set_disable_debug_overlay(true);
+    }
+
     m_request_manager->send_request(request);
 
     return request->request_id();
@@ -43,6 +43,7 @@ public:
 
 	// -- System Requests ----
     PSMRequestID get_service_version();
+    PSMRequestID get_service_metrics();
 
     // -- ClientPSMoveAPI Requests -----
     bool allocate_controller_listener(PSMControllerID controller_id);
@@ -61,7 +62,7 @@ public:
     PSMTracker* get_tracker_view(PSMTrackerID tracker_id);
 	PSMRequestID get_tracking_space_settings();
     PSMRequestID get_tracker_list();
-    PSMRequestID start_tracker_data_stream(PSMTrackerID tracker_id);
+    PSMRequestID start_tracker_data_stream(PSMTrackerID tracker_id, unsigned int flags);
     PSMRequestID stop_tracker_data_stream(PSMTrackerID tracker_id);
 	bool open_video_stream(PSMTrackerID tracker_id);
 	bool poll_video_stream(PSMTrackerID tracker_id);
@@ -120,6 +120,104 @@ protected:
     PSMResponseMessage m_response;
 };
 
+// The service metrics don't fit in the PSMResponseMessage payload,
+// so they are read straight from the PSMoveProtocol response
+static void build_metric_counter(
+	const PSMoveProtocol::Response_ResultServiceMetrics_CounterStats &counter_response,
+	PSMMetricCounter *counter)
+{
+	counter->total = counter_response.total();
+	counter->rate_per_sec = counter_response.rate_per_sec();
+}
+
+static void build_metric_timer(
+	const PSMoveProtocol::Response_ResultServiceMetrics_TimerStats &timer_response,
+	PSMMetricTimer *timer)
+{
+	timer->total_count = timer_response.total_count();
+	timer->total_ms = timer_response.total_ms();
+	timer->max_ms = timer_response.max_ms();
+	timer->window_count = timer_response.window_count();
+	timer->window_mean_ms = timer_response.window_mean_ms();
+	timer->window_p50_ms = timer_response.window_p50_ms();
+	timer->window_p99_ms = timer_response.window_p99_ms();
+	timer->window_max_ms = timer_response.window_max_ms();
+
+	for (int bucket_index = 0;
+		bucket_index < timer_response.window_bucket_counts_size() && bucket_index < PSMOVESERVICE_METRICS_HISTOGRAM_BUCKET_COUNT;
+		++bucket_index)
+	{
+		timer->window_bucket_counts[bucket_index] = timer_response.window_bucket_counts(bucket_index);
+	}
+}
+
+static void build_service_metrics(
+	const PSMoveProtocol::Response_ResultServiceMetrics &MetricsResponse,
+	PSMServiceMetrics *service_metrics)
+{
+	memset(service_metrics, 0, sizeof(PSMServiceMetrics));
+
+	service_metrics->window_seconds = MetricsResponse.window_seconds();
+	build_metric_timer(MetricsResponse.update_time(), &service_metrics->update_time);
+	service_metrics->segmented_pixel_count = MetricsResponse.segmented_pixel_count();
+
+	service_metrics->stage_count = 0;
+	for (int stage_index = 0;
+		stage_index < MetricsResponse.stages_size() && stage_index < PSMOVESERVICE_MAX_METRICS_STAGE_COUNT;
+		++stage_index)
+	{
+		const auto &StageResponse = MetricsResponse.stages(stage_index);
+		PSMTrackingStageMetrics *stage = &service_metrics->stages[service_metrics->stage_count++];
+
+		strncpy(stage->stage_name, StageResponse.stage_name().c_str(), PSMOVESERVICE_MAX_METRICS_STAGE_NAME_LEN - 1);
+		build_metric_timer(StageResponse.time(), &stage->time);
+	}
+
+	service_metrics->tracker_count = 0;
+	for (int tracker_index = 0;
+		tracker_index < MetricsResponse.trackers_size() && tracker_index < PSMOVESERVICE_MAX_TRACKER_COUNT;
+		++tracker_index)
+	{
+		const auto &TrackerResponse = MetricsResponse.trackers(tracker_index);
+		PSMTrackerMetrics *tracker = &service_metrics->trackers[service_metrics->tracker_count++];
+
+		tracker->tracker_id = TrackerResponse.tracker_id();
+		build_metric_counter(TrackerResponse.captured_frames(), &tracker->captured_frames);
+		build_metric_counter(TrackerResponse.dropped_frames(), &tracker->dropped_frames);
+	}
+
+	service_metrics->controller_count = 0;
+	for (int controller_index = 0;
+		controller_index < MetricsResponse.controllers_size() && controller_index < PSMOVESERVICE_MAX_CONTROLLER_COUNT;
+		++controller_index)
+	{
+		const auto &ControllerResponse = MetricsResponse.controllers(controller_index);
+		PSMControllerMetrics *controller = &service_metrics->controllers[service_metrics->controller_count++];
+
+		controller->controller_id = ControllerResponse.controller_id();
+		build_metric_counter(ControllerResponse.imu_packets(), &controller->imu_packets);
+		controller->imu_queue_depth = ControllerResponse.imu_queue_depth();
+		controller->imu_queue_high_water_mark = ControllerResponse.imu_queue_high_water_mark();
+	}
+
+	service_metrics->connection_count = 0;
+	for (int connection_index = 0;
+		connection_index < MetricsResponse.connections_size() && connection_index < PSMOVESERVICE_MAX_METRICS_CONNECTION_COUNT;
+		++connection_index)
+	{
+		const auto &ConnectionResponse = MetricsResponse.connections(connection_index);
+		PSMConnectionMetrics *connection = &service_metrics->connections[service_metrics->connection_count++];
+
+		connection->connection_id = ConnectionResponse.connection_id();
+		build_metric_counter(ConnectionResponse.udp_data_frames(), &connection->udp_data_frames);
+		build_metric_counter(ConnectionResponse.udp_bytes(), &connection->udp_bytes);
+		build_metric_counter(ConnectionResponse.tcp_responses(), &connection->tcp_responses);
+		build_metric_counter(ConnectionResponse.tcp_bytes(), &connection->tcp_bytes);
+		connection->pending_data_frames = ConnectionResponse.pending_data_frames();
+		connection->pending_responses = ConnectionResponse.pending_responses();
+	}
+}
+
 // -- public interface -----
 const char* PSM_GetClientVersionString()
 {
@@ -264,6 +362,29 @@ PSMResult PSM_GetServiceVersionStringAsync(PSMRequestID *out_request_id)
     return result;
 }
 
+PSMResult PSM_GetServiceMetrics(PSMServiceMetrics *out_metrics, int timeout_ms)
+{
+    PSMResult result_code= PSMResult_Error;
+
+    if (g_psm_client != nullptr && out_metrics != nullptr)
+    {
+	    PSMBlockingRequest request(g_psm_client->get_service_metrics());
+        result_code= request.send(timeout_ms);
+
+        if (result_code == PSMResult_Success)
+        {
+            // The response stays valid until the next PSM_Update()
+            const PSMoveProtocol::Response *response=
+                reinterpret_cast<const PSMoveProtocol::Response *>(request.get_response_message().opaque_response_handle);
+            assert(response->type() == PSMoveProtocol::Response_ResponseType_SERVICE_METRICS);
+
+            build_service_metrics(response->result_service_metrics(), out_metrics);
+        }
+    }
+    
+    return result_code;
+}
+
 PSMResult PSM_Shutdown()
 {
 	PSMResult result= PSMResult_Error;
@@ -1126,12 +1247,17 @@ PSMResult PSM_GetTrackerList(PSMTrackerList *out_tracker_list, int timeout_ms)
 }
 
 PSMResult PSM_StartTrackerDataStream(PSMTrackerID tracker_id, int timeout_ms)
+{
+    return PSM_StartTrackerDataStreamWithFlags(tracker_id, PSMTrackerStreamFlags_defaultStreamOptions, timeout_ms);
+}
+
+PSMResult PSM_StartTrackerDataStreamWithFlags(PSMTrackerID tracker_id, unsigned int data_stream_flags, int timeout_ms)
 {
     PSMResult result= PSMResult_Error;
 
     if (g_psm_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id))
     {
-		PSMBlockingRequest request(g_psm_client->start_tracker_data_stream(tracker_id));
+		PSMBlockingRequest request(g_psm_client->start_tracker_data_stream(tracker_id, data_stream_flags));
 
 		result= request.send(timeout_ms);
     }
@@ -1273,12 +1399,17 @@ PSMResult PSM_GetTrackerListAsync(PSMRequestID *out_request_id)
 }
 
 PSMResult PSM_StartTrackerDataStreamAsync(PSMTrackerID tracker_id, PSMRequestID *out_request_id)
+{
+    return PSM_StartTrackerDataStreamWithFlagsAsync(tracker_id, PSMTrackerStreamFlags_defaultStreamOptions, out_request_id);
+}
+
+PSMResult PSM_StartTrackerDataStreamWithFlagsAsync(PSMTrackerID tracker_id, unsigned int data_stream_flags, PSMRequestID *out_request_id)
 {
     PSMResult result_code= PSMResult_Error;
 
     if (g_psm_client != nullptr && IS_VALID_TRACKER_INDEX(tracker_id))
     {
-        PSMRequestID req_id = g_psm_client->start_tracker_data_stream(tracker_id);
+        PSMRequestID req_id = g_psm_client->start_tracker_data_stream(tracker_id, data_stream_flags);
 
         if (out_request_id != nullptr)
         {
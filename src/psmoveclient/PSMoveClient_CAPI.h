@@ -124,6 +124,13 @@ typedef enum
 	PSMStreamFlags_disableROI = 0x20,					///< Disable Region-of-Interest tracking optimization
 } PSMControllerDataStreamFlags;
 
+/// Tracker video stream options
+typedef enum
+{
+	PSMTrackerStreamFlags_defaultStreamOptions = 0x00,	///< Video with the tracking debug overlay drawn onto it
+	PSMTrackerStreamFlags_disableDebugOverlay = 0x01,	///< Raw video, unless another client asked for the overlay
+} PSMTrackerDataStreamFlags;
+
 /// The possible rumble channels available to the comtrollers
 typedef enum
 {
@@ -603,6 +610,82 @@ typedef struct
     float global_forward_degrees;
 } PSMTrackingSpace;
 
+/// Event counter in the service metrics
+typedef struct
+{
+    long long total;        ///< Since the service started
+    float rate_per_sec;     ///< Over the last metrics window
+} PSMMetricCounter;
+
+/// Duration histogram in the service metrics
+typedef struct
+{
+    // Since the service started
+    long long total_count;
+    float total_ms;
+    float max_ms;
+
+    // Over the last metrics window
+    int window_count;
+    float window_mean_ms;
+    float window_p50_ms;
+    float window_p99_ms;
+    float window_max_ms;
+    int window_bucket_counts[PSMOVESERVICE_METRICS_HISTOGRAM_BUCKET_COUNT]; ///< Bucket i holds [2^(i-1), 2^i) microseconds
+} PSMMetricTimer;
+
+/// Time spent in a stage of the optical tracking pipeline
+typedef struct
+{
+    char stage_name[PSMOVESERVICE_MAX_METRICS_STAGE_NAME_LEN];
+    PSMMetricTimer time;
+} PSMTrackingStageMetrics;
+
+/// Frames a tracker delivered and dropped
+typedef struct
+{
+    PSMTrackerID tracker_id;
+    PSMMetricCounter captured_frames;
+    PSMMetricCounter dropped_frames;    ///< Replaced by a newer frame before the service took them
+} PSMTrackerMetrics;
+
+/// Sensor reports a controller delivered and the IMU packets waiting for the filter
+typedef struct
+{
+    PSMControllerID controller_id;
+    PSMMetricCounter imu_packets;
+    int imu_queue_depth;
+    int imu_queue_high_water_mark;
+} PSMControllerMetrics;
+
+/// Traffic sent to a client connection
+typedef struct
+{
+    int connection_id;
+    PSMMetricCounter udp_data_frames;
+    PSMMetricCounter udp_bytes;
+    PSMMetricCounter tcp_responses;
+    PSMMetricCounter tcp_bytes;
+    int pending_data_frames;
+    int pending_responses;
+} PSMConnectionMetrics;
+
+/// Counters and timers PSMoveService keeps on itself
+typedef struct
+{
+    float window_seconds;               ///< Length of the window the rates and histograms cover
+    PSMMetricTimer update_time;         ///< One main loop update
+    PSMTrackingStageMetrics stages[PSMOVESERVICE_MAX_METRICS_STAGE_COUNT];
+    int stage_count;
+    long long segmented_pixel_count;
+    PSMTrackerMetrics trackers[PSMOVESERVICE_MAX_TRACKER_COUNT];
+    int tracker_count;
+    PSMControllerMetrics controllers[PSMOVESERVICE_MAX_CONTROLLER_COUNT];
+    int controller_count;
+    PSMConnectionMetrics connections[PSMOVESERVICE_MAX_METRICS_CONNECTION_COUNT];
+    int connection_count;
+} PSMServiceMetrics;
+
 /// A contrainer for all possible responses to requests sent from PSMoveService
 typedef struct
 {
@@ -813,6 +896,17 @@ PSM_PUBLIC_FUNCTION(bool) PSM_WasSystemButtonPressed();
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetServiceVersionString(char *out_version_string, size_t max_version_string, int timeout_ms);
 
+/** \brief Get the counters and timers PSMoveService keeps on itself
+	Sends a request to PSMoveService for its main loop, optical tracking, tracker, controller and connection metrics.
+	Rates and histograms cover the last complete metrics window, totals everything since the service started.
+	The metrics are too large for the \ref PSMResponseMessage payload, so there is no async version of this request.
+	\remark Blocking - Returns after either the metrics are returned OR the timeout period is reached. 
+	\param[out] out_metrics The metrics of the service
+	\param timeout_ms The conection timeout period in milliseconds, usually PSM_DEFAULT_TIMEOUT
+	\return PSMResult_Success upon receiving result, PSMResult_Timeoout, or PSMResult_Error on request error.
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetServiceMetrics(PSMServiceMetrics *out_metrics, int timeout_ms);
+
 // System Async Queries
 /** \brief Get the client API version string from PSMoveService
 	Sends a request to PSMoveService to get the protocol version.
@@ -1273,6 +1367,20 @@ PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerList(PSMTrackerList *out_tracker_li
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStream(PSMTrackerID tracker_id, int timeout_ms);
 
+/** \brief Requests start of a shared memory video stream for a given tracker with stream options
+	Same as \ref PSM_StartTrackerDataStream, but lets the client opt out of the tracking debug overlay.
+	The overlay costs extra work on every tracked frame, so clients that only want the video should disable it.
+	\remark The shared memory buffer is shared by all clients, so the overlay is drawn if any client wants it.
+	\remark Blocking - Returns after either stream start response comes back OR the timeout period is reached. 
+	\param tracker_id The id of the tracker to start the stream for.
+	\param data_stream_flags One or more of the following steam:
+	    - PSMTrackerStreamFlags_defaultStreamOptions = video with the tracking debug overlay
+		- PSMTrackerStreamFlags_disableDebugOverlay = video without the tracking debug overlay
+	\param timeout_ms The conection timeout period in milliseconds, usually PSM_DEFAULT_TIMEOUT
+	\return PSMResult_Success upon receiving result, PSMResult_Timeoout, or PSMResult_Error on request error.
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamWithFlags(PSMTrackerID tracker_id, unsigned int data_stream_flags, int timeout_ms);
+
 /** \brief Requests stop of a shared memory video stream for a given tracker
 	Asks PSMoveService to stop an active video stream for the given tracker.
 	\remark Video streams can only be started on clients that run on the same machine as PSMoveService is running on.
@@ -1358,6 +1466,19 @@ PSM_PUBLIC_FUNCTION(PSMResult) PSM_GetTrackerFrustum(PSMTrackerID tracker_id, PS
  */
 PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamAsync(PSMTrackerID tracker_id, PSMRequestID *out_request_id);
 
+/** \brief Requests start of a shared memory video stream for a given tracker with stream options
+	Same as \ref PSM_StartTrackerDataStreamAsync, but lets the client opt out of the tracking debug overlay.
+	\remark Async - Result obtained in one of two ways:
+	  - Register callback for request id with \ref PSM_RegisterCallback and the poll with \ref PSM_Update()
+	  - Poll with \ref PSM_UpdateNoPollMessages() and then call \ref PSM_PollNextMessage() to see if 
+	  generic \ref PSMResponseMessage result has been received.
+	\param tracker_id The tracker id we wish to start the stream for
+	\param data_stream_flags A bitmask of \ref PSMTrackerDataStreamFlags
+	\param[out] out_request_id The id of the request sent to PSMoveService. Can be used to register callback with \ref PSM_RegisterCallback.
+	\return PSMResult_RequestSent on success or PSMResult_Error if there was no valid connection
+ */
+PSM_PUBLIC_FUNCTION(PSMResult) PSM_StartTrackerDataStreamWithFlagsAsync(PSMTrackerID tracker_id, unsigned int data_stream_flags, PSMRequestID *out_request_id);
+
 /** \brief Requests stop shared memory video stream for a given tracker
 	Asks PSMoveService to stop video data for the given tracker.
 	\remark Async - Result obtained in one of two ways:
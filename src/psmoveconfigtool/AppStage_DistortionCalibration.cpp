@@ -885,10 +885,12 @@ void AppStage_DistortionCalibration::request_tracker_start_stream()
     {
         m_menuState = AppStage_DistortionCalibration::pendingTrackerStartStreamRequest;
 
-        // Tell the psmove service that we want to start streaming data from the tracker
+        // Tell the psmove service that we want to start streaming data from the tracker.
+		// The chessboard detection wants the raw video without the tracking overlay.
 		PSMRequestID requestID;
-		PSM_StartTrackerDataStreamAsync(
+		PSM_StartTrackerDataStreamWithFlagsAsync(
 			m_tracker_view->tracker_info.tracker_id, 
+			PSMTrackerStreamFlags_disableDebugOverlay,
 			&requestID);
 		PSM_RegisterCallback(requestID, AppStage_DistortionCalibration::handle_tracker_start_stream_response, this);
     }
@@ -3,6 +3,7 @@
 #include "Eigen/SVD"
 #include "Eigen/Dense"
 #include <iostream>
+#include <vector>
 
 //-- public methods -----
 Eigen::Quaternionf
@@ -209,6 +210,10 @@ eigen_alignment_fit_bounding_box_ellipsoid(
 
 // See http://stackoverflow.com/questions/1768197/bounding-ellipse/1768440#1768440
 // Relevant paper: http://www.seas.upenn.edu/~nima/papers/Mim_vol_ellipse.pdf
+// Khachiyan's algorithm only ever needs the diagonal of Q'*inv(X)*Q, where Q holds the points
+// in homogeneous coordinates, so instead of building the NxN product every iteration
+// each diagonal element q'*inv(X)*q is computed on its own from the Cholesky factor of the 4x4 X.
+// Besides the weights u nothing scales with the point count.
 void
 eigen_alignment_fit_min_volume_ellipsoid(
     const Eigen::Vector3f *points,
@@ -220,65 +225,88 @@ eigen_alignment_fit_min_volume_ellipsoid(
 
     if (point_count > POINT_DIMENSION)
     {
-        const float N = static_cast<float>(point_count);
+        const double N = static_cast<double>(point_count);
+        const double d = static_cast<double>(POINT_DIMENSION);
 
         //u is an Nx1 vector where each element is 1/N
-        Eigen::VectorXf u(point_count);
+        std::vector<double> u(point_count, 1.0 / N);
 
         const int k_max_iteration_count = 100;
-        float error = k_real_max;
-
-        // Fill out 3xN and 4xN point matrices P & Q
-        Eigen::MatrixXf P(3, point_count);
-        Eigen::MatrixXf Q(4, point_count);
-
-        int dest_row = 0;
-        for (int point_index = 0; point_index < point_count; ++point_index)
-        {
-            const Eigen::Vector3f &point = points[point_index];
-
-            P.col(dest_row) = point;
-            Q.col(dest_row) = Eigen::Vector4f(point.x(), point.y(), point.z(), 1.f);
-            ++dest_row;
-        }
+        double error = k_real_max;
 
         // Run the Khachiyan Convex Optimization Algorithm
-        u.setConstant(1.f / N);
         for (int iteration_count = 0; error > tolerance && iteration_count < k_max_iteration_count; ++iteration_count)
         {
-            Eigen::Matrix4f X = Q*u.asDiagonal()*Q.transpose(); // (4xN)(NxN)(Nx4) = (4x4)
-            Eigen::VectorXf M = (Q.transpose()*X.inverse()*Q).diagonal(); // [(Nx4)(4x4)(4xN)].diagonal() = (Nx1)
+            // X = Q*diag(u)*Q'
+            Eigen::Matrix4d X = Eigen::Matrix4d::Zero();
+            for (int point_index = 0; point_index < point_count; ++point_index)
+            {
+                const Eigen::Vector4d q = points[point_index].cast<double>().homogeneous();
+
+                X.selfadjointView<Eigen::Lower>().rankUpdate(q, u[point_index]);
+            }
+
+            const Eigen::LLT<Eigen::Matrix4d, Eigen::Lower> X_llt(X.selfadjointView<Eigen::Lower>());
+            if (X_llt.info() != Eigen::Success)
+            {
+                // All of the points are on a plane
+                break;
+            }
 
-            // Find the max element and position in M
+            // Find the max element and position in M = diag(Q'*inv(X)*Q),
+            // where q'*inv(X)*q = |inv(L)*q|^2 for X = L*L'
             int max_element_index = 0;
-            float max_element = M[0];
-            for (int element_index = 1; element_index < 4; ++element_index)
+            double max_element = -1.0;
+            for (int point_index = 0; point_index < point_count; ++point_index)
             {
-                if (M[element_index] > max_element)
+                const Eigen::Vector4d q = points[point_index].cast<double>().homogeneous();
+                const double element = X_llt.matrixL().solve(q).squaredNorm();
+
+                if (element > max_element)
                 {
-                    max_element = M[element_index];
-                    max_element_index = element_index;
+                    max_element = element;
+                    max_element_index = point_index;
                 }
             }
 
             // Update u
             {
                 // Calculate the step size for the ascent
-                const float step_size = (max_element - POINT_DIMENSION - 1.f) / ((POINT_DIMENSION + 1.f)*(max_element - 1.f));
-                Eigen::VectorXf new_u = (1.f - step_size)*u;
-
-                new_u[max_element_index] = new_u[max_element_index] + step_size;
+                const double step_size = (max_element - d - 1.0) / ((d + 1.0)*(max_element - 1.0));
 
-                error = (new_u - u).norm();
+                // |new_u - u|^2, where new_u = (1 - step_size)*u + step_size*e_max
+                double error_squared = 0.0;
+                for (int point_index = 0; point_index < point_count; ++point_index)
+                {
+                    double delta = -step_size*u[point_index];
+                    if (point_index == max_element_index)
+                    {
+                        delta += step_size;
+                    }
+
+                    u[point_index] += delta;
+                    error_squared += delta*delta;
+                }
 
-                u = new_u;
+                error = sqrt(error_squared);
             }
         }
 
         // Compute the Ellipsoid A-matrix i.e. (X-c)'*A*(X-c)
-		Eigen::Matrix3f PuP_trans= P*u.asDiagonal()*P.transpose();
-		Eigen::Matrix3f PuPu_trans= (P*u)*(P*u).transpose();
-        Eigen::Matrix3f A = (1.f / POINT_DIMENSION) * (PuP_trans - PuPu_trans).inverse();
+        // from the weighted point covariance P*diag(u)*P' - (P*u)*(P*u)'
+        Eigen::Vector3d Pu = Eigen::Vector3d::Zero();
+        Eigen::Matrix3d PuP_trans = Eigen::Matrix3d::Zero();
+        for (int point_index = 0; point_index < point_count; ++point_index)
+        {
+            const Eigen::Vector3d p = points[point_index].cast<double>();
+
+            Pu += u[point_index]*p;
+            PuP_trans.selfadjointView<Eigen::Lower>().rankUpdate(p, u[point_index]);
+        }
+        PuP_trans.triangularView<Eigen::StrictlyUpper>() = PuP_trans.transpose();
+
+        const Eigen::Matrix3d PuPu_trans = Pu*Pu.transpose();
+        const Eigen::Matrix3f A = ((1.0 / d) * (PuP_trans - PuPu_trans).inverse()).cast<float>();
 
         // Compute the singular values of A (where A = U*D*V)
         const Eigen::JacobiSVD<Eigen::Matrix3f> svd(A, Eigen::ComputeFullU | Eigen::ComputeFullV);
@@ -295,7 +323,7 @@ eigen_alignment_fit_min_volume_ellipsoid(
             1.f / safe_sqrt_with_default(D(2), 100000));
 
         // Compute the center
-        out_ellipsoid.center = P*u;
+        out_ellipsoid.center = Pu.cast<float>();
 
         // Compute the fit error
         out_ellipsoid.error = eigen_alignment_compute_ellipsoid_fit_error(points, point_count, out_ellipsoid);
@@ -457,20 +485,20 @@ eigen_alignment_fit_least_squares_ellipse(
     bool bSuccess = false;
 
     // See http://autotrace.sourceforge.net/WSCG98.pdf
-    Eigen::MatrixXf D1(point_count, 3);
-    Eigen::MatrixXf D2(point_count, 3);
+    // The scatter matrices S1 = D1'*D1, S2 = D1'*D2 and S3 = D2'*D2 are summed
+    // one row of the Nx3 design matrices D1 and D2 at a time, so nothing gets allocated
+    Eigen::Matrix3f S1 = Eigen::Matrix3f::Zero();
+    Eigen::Matrix3f S2 = Eigen::Matrix3f::Zero();
+    Eigen::Matrix3f S3 = Eigen::Matrix3f::Zero();
     for (int ix = 0; ix < point_count; ++ix) {
-        D1.row(ix)[0] = points[ix].x() * points[ix].x();
-        D1.row(ix)[1] = points[ix].x() * points[ix].y();
-        D1.row(ix)[2] = points[ix].y() * points[ix].y();
-        D2.row(ix)[0] = points[ix].x();
-        D2.row(ix)[1] = points[ix].y();
-        D2.row(ix)[2] = 1;
+        const Eigen::Vector3f d1(points[ix].x() * points[ix].x(), points[ix].x() * points[ix].y(), points[ix].y() * points[ix].y());
+        const Eigen::Vector3f d2(points[ix].x(), points[ix].y(), 1.f);
+
+        S1.noalias() += d1 * d1.transpose();
+        S2.noalias() += d1 * d2.transpose();
+        S3.noalias() += d2 * d2.transpose();
     }
 
-    Eigen::Matrix3f S1 = D1.transpose() * D1;
-    Eigen::Matrix3f S2 = D1.transpose() * D2;
-    Eigen::Matrix3f S3 = D2.transpose() * D2;
     Eigen::Matrix3f T = -S3.colPivHouseholderQr().solve(S2.transpose());
     //                        Eigen::Matrix3f T = -S3.inverse() * S2.transpose();
     Eigen::Matrix3f M = S2*T + S1;
@@ -722,6 +750,42 @@ eigen_alignment_fit_focal_cone_to_sphere(
     *out_sphere_center = Eigen::Vector3f(x, y, z);
 }
 
+// Turns the least squares solution [Bx, By, c] of Doc_ok's focal cone fit
+// into the sphere center and, optionally, the projected ellipse
+static void
+compute_sphere_from_focal_cone_solution(
+    const Eigen::Vector3f &Bx_By_c,
+    const Eigen::Vector2f *points,
+    const int point_count,
+    const float sphere_radius,
+    const float focal_length_pts,
+    Eigen::Vector3f *out_sphere_center,
+    EigenFitEllipse *out_ellipse_projection)
+{
+    float zz = focal_length_pts * focal_length_pts;
+    float norm_norm_B = sqrt(Bx_By_c[0] * Bx_By_c[0] +
+        Bx_By_c[1] * Bx_By_c[1] +
+        zz);
+    float cos_theta = Bx_By_c[2] / norm_norm_B;
+    float k = cos_theta * cos_theta;
+    float norm_B = sphere_radius / sqrt(1 - k);
+
+    *out_sphere_center << Bx_By_c[0], Bx_By_c[1], focal_length_pts;
+    *out_sphere_center *= (norm_B / norm_norm_B);
+
+    // Optionally compute the best fit ellipse
+    if (out_ellipse_projection != nullptr)
+    {
+        eigen_alignment_project_ellipse(out_sphere_center, k,
+                                        focal_length_pts, zz,
+                                        out_ellipse_projection);
+        
+        out_ellipse_projection->error=
+            eigen_alignment_compute_ellipse_fit_error(
+                points, point_count, *out_ellipse_projection);
+    }
+}
+
 void
 eigen_alignment_fit_focal_cone_to_sphere(
     const Eigen::Vector2f *points,
@@ -748,27 +812,44 @@ eigen_alignment_fit_focal_cone_to_sphere(
     Eigen::VectorXf b(point_count);
     b.fill(-zz);
     Eigen::Vector3f Bx_By_c = A.colPivHouseholderQr().solve(b);
-    float norm_norm_B = sqrt(Bx_By_c[0] * Bx_By_c[0] +
-        Bx_By_c[1] * Bx_By_c[1] +
-        zz);
-    float cos_theta = Bx_By_c[2] / norm_norm_B;
-    float k = cos_theta * cos_theta;
-    float norm_B = sphere_radius / sqrt(1 - k);
 
-    *out_sphere_center << Bx_By_c[0], Bx_By_c[1], focal_length_pts;
-    *out_sphere_center *= (norm_B / norm_norm_B);
+    compute_sphere_from_focal_cone_solution(
+        Bx_By_c, points, point_count, sphere_radius, focal_length_pts, out_sphere_center, out_ellipse_projection);
+}
 
-    // Optionally compute the best fit ellipse
-    if (out_ellipse_projection != nullptr)
+void
+eigen_alignment_fast_fit_focal_cone_to_sphere(
+    const Eigen::Vector2f *points,
+    const int point_count,
+    const float sphere_radius,
+    const float focal_length_pts, // a.k.a. "f_px"
+    Eigen::Vector3f *out_sphere_center,
+    EigenFitEllipse *out_ellipse_projection)
+{
+    // Same least squares problem as above, but accumulate the 3x3 normal equations
+    // (A^T*A)x = A^T*b directly instead of building the Nx3 matrix.
+    // The columns of A are nearly parallel for a small contour far from the
+    // optical axis, so accumulate and solve in double to make up for
+    // squaring the condition number.
+    const double zz = static_cast<double>(focal_length_pts) * static_cast<double>(focal_length_pts);
+
+    Eigen::Matrix3d AtA = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d Atb = Eigen::Vector3d::Zero();
+    for (int i = 0; i<point_count; ++i)
     {
-        eigen_alignment_project_ellipse(out_sphere_center, k,
-                                        focal_length_pts, zz,
-                                        out_ellipse_projection);
-        
-        out_ellipse_projection->error=
-            eigen_alignment_compute_ellipse_fit_error(
-                points, point_count, *out_ellipse_projection);
+        const double x = points[i].x();
+        const double y = points[i].y();
+        const Eigen::Vector3d row(x, y, -sqrt(x*x + y*y + zz));
+
+        AtA.selfadjointView<Eigen::Upper>().rankUpdate(row);
+        Atb -= row * zz;
     }
+
+    const Eigen::Vector3f Bx_By_c = 
+        AtA.selfadjointView<Eigen::Upper>().ldlt().solve(Atb).cast<float>();
+
+    compute_sphere_from_focal_cone_solution(
+        Bx_By_c, points, point_count, sphere_radius, focal_length_pts, out_sphere_center, out_ellipse_projection);
 }
 
 
@@ -800,8 +881,8 @@ eigen_quaternion_compute_normalized_weighted_average(
     else if (count > 2)
     {
         // http://stackoverflow.com/questions/12374087/average-of-multiple-quaternions
-        Eigen::MatrixXf q(4, count);
-        Eigen::MatrixXf q_transpose(count, 4);
+        // M = q*q' is summed one weighted sample at a time instead of building the 4xN matrix q
+        Eigen::Matrix4f M = Eigen::Matrix4f::Zero();
 
         float total_weight= 0.f;
 		if (weights != nullptr)
@@ -820,24 +901,15 @@ eigen_quaternion_compute_normalized_weighted_average(
 			const float weight = (weights != nullptr) ? weights[index] : 0.f;
             const float normalized_weight= safe_divide_with_default(weight, total_weight, 1.f);
 
-            const float w= sample.w() * normalized_weight;
-            const float x= sample.x() * normalized_weight;
-            const float y= sample.y() * normalized_weight;
-            const float z= sample.z() * normalized_weight;
+            const Eigen::Vector4f q(
+                sample.w() * normalized_weight,
+                sample.x() * normalized_weight,
+                sample.y() * normalized_weight,
+                sample.z() * normalized_weight);
 
-            q(0, index) = w;
-            q(1, index) = x;
-            q(2, index) = y;
-            q(3, index) = z;
-
-            q_transpose(index, 0) = w;
-            q_transpose(index, 1) = x;
-            q_transpose(index, 2) = y;
-            q_transpose(index, 3) = z;
+            M.noalias() += q * q.transpose();
         }
 
-        Eigen::Matrix4f M= q*q_transpose;
-
         Eigen::EigenSolver<Eigen::Matrix4f> eigsolv(M);
         if (eigsolv.info() == Eigen::Success)
         {
@@ -883,8 +955,8 @@ eigen_quaternion_compute_weighted_average(
     else
     {
         // http://stackoverflow.com/questions/12374087/average-of-multiple-quaternions
-        Eigen::MatrixXd q(4, count);
-        Eigen::MatrixXd q_transpose(count, 4);
+        // M = q*q' is summed one weighted sample at a time instead of building the 4xN matrix q
+        Eigen::Matrix4d M = Eigen::Matrix4d::Zero();
 
         for (int index = 0; index < count; ++index)
         {
@@ -892,25 +964,16 @@ eigen_quaternion_compute_weighted_average(
 			const double signed_weight= (weights != nullptr) ? weights[index] : 1.f;
             const double unsigned_weight= fabs(signed_weight);
 
-            const double w= sample.w() * unsigned_weight;
 			// For negative weights, use the conjugate of the quaternion 
 			// (i.e. flip the rotation axis)
-            const double x= sample.x() * signed_weight;
-            const double y= sample.y() * signed_weight;
-            const double z= sample.z() * signed_weight;
-
-            q(0, index) = w;
-            q(1, index) = x;
-            q(2, index) = y;
-            q(3, index) = z;
-
-            q_transpose(index, 0) = w;
-            q_transpose(index, 1) = x;
-            q_transpose(index, 2) = y;
-            q_transpose(index, 3) = z;
-        }
+            const Eigen::Vector4d q(
+                sample.w() * unsigned_weight,
+                sample.x() * signed_weight,
+                sample.y() * signed_weight,
+                sample.z() * signed_weight);
 
-        Eigen::Matrix4d M= q*q_transpose;
+            M.noalias() += q * q.transpose();
+        }
 
         Eigen::EigenSolver<Eigen::Matrix4d> eigsolv(M);
         if (eigsolv.info() == Eigen::Success)
@@ -1116,24 +1179,28 @@ eigen_alignment_fit_least_squares_plane(
 
 	if (sample_count > 3)
 	{
-		Eigen::Matrix< float, Eigen::Dynamic, Eigen::Dynamic > coord(3, sample_count);
+		// calculate centroid
+		Eigen::Vector3f centroid= Eigen::Vector3f::Zero();
 		for (int i = 0; i < sample_count; ++i)
 		{
-			coord.col(i) = samples[i];
+			centroid+= samples[i];
 		}
+		centroid/= static_cast<float>(sample_count);
 
-		// calculate centroid
-		Eigen::Vector3f centroid(coord.row(0).mean(), coord.row(1).mean(), coord.row(2).mean());
+		// The left-singular vectors of the centered 3xN coordinate matrix are the
+		// eigenvectors of its 3x3 scatter matrix, so sum that instead of building the 3xN matrix.
+		//  http://math.stackexchange.com/questions/99299/best-fitting-plane-given-a-set-of-points
+		Eigen::Matrix3f scatter= Eigen::Matrix3f::Zero();
+		for (int i = 0; i < sample_count; ++i)
+		{
+			const Eigen::Vector3f offset= samples[i] - centroid;
 
-		// subtract centroid
-		coord.row(0).array() -= centroid(0);
-		coord.row(1).array() -= centroid(1); 
-		coord.row(2).array() -= centroid(2);
+			scatter.noalias()+= offset * offset.transpose();
+		}
 
-		// we only need the left-singular matrix here
-		//  http://math.stackexchange.com/questions/99299/best-fitting-plane-given-a-set-of-points
-		auto svd = coord.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV);
-		Eigen::Vector3f plane_normal = svd.matrixU().rightCols<1>();
+		// Eigenvalues are sorted in increasing order, the normal is the direction of least spread
+		const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> eigen_solver(scatter);
+		Eigen::Vector3f plane_normal = eigen_solver.eigenvectors().col(0);
 		float length= plane_normal.norm();
 
 		if (length > k_real_epsilon)
@@ -115,7 +115,8 @@ eigen_alignment_fit_focal_cone_to_sphere(
     const float focal_length_pts,
     Eigen::Vector3f *out_sphere_center);
 
-// Method of Doc_ok
+// Method of Doc_ok, solved with a QR decomposition of the Nx3 system.
+// Allocates the system on every call, use the fast version below on per frame paths.
 void
 eigen_alignment_fit_focal_cone_to_sphere(
     const Eigen::Vector2f *points,
@@ -125,6 +126,17 @@ eigen_alignment_fit_focal_cone_to_sphere(
     Eigen::Vector3f *out_sphere_center,
     EigenFitEllipse *out_ellipse_projection= nullptr);
 
+// Method of Doc_ok, solved through the 3x3 normal equations.
+// Doesn't allocate, so it can run on fixed capacity contour buffers every frame.
+void
+eigen_alignment_fast_fit_focal_cone_to_sphere(
+    const Eigen::Vector2f *points,
+    const int point_count,
+    const float sphere_radius,
+    const float focal_length_pts, // a.k.a. "f_px"
+    Eigen::Vector3f *out_sphere_center,
+    EigenFitEllipse *out_ellipse_projection= nullptr);
+
 // Compute the weighted average of multiple quaternions
 // * All weights will be renormalized against the total weight
 // * All input weights must be >= 0
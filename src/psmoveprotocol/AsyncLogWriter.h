@@ -0,0 +1,313 @@
+#ifndef ASYNC_LOG_WRITER_H
+#define ASYNC_LOG_WRITER_H
+
+//-- includes -----
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning (push)
+#pragma warning (disable: 4996) // 'This function or variable may be unsafe': localtime
+#endif
+
+//-- constants -----
+#define ASYNC_LOG_DEFAULT_CAPACITY		4096	// Queued lines before new lines get dropped
+#define ASYNC_LOG_FLUSH_INTERVAL_MS		10		// Longest a non-urgent line waits to get written
+
+//-- definitions -----
+struct AsyncLogEntry
+{
+	std::chrono::system_clock::time_point timestamp;
+	std::string text;
+};
+
+/// Bounded lock-free multi-producer / single-consumer ring buffer of log lines.
+/// Based on Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number
+/// that tells producers and the consumer whose turn it is to touch the cell.
+class AsyncLogQueue
+{
+public:
+	explicit AsyncLogQueue(size_t min_capacity)
+		: m_cells()
+		, m_mask(0)
+		, m_enqueuePos(0)
+		, m_dequeuePos(0)
+	{
+		size_t capacity = 2;
+		while (capacity < min_capacity)
+		{
+			capacity <<= 1;
+		}
+
+		m_cells.reset(new Cell[capacity]);
+		m_mask = capacity - 1;
+
+		for (size_t index = 0; index < capacity; ++index)
+		{
+			m_cells[index].sequence.store(index, std::memory_order_relaxed);
+		}
+	}
+
+	/// Safe to call from any thread. Returns false without blocking when the queue is full.
+	bool tryEnqueue(AsyncLogEntry &entry)
+	{
+		size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+		Cell *cell = nullptr;
+
+		for (;;)
+		{
+			cell = &m_cells[pos & m_mask];
+
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+			if (diff == 0)
+			{
+				// Cell is free, claim it
+				if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				// Consumer hasn't caught up yet
+				return false;
+			}
+			else
+			{
+				// Another producer claimed the cell first
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->entry.timestamp = entry.timestamp;
+		cell->entry.text.swap(entry.text);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/// Only call from the consumer thread
+	bool tryDequeue(AsyncLogEntry &out_entry)
+	{
+		const size_t pos = m_dequeuePos;
+		Cell &cell = m_cells[pos & m_mask];
+
+		const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0)
+		{
+			return false;
+		}
+
+		out_entry.timestamp = cell.entry.timestamp;
+		out_entry.text.swap(cell.entry.text);
+		cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+		m_dequeuePos = pos + 1;
+
+		return true;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		AsyncLogEntry entry;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	size_t m_mask;
+
+	// Keep the producer and consumer positions on separate cache lines
+	char m_pad0[64];
+	std::atomic<size_t> m_enqueuePos;
+	char m_pad1[64];
+	size_t m_dequeuePos;
+};
+
+/// Writes log lines to a set of streams from a background thread.
+/// Logging threads only format their line and push it onto the lock-free queue.
+/// The writer thread prefixes the timestamp, writes the lines in batches
+/// and flushes the streams once per batch instead of once per line.
+/// Lines are dropped, and counted, rather than blocking the caller when the queue is full.
+class AsyncLogWriter
+{
+public:
+	AsyncLogWriter(bool bTimestampPrefix, size_t capacity = ASYNC_LOG_DEFAULT_CAPACITY)
+		: m_queue(capacity)
+		, m_streams()
+		, m_bTimestampPrefix(bTimestampPrefix)
+		, m_droppedLineCount(0)
+		, m_bExitSignaled(false)
+		, m_wakeMutex()
+		, m_wakeCondition()
+		, m_thread()
+	{
+	}
+
+	~AsyncLogWriter()
+	{
+		stop();
+	}
+
+	void addStream(std::ostream *stream)
+	{
+		if (stream != nullptr && !m_thread.joinable())
+		{
+			m_streams.push_back(stream);
+		}
+	}
+
+	void start()
+	{
+		if (!m_thread.joinable())
+		{
+			m_bExitSignaled = false;
+			m_thread = std::thread(&AsyncLogWriter::threadFunc, this);
+		}
+	}
+
+	/// Writes out every queued line before returning
+	void stop()
+	{
+		if (m_thread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_wakeMutex);
+				m_bExitSignaled = true;
+			}
+			m_wakeCondition.notify_one();
+			m_thread.join();
+		}
+	}
+
+	/// Urgent lines (errors) wake the writer thread right away,
+	/// everything else is picked up on the next flush interval.
+	void push(std::chrono::system_clock::time_point timestamp, std::string &text, bool bUrgent)
+	{
+		AsyncLogEntry entry;
+		entry.timestamp = timestamp;
+		entry.text.swap(text);
+
+		if (m_queue.tryEnqueue(entry))
+		{
+			if (bUrgent)
+			{
+				m_wakeCondition.notify_one();
+			}
+		}
+		else
+		{
+			m_droppedLineCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	static std::string formatTimestampPrefix(std::chrono::system_clock::time_point timestamp)
+	{
+		const std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> seconds =
+			std::chrono::time_point_cast<std::chrono::seconds>(timestamp);
+		const long long milliseconds =
+			std::chrono::duration_cast<std::chrono::milliseconds>(timestamp - seconds).count();
+		const time_t in_time_t = std::chrono::system_clock::to_time_t(timestamp);
+
+		char date_string[32];
+		strftime(date_string, sizeof(date_string), "%Y-%m-%d %H:%M:%S", localtime(&in_time_t));
+
+		char prefix[48];
+		snprintf(prefix, sizeof(prefix), "[%s.%03d]: ", date_string, static_cast<int>(milliseconds));
+
+		return prefix;
+	}
+
+private:
+	void threadFunc()
+	{
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+
+		while (!m_bExitSignaled)
+		{
+			lock.unlock();
+			writeQueuedLines();
+			lock.lock();
+
+			if (!m_bExitSignaled)
+			{
+				m_wakeCondition.wait_for(lock, std::chrono::milliseconds(ASYNC_LOG_FLUSH_INTERVAL_MS));
+			}
+		}
+
+		lock.unlock();
+		writeQueuedLines();
+	}
+
+	void writeQueuedLines()
+	{
+		AsyncLogEntry entry;
+		bool bWroteLines = false;
+
+		while (m_queue.tryDequeue(entry))
+		{
+			const bool bNeedsNewline = entry.text.empty() || entry.text.back() != '\n';
+			const std::string prefix = m_bTimestampPrefix ? formatTimestampPrefix(entry.timestamp) : std::string();
+
+			for (std::ostream *stream : m_streams)
+			{
+				*stream << prefix << entry.text;
+				if (bNeedsNewline)
+				{
+					*stream << '\n';
+				}
+			}
+
+			bWroteLines = true;
+		}
+
+		const uint32_t dropped_line_count = m_droppedLineCount.exchange(0, std::memory_order_relaxed);
+		if (dropped_line_count > 0)
+		{
+			const std::string prefix = m_bTimestampPrefix ? formatTimestampPrefix(std::chrono::system_clock::now()) : std::string();
+
+			for (std::ostream *stream : m_streams)
+			{
+				*stream << prefix << "AsyncLogWriter - Log queue full, dropped " << dropped_line_count << " lines\n";
+			}
+
+			bWroteLines = true;
+		}
+
+		if (bWroteLines)
+		{
+			for (std::ostream *stream : m_streams)
+			{
+				stream->flush();
+			}
+		}
+	}
+
+	AsyncLogQueue m_queue;
+	std::vector<std::ostream *> m_streams;
+	bool m_bTimestampPrefix;
+	std::atomic<uint32_t> m_droppedLineCount;
+
+	// Writer thread state
+	bool m_bExitSignaled;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+	std::thread m_thread;
+};
+
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
+
+#endif // ASYNC_LOG_WRITER_H
@@ -12,6 +12,8 @@ namespace PSMoveProtocol
     class TrackingColorPreset;
 };
 
+struct MetricCounterStats;
+
 // -- constants -----
 enum eCommonTrackingColorID {
     INVALID_COLOR= -1,
@@ -480,8 +482,9 @@ public:
     // Sets the address of the bluetooth adapter on the host PC with the controller
     virtual bool setHostBluetoothAddress(const std::string &address) = 0;
 
-	// Sets the tracking color enum of the controller
-	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id) = 0;
+	// Sets the tracking color enum of the controller.
+	// Without bUpdateConfig the color only lasts until the controller is reopened and the config is left alone.
+	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig) = 0;
 
 	// Assign an HMD listener to send HMD events to
 	virtual void setControllerListener(IControllerListener *listener) = 0;
@@ -611,7 +614,8 @@ public:
         float distortionP1, float distortionP2) = 0;
 
     virtual CommonDevicePose getTrackerPose() const = 0;
-    virtual void setTrackerPose(const struct CommonDevicePose *pose) = 0;
+    // Without bUpdateConfig the pose only lasts until the settings are reloaded and the config is left alone
+    virtual void setTrackerPose(const struct CommonDevicePose *pose, bool bUpdateConfig) = 0;
 
     virtual void getFOV(float &outHFOV, float &outVFOV) const = 0;
     virtual void getZRange(float &outZNear, float &outZFar) const = 0;
@@ -623,6 +627,9 @@ public:
     virtual void gatherTrackingColorPresets(const std::string &controller_serial, PSMoveProtocol::Response_ResultTrackerSettings* settings) const = 0;
     virtual void setTrackingColorPreset(const std::string &controller_serial, eCommonTrackingColorID color, const CommonHSVColorRange *preset) = 0;
     virtual void getTrackingColorPreset(const std::string &controller_serial, eCommonTrackingColorID color, CommonHSVColorRange *out_preset) const = 0;
+
+    // Frames handed to the tracking pipeline and frames the camera replaced before they were taken
+    virtual void getCaptureMetrics(MetricCounterStats &out_captured_frames, MetricCounterStats &out_dropped_frames) const = 0;
 };
 
 /// Abstract class for HMD interface. Implemented HMD classes
@@ -15,6 +15,14 @@
 #include "hidapi.h"
 #include "gamepad/Gamepad.h"
 
+#include <algorithm>
+
+//-- constants -----
+// Merging the oldest packets needs at least two in the queue
+static const int k_min_imu_queue_capacity = 2;
+// Several seconds of IMU packets at 1kHz, any more lag than that isn't worth catching up on
+static const int k_max_imu_queue_capacity = 4096;
+
 //-- methods -----
 //-- Tracker Manager Config -----
 const int ControllerManagerConfig::CONFIG_VERSION = 1;
@@ -22,6 +30,8 @@ const int ControllerManagerConfig::CONFIG_VERSION = 1;
 ControllerManagerConfig::ControllerManagerConfig(const std::string &fnamebase)
     : PSMoveConfig(fnamebase)
     , virtual_controller_count(0)
+    , imu_queue_capacity(128)
+    , imu_queue_overflow_policy("drop_oldest")
 {
 
 };
@@ -33,6 +43,8 @@ ControllerManagerConfig::config2ptree()
 
     pt.put("version", ControllerManagerConfig::CONFIG_VERSION);
     pt.put("virtual_controller_count", virtual_controller_count);
+    pt.put("imu_queue_capacity", imu_queue_capacity);
+    pt.put("imu_queue_overflow_policy", imu_queue_overflow_policy);
 
     return pt;
 }
@@ -45,6 +57,18 @@ ControllerManagerConfig::ptree2config(const boost::property_tree::ptree &pt)
     if (version == ControllerManagerConfig::CONFIG_VERSION)
     {
         virtual_controller_count = pt.get<int>("virtual_controller_count", 0);
+        imu_queue_capacity = pt.get<int>("imu_queue_capacity", imu_queue_capacity);
+        if (imu_queue_capacity < k_min_imu_queue_capacity || imu_queue_capacity > k_max_imu_queue_capacity)
+        {
+            const int clamped_capacity =
+                std::min(std::max(imu_queue_capacity, k_min_imu_queue_capacity), k_max_imu_queue_capacity);
+
+            SERVER_LOG_WARNING("ControllerManagerConfig") <<
+                "imu_queue_capacity " << imu_queue_capacity << " out of range [" <<
+                k_min_imu_queue_capacity << ", " << k_max_imu_queue_capacity << "], using " << clamped_capacity;
+            imu_queue_capacity = clamped_capacity;
+        }
+        imu_queue_overflow_policy = pt.get<std::string>("imu_queue_overflow_policy", imu_queue_overflow_policy);
     }
     else
     {
@@ -27,6 +27,11 @@ public:
 
     int version;
     int virtual_controller_count;
+
+    // Max IMU packets queued per controller between main loop updates, clamped to [2, 4096]
+    int imu_queue_capacity;
+    // What to do when the queue fills up: "drop_oldest" or "merge_oldest"
+    std::string imu_queue_overflow_policy;
 };
 
 class ControllerManager : public DeviceTypeManager
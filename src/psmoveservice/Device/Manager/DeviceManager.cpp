@@ -18,7 +18,11 @@
 #include "ServerUtility.h"
 #include "PSMoveProtocol.pb.h"
 #include "PSMoveConfig.h"
+#include "SensorSessionRecorder.h"
+#include "TrackerColorCalibrator.h"
+#include "TrackerPoseCalibrator.h"
 #include "TrackerManager.h"
+#include "TrackingStageProfiler.h"
 
 #include <chrono>
 
@@ -110,11 +114,17 @@ DeviceManager::DeviceManager()
     , m_controller_manager(new ControllerManager())
     , m_tracker_manager(new TrackerManager())
     , m_hmd_manager(new HMDManager())
+    , m_sensor_session_recorder(new SensorSessionRecorder())
+    , m_tracker_pose_calibrator(new TrackerPoseCalibrator())
+    , m_tracker_color_calibrator(new TrackerColorCalibrator())
 {
 }
 
 DeviceManager::~DeviceManager()
 {
+    delete m_sensor_session_recorder;
+    delete m_tracker_pose_calibrator;
+    delete m_tracker_color_calibrator;
     delete m_controller_manager;
     delete m_tracker_manager;
     delete m_hmd_manager;
@@ -205,10 +215,22 @@ DeviceManager::update()
 
 	m_controller_manager->updateStateAndPredict(m_tracker_manager); // Compute pose/prediction of tracking blob+IMU state
 	m_hmd_manager->updateStateAndPredict(m_tracker_manager); // Compute pose/prediction of tracking blobs+IMU state
+	m_tracker_manager->updateFrameModes(); // Pick tracker frame modes for the next frames
+	m_tracker_pose_calibrator->update(m_controller_manager, m_tracker_manager); // Sample the calibration controller or apply solved tracker poses
+	m_tracker_color_calibrator->update(m_tracker_manager); // Sample the lit bulb and fit tracker color presets
 
-	m_controller_manager->publish(); // publish controller state to any listening clients  (common case)
-	m_tracker_manager->publish(); // publish tracker state to any listening clients (probably only used by ConfigTool)
-	m_hmd_manager->publish(); // publish hmd state to any listening clients (common case)
+	{
+		TrackingStageScope publish_scope(TrackingStage_Publish);
+
+		m_controller_manager->publish(); // publish controller state to any listening clients  (common case)
+		m_tracker_manager->publish(); // publish tracker state to any listening clients (probably only used by ConfigTool)
+		m_hmd_manager->publish(); // publish hmd state to any listening clients (common case)
+	}
+
+	if (m_sensor_session_recorder->getIsRecording())
+	{
+		m_sensor_session_recorder->recordUpdateTick(); // mark the end of this update in the sensor session
+	}
 }
 
 void
@@ -219,6 +241,15 @@ DeviceManager::shutdown()
 		m_config->save();
 	}
 
+	// Flush out any in-progress sensor session before the devices go away
+	m_sensor_session_recorder->stopRecording();
+
+	// Drop any tracker pose calibration in progress
+	m_tracker_pose_calibrator->cancel();
+
+	// Hand the controller LEDs back before the controllers close
+	m_tracker_color_calibrator->cancel();
+
 	if (m_controller_manager != nullptr)
 	{
 	    m_controller_manager->shutdown();
@@ -242,6 +273,111 @@ DeviceManager::shutdown()
     m_instance= nullptr;
 }
 
+// -- Sensor Session Recording --
+bool
+DeviceManager::startSensorSessionRecording(const std::string &filename, const bool bIncludeVideoFrames)
+{
+	if (!m_sensor_session_recorder->startRecording(filename, bIncludeVideoFrames))
+	{
+		return false;
+	}
+
+	// Record how to rebuild the pose filter of every device that is already open
+	for (int controller_id = 0; controller_id < getControllerViewMaxCount(); ++controller_id)
+	{
+		ServerControllerViewPtr controller_view = getControllerViewPtr(controller_id);
+
+		if (controller_view->getIsOpen() && controller_view->getPoseFilter() != nullptr)
+		{
+			m_sensor_session_recorder->recordFilterDesc(
+				SensorSessionDevice_Controller, controller_id, controller_view->getPoseFilterDesc());
+		}
+	}
+
+	for (int hmd_id = 0; hmd_id < getHMDViewMaxCount(); ++hmd_id)
+	{
+		ServerHMDViewPtr hmd_view = getHMDViewPtr(hmd_id);
+
+		if (hmd_view->getIsOpen() && hmd_view->getPoseFilter() != nullptr)
+		{
+			m_sensor_session_recorder->recordFilterDesc(
+				SensorSessionDevice_HMD, hmd_id, hmd_view->getPoseFilterDesc());
+		}
+	}
+
+	return true;
+}
+
+void
+DeviceManager::stopSensorSessionRecording()
+{
+	m_sensor_session_recorder->stopRecording();
+}
+
+bool
+DeviceManager::getIsRecordingSensorSession() const
+{
+	return m_sensor_session_recorder->getIsRecording();
+}
+
+// -- Tracker Pose Calibration --
+bool
+DeviceManager::startTrackerPoseCalibration(const int controller_id, const bool bOptimizeIntrinsics)
+{
+	return m_tracker_pose_calibrator->startSampling(controller_id, bOptimizeIntrinsics);
+}
+
+bool
+DeviceManager::solveTrackerPoseCalibration(const bool bApplyResult)
+{
+	return m_tracker_pose_calibrator->stopSampling(bApplyResult);
+}
+
+void
+DeviceManager::cancelTrackerPoseCalibration()
+{
+	m_tracker_pose_calibrator->cancel();
+}
+
+void
+DeviceManager::getTrackerPoseCalibrationStatus(TrackerPoseCalibrationStatus &out_status) const
+{
+	m_tracker_pose_calibrator->getStatus(out_status);
+}
+
+// -- Tracker Color Calibration --
+bool
+DeviceManager::startTrackerColorCalibration(const int connection_id, const std::vector<int> &controller_ids)
+{
+	std::vector<ServerControllerViewPtr> controller_views;
+
+	if (controller_ids.empty())
+	{
+		for (int controller_id = 0; controller_id < getControllerViewMaxCount(); ++controller_id)
+		{
+			controller_views.push_back(getControllerViewPtr(controller_id));
+		}
+	}
+	else
+	{
+		for (const int controller_id : controller_ids)
+		{
+			if (controller_id >= 0 && controller_id < getControllerViewMaxCount())
+			{
+				controller_views.push_back(getControllerViewPtr(controller_id));
+			}
+		}
+	}
+
+	return m_tracker_color_calibrator->start(connection_id, controller_views);
+}
+
+void
+DeviceManager::cancelTrackerColorCalibration()
+{
+	m_tracker_color_calibrator->cancel();
+}
+
 // -- Queries ---
 bool 
 DeviceManager::get_device_property(
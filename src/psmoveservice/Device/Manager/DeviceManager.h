@@ -77,6 +77,21 @@ public:
 	void handle_device_disconnected(enum DeviceClass device_class, const std::string &device_path) override;
 	void handle_bluetooth_request_started();
 	void handle_bluetooth_request_finished();
+
+	// -- Sensor Session Recording --
+	bool startSensorSessionRecording(const std::string &filename, const bool bIncludeVideoFrames);
+	void stopSensorSessionRecording();
+	bool getIsRecordingSensorSession() const;
+
+	// -- Tracker Pose Calibration --
+	bool startTrackerPoseCalibration(const int controller_id, const bool bOptimizeIntrinsics);
+	bool solveTrackerPoseCalibration(const bool bApplyResult);
+	void cancelTrackerPoseCalibration();
+	void getTrackerPoseCalibrationStatus(struct TrackerPoseCalibrationStatus &out_status) const;
+
+	// -- Tracker Color Calibration --
+	bool startTrackerColorCalibration(const int connection_id, const std::vector<int> &controller_ids);
+	void cancelTrackerColorCalibration();
     
 private:
 	/// Singleton instance of the class
@@ -96,6 +111,9 @@ public:
     class ControllerManager *m_controller_manager;
     class TrackerManager *m_tracker_manager;
     class HMDManager *m_hmd_manager;
+    class SensorSessionRecorder *m_sensor_session_recorder;
+    class TrackerPoseCalibrator *m_tracker_pose_calibrator;
+    class TrackerColorCalibrator *m_tracker_color_calibrator;
 };
 
 #endif  // DEVICE_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,237 @@
+#ifndef SENSOR_SESSION_LOG_H
+#define SENSOR_SESSION_LOG_H
+
+//-- includes -----
+#include "DeviceInterface.h"
+#include "PoseFilterInterface.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+//-- constants -----
+// A sensor session log is an append-only binary file:
+//   SensorSessionFileHeader
+//   { SensorSessionRecordHeader, payload (padded to k_sensor_session_record_alignment) } ...
+// Every record starts on an 8-byte boundary so the whole file can be memory mapped
+// and walked in place without copying.
+#define SENSOR_SESSION_LOG_MAGIC "PSMSESS"
+#define SENSOR_SESSION_LOG_VERSION 1
+
+static const size_t k_sensor_session_record_alignment = 8;
+static const size_t k_sensor_session_filter_name_length = 32;
+
+enum eSensorSessionRecordType
+{
+	SensorSessionRecord_FilterDesc,       // SensorSessionFilterDesc
+	SensorSessionRecord_PoseSensorPacket, // SensorSessionPoseSensorPacket
+	SensorSessionRecord_TrackerProjection,// SensorSessionTrackerProjection
+	SensorSessionRecord_TrackerFrame,     // SensorSessionTrackerFrame + pixel data
+	SensorSessionRecord_UpdateTick,       // SensorSessionUpdateTick
+
+	SensorSessionRecord_COUNT
+};
+
+enum eSensorSessionDeviceClass
+{
+	SensorSessionDevice_Controller,
+	SensorSessionDevice_HMD,
+	SensorSessionDevice_Tracker
+};
+
+//-- definitions -----
+#pragma pack(push, 1)
+struct SensorSessionFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t record_header_size;
+	uint32_t pose_filter_constants_size; // sizeof(PoseFilterConstants) in the recording build
+	int64_t start_time_ns; // high resolution clock time when the recording started
+};
+
+struct SensorSessionRecordHeader
+{
+	uint16_t record_type; // eSensorSessionRecordType
+	uint16_t device_class; // eSensorSessionDeviceClass
+	int16_t device_id;
+	int16_t tracker_id; // -1 when not tracker specific
+	uint32_t payload_size; // unpadded size of the payload following this header
+	uint32_t reserved;
+	int64_t timestamp_ns; // time since the start of the recording
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SensorSessionFileHeader) % k_sensor_session_record_alignment == 0, "unaligned file header");
+static_assert(sizeof(SensorSessionRecordHeader) % k_sensor_session_record_alignment == 0, "unaligned record header");
+
+/// Everything needed to rebuild a device's pose filter without the device being connected
+struct SensorSessionFilterDesc
+{
+	int32_t device_type; // CommonDeviceState::eDeviceType
+	char position_filter_type[k_sensor_session_filter_name_length];
+	char orientation_filter_type[k_sensor_session_filter_name_length];
+
+	float identity_gravity[3];
+	float identity_magnetometer[3];
+	float calibration_transform[9]; // column major
+	float sensor_transform[9]; // column major
+
+	PoseFilterConstants constants;
+
+	inline void clear()
+	{
+		memset(static_cast<void *>(this), 0, sizeof(SensorSessionFilterDesc));
+		device_type = CommonDeviceState::INVALID_DEVICE_TYPE;
+		constants.clear();
+	}
+
+	inline void set(
+		const CommonDeviceState::eDeviceType deviceType,
+		const std::string &position_filter,
+		const std::string &orientation_filter,
+		const PoseFilterSpace *space,
+		const PoseFilterConstants &filter_constants)
+	{
+		device_type = static_cast<int32_t>(deviceType);
+		strncpy(position_filter_type, position_filter.c_str(), k_sensor_session_filter_name_length - 1);
+		position_filter_type[k_sensor_session_filter_name_length - 1] = '\0';
+		strncpy(orientation_filter_type, orientation_filter.c_str(), k_sensor_session_filter_name_length - 1);
+		orientation_filter_type[k_sensor_session_filter_name_length - 1] = '\0';
+
+		Eigen::Vector3f::Map(identity_gravity) = space->getIdentityGravity();
+		Eigen::Vector3f::Map(identity_magnetometer) = space->getIdentityMagnetometer();
+		Eigen::Matrix3f::Map(calibration_transform) = space->getCalibrationTransform();
+		Eigen::Matrix3f::Map(sensor_transform) = space->getSensorTransform();
+
+		constants = filter_constants;
+	}
+
+	inline void applyToSpace(PoseFilterSpace *space) const
+	{
+		space->setIdentityGravity(Eigen::Vector3f::Map(identity_gravity));
+		space->setIdentityMagnetometer(Eigen::Vector3f::Map(identity_magnetometer));
+		space->setCalibrationTransform(Eigen::Matrix3f::Map(calibration_transform));
+		space->setSensorTransform(Eigen::Matrix3f::Map(sensor_transform));
+	}
+};
+
+/// A PoseSensorPacket exactly as it was handed to a pose filter
+struct SensorSessionPoseSensorPacket
+{
+	int64_t sensor_timestamp_ns; // PoseSensorPacket::timestamp since the clock epoch
+	float time_delta_seconds; // filter time step used for this packet
+	float tracking_projection_area_px_sqr;
+
+	float optical_position_cm[3];
+	float optical_orientation[4]; // w, x, y, z
+
+	int32_t raw_imu_accelerometer[3];
+	int32_t raw_imu_magnetometer[3];
+	int32_t raw_imu_gyroscope[3];
+	float imu_accelerometer_g_units[3];
+	float imu_magnetometer_unit[3];
+	float imu_gyroscope_rad_per_sec[3];
+
+	uint8_t has_accelerometer_measurement;
+	uint8_t has_magnetometer_measurement;
+	uint8_t has_gyroscope_measurement;
+	uint8_t is_synced;
+	uint32_t padding;
+
+	inline void set(const PoseSensorPacket &packet, const float time_delta, const bool bIsSynced)
+	{
+		sensor_timestamp_ns =
+			std::chrono::duration_cast<std::chrono::nanoseconds>(packet.timestamp.time_since_epoch()).count();
+		time_delta_seconds = time_delta;
+		tracking_projection_area_px_sqr = packet.tracking_projection_area_px_sqr;
+
+		Eigen::Vector3f::Map(optical_position_cm) = packet.optical_position_cm;
+		optical_orientation[0] = packet.optical_orientation.w();
+		optical_orientation[1] = packet.optical_orientation.x();
+		optical_orientation[2] = packet.optical_orientation.y();
+		optical_orientation[3] = packet.optical_orientation.z();
+
+		raw_imu_accelerometer[0] = packet.raw_imu_accelerometer.i;
+		raw_imu_accelerometer[1] = packet.raw_imu_accelerometer.j;
+		raw_imu_accelerometer[2] = packet.raw_imu_accelerometer.k;
+		raw_imu_magnetometer[0] = packet.raw_imu_magnetometer.i;
+		raw_imu_magnetometer[1] = packet.raw_imu_magnetometer.j;
+		raw_imu_magnetometer[2] = packet.raw_imu_magnetometer.k;
+		raw_imu_gyroscope[0] = packet.raw_imu_gyroscope.i;
+		raw_imu_gyroscope[1] = packet.raw_imu_gyroscope.j;
+		raw_imu_gyroscope[2] = packet.raw_imu_gyroscope.k;
+		Eigen::Vector3f::Map(imu_accelerometer_g_units) = packet.imu_accelerometer_g_units;
+		Eigen::Vector3f::Map(imu_magnetometer_unit) = packet.imu_magnetometer_unit;
+		Eigen::Vector3f::Map(imu_gyroscope_rad_per_sec) = packet.imu_gyroscope_rad_per_sec;
+
+		has_accelerometer_measurement = packet.has_accelerometer_measurement ? 1 : 0;
+		has_magnetometer_measurement = packet.has_magnetometer_measurement ? 1 : 0;
+		has_gyroscope_measurement = packet.has_gyroscope_measurement ? 1 : 0;
+		is_synced = bIsSynced ? 1 : 0;
+		padding = 0;
+	}
+
+	inline void get(PoseSensorPacket &out_packet) const
+	{
+		out_packet.clear();
+		out_packet.timestamp =
+			std::chrono::time_point<std::chrono::high_resolution_clock>(
+				std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+					std::chrono::nanoseconds(sensor_timestamp_ns)));
+		out_packet.tracking_projection_area_px_sqr = tracking_projection_area_px_sqr;
+
+		out_packet.optical_position_cm = Eigen::Vector3f::Map(optical_position_cm);
+		out_packet.optical_orientation =
+			Eigen::Quaternionf(optical_orientation[0], optical_orientation[1], optical_orientation[2], optical_orientation[3]);
+
+		out_packet.raw_imu_accelerometer.i = raw_imu_accelerometer[0];
+		out_packet.raw_imu_accelerometer.j = raw_imu_accelerometer[1];
+		out_packet.raw_imu_accelerometer.k = raw_imu_accelerometer[2];
+		out_packet.raw_imu_magnetometer.i = raw_imu_magnetometer[0];
+		out_packet.raw_imu_magnetometer.j = raw_imu_magnetometer[1];
+		out_packet.raw_imu_magnetometer.k = raw_imu_magnetometer[2];
+		out_packet.raw_imu_gyroscope.i = raw_imu_gyroscope[0];
+		out_packet.raw_imu_gyroscope.j = raw_imu_gyroscope[1];
+		out_packet.raw_imu_gyroscope.k = raw_imu_gyroscope[2];
+		out_packet.imu_accelerometer_g_units = Eigen::Vector3f::Map(imu_accelerometer_g_units);
+		out_packet.imu_magnetometer_unit = Eigen::Vector3f::Map(imu_magnetometer_unit);
+		out_packet.imu_gyroscope_rad_per_sec = Eigen::Vector3f::Map(imu_gyroscope_rad_per_sec);
+
+		out_packet.has_accelerometer_measurement = has_accelerometer_measurement != 0;
+		out_packet.has_magnetometer_measurement = has_magnetometer_measurement != 0;
+		out_packet.has_gyroscope_measurement = has_gyroscope_measurement != 0;
+	}
+};
+
+/// The projection of a tracked device found in a single tracker's video frame
+struct SensorSessionTrackerProjection
+{
+	CommonDeviceTrackingProjection projection;
+	int32_t is_visible;
+	int32_t padding;
+};
+
+/// Raw video frame as delivered by the tracker (pixel data follows this struct)
+struct SensorSessionTrackerFrame
+{
+	int32_t width;
+	int32_t height;
+	int32_t stride;
+	int32_t byte_count;
+};
+
+/// Marks the end of one DeviceManager::update()
+struct SensorSessionUpdateTick
+{
+	int64_t tick_index;
+};
+
+//-- functions -----
+inline size_t sensor_session_padded_size(const size_t payload_size)
+{
+	return (payload_size + k_sensor_session_record_alignment - 1) & ~(k_sensor_session_record_alignment - 1);
+}
+
+#endif // SENSOR_SESSION_LOG_H
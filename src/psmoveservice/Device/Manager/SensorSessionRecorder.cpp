@@ -0,0 +1,368 @@
+//-- includes -----
+#include "SensorSessionRecorder.h"
+#include "PSMoveConfig.h"
+#include "ServerLog.h"
+
+#include <assert.h>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+//-- constants -----
+static const char *k_recordings_directory_name = "recordings";
+static const int k_records_per_flush = 256;
+static const int k_max_records_per_work_item = 64;
+static const int k_idle_sleep_milliseconds = 2;
+
+//-- prototypes -----
+static bool is_bare_filename(const std::string &filename);
+
+//-- statics -----
+SensorSessionRecorder *SensorSessionRecorder::m_active_instance = nullptr;
+
+//-- public implementation -----
+SensorSessionRecorder::SensorSessionRecorder()
+	: WorkerThread("SensorSessionWriter")
+	, m_filename()
+	, m_bRecordVideoFrames(false)
+	, m_startTime()
+	, m_tickIndex(0)
+	, m_droppedRecordCount(0)
+	, m_spareFrameBufferIndex(-1)
+	, m_recordQueue(k_sensor_session_record_queue_size)
+	, m_freeFrameBufferQueue(k_sensor_session_max_pending_frames)
+	, m_file(nullptr)
+	, m_recordsSinceFlush(0)
+{
+}
+
+SensorSessionRecorder::~SensorSessionRecorder()
+{
+	stopRecording();
+}
+
+bool SensorSessionRecorder::startRecording(const std::string &filename, const bool bIncludeVideoFrames)
+{
+	if (getIsRecording())
+	{
+		SERVER_LOG_WARNING("SensorSessionRecorder::startRecording") << "Already recording to " << m_filename;
+		return false;
+	}
+
+	if (!is_bare_filename(filename))
+	{
+		SERVER_LOG_ERROR("SensorSessionRecorder::startRecording") << "Rejected recording file name \"" << filename
+			<< "\", only a file name without a path is allowed";
+		return false;
+	}
+
+	// Recordings always go in the recordings folder of the config directory
+	boost::filesystem::path recording_path(PSMoveConfig::getConfigDirectory());
+	recording_path /= k_recordings_directory_name;
+
+	boost::system::error_code error;
+	boost::filesystem::create_directory(recording_path, error);
+
+	recording_path /= filename;
+	const std::string recording_filename = recording_path.string();
+
+	m_file = fopen(recording_filename.c_str(), "wb");
+	if (m_file == nullptr)
+	{
+		SERVER_LOG_ERROR("SensorSessionRecorder::startRecording") << "Failed to open " << recording_filename << " for writing";
+		return false;
+	}
+
+	m_filename = recording_filename;
+	m_bRecordVideoFrames = bIncludeVideoFrames;
+	m_startTime = std::chrono::high_resolution_clock::now();
+	m_tickIndex = 0;
+	m_droppedRecordCount = 0;
+	m_recordsSinceFlush = 0;
+
+	SensorSessionFileHeader file_header;
+	memset(&file_header, 0, sizeof(SensorSessionFileHeader));
+	strncpy(file_header.magic, SENSOR_SESSION_LOG_MAGIC, sizeof(file_header.magic));
+	file_header.version = SENSOR_SESSION_LOG_VERSION;
+	file_header.header_size = sizeof(SensorSessionFileHeader);
+	file_header.record_header_size = sizeof(SensorSessionRecordHeader);
+	file_header.pose_filter_constants_size = sizeof(PoseFilterConstants);
+	file_header.start_time_ns =
+		std::chrono::duration_cast<std::chrono::nanoseconds>(m_startTime.time_since_epoch()).count();
+	fwrite(&file_header, sizeof(SensorSessionFileHeader), 1, m_file);
+
+	// Hand every frame buffer to the pool.
+	// The writer thread isn't running yet so it's safe to produce into its queue here.
+	for (int buffer_index = 0; buffer_index < k_sensor_session_max_pending_frames; ++buffer_index)
+	{
+		m_freeFrameBufferQueue.try_enqueue(buffer_index);
+	}
+
+	WorkerThread::startThread();
+	m_active_instance = this;
+
+	SERVER_LOG_INFO("SensorSessionRecorder::startRecording") << "Recording sensor session to " << recording_filename
+		<< (bIncludeVideoFrames ? " (with video frames)" : "");
+
+	return true;
+}
+
+void SensorSessionRecorder::stopRecording()
+{
+	if (getIsRecording())
+	{
+		m_active_instance = nullptr;
+
+		// Joins the writer thread, which drains the queue and closes the file in onThreadHaltComplete
+		WorkerThread::stopThread();
+
+		if (m_droppedRecordCount > 0)
+		{
+			SERVER_LOG_WARNING("SensorSessionRecorder::stopRecording") << "Dropped " << m_droppedRecordCount
+				<< " records because the writer thread fell behind";
+		}
+
+		SERVER_LOG_INFO("SensorSessionRecorder::stopRecording") << "Stopped recording sensor session to " << m_filename;
+	}
+}
+
+void SensorSessionRecorder::recordFilterDesc(
+	const eSensorSessionDeviceClass device_class,
+	const int device_id,
+	const SensorSessionFilterDesc &filter_desc)
+{
+	enqueue_record(
+		SensorSessionRecord_FilterDesc, device_class, device_id, -1,
+		&filter_desc, sizeof(SensorSessionFilterDesc));
+}
+
+void SensorSessionRecorder::recordPoseSensorPacket(
+	const eSensorSessionDeviceClass device_class,
+	const int device_id,
+	const PoseSensorPacket &sensor_packet,
+	const float time_delta_seconds,
+	const bool bIsSynced)
+{
+	SensorSessionPoseSensorPacket packet;
+	packet.set(sensor_packet, time_delta_seconds, bIsSynced);
+
+	enqueue_record(
+		SensorSessionRecord_PoseSensorPacket, device_class, device_id, -1,
+		&packet, sizeof(SensorSessionPoseSensorPacket));
+}
+
+void SensorSessionRecorder::recordTrackerProjection(
+	const eSensorSessionDeviceClass device_class,
+	const int device_id,
+	const int tracker_id,
+	const CommonDeviceTrackingProjection &projection,
+	const bool bIsVisible)
+{
+	SensorSessionTrackerProjection record;
+	record.projection = projection;
+	record.is_visible = bIsVisible ? 1 : 0;
+	record.padding = 0;
+
+	enqueue_record(
+		SensorSessionRecord_TrackerProjection, device_class, device_id, tracker_id,
+		&record, sizeof(SensorSessionTrackerProjection));
+}
+
+void SensorSessionRecorder::recordTrackerFrame(
+	const int tracker_id,
+	const unsigned char *buffer,
+	const int width,
+	const int height,
+	const int stride)
+{
+	if (!m_bRecordVideoFrames || buffer == nullptr || height <= 0 || stride <= 0)
+	{
+		return;
+	}
+
+	// Video frames are too big for the record queue so they get copied into a pooled buffer.
+	// If the writer hasn't returned any buffers yet then drop the frame rather than stall the main thread.
+	int buffer_index = m_spareFrameBufferIndex;
+	if (buffer_index >= 0)
+	{
+		m_spareFrameBufferIndex = -1;
+	}
+	else if (!m_freeFrameBufferQueue.try_dequeue(buffer_index))
+	{
+		++m_droppedRecordCount;
+		return;
+	}
+
+	SensorSessionTrackerFrame frame;
+	frame.width = width;
+	frame.height = height;
+	frame.stride = stride;
+	frame.byte_count = stride * height;
+
+	std::vector<unsigned char> &frame_buffer = m_frameBuffers[buffer_index];
+	frame_buffer.resize(frame.byte_count);
+	memcpy(frame_buffer.data(), buffer, frame.byte_count);
+
+	if (!enqueue_record(
+			SensorSessionRecord_TrackerFrame, SensorSessionDevice_Tracker, tracker_id, tracker_id,
+			&frame, sizeof(SensorSessionTrackerFrame), buffer_index))
+	{
+		// The writer thread is the only producer of free buffers so hold on to this one locally
+		m_spareFrameBufferIndex = buffer_index;
+	}
+}
+
+void SensorSessionRecorder::recordUpdateTick()
+{
+	SensorSessionUpdateTick tick;
+	tick.tick_index = m_tickIndex;
+	++m_tickIndex;
+
+	enqueue_record(
+		SensorSessionRecord_UpdateTick, SensorSessionDevice_Controller, -1, -1,
+		&tick, sizeof(SensorSessionUpdateTick));
+}
+
+//-- protected implementation -----
+bool SensorSessionRecorder::enqueue_record(
+	const eSensorSessionRecordType record_type,
+	const eSensorSessionDeviceClass device_class,
+	const int device_id,
+	const int tracker_id,
+	const void *payload,
+	const size_t payload_size,
+	const int frame_buffer_index)
+{
+	assert(payload_size <= k_sensor_session_max_inline_payload_size);
+	const std::chrono::duration<int64_t, std::nano> time_since_start =
+		std::chrono::high_resolution_clock::now() - m_startTime;
+
+	SensorSessionQueuedRecord record;
+	record.header.record_type = static_cast<uint16_t>(record_type);
+	record.header.device_class = static_cast<uint16_t>(device_class);
+	record.header.device_id = static_cast<int16_t>(device_id);
+	record.header.tracker_id = static_cast<int16_t>(tracker_id);
+	record.header.payload_size = static_cast<uint32_t>(payload_size);
+	record.header.reserved = 0;
+	record.header.timestamp_ns = time_since_start.count();
+	record.frame_buffer_index = frame_buffer_index;
+	memcpy(record.payload.bytes, payload, payload_size);
+
+	// Never block or allocate on the main thread
+	if (!m_recordQueue.try_enqueue(record))
+	{
+		++m_droppedRecordCount;
+		return false;
+	}
+
+	return true;
+}
+
+bool SensorSessionRecorder::write_record(const SensorSessionQueuedRecord &record)
+{
+	static const uint8_t k_padding[k_sensor_session_record_alignment] = { 0 };
+
+	const uint8_t *payload = record.payload.bytes;
+	size_t payload_size = record.header.payload_size;
+	const unsigned char *frame_data = nullptr;
+	size_t frame_size = 0;
+
+	SensorSessionRecordHeader header = record.header;
+	if (record.frame_buffer_index >= 0)
+	{
+		frame_data = m_frameBuffers[record.frame_buffer_index].data();
+		frame_size = m_frameBuffers[record.frame_buffer_index].size();
+		header.payload_size += static_cast<uint32_t>(frame_size);
+	}
+
+	const size_t padding_size = sensor_session_padded_size(header.payload_size) - header.payload_size;
+
+	bool bSuccess = fwrite(&header, sizeof(SensorSessionRecordHeader), 1, m_file) == 1;
+	bSuccess &= fwrite(payload, 1, payload_size, m_file) == payload_size;
+	if (frame_data != nullptr)
+	{
+		bSuccess &= fwrite(frame_data, 1, frame_size, m_file) == frame_size;
+	}
+	if (padding_size > 0)
+	{
+		bSuccess &= fwrite(k_padding, 1, padding_size, m_file) == padding_size;
+	}
+
+	if (record.frame_buffer_index >= 0)
+	{
+		// Give the frame buffer back to the main thread
+		m_freeFrameBufferQueue.try_enqueue(record.frame_buffer_index);
+	}
+
+	return bSuccess;
+}
+
+bool SensorSessionRecorder::doWork()
+{
+	int records_written = 0;
+
+	SensorSessionQueuedRecord record;
+	while (records_written < k_max_records_per_work_item && m_recordQueue.try_dequeue(record))
+	{
+		if (!write_record(record))
+		{
+			SERVER_MT_LOG_ERROR("SensorSessionRecorder::doWork") << "Failed to write to " << m_filename;
+
+			// halt the worker thread
+			return false;
+		}
+
+		++records_written;
+	}
+
+	if (records_written > 0)
+	{
+		m_recordsSinceFlush += records_written;
+		if (m_recordsSinceFlush >= k_records_per_flush)
+		{
+			fflush(m_file);
+			m_recordsSinceFlush = 0;
+		}
+	}
+	else
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(k_idle_sleep_milliseconds));
+	}
+
+	return true;
+}
+
+void SensorSessionRecorder::onThreadHaltComplete()
+{
+	// The writer thread has exited so the main thread owns the queue consumer now.
+	// Write out anything posted before the recording was stopped.
+	SensorSessionQueuedRecord record;
+	while (m_recordQueue.try_dequeue(record))
+	{
+		write_record(record);
+	}
+
+	// Reclaim the frame buffers for the next recording
+	m_spareFrameBufferIndex = -1;
+	int buffer_index;
+	while (m_freeFrameBufferQueue.try_dequeue(buffer_index))
+	{
+		m_frameBuffers[buffer_index].clear();
+	}
+
+	fclose(m_file);
+	m_file = nullptr;
+}
+
+//-- private functions -----
+static bool
+is_bare_filename(const std::string &filename)
+{
+	if (filename.empty() || filename == "." || filename.find("..") != std::string::npos)
+	{
+		return false;
+	}
+
+	// No directory separators or drive letters
+	return filename.find_first_of("/\\:") == std::string::npos;
+}
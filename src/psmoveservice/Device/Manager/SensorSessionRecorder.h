@@ -0,0 +1,125 @@
+#ifndef SENSOR_SESSION_RECORDER_H
+#define SENSOR_SESSION_RECORDER_H
+
+//-- includes -----
+#include "SensorSessionLog.h"
+#include "WorkerThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "readerwriterqueue.h" // lockfree queue
+
+//-- constants -----
+static const size_t k_sensor_session_max_inline_payload_size = sizeof(SensorSessionFilterDesc);
+static const int k_sensor_session_record_queue_size = 4096;
+static const int k_sensor_session_max_pending_frames = 8;
+
+//-- definitions -----
+/// A record waiting in the queue for the writer thread
+struct SensorSessionQueuedRecord
+{
+	SensorSessionRecordHeader header;
+	int frame_buffer_index; // -1 unless this is a SensorSessionRecord_TrackerFrame
+
+	union
+	{
+		uint64_t aligned_words[(k_sensor_session_max_inline_payload_size + 7) / 8];
+		uint8_t bytes[(k_sensor_session_max_inline_payload_size + 7) / 8 * 8];
+	} payload;
+};
+
+using t_sensor_session_record_queue = moodycamel::ReaderWriterQueue<SensorSessionQueuedRecord, 512>;
+using t_sensor_session_frame_index_queue = moodycamel::ReaderWriterQueue<int, 16>;
+
+/// Captures the inputs of every pose filter (and optionally the raw tracker video)
+/// into a binary sensor session log that SensorSessionReplayer can play back.
+/// All of the record* methods must be called from the main thread.
+/// They only copy the record into a lock-free queue; the file IO happens on a worker thread.
+class SensorSessionRecorder : public WorkerThread
+{
+public:
+	SensorSessionRecorder();
+	virtual ~SensorSessionRecorder();
+
+	/// Returns the recorder if a recording is in progress, nullptr otherwise
+	static inline SensorSessionRecorder *getActiveRecorder()
+	{ return m_active_instance; }
+
+	/// Starts writing a session to <config directory>/recordings/<filename>.
+	/// The filename comes from clients so it must be a bare file name, paths are rejected.
+	bool startRecording(const std::string &filename, const bool bIncludeVideoFrames);
+	void stopRecording();
+
+	inline bool getIsRecording() const { return m_file != nullptr; }
+	inline bool getIsRecordingVideoFrames() const { return m_bRecordVideoFrames; }
+	inline const std::string &getFilename() const { return m_filename; }
+	inline int getDroppedRecordCount() const { return m_droppedRecordCount; }
+
+	void recordFilterDesc(
+		const eSensorSessionDeviceClass device_class,
+		const int device_id,
+		const SensorSessionFilterDesc &filter_desc);
+	void recordPoseSensorPacket(
+		const eSensorSessionDeviceClass device_class,
+		const int device_id,
+		const PoseSensorPacket &sensor_packet,
+		const float time_delta_seconds,
+		const bool bIsSynced);
+	void recordTrackerProjection(
+		const eSensorSessionDeviceClass device_class,
+		const int device_id,
+		const int tracker_id,
+		const CommonDeviceTrackingProjection &projection,
+		const bool bIsVisible);
+	void recordTrackerFrame(
+		const int tracker_id,
+		const unsigned char *buffer,
+		const int width,
+		const int height,
+		const int stride);
+	void recordUpdateTick();
+
+protected:
+	bool enqueue_record(
+		const eSensorSessionRecordType record_type,
+		const eSensorSessionDeviceClass device_class,
+		const int device_id,
+		const int tracker_id,
+		const void *payload,
+		const size_t payload_size,
+		const int frame_buffer_index= -1);
+	bool write_record(const SensorSessionQueuedRecord &record);
+
+	virtual bool doWork() override;
+	virtual void onThreadHaltComplete() override;
+
+private:
+	static SensorSessionRecorder *m_active_instance;
+
+	// Main Thread State
+	std::string m_filename;
+	bool m_bRecordVideoFrames;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
+	int64_t m_tickIndex;
+	int m_droppedRecordCount;
+	int m_spareFrameBufferIndex;
+
+	// Owned by whichever thread holds the buffer's index
+	std::vector<unsigned char> m_frameBuffers[k_sensor_session_max_pending_frames];
+
+	// Shared State (main thread produces records, the writer thread returns frame buffers)
+	t_sensor_session_record_queue m_recordQueue;
+	t_sensor_session_frame_index_queue m_freeFrameBufferQueue;
+
+	// Opened and closed on the main thread, only written to by the writer thread
+	FILE *m_file;
+
+	// Writer Thread State
+	int m_recordsSinceFlush;
+};
+
+#endif // SENSOR_SESSION_RECORDER_H
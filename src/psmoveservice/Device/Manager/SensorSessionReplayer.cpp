@@ -0,0 +1,363 @@
+//-- includes -----
+#include "SensorSessionReplayer.h"
+#include "ServerControllerView.h"
+#include "ServerHMDView.h"
+#include "ServerLog.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//-- constants -----
+// Filters that read live input from outside the recording (named pipes, other devices).
+// A replay must only ever feed a filter with what is in the session file.
+static const char *k_non_replayable_filter_types[] = {
+	"OrientationExternal",
+	"PositionExternalAttachment"
+};
+
+//-- prototypes -----
+static bool is_replayable_filter_type(const char *filter_type);
+
+//-- public implementation -----
+SensorSessionReplayer::SensorSessionReplayer()
+	: m_file_mapping(nullptr)
+	, m_region(nullptr)
+	, m_data(nullptr)
+	, m_data_size(0)
+{
+	m_stats.clear();
+}
+
+SensorSessionReplayer::~SensorSessionReplayer()
+{
+	close();
+}
+
+bool SensorSessionReplayer::open(const std::string &filename)
+{
+	close();
+
+	try
+	{
+		m_file_mapping = new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+		m_region = new boost::interprocess::mapped_region(*m_file_mapping, boost::interprocess::read_only);
+	}
+	catch (boost::interprocess::interprocess_exception &e)
+	{
+		SERVER_LOG_ERROR("SensorSessionReplayer::open") << "Failed to map " << filename << ": " << e.what();
+		close();
+		return false;
+	}
+
+	m_data = static_cast<const uint8_t *>(m_region->get_address());
+	m_data_size = m_region->get_size();
+
+	if (m_data_size < sizeof(SensorSessionFileHeader))
+	{
+		SERVER_LOG_ERROR("SensorSessionReplayer::open") << filename << " is too small to be a sensor session";
+		close();
+		return false;
+	}
+
+	const SensorSessionFileHeader *file_header = reinterpret_cast<const SensorSessionFileHeader *>(m_data);
+	if (strncmp(file_header->magic, SENSOR_SESSION_LOG_MAGIC, sizeof(file_header->magic)) != 0 ||
+		file_header->version != SENSOR_SESSION_LOG_VERSION ||
+		file_header->header_size != sizeof(SensorSessionFileHeader) ||
+		file_header->record_header_size != sizeof(SensorSessionRecordHeader))
+	{
+		SERVER_LOG_ERROR("SensorSessionReplayer::open") << filename << " is not a version "
+			<< SENSOR_SESSION_LOG_VERSION << " sensor session";
+		close();
+		return false;
+	}
+
+	// The filter constants are stored as raw structs, so they only make sense to a matching build
+	if (file_header->pose_filter_constants_size != sizeof(PoseFilterConstants))
+	{
+		SERVER_LOG_ERROR("SensorSessionReplayer::open") << filename
+			<< " was recorded by an incompatible build (PoseFilterConstants size "
+			<< file_header->pose_filter_constants_size << " != " << sizeof(PoseFilterConstants) << ")";
+		close();
+		return false;
+	}
+
+	SERVER_LOG_INFO("SensorSessionReplayer::open") << "Opened sensor session " << filename
+		<< " (" << m_data_size << " bytes)";
+
+	return true;
+}
+
+void SensorSessionReplayer::close()
+{
+	for (int controller_id = 0; controller_id < PSMOVESERVICE_MAX_CONTROLLER_COUNT; ++controller_id)
+	{
+		m_controller_views[controller_id].reset();
+	}
+
+	for (int hmd_id = 0; hmd_id < PSMOVESERVICE_MAX_HMD_COUNT; ++hmd_id)
+	{
+		m_hmd_views[hmd_id].reset();
+	}
+
+	if (m_region != nullptr)
+	{
+		delete m_region;
+		m_region = nullptr;
+	}
+
+	if (m_file_mapping != nullptr)
+	{
+		delete m_file_mapping;
+		m_file_mapping = nullptr;
+	}
+
+	m_data = nullptr;
+	m_data_size = 0;
+}
+
+bool SensorSessionReplayer::replay(const std::string &output_filename)
+{
+	if (m_data == nullptr)
+	{
+		return false;
+	}
+
+	FILE *output_file = nullptr;
+	if (output_filename.length() > 0)
+	{
+		output_file = fopen(output_filename.c_str(), "wt");
+		if (output_file == nullptr)
+		{
+			SERVER_LOG_ERROR("SensorSessionReplayer::replay") << "Failed to open " << output_filename << " for writing";
+			return false;
+		}
+
+		fprintf(output_file, "DEVICE_CLASS, DEVICE_ID, RECORD_TIME_NS, DELTA_TIME, POS_X_CM, POS_Y_CM, POS_Z_CM, ORI_W, ORI_X, ORI_Y, ORI_Z\n");
+	}
+
+	m_stats.clear();
+
+	bool bSuccess = true;
+	size_t offset = sizeof(SensorSessionFileHeader);
+	while (offset + sizeof(SensorSessionRecordHeader) <= m_data_size)
+	{
+		const SensorSessionRecordHeader *header = reinterpret_cast<const SensorSessionRecordHeader *>(m_data + offset);
+		const uint8_t *payload = m_data + offset + sizeof(SensorSessionRecordHeader);
+		const size_t record_size = sizeof(SensorSessionRecordHeader) + sensor_session_padded_size(header->payload_size);
+
+		if (offset + sizeof(SensorSessionRecordHeader) + header->payload_size > m_data_size)
+		{
+			// The recording was cut short (i.e. the service was killed mid write)
+			SERVER_LOG_WARNING("SensorSessionReplayer::replay") << "Truncated record at offset " << offset;
+			break;
+		}
+
+		switch (header->record_type)
+		{
+		case SensorSessionRecord_FilterDesc:
+			if (header->payload_size == sizeof(SensorSessionFilterDesc))
+			{
+				handle_filter_desc(*header, payload);
+				++m_stats.filter_desc_count;
+			}
+			else
+			{
+				bSuccess = false;
+			}
+			break;
+		case SensorSessionRecord_PoseSensorPacket:
+			if (header->payload_size == sizeof(SensorSessionPoseSensorPacket))
+			{
+				handle_pose_sensor_packet(*header, payload, output_file);
+			}
+			else
+			{
+				bSuccess = false;
+			}
+			break;
+		case SensorSessionRecord_TrackerProjection:
+			// Projections and frames are kept for offline analysis,
+			// the pose filters only consume the sensor packets
+			++m_stats.tracker_projection_count;
+			break;
+		case SensorSessionRecord_TrackerFrame:
+			++m_stats.tracker_frame_count;
+			break;
+		case SensorSessionRecord_UpdateTick:
+			++m_stats.update_tick_count;
+			break;
+		default:
+			SERVER_LOG_WARNING("SensorSessionReplayer::replay") << "Unknown record type " << header->record_type
+				<< " at offset " << offset;
+			break;
+		}
+
+		if (!bSuccess)
+		{
+			SERVER_LOG_ERROR("SensorSessionReplayer::replay") << "Malformed record at offset " << offset;
+			break;
+		}
+
+		offset += record_size;
+	}
+
+	if (output_file != nullptr)
+	{
+		fclose(output_file);
+	}
+
+	SERVER_LOG_INFO("SensorSessionReplayer::replay") << "Replayed "
+		<< m_stats.pose_sensor_packet_count << " sensor packets over "
+		<< m_stats.update_tick_count << " updates ("
+		<< m_stats.filter_desc_count << " filters, "
+		<< m_stats.tracker_projection_count << " projections, "
+		<< m_stats.tracker_frame_count << " frames, "
+		<< m_stats.skipped_record_count << " skipped)";
+
+	return bSuccess;
+}
+
+//-- protected implementation -----
+void SensorSessionReplayer::handle_filter_desc(const SensorSessionRecordHeader &header, const uint8_t *payload)
+{
+	SensorSessionFilterDesc filter_desc;
+	memcpy(static_cast<void *>(&filter_desc), payload, sizeof(SensorSessionFilterDesc));
+
+	// The session file isn't trusted to terminate the names
+	filter_desc.position_filter_type[k_sensor_session_filter_name_length - 1] = '\0';
+	filter_desc.orientation_filter_type[k_sensor_session_filter_name_length - 1] = '\0';
+
+	if (!is_replayable_filter_type(filter_desc.position_filter_type) ||
+		!is_replayable_filter_type(filter_desc.orientation_filter_type))
+	{
+		SERVER_LOG_WARNING("SensorSessionReplayer::handle_filter_desc") << "Can't replay device " << header.device_id
+			<< " using the " << filter_desc.orientation_filter_type << "/" << filter_desc.position_filter_type
+			<< " filters, they read live input";
+
+		// Drop any earlier filter for this device so its packets get skipped
+		if (header.device_class == SensorSessionDevice_Controller &&
+			header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_CONTROLLER_COUNT)
+		{
+			m_controller_views[header.device_id].reset();
+		}
+		else if (header.device_class == SensorSessionDevice_HMD &&
+			header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_HMD_COUNT)
+		{
+			m_hmd_views[header.device_id].reset();
+		}
+		return;
+	}
+
+	// A filter description mid-session means the pose filter was reset,
+	// so start over with a fresh view just like the service did
+	switch (header.device_class)
+	{
+	case SensorSessionDevice_Controller:
+		if (header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_CONTROLLER_COUNT)
+		{
+			ServerControllerViewPtr controller_view(new ServerControllerView(header.device_id));
+
+			if (controller_view->openForReplay(filter_desc))
+			{
+				m_controller_views[header.device_id] = controller_view;
+			}
+		}
+		break;
+	case SensorSessionDevice_HMD:
+		if (header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_HMD_COUNT)
+		{
+			ServerHMDViewPtr hmd_view(new ServerHMDView(header.device_id));
+
+			if (hmd_view->openForReplay(filter_desc))
+			{
+				m_hmd_views[header.device_id] = hmd_view;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void SensorSessionReplayer::handle_pose_sensor_packet(
+	const SensorSessionRecordHeader &header,
+	const uint8_t *payload,
+	FILE *output_file)
+{
+	SensorSessionPoseSensorPacket recorded_packet;
+	memcpy(static_cast<void *>(&recorded_packet), payload, sizeof(SensorSessionPoseSensorPacket));
+
+	PoseSensorPacket sensor_packet;
+	recorded_packet.get(sensor_packet);
+
+	const float time_delta_seconds = recorded_packet.time_delta_seconds;
+	const bool bIsSynced = recorded_packet.is_synced != 0;
+
+	CommonDevicePose pose;
+	switch (header.device_class)
+	{
+	case SensorSessionDevice_Controller:
+		{
+			ServerControllerViewPtr controller_view =
+				(header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_CONTROLLER_COUNT)
+				? m_controller_views[header.device_id]
+				: ServerControllerViewPtr();
+
+			if (!controller_view)
+			{
+				++m_stats.skipped_record_count;
+				return;
+			}
+
+			controller_view->replayPoseSensorPacket(sensor_packet, time_delta_seconds, bIsSynced);
+			pose = controller_view->getFilteredPose();
+		} break;
+	case SensorSessionDevice_HMD:
+		{
+			ServerHMDViewPtr hmd_view =
+				(header.device_id >= 0 && header.device_id < PSMOVESERVICE_MAX_HMD_COUNT)
+				? m_hmd_views[header.device_id]
+				: ServerHMDViewPtr();
+
+			if (!hmd_view)
+			{
+				++m_stats.skipped_record_count;
+				return;
+			}
+
+			hmd_view->replayPoseSensorPacket(sensor_packet, time_delta_seconds, bIsSynced);
+			pose = hmd_view->getFilteredPose();
+		} break;
+	default:
+		++m_stats.skipped_record_count;
+		return;
+	}
+
+	++m_stats.pose_sensor_packet_count;
+
+	if (output_file != nullptr)
+	{
+		fprintf(output_file, "%s, %d, %lld, %f, %f, %f, %f, %f, %f, %f, %f\n",
+			header.device_class == SensorSessionDevice_Controller ? "controller" : "hmd",
+			header.device_id,
+			static_cast<long long>(header.timestamp_ns),
+			time_delta_seconds,
+			pose.PositionCm.x, pose.PositionCm.y, pose.PositionCm.z,
+			pose.Orientation.w, pose.Orientation.x, pose.Orientation.y, pose.Orientation.z);
+	}
+}
+
+//-- private functions -----
+static bool
+is_replayable_filter_type(const char *filter_type)
+{
+	for (const char *non_replayable_filter_type : k_non_replayable_filter_types)
+	{
+		if (strcmp(filter_type, non_replayable_filter_type) == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
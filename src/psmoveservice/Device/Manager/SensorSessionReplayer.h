@@ -0,0 +1,76 @@
+#ifndef SENSOR_SESSION_REPLAYER_H
+#define SENSOR_SESSION_REPLAYER_H
+
+//-- includes -----
+#include "SensorSessionLog.h"
+#include "PSMoveProtocolInterface.h"
+
+#include <memory>
+#include <stdio.h>
+#include <string>
+
+//-- typedefs -----
+class ServerControllerView;
+typedef std::shared_ptr<ServerControllerView> ServerControllerViewPtr;
+
+class ServerHMDView;
+typedef std::shared_ptr<ServerHMDView> ServerHMDViewPtr;
+
+namespace boost { namespace interprocess {
+	class file_mapping;
+	class mapped_region;
+}}
+
+//-- definitions -----
+struct SensorSessionReplayStats
+{
+	int filter_desc_count;
+	int pose_sensor_packet_count;
+	int tracker_projection_count;
+	int tracker_frame_count;
+	int update_tick_count;
+	int skipped_record_count; // packets for devices with no recorded filter description
+
+	inline void clear()
+	{
+		memset(this, 0, sizeof(SensorSessionReplayStats));
+	}
+};
+
+/// Plays a sensor session log recorded by SensorSessionRecorder back through
+/// freshly created controller and HMD views. No devices are opened, the views
+/// rebuild their pose filters from the recorded filter descriptions and are fed
+/// the recorded filter inputs in order, so a replay is deterministic.
+class SensorSessionReplayer
+{
+public:
+	SensorSessionReplayer();
+	virtual ~SensorSessionReplayer();
+
+	/// Memory map the session log and validate its header
+	bool open(const std::string &filename);
+	void close();
+
+	/// Replay every record in the session.
+	/// If an output filename is given the filtered pose after every sensor packet is written to it as CSV.
+	bool replay(const std::string &output_filename);
+
+	inline const SensorSessionReplayStats &getStats() const { return m_stats; }
+
+protected:
+	void handle_filter_desc(const SensorSessionRecordHeader &header, const uint8_t *payload);
+	void handle_pose_sensor_packet(const SensorSessionRecordHeader &header, const uint8_t *payload, FILE *output_file);
+
+private:
+	boost::interprocess::file_mapping *m_file_mapping;
+	boost::interprocess::mapped_region *m_region;
+	const uint8_t *m_data;
+	size_t m_data_size;
+
+	ServerControllerViewPtr m_controller_views[PSMOVESERVICE_MAX_CONTROLLER_COUNT];
+	ServerHMDViewPtr m_hmd_views[PSMOVESERVICE_MAX_HMD_COUNT];
+
+	SensorSessionReplayStats m_stats;
+};
+
+#endif // SENSOR_SESSION_REPLAYER_H
@@ -0,0 +1,464 @@
+//-- includes -----
+#include "TrackerColorCalibrator.h"
+#include "PSMoveProtocol.pb.h"
+#include "ServerControllerView.h"
+#include "ServerLog.h"
+#include "ServerNetworkManager.h"
+#include "ServerRequestHandler.h"
+#include "ServerTrackerView.h"
+#include "TrackerManager.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+//-- constants -----
+// Timing
+static const int k_led_settle_ms = 100; // Frames arriving sooner than this after an LED change are skipped
+static const int k_sample_frame_count = 5; // Frames accumulated per tracker and color
+static const int k_step_timeout_ms = 2000; // Trackers that haven't delivered their frames by then are left out
+
+// Bulb segmentation
+static const int k_min_value_increase = 48; // How much brighter than the background a lit pixel has to be
+static const float k_search_hue_range = 20.f; // Around the nominal hue of the LED color, in OpenCV's [0, 180) hue
+static const float k_search_min_saturation = 32.f; // Drops the washed out core of an over exposed bulb
+static const int k_min_histogram_pixel_count = 50; // Trackers that saw fewer lit pixels keep their preset
+
+// Preset fit, the percentiles drop the stray pixels at the bulb's edge
+static const float k_low_percentile = 0.05f;
+static const float k_high_percentile = 0.95f;
+static const float k_hue_margin = 2.f;
+static const float k_min_hue_range = 5.f;
+static const float k_max_hue_range = 15.f; // Half way to the neighbouring standard color
+static const float k_channel_margin = 8.f;
+static const float k_min_channel_range = 32.f;
+
+struct CalibrationColor
+{
+	eCommonTrackingColorID color_id;
+	const char *name;
+	unsigned char r, g, b;
+	float nominal_hue;
+};
+
+// Same LED colors as ServerControllerView uses for tracking
+static const CalibrationColor k_calibration_colors[] = {
+	{ eCommonTrackingColorID::Magenta, "magenta", 0xFF, 0x00, 0xFF, 150.f },
+	{ eCommonTrackingColorID::Cyan, "cyan", 0x00, 0xFF, 0xFF, 90.f },
+	{ eCommonTrackingColorID::Yellow, "yellow", 0xFF, 0xFF, 0x00, 30.f },
+	{ eCommonTrackingColorID::Red, "red", 0xFF, 0x00, 0x00, 0.f },
+	{ eCommonTrackingColorID::Green, "green", 0x00, 0xFF, 0x00, 60.f },
+	{ eCommonTrackingColorID::Blue, "blue", 0x00, 0x00, 0xFF, 120.f },
+};
+static const int k_calibration_color_count = static_cast<int>(sizeof(k_calibration_colors) / sizeof(k_calibration_colors[0]));
+
+//-- private methods -----
+static bool controller_has_tracking_led(const ServerControllerView *controller_view);
+static int find_histogram_percentile(const int *bins, const int bin_count, const int total_count, const float fraction);
+static void fit_color_preset(const TrackerColorHistogram &histogram, const float nominal_hue, CommonHSVColorRange &out_preset);
+
+//-- public implementation -----
+TrackerColorCalibrator::TrackerColorCalibrator()
+	: m_state(TrackerColorCalibration_Idle)
+	, m_connectionId(-1)
+	, m_controllerViews()
+	, m_controllerIndex(0)
+	, m_colorIndex(-1)
+	, m_stepStartTime()
+	, m_stepsCompleted(0)
+	, m_totalSteps(0)
+	, m_presetsUpdated(0)
+{
+	for (int tracker_id = 0; tracker_id < k_tracker_color_calibration_max_trackers; ++tracker_id)
+	{
+		TrackerState &tracker = m_trackers[tracker_id];
+
+		tracker.sampledFrameCount = 0;
+		tracker.bSkippedSettleFrame = false;
+		tracker.bHasBackground = false;
+		memset(&tracker.histogram, 0, sizeof(tracker.histogram));
+	}
+}
+
+TrackerColorCalibrator::~TrackerColorCalibrator()
+{
+	cancel();
+}
+
+bool TrackerColorCalibrator::start(const int connection_id, const std::vector<ServerControllerViewPtr> &controller_views)
+{
+	if (m_state == TrackerColorCalibration_Running)
+	{
+		SERVER_LOG_WARNING("TrackerColorCalibrator::start") << "Tracker color calibration already in progress";
+		return false;
+	}
+
+	m_controllerViews.clear();
+	for (const ServerControllerViewPtr &controller_view : controller_views)
+	{
+		if (controller_view && controller_view->getIsOpen() && controller_has_tracking_led(controller_view.get()))
+		{
+			m_controllerViews.push_back(controller_view);
+		}
+	}
+
+	if (m_controllerViews.empty())
+	{
+		SERVER_LOG_WARNING("TrackerColorCalibrator::start") << "No open controllers with a tracking LED to calibrate";
+		return false;
+	}
+
+	m_connectionId = connection_id;
+	m_controllerIndex = 0;
+	m_colorIndex = -1;
+	m_stepsCompleted = 0;
+	m_totalSteps = static_cast<int>(m_controllerViews.size()) * (k_calibration_color_count + 1);
+	m_presetsUpdated = 0;
+	m_state = TrackerColorCalibration_Running;
+
+	SERVER_LOG_INFO("TrackerColorCalibrator::start")
+		<< "Calibrating tracker color presets for " << m_controllerViews.size() << " controller(s)";
+
+	beginStep();
+
+	return true;
+}
+
+void TrackerColorCalibrator::cancel()
+{
+	if (m_state == TrackerColorCalibration_Running)
+	{
+		finish(TrackerColorCalibration_Canceled);
+	}
+}
+
+void TrackerColorCalibrator::update(TrackerManager *tracker_manager)
+{
+	if (m_state != TrackerColorCalibration_Running)
+	{
+		return;
+	}
+
+	const ServerControllerViewPtr &controller_view = m_controllerViews[m_controllerIndex];
+	if (!controller_view->getIsOpen())
+	{
+		SERVER_LOG_WARNING("TrackerColorCalibrator::update")
+			<< "Controller " << controller_view->getDeviceID() << " closed during color calibration, skipping it";
+
+		// Skip the rest of this controller's steps
+		m_stepsCompleted += k_calibration_color_count - m_colorIndex;
+		m_colorIndex = k_calibration_color_count - 1;
+		advanceStep();
+		return;
+	}
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+	const std::chrono::time_point<std::chrono::high_resolution_clock> settle_end =
+		m_stepStartTime + std::chrono::milliseconds(k_led_settle_ms);
+	const bool bIsBackgroundStep = m_colorIndex < 0;
+	const int needed_frame_count = bIsBackgroundStep ? 1 : k_sample_frame_count;
+
+	CommonHSVColorRange search_range;
+	if (!bIsBackgroundStep)
+	{
+		search_range.hue_range.center = k_calibration_colors[m_colorIndex].nominal_hue;
+		search_range.hue_range.range = k_search_hue_range;
+		search_range.saturation_range.center = (k_search_min_saturation + 255.f) / 2.f;
+		search_range.saturation_range.range = (255.f - k_search_min_saturation) / 2.f;
+		search_range.value_range.center = 127.5f;
+		search_range.value_range.range = 127.5f;
+	}
+
+	// Every tracker works on its own newest frame, so one LED change serves all of them
+	bool bAllTrackersDone = true;
+	for (int tracker_id = 0; tracker_id < tracker_manager->getMaxDevices(); ++tracker_id)
+	{
+		ServerTrackerViewPtr tracker_view = tracker_manager->getTrackerViewPtr(tracker_id);
+		TrackerState &tracker = m_trackers[tracker_id];
+
+		if (!tracker_view->getIsOpen() || tracker.sampledFrameCount >= needed_frame_count)
+		{
+			continue;
+		}
+
+		// Trackers that missed the background can't tell the bulb apart
+		if (!bIsBackgroundStep && !tracker.bHasBackground)
+		{
+			continue;
+		}
+
+		const std::chrono::time_point<std::chrono::high_resolution_clock> frame_timestamp =
+			tracker_view->getLastNewDataTimestamp();
+		if (frame_timestamp != tracker.lastFrameTimestamp && frame_timestamp >= settle_end)
+		{
+			tracker.lastFrameTimestamp = frame_timestamp;
+
+			if (!tracker.bSkippedSettleFrame)
+			{
+				// The first frame after settling may still have been exposing while the LED changed
+				tracker.bSkippedSettleFrame = true;
+			}
+			else if (bIsBackgroundStep)
+			{
+				tracker_view->captureColorCalibrationBackground();
+				tracker.bHasBackground = true;
+				++tracker.sampledFrameCount;
+			}
+			else
+			{
+				tracker_view->accumulateColorCalibrationHistogram(search_range, k_min_value_increase, tracker.histogram);
+				++tracker.sampledFrameCount;
+			}
+		}
+
+		if (tracker.sampledFrameCount < needed_frame_count)
+		{
+			bAllTrackersDone = false;
+		}
+	}
+
+	if (bAllTrackersDone || now - m_stepStartTime > std::chrono::milliseconds(k_step_timeout_ms))
+	{
+		finishStep(tracker_manager);
+	}
+}
+
+//-- protected methods -----
+void TrackerColorCalibrator::beginStep()
+{
+	ServerControllerView *controller_view = m_controllerViews[m_controllerIndex].get();
+
+	if (m_colorIndex < 0)
+	{
+		controller_view->setLEDOverride(0x00, 0x00, 0x00);
+	}
+	else
+	{
+		const CalibrationColor &color = k_calibration_colors[m_colorIndex];
+
+		controller_view->setLEDOverride(color.r, color.g, color.b);
+	}
+
+	m_stepStartTime = std::chrono::high_resolution_clock::now();
+
+	for (int tracker_id = 0; tracker_id < k_tracker_color_calibration_max_trackers; ++tracker_id)
+	{
+		TrackerState &tracker = m_trackers[tracker_id];
+
+		tracker.lastFrameTimestamp = m_stepStartTime;
+		tracker.sampledFrameCount = 0;
+		tracker.bSkippedSettleFrame = false;
+		if (m_colorIndex < 0)
+		{
+			tracker.bHasBackground = false;
+		}
+		memset(&tracker.histogram, 0, sizeof(tracker.histogram));
+	}
+}
+
+void TrackerColorCalibrator::finishStep(TrackerManager *tracker_manager)
+{
+	if (m_colorIndex >= 0)
+	{
+		const ServerControllerView *controller_view = m_controllerViews[m_controllerIndex].get();
+		const CalibrationColor &color = k_calibration_colors[m_colorIndex];
+		int open_tracker_count = 0;
+		int fit_tracker_count = 0;
+
+		for (int tracker_id = 0; tracker_id < tracker_manager->getMaxDevices(); ++tracker_id)
+		{
+			ServerTrackerViewPtr tracker_view = tracker_manager->getTrackerViewPtr(tracker_id);
+			if (!tracker_view->getIsOpen())
+			{
+				continue;
+			}
+
+			++open_tracker_count;
+
+			const TrackerColorHistogram &histogram = m_trackers[tracker_id].histogram;
+			if (histogram.pixel_count >= k_min_histogram_pixel_count)
+			{
+				CommonHSVColorRange preset;
+				fit_color_preset(histogram, color.nominal_hue, preset);
+
+				tracker_view->setControllerTrackingColorPreset(controller_view, color.color_id, &preset);
+				++fit_tracker_count;
+			}
+		}
+
+		m_presetsUpdated += fit_tracker_count;
+
+		SERVER_LOG_INFO("TrackerColorCalibrator::finishStep")
+			<< "Controller " << controller_view->getDeviceID() << " " << color.name
+			<< ": fit presets for " << fit_tracker_count << "/" << open_tracker_count << " trackers";
+	}
+
+	++m_stepsCompleted;
+	sendProgressNotification();
+
+	advanceStep();
+}
+
+void TrackerColorCalibrator::advanceStep()
+{
+	++m_colorIndex;
+
+	if (m_colorIndex >= k_calibration_color_count)
+	{
+		// Done with this controller, hand its LED back to tracking
+		const ServerControllerViewPtr &controller_view = m_controllerViews[m_controllerIndex];
+		if (controller_view->getIsOpen())
+		{
+			controller_view->clearLEDOverride();
+		}
+
+		++m_controllerIndex;
+		m_colorIndex = -1;
+
+		if (m_controllerIndex >= static_cast<int>(m_controllerViews.size()))
+		{
+			finish(m_presetsUpdated > 0 ? TrackerColorCalibration_Finished : TrackerColorCalibration_Failed);
+			return;
+		}
+	}
+
+	beginStep();
+}
+
+void TrackerColorCalibrator::finish(const eTrackerColorCalibrationState state)
+{
+	for (const ServerControllerViewPtr &controller_view : m_controllerViews)
+	{
+		if (controller_view->getIsOpen() && controller_view->getIsLEDOverrideActive())
+		{
+			controller_view->clearLEDOverride();
+		}
+	}
+
+	m_state = state;
+
+	SERVER_LOG_INFO("TrackerColorCalibrator::finish")
+		<< "Tracker color calibration "
+		<< (state == TrackerColorCalibration_Finished ? "finished" : (state == TrackerColorCalibration_Canceled ? "canceled" : "failed"))
+		<< " after " << m_stepsCompleted << "/" << m_totalSteps << " steps, "
+		<< m_presetsUpdated << " presets updated";
+
+	sendProgressNotification();
+
+	m_controllerViews.clear();
+}
+
+void TrackerColorCalibrator::sendProgressNotification() const
+{
+	ResponsePtr notification(new PSMoveProtocol::Response);
+
+	notification->set_type(PSMoveProtocol::Response_ResponseType_TRACKER_COLOR_CALIBRATION_PROGRESS);
+	notification->set_request_id(-1); // This is an notification, not a response
+
+	switch (m_state)
+	{
+	case TrackerColorCalibration_Canceled:
+		notification->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_CANCELED);
+		break;
+	case TrackerColorCalibration_Failed:
+		notification->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_ERROR);
+		break;
+	default:
+		notification->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
+		break;
+	}
+
+	PSMoveProtocol::Response_ResultTrackerColorCalibrationProgress *progress =
+		notification->mutable_result_tracker_color_calibration_progress();
+
+	// eTrackerColorCalibrationState matches the protocol state enum
+	progress->set_state(static_cast<PSMoveProtocol::Response_ResultTrackerColorCalibrationProgress_State>(m_state));
+	if (m_controllerIndex < static_cast<int>(m_controllerViews.size()))
+	{
+		progress->set_controller_id(m_controllerViews[m_controllerIndex]->getDeviceID());
+		progress->set_color_type(m_colorIndex >= 0 ? k_calibration_colors[m_colorIndex].color_id : -1);
+	}
+	else
+	{
+		progress->set_controller_id(-1);
+		progress->set_color_type(-1);
+	}
+	progress->set_steps_completed(m_stepsCompleted);
+	progress->set_total_steps(m_totalSteps);
+	progress->set_presets_updated(m_presetsUpdated);
+
+	ServerNetworkManager::get_instance()->send_notification(m_connectionId, notification);
+}
+
+//-- private methods -----
+static bool controller_has_tracking_led(const ServerControllerView *controller_view)
+{
+	switch (controller_view->getControllerDeviceType())
+	{
+	case CommonDeviceState::PSMove:
+	case CommonDeviceState::PSDualShock4:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int find_histogram_percentile(const int *bins, const int bin_count, const int total_count, const float fraction)
+{
+	const int target_count = std::max(static_cast<int>(fraction * static_cast<float>(total_count)), 1);
+	int cumulative_count = 0;
+
+	for (int bin_index = 0; bin_index < bin_count; ++bin_index)
+	{
+		cumulative_count += bins[bin_index];
+
+		if (cumulative_count >= target_count)
+		{
+			return bin_index;
+		}
+	}
+
+	return bin_count - 1;
+}
+
+static void fit_color_preset(const TrackerColorHistogram &histogram, const float nominal_hue, CommonHSVColorRange &out_preset)
+{
+	// Hue, unwrapped around the nominal hue so red doesn't split across 0
+	static const int k_hue_offset_count = 2 * static_cast<int>(k_search_hue_range) + 1;
+	int hue_offsets[k_hue_offset_count];
+	int hue_total = 0;
+	for (int offset_index = 0; offset_index < k_hue_offset_count; ++offset_index)
+	{
+		const int offset = offset_index - static_cast<int>(k_search_hue_range);
+		const int hue_bin =
+			(static_cast<int>(nominal_hue) + offset + TrackerColorHistogram::k_hue_bin_count) % TrackerColorHistogram::k_hue_bin_count;
+
+		hue_offsets[offset_index] = histogram.hue[hue_bin];
+		hue_total += histogram.hue[hue_bin];
+	}
+
+	const float hue_low = static_cast<float>(find_histogram_percentile(hue_offsets, k_hue_offset_count, hue_total, k_low_percentile));
+	const float hue_median = static_cast<float>(find_histogram_percentile(hue_offsets, k_hue_offset_count, hue_total, 0.5f));
+	const float hue_high = static_cast<float>(find_histogram_percentile(hue_offsets, k_hue_offset_count, hue_total, k_high_percentile));
+	const float hue_center = nominal_hue + hue_median - k_search_hue_range;
+
+	out_preset.hue_range.center = fmodf(hue_center + static_cast<float>(TrackerColorHistogram::k_hue_bin_count), static_cast<float>(TrackerColorHistogram::k_hue_bin_count));
+	out_preset.hue_range.range =
+		std::min(std::max(std::max(hue_median - hue_low, hue_high - hue_median) + k_hue_margin, k_min_hue_range), k_max_hue_range);
+
+	// Saturation and value, centered on the bulk of the lit pixels
+	const float saturation_low = static_cast<float>(find_histogram_percentile(
+		histogram.saturation, TrackerColorHistogram::k_channel_bin_count, histogram.pixel_count, k_low_percentile));
+	const float saturation_high = static_cast<float>(find_histogram_percentile(
+		histogram.saturation, TrackerColorHistogram::k_channel_bin_count, histogram.pixel_count, k_high_percentile));
+	out_preset.saturation_range.center = (saturation_low + saturation_high) / 2.f;
+	out_preset.saturation_range.range = std::max((saturation_high - saturation_low) / 2.f + k_channel_margin, k_min_channel_range);
+
+	const float value_low = static_cast<float>(find_histogram_percentile(
+		histogram.value, TrackerColorHistogram::k_channel_bin_count, histogram.pixel_count, k_low_percentile));
+	const float value_high = static_cast<float>(find_histogram_percentile(
+		histogram.value, TrackerColorHistogram::k_channel_bin_count, histogram.pixel_count, k_high_percentile));
+	out_preset.value_range.center = (value_low + value_high) / 2.f;
+	out_preset.value_range.range = std::max((value_high - value_low) / 2.f + k_channel_margin, k_min_channel_range);
+}
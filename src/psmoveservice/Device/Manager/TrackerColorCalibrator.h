@@ -0,0 +1,83 @@
+#ifndef TRACKER_COLOR_CALIBRATOR_H
+#define TRACKER_COLOR_CALIBRATOR_H
+
+//-- includes -----
+#include "ServerTrackerView.h"
+#include "SharedConstants.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+//-- typedefs -----
+class ServerControllerView;
+typedef std::shared_ptr<ServerControllerView> ServerControllerViewPtr;
+
+//-- constants -----
+static const int k_tracker_color_calibration_max_trackers = PSMOVESERVICE_MAX_TRACKER_COUNT;
+
+enum eTrackerColorCalibrationState
+{
+	TrackerColorCalibration_Idle,
+	TrackerColorCalibration_Running,
+	TrackerColorCalibration_Finished,
+	TrackerColorCalibration_Canceled,
+	TrackerColorCalibration_Failed
+};
+
+//-- definitions -----
+/// Fits the HSV color presets of every tracker for a set of controllers, without a client in the loop.
+/// For each controller the bulb is first turned off to take a background frame on every tracker,
+/// then lit in each of the standard tracking colors in turn. The pixels that light up,
+/// compared to the background, are collected into a histogram per tracker and the preset
+/// for that tracker, controller and color is fit to it.
+/// All trackers are sampled from the same frames, and a step moves on as soon as
+/// every tracker has delivered enough frames taken after the LED change, instead of waiting a fixed time.
+/// Progress is sent as notifications to the connection that started the calibration.
+/// All of the methods must be called from the main thread.
+class TrackerColorCalibrator
+{
+public:
+	TrackerColorCalibrator();
+	virtual ~TrackerColorCalibrator();
+
+	bool start(const int connection_id, const std::vector<ServerControllerViewPtr> &controller_views);
+	void cancel();
+
+	/// Samples the trackers for the current step and moves on to the next step once they are done
+	void update(class TrackerManager *tracker_manager);
+
+	inline eTrackerColorCalibrationState getState() const { return m_state; }
+
+protected:
+	void beginStep();
+	void finishStep(class TrackerManager *tracker_manager);
+	void advanceStep();
+	void finish(const eTrackerColorCalibrationState state);
+	void sendProgressNotification() const;
+
+private:
+	struct TrackerState
+	{
+		std::chrono::time_point<std::chrono::high_resolution_clock> lastFrameTimestamp;
+		int sampledFrameCount;
+		bool bSkippedSettleFrame;
+		bool bHasBackground; // Taken for the current controller
+		TrackerColorHistogram histogram;
+	};
+
+	eTrackerColorCalibrationState m_state;
+	int m_connectionId;
+
+	std::vector<ServerControllerViewPtr> m_controllerViews;
+	int m_controllerIndex;
+	int m_colorIndex; // Into the standard tracking colors, -1 while taking the background
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_stepStartTime;
+	TrackerState m_trackers[k_tracker_color_calibration_max_trackers];
+
+	int m_stepsCompleted;
+	int m_totalSteps;
+	int m_presetsUpdated;
+};
+
+#endif // TRACKER_COLOR_CALIBRATOR_H
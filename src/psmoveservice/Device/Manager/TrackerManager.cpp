@@ -11,9 +11,18 @@
 #include "ServerTrackerView.h"
 #include "ServerDeviceView.h"
 #include "MathUtility.h"
+#include "PoseFilterInterface.h"
 #include "PSMoveProtocol.pb.h"
 
+#include <algorithm>
+
 //-- constants -----
+// Half the frame period of a 30 fps tracker, used before any tracker reports its frame rate
+static const int64_t k_default_frame_sync_tolerance_us = 16667;
+
+//-- prototypes -----
+static float compute_close_and_fast_ratio(
+	const TrackerManagerTunables &cfg, const float screen_area, const float speed_cm_per_sec);
 
 //-- Tracker Manager Config -----
 const int TrackerManagerConfig::CONFIG_VERSION = 3;
@@ -36,9 +45,17 @@ TrackerManagerConfig::TrackerManagerConfig(const std::string &fnamebase)
 	occluded_area_regain_projection_size = 32.f;
 	min_points_in_contour = 4;
 	max_tracker_position_deviation = 12.0f;
+	max_triangulation_pairs = 3;
+	frame_sync_tolerance_ms = 0; // Half the frame period of the slowest tracker
+	auto_frame_mode = false;
+	auto_frame_mode_near_screen_area = 500.f; // A PSMove bulb about 1m away
+	auto_frame_mode_fast_speed = 150.f;
+	auto_frame_mode_fast_frame_rate = 125.f;
+	auto_frame_mode_hold_ms = 1000;
 	disable_roi = false;
 	optimized_roi = true;
 	roi_edge_offset = 4;
+	roi_search_downscale = 2;
 	default_tracker_profile.frame_width = 640;
 	//default_tracker_profile.frame_height = 480;
 	default_tracker_profile.frame_rate = 30;
@@ -76,10 +93,19 @@ TrackerManagerConfig::config2ptree()
 	pt.put("occluded_area_regain_projection_size", occluded_area_regain_projection_size);
 	pt.put("min_points_in_contour", min_points_in_contour);
 	pt.put("max_tracker_position_deviation", max_tracker_position_deviation);
+	pt.put("max_triangulation_pairs", max_triangulation_pairs);
+	pt.put("frame_sync_tolerance_ms", frame_sync_tolerance_ms);
+
+	pt.put("auto_frame_mode", auto_frame_mode);
+	pt.put("auto_frame_mode_near_screen_area", auto_frame_mode_near_screen_area);
+	pt.put("auto_frame_mode_fast_speed", auto_frame_mode_fast_speed);
+	pt.put("auto_frame_mode_fast_frame_rate", auto_frame_mode_fast_frame_rate);
+	pt.put("auto_frame_mode_hold_ms", auto_frame_mode_hold_ms);
 
 	pt.put("disable_roi", disable_roi);
 	pt.put("optimized_roi", optimized_roi);
 	pt.put("roi_edge_offset", roi_edge_offset);
+	pt.put("roi_search_downscale", roi_search_downscale);
 
 	pt.put("default_tracker_profile.frame_width", default_tracker_profile.frame_width);
 	//pt.put("default_tracker_profile.frame_height", default_tracker_profile.frame_height);
@@ -118,10 +144,19 @@ TrackerManagerConfig::ptree2config(const boost::property_tree::ptree &pt)
 		occluded_area_regain_projection_size = pt.get<float>("occluded_area_regain_projection_size", occluded_area_regain_projection_size);
 		min_points_in_contour = pt.get<int>("min_points_in_contour", min_points_in_contour);
 		max_tracker_position_deviation = pt.get<float>("max_tracker_position_deviation", max_tracker_position_deviation);
+		max_triangulation_pairs = pt.get<int>("max_triangulation_pairs", max_triangulation_pairs);
+		frame_sync_tolerance_ms = pt.get<int>("frame_sync_tolerance_ms", frame_sync_tolerance_ms);
+
+		auto_frame_mode = pt.get<bool>("auto_frame_mode", auto_frame_mode);
+		auto_frame_mode_near_screen_area = pt.get<float>("auto_frame_mode_near_screen_area", auto_frame_mode_near_screen_area);
+		auto_frame_mode_fast_speed = pt.get<float>("auto_frame_mode_fast_speed", auto_frame_mode_fast_speed);
+		auto_frame_mode_fast_frame_rate = pt.get<float>("auto_frame_mode_fast_frame_rate", auto_frame_mode_fast_frame_rate);
+		auto_frame_mode_hold_ms = pt.get<int>("auto_frame_mode_hold_ms", auto_frame_mode_hold_ms);
 
 		disable_roi = pt.get<bool>("disable_roi", disable_roi);
 		optimized_roi = pt.get<bool>("optimized_roi", optimized_roi);
 		roi_edge_offset = pt.get<int>("roi_edge_offset", roi_edge_offset);
+		roi_search_downscale = pt.get<int>("roi_search_downscale", roi_search_downscale);
 
 		default_tracker_profile.frame_width = pt.get<float>("default_tracker_profile.frame_width", 640);
 		//default_tracker_profile.frame_height = pt.get<float>("default_tracker_profile.frame_height", 480);
@@ -177,15 +212,64 @@ TrackerManagerConfig::get_global_down_axis() const
 	return CommonDeviceVector::create(0.f, -1.f, 0.f);
 }
 
+//-- Tracker Manager Tunables -----
+void TrackerManagerTunables::applyConfig(const TrackerManagerConfig &config)
+{
+	controller_position_smoothing = config.controller_position_smoothing;
+	controller_position_prediction = config.controller_position_prediction;
+	controller_position_prediction_history = config.controller_position_prediction_history;
+	ignore_pose_from_one_tracker = config.ignore_pose_from_one_tracker;
+	optical_tracking_timeout = config.optical_tracking_timeout;
+	thread_sleep_ms = config.thread_sleep_ms;
+	exclude_opposed_cameras = config.exclude_opposed_cameras;
+	min_valid_projection_area = config.min_valid_projection_area;
+	occluded_area_on_loss_size = config.occluded_area_on_loss_size;
+	occluded_area_ignore_trackers = config.occluded_area_ignore_trackers;
+	occluded_area_regain_projection_size = config.occluded_area_regain_projection_size;
+	min_points_in_contour = std::max(config.min_points_in_contour, 1);
+	max_tracker_position_deviation = config.max_tracker_position_deviation;
+	max_triangulation_pairs = config.max_triangulation_pairs;
+	frame_sync_tolerance_ms = config.frame_sync_tolerance_ms;
+	auto_frame_mode = config.auto_frame_mode;
+	auto_frame_mode_near_screen_area = config.auto_frame_mode_near_screen_area;
+	auto_frame_mode_fast_speed = config.auto_frame_mode_fast_speed;
+	auto_frame_mode_fast_frame_rate = config.auto_frame_mode_fast_frame_rate;
+	auto_frame_mode_hold_ms = config.auto_frame_mode_hold_ms;
+	disable_roi = config.disable_roi;
+	optimized_roi = config.optimized_roi;
+	roi_edge_offset = std::max(0, std::min(64, config.roi_edge_offset));
+
+	// Only power of two downscales, anything coarser would miss distant bulbs
+	if (config.roi_search_downscale >= 4)
+	{
+		roi_search_downscale = 4;
+	}
+	else if (config.roi_search_downscale >= 2)
+	{
+		roi_search_downscale = 2;
+	}
+	else
+	{
+		roi_search_downscale = 1;
+	}
+
+	global_forward_degrees = config.global_forward_degrees;
+	global_forward_axis = config.get_global_forward_axis();
+	global_right_axis = config.get_global_right_axis();
+}
+
 //-- Tracker Manager -----
 bool TrackerManager::m_trackersSynced = true;
-bool TrackerManager::m_isTrackerFrameAvailable[TrackerManager::k_max_devices];
-bool TrackerManager::m_readyToReceive = false;
+bool TrackerManager::m_isTrackerFramePending[TrackerManager::k_max_devices];
+bool TrackerManager::m_isTrackerInFrameGroup[TrackerManager::k_max_devices];
+std::chrono::time_point<std::chrono::high_resolution_clock> TrackerManager::m_trackerFrameArrivalTimes[TrackerManager::k_max_devices];
 
 TrackerManager::TrackerManager()
     : DeviceTypeManager(10000, 13)
     , m_tracker_list_dirty(false)
 {
+	// Readers see the default config until the config file is loaded
+	publishTunables();
 }
 
 bool 
@@ -201,6 +285,8 @@ TrackerManager::startup()
         // Save back out the config in case there were updated defaults
         cfg.save();
 
+		publishTunables();
+
 		// Copy the virtual tracker count into the Virtual tracker enumerator's static variable.
 		// This breaks the dependency between the Tracker Manager and the enumerator.
 		VirtualTrackerEnumerator::virtual_tracker_count = cfg.virtual_tracker_count;
@@ -220,31 +306,146 @@ TrackerManager::startup()
 
 void TrackerManager::poll_devices()
 {
+	// Trackers retrieve a new frame whenever they aren't holding one for the next group
+	DeviceTypeManager::poll_devices();
+
+	update_frame_group();
+}
+
+void TrackerManager::update_frame_group()
+{
+	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+	const int frame_sync_tolerance_ms = getTunables()->frame_sync_tolerance_ms;
+
 	m_trackersSynced = false;
-	m_readyToReceive = true;
-	for (int i = 0; i < getMaxDevices(); i++)
+
+	double slowest_frame_rate = 0.0;
+	int open_count = 0;
+	int pending_count = 0;
+	std::chrono::time_point<std::chrono::high_resolution_clock> oldest_arrival = now;
+	std::chrono::time_point<std::chrono::high_resolution_clock> newest_arrival;
+
+	for (int tracker_id = 0; tracker_id < getMaxDevices(); ++tracker_id)
 	{
-		const ServerTrackerViewPtr tracker = getTrackerViewPtr(i);
-		if (tracker->getIsOpen())
+		m_isTrackerInFrameGroup[tracker_id] = false;
+
+		const ServerTrackerViewPtr tracker = getTrackerViewPtr(tracker_id);
+		if (!tracker->getIsOpen())
 		{
-			if (!m_isTrackerFrameAvailable[tracker->getDeviceID()])
-			{
-				m_readyToReceive = false;
-				break;
-			}
+			// A closed tracker can't hold up a group
+			m_isTrackerFramePending[tracker_id] = false;
+			continue;
+		}
+
+		++open_count;
+
+		const double frame_rate = tracker->getFrameRate();
+		if (frame_rate > 0.0)
+		{
+			slowest_frame_rate = (slowest_frame_rate > 0.0) ? std::min(slowest_frame_rate, frame_rate) : frame_rate;
+		}
+
+		if (m_isTrackerFramePending[tracker_id])
+		{
+			const std::chrono::time_point<std::chrono::high_resolution_clock> &arrival = m_trackerFrameArrivalTimes[tracker_id];
+
+			oldest_arrival = std::min(oldest_arrival, arrival);
+			newest_arrival = (pending_count > 0) ? std::max(newest_arrival, arrival) : arrival;
+			++pending_count;
 		}
 	}
 
-	DeviceTypeManager::poll_devices();
+	// Unless configured, frames within half a frame period of each other belong to the same group
+	std::chrono::microseconds tolerance(frame_sync_tolerance_ms * 1000);
+	if (frame_sync_tolerance_ms <= 0)
+	{
+		tolerance = std::chrono::microseconds(
+			(slowest_frame_rate > 0.0) ? static_cast<int64_t>(500000.0 / slowest_frame_rate) : k_default_frame_sync_tolerance_us);
+	}
+
+	// Wait for every tracker's next frame, 
+	// but don't hold up the others for longer than the tolerance when a tracker is slow or stalled
+	if (pending_count == 0 || (pending_count < open_count && now - oldest_arrival < tolerance))
+	{
+		return;
+	}
 
-	if (m_readyToReceive)
+	// Group the frames that arrived close to the newest one.
+	// The older frames are released so that those trackers pick up a fresher frame for the next group.
+	for (int tracker_id = 0; tracker_id < getMaxDevices(); ++tracker_id)
 	{
-		for (int i = 0; i < getMaxDevices(); i++)
+		if (m_isTrackerFramePending[tracker_id])
 		{
-			m_isTrackerFrameAvailable[i] = false;
+			m_isTrackerInFrameGroup[tracker_id] = (newest_arrival - m_trackerFrameArrivalTimes[tracker_id] <= tolerance);
+			m_isTrackerFramePending[tracker_id] = false;
 		}
-		m_readyToReceive = false;
-		m_trackersSynced = true;
+	}
+
+	m_trackersSynced = true;
+}
+
+void TrackerManager::updateFrameModes()
+{
+	ControllerManager *controller_manager = DeviceManager::getInstance()->m_controller_manager;
+	HMDManager *hmd_manager = DeviceManager::getInstance()->m_hmd_manager;
+	const TrackerManagerTunables &cfg = *getTunables();
+
+	for (int tracker_id = 0; tracker_id < getMaxDevices(); ++tracker_id)
+	{
+		ServerTrackerViewPtr tracker = getTrackerViewPtr(tracker_id);
+
+		if (!tracker->getIsOpen())
+		{
+			continue;
+		}
+
+		// Compare projections in 640x480 pixels whatever mode the tracker is in
+		const float frame_width = static_cast<float>(tracker->getFrameWidth());
+		const float area_scale = (frame_width > 0.f) ? (640.f*640.f) / (frame_width*frame_width) : 1.f;
+
+		// Each object has to be both close and fast on its own,
+		// a close slow object and a far fast one don't make this tracker switch
+		float max_close_and_fast_ratio = 0.f;
+
+		for (int controller_id = 0; controller_id < controller_manager->getMaxDevices(); ++controller_id)
+		{
+			ServerControllerViewPtr controller = controller_manager->getControllerViewPtr(controller_id);
+			if (!controller->getIsOpen())
+			{
+				continue;
+			}
+
+			const ControllerOpticalPoseEstimation *pose_estimate = controller->getTrackerPoseEstimate(tracker_id);
+			const IPoseFilter *pose_filter = controller->getPoseFilter();
+			if (pose_estimate != nullptr && pose_estimate->bCurrentlyTracking && pose_filter != nullptr)
+			{
+				max_close_and_fast_ratio = std::max(
+					max_close_and_fast_ratio,
+					compute_close_and_fast_ratio(
+						cfg, pose_estimate->projection.screen_area*area_scale, pose_filter->getVelocityCmPerSec().norm()));
+			}
+		}
+
+		for (int hmd_id = 0; hmd_id < hmd_manager->getMaxDevices(); ++hmd_id)
+		{
+			ServerHMDViewPtr hmd = hmd_manager->getHMDViewPtr(hmd_id);
+			if (!hmd->getIsOpen())
+			{
+				continue;
+			}
+
+			const HMDOpticalPoseEstimation *pose_estimate = hmd->getTrackerPoseEstimate(tracker_id);
+			const IPoseFilter *pose_filter = hmd->getPoseFilter();
+			if (pose_estimate != nullptr && pose_estimate->bCurrentlyTracking && pose_filter != nullptr)
+			{
+				max_close_and_fast_ratio = std::max(
+					max_close_and_fast_ratio,
+					compute_close_and_fast_ratio(
+						cfg, pose_estimate->projection.screen_area*area_scale, pose_filter->getVelocityCmPerSec().norm()));
+			}
+		}
+
+		tracker->updateAutoFrameMode(max_close_and_fast_ratio);
 	}
 }
 
@@ -280,6 +481,15 @@ TrackerManager::mark_tracker_list_dirty()
     m_tracker_list_dirty= true;
 }
 
+void
+TrackerManager::publishTunables()
+{
+	TrackerManagerTunables tunables;
+	tunables.applyConfig(cfg);
+
+	m_tunables.publish(tunables);
+}
+
 DeviceEnumerator *
 TrackerManager::allocate_device_enumerator()
 {
@@ -368,7 +578,7 @@ TrackerManager::claimTrackingColorID(const ServerControllerView *claiming_contro
             {
                 if (controller_view->getTrackingColorID() == color_id)
                 {
-                    controller_view->setTrackingColorID(allocateTrackingColorID());
+                    controller_view->setTrackingColorID(allocateTrackingColorID(), true);
                     bColorWasInUse = true;
                     break;
                 }
@@ -435,7 +645,7 @@ TrackerManager::claimTrackingColorID(const ServerHMDView *claiming_hmd_view, eCo
             {
                 if (controller_view->getTrackingColorID() == color_id)
                 {
-                    controller_view->setTrackingColorID(allocateTrackingColorID());
+                    controller_view->setTrackingColorID(allocateTrackingColorID(), true);
                     bColorWasInUse = true;
                     break;
                 }
@@ -465,3 +675,17 @@ TrackerManager::freeTrackingColorID(eCommonTrackingColorID color_id)
     assert(std::find(m_available_color_ids.begin(), m_available_color_ids.end(), color_id) == m_available_color_ids.end());
     m_available_color_ids.push_back(color_id);
 }
+
+//-- private functions -----
+// How far an object is past both the near area and the fast speed thresholds, 1 means right at both
+static float
+compute_close_and_fast_ratio(
+	const TrackerManagerTunables &cfg,
+	const float screen_area,
+	const float speed_cm_per_sec)
+{
+	const float area_ratio = screen_area / std::max(cfg.auto_frame_mode_near_screen_area, 1.f);
+	const float speed_ratio = speed_cm_per_sec / std::max(cfg.auto_frame_mode_fast_speed, 1.f);
+
+	return std::min(area_ratio, speed_ratio);
+}
@@ -2,12 +2,14 @@
 #define TRACKER_MANAGER_H
 
 //-- includes -----
+#include <chrono>
 #include <memory>
 #include <deque>
 #include "DeviceTypeManager.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
 #include "PSMoveConfig.h"
+#include "AtomicPrimitives.h"
 
 //-- typedefs -----
 
@@ -65,9 +67,17 @@ public:
 	float occluded_area_regain_projection_size;
 	int min_points_in_contour;
 	float max_tracker_position_deviation;
+	int max_triangulation_pairs;
+	int frame_sync_tolerance_ms; // <= 0 uses half the frame period of the slowest tracker
+	bool auto_frame_mode;
+	float auto_frame_mode_near_screen_area;
+	float auto_frame_mode_fast_speed;
+	float auto_frame_mode_fast_frame_rate;
+	int auto_frame_mode_hold_ms;
 	bool disable_roi;
 	bool optimized_roi;
 	int roi_edge_offset;
+	int roi_search_downscale;
     TrackerProfile default_tracker_profile;
 	float global_forward_degrees;
 
@@ -79,6 +89,45 @@ public:
 	CommonDeviceVector get_global_down_axis() const;
 };
 
+/// The tracker manager settings read by the tracking code on every frame.
+/// An immutable copy is published whenever the config changes, so the tracking code
+/// reads a consistent set of values through a single atomic load.
+/// Values are clamped and derived values (like the global axes) are computed once when published.
+struct TrackerManagerTunables
+{
+	unsigned int snapshot_version;
+
+	float controller_position_smoothing;
+	float controller_position_prediction;
+	int controller_position_prediction_history;
+	bool ignore_pose_from_one_tracker;
+	int optical_tracking_timeout;
+	int thread_sleep_ms;
+	bool exclude_opposed_cameras;
+	float min_valid_projection_area;
+	float occluded_area_on_loss_size;
+	int occluded_area_ignore_trackers;
+	float occluded_area_regain_projection_size;
+	int min_points_in_contour; // At least 1
+	float max_tracker_position_deviation;
+	int max_triangulation_pairs;
+	int frame_sync_tolerance_ms;
+	bool auto_frame_mode;
+	float auto_frame_mode_near_screen_area;
+	float auto_frame_mode_fast_speed;
+	float auto_frame_mode_fast_frame_rate;
+	int auto_frame_mode_hold_ms;
+	bool disable_roi;
+	bool optimized_roi;
+	int roi_edge_offset; // Clamped to [0, 64]
+	int roi_search_downscale; // 1, 2 or 4
+	float global_forward_degrees;
+	CommonDeviceVector global_forward_axis;
+	CommonDeviceVector global_right_axis;
+
+	void applyConfig(const TrackerManagerConfig &config);
+};
+
 class TrackerManager : public DeviceTypeManager
 {
 public:
@@ -87,6 +136,9 @@ public:
     bool startup() override;
 	void poll_devices();
 
+	// Lets each tracker pick its frame mode based on how close and how fast the objects it tracks are
+	void updateFrameModes();
+
     void closeAllTrackers();
 
     static const int k_max_devices = PSMOVESERVICE_MAX_TRACKER_COUNT;
@@ -113,19 +165,36 @@ public:
         return cfg;
     }
 
+	// The hot path settings as of the last config change, safe to read from any thread
+	inline const TrackerManagerTunables *getTunables() const
+	{
+		return m_tunables.get();
+	}
+
+	// True on the ticks a group of tracker frames is ready for optical tracking
 	inline static bool trackersSynced()
 	{
 		return m_trackersSynced;
 	}
 
-	inline static void setTrackFrameAvailable(int deviceId)
+	// True if the tracker's frame is part of this tick's frame group
+	inline static bool isTrackerInFrameGroup(int deviceId)
+	{
+		return m_isTrackerInFrameGroup[deviceId];
+	}
+
+	// A tracker holds on to the frame it retrieved until that frame has been grouped
+	inline static bool canReceiveFrame(int deviceId)
 	{
-		m_isTrackerFrameAvailable[deviceId] = true;
+		return !m_isTrackerFramePending[deviceId];
 	}
 
-	inline static bool isReadyToReceive()
+	inline static void setTrackerFrameReceived(
+		int deviceId, 
+		const std::chrono::time_point<std::chrono::high_resolution_clock> &arrivalTime)
 	{
-		return m_readyToReceive;
+		m_isTrackerFramePending[deviceId] = true;
+		m_trackerFrameArrivalTimes[deviceId] = arrivalTime;
 	}
 
 
@@ -137,6 +206,7 @@ public:
 protected:
     bool can_update_connected_devices() override;
     void mark_tracker_list_dirty();
+	void publishTunables();
 
     DeviceEnumerator *allocate_device_enumerator() override;
     void free_device_enumerator(DeviceEnumerator *) override;
@@ -146,11 +216,15 @@ protected:
 private:
     std::deque<eCommonTrackingColorID> m_available_color_ids;
     TrackerManagerConfig cfg;
+	AtomicSnapshot<TrackerManagerTunables> m_tunables;
     bool m_tracker_list_dirty;
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastSync;
+	void update_frame_group();
+
 	static bool m_trackersSynced;
-	static bool m_isTrackerFrameAvailable[TrackerManager::k_max_devices];
-	static bool m_readyToReceive;
+	static bool m_isTrackerFramePending[TrackerManager::k_max_devices];
+	static bool m_isTrackerInFrameGroup[TrackerManager::k_max_devices];
+	static std::chrono::time_point<std::chrono::high_resolution_clock> m_trackerFrameArrivalTimes[TrackerManager::k_max_devices];
 };
 
 #endif // TRACKER_MANAGER_H
\ No newline at end of file
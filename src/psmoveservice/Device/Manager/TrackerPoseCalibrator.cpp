@@ -0,0 +1,380 @@
+//-- includes -----
+#include "TrackerPoseCalibrator.h"
+#include "ControllerManager.h"
+#include "ServerControllerView.h"
+#include "ServerLog.h"
+#include "ServerTrackerView.h"
+#include "TrackerCameraModel.h"
+#include "TrackerManager.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+//-- constants -----
+// Sampling
+static const float k_min_sample_spacing_cm = 2.f; // The controller has to move this far between samples
+static const size_t k_max_sample_count = 1000;
+static const size_t k_min_sample_count = 50;
+static const int k_min_tracker_observation_count = 30; // Trackers with fewer observations keep their pose
+
+//-- public implementation -----
+TrackerPoseCalibrator::TrackerPoseCalibrator()
+	: WorkerThread("TrackerPoseCalibrator")
+	, m_state(TrackerPoseCalibration_Idle)
+	, m_controllerId(-1)
+	, m_bOptimizeIntrinsics(false)
+	, m_bSolvePending(false)
+	, m_bApplyResult(false)
+	, m_lastSamplePosition(Eigen::Vector3d::Zero())
+	, m_samplePositions()
+	, m_observations()
+	, m_iterationCount(0)
+	, m_initialRMSErrorPx(0.f)
+	, m_finalRMSErrorPx(0.f)
+{
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		m_initialCameras[tracker_id].bIsOptimized = false;
+		m_solvedCameras[tracker_id].bIsOptimized = false;
+	}
+}
+
+TrackerPoseCalibrator::~TrackerPoseCalibrator()
+{
+	cancel();
+}
+
+bool TrackerPoseCalibrator::startSampling(const int controller_id, const bool bOptimizeIntrinsics)
+{
+	const eTrackerPoseCalibrationState state = m_state.load();
+	if (state == TrackerPoseCalibration_Sampling || state == TrackerPoseCalibration_Solving)
+	{
+		SERVER_LOG_WARNING("TrackerPoseCalibrator::startSampling") << "Tracker pose calibration already in progress";
+		return false;
+	}
+
+	// A previous solve thread has ended by now, but may not have been joined yet
+	stopThread();
+
+	m_controllerId = controller_id;
+	m_bOptimizeIntrinsics = bOptimizeIntrinsics;
+	m_bSolvePending = false;
+	m_bApplyResult = false;
+	m_samplePositions.clear();
+	m_observations.clear();
+	m_samplePositions.reserve(k_max_sample_count);
+	m_observations.reserve(k_max_sample_count * 2);
+	m_iterationCount = 0;
+	m_initialRMSErrorPx = 0.f;
+	m_finalRMSErrorPx = 0.f;
+	m_state.store(TrackerPoseCalibration_Sampling);
+
+	SERVER_LOG_INFO("TrackerPoseCalibrator::startSampling")
+		<< "Sampling controller " << controller_id << " for tracker pose calibration"
+		<< (bOptimizeIntrinsics ? " (with focal lengths)" : "");
+
+	return true;
+}
+
+bool TrackerPoseCalibrator::stopSampling(const bool bApplyResult)
+{
+	if (m_state.load() != TrackerPoseCalibration_Sampling)
+	{
+		return false;
+	}
+
+	// The solve starts on the next update, where the trackers are available
+	m_bSolvePending = true;
+	m_bApplyResult = bApplyResult;
+
+	return true;
+}
+
+void TrackerPoseCalibrator::cancel()
+{
+	// Signals the solver to bail and blocks until it does
+	stopThread();
+
+	m_bSolvePending = false;
+	m_samplePositions.clear();
+	m_observations.clear();
+	m_state.store(TrackerPoseCalibration_Idle);
+}
+
+void TrackerPoseCalibrator::update(ControllerManager *controller_manager, TrackerManager *tracker_manager)
+{
+	switch (m_state.load())
+	{
+	case TrackerPoseCalibration_Sampling:
+		if (m_bSolvePending)
+		{
+			m_bSolvePending = false;
+
+			if (m_samplePositions.size() >= k_min_sample_count && snapshotCameras(tracker_manager))
+			{
+				SERVER_LOG_INFO("TrackerPoseCalibrator::update")
+					<< "Solving tracker poses from " << m_samplePositions.size() << " samples ("
+					<< m_observations.size() << " observations)";
+
+				m_state.store(TrackerPoseCalibration_Solving);
+				startThread();
+			}
+			else
+			{
+				SERVER_LOG_WARNING("TrackerPoseCalibrator::update")
+					<< "Not enough samples to calibrate the tracker poses (" << m_samplePositions.size()
+					<< " samples, need " << k_min_sample_count << " seen by at least two trackers)";
+
+				m_state.store(TrackerPoseCalibration_Failed);
+			}
+		}
+		else if (m_samplePositions.size() < k_max_sample_count)
+		{
+			ServerControllerViewPtr controller_view = controller_manager->getControllerViewPtr(m_controllerId);
+
+			if (controller_view && controller_view->getIsOpen())
+			{
+				addSample(controller_view.get(), tracker_manager);
+			}
+		}
+		break;
+	case TrackerPoseCalibration_Solved:
+	case TrackerPoseCalibration_Failed:
+		if (hasThreadStarted() && hasThreadEnded())
+		{
+			stopThread();
+
+			if (m_state.load() == TrackerPoseCalibration_Solved && m_bApplyResult)
+			{
+				applyResult(tracker_manager);
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void TrackerPoseCalibrator::getStatus(TrackerPoseCalibrationStatus &out_status) const
+{
+	out_status.state = m_state.load();
+
+	// The solver only reads the samples
+	out_status.sample_count = static_cast<int>(m_samplePositions.size());
+	out_status.observation_count = static_cast<int>(m_observations.size());
+
+	// but its results are only valid once it has left the solving state
+	if (out_status.state != TrackerPoseCalibration_Solving)
+	{
+		out_status.iteration_count = m_iterationCount;
+		out_status.initial_rms_error_px = m_initialRMSErrorPx;
+		out_status.final_rms_error_px = m_finalRMSErrorPx;
+	}
+	else
+	{
+		out_status.iteration_count = 0;
+		out_status.initial_rms_error_px = 0.f;
+		out_status.final_rms_error_px = 0.f;
+	}
+}
+
+//-- protected implementation -----
+void TrackerPoseCalibrator::addSample(const ServerControllerView *controller_view, TrackerManager *tracker_manager)
+{
+	// Only the sphere projection has a single well defined point to triangulate
+	CommonDeviceTrackingShape tracking_shape;
+	if (!controller_view->getTrackingShape(tracking_shape) ||
+		tracking_shape.shape_type != eCommonTrackingShapeType::Sphere)
+	{
+		return;
+	}
+
+	const ControllerOpticalPoseEstimation *multicam_estimate = controller_view->getMulticamPoseEstimate();
+	if (!multicam_estimate->bCurrentlyTracking)
+	{
+		return;
+	}
+
+	const Eigen::Vector3d world_position(
+		multicam_estimate->position_cm.x,
+		multicam_estimate->position_cm.y,
+		multicam_estimate->position_cm.z);
+	if (!m_samplePositions.empty() &&
+		(world_position - m_lastSamplePosition).norm() < k_min_sample_spacing_cm)
+	{
+		return;
+	}
+
+	// Every tracker with a fresh sighting of the sphere in this frame group
+	const int sample_index = static_cast<int>(m_samplePositions.size());
+	const size_t first_observation = m_observations.size();
+	for (int tracker_id = 0; tracker_id < tracker_manager->getMaxDevices(); ++tracker_id)
+	{
+		ServerTrackerViewPtr tracker_view = tracker_manager->getTrackerViewPtr(tracker_id);
+		if (!tracker_view->getIsOpen() || !TrackerManager::isTrackerInFrameGroup(tracker_id))
+		{
+			continue;
+		}
+
+		const ControllerOpticalPoseEstimation *tracker_estimate = controller_view->getTrackerPoseEstimate(tracker_id);
+		if (tracker_estimate == nullptr || !tracker_estimate->bCurrentlyTracking ||
+			tracker_estimate->projection.shape_type != eCommonTrackingProjectionType::ProjectionType_Ellipse)
+		{
+			continue;
+		}
+
+		TrackerPoseCalibrationObservation observation;
+		observation.sample_index = sample_index;
+		observation.tracker_id = tracker_id;
+		observation.screen_x = tracker_estimate->projection.shape.ellipse.center.x;
+		observation.screen_y = tracker_estimate->projection.shape.ellipse.center.y;
+		m_observations.push_back(observation);
+	}
+
+	if (m_observations.size() - first_observation >= 2)
+	{
+		m_samplePositions.push_back(world_position);
+		m_lastSamplePosition = world_position;
+
+		if (m_samplePositions.size() == k_max_sample_count)
+		{
+			SERVER_LOG_INFO("TrackerPoseCalibrator::addSample") << "Collected the maximum of " << k_max_sample_count << " samples";
+		}
+	}
+	else
+	{
+		// A single tracker adds nothing to the cross tracker consistency
+		m_observations.resize(first_observation);
+	}
+}
+
+bool TrackerPoseCalibrator::snapshotCameras(TrackerManager *tracker_manager)
+{
+	int observation_counts[k_tracker_pose_calibration_max_trackers];
+	memset(observation_counts, 0, sizeof(observation_counts));
+	for (const TrackerPoseCalibrationObservation &observation : m_observations)
+	{
+		++observation_counts[observation.tracker_id];
+	}
+
+	int optimized_tracker_count = 0;
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		TrackerPoseCalibrationCamera &camera = m_initialCameras[tracker_id];
+		camera.bIsOptimized = false;
+
+		if (tracker_id >= tracker_manager->getMaxDevices() ||
+			observation_counts[tracker_id] < k_min_tracker_observation_count)
+		{
+			continue;
+		}
+
+		ServerTrackerViewPtr tracker_view = tracker_manager->getTrackerViewPtr(tracker_id);
+		if (!tracker_view->getIsOpen())
+		{
+			continue;
+		}
+
+		const CommonDevicePose pose = tracker_view->getTrackerPose();
+		const TrackerCameraModel &camera_model = tracker_view->getCameraModel();
+
+		camera.bIsOptimized = true;
+		camera.orientation = Eigen::Quaterniond(pose.Orientation.w, pose.Orientation.x, pose.Orientation.y, pose.Orientation.z).normalized();
+		camera.position = Eigen::Vector3d(pose.PositionCm.x, pose.PositionCm.y, pose.PositionCm.z);
+		camera.focal_length_x = camera_model.intrinsicMatrix(0, 0);
+		camera.focal_length_y = camera_model.intrinsicMatrix(1, 1);
+		camera.principal_x = camera_model.intrinsicMatrix(0, 2);
+		camera.principal_y = camera_model.intrinsicMatrix(1, 2);
+		camera.focal_scale = 1.0;
+		++optimized_tracker_count;
+	}
+
+	return optimized_tracker_count >= 2;
+}
+
+void TrackerPoseCalibrator::applyResult(TrackerManager *tracker_manager)
+{
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		const TrackerPoseCalibrationCamera &camera = m_solvedCameras[tracker_id];
+		if (!camera.bIsOptimized || tracker_id >= tracker_manager->getMaxDevices())
+		{
+			continue;
+		}
+
+		ServerTrackerViewPtr tracker_view = tracker_manager->getTrackerViewPtr(tracker_id);
+		if (!tracker_view->getIsOpen())
+		{
+			SERVER_LOG_WARNING("TrackerPoseCalibrator::applyResult") << "Tracker " << tracker_id << " closed while solving, pose not updated";
+			continue;
+		}
+
+		CommonDevicePose pose;
+		pose.Orientation.w = static_cast<float>(camera.orientation.w());
+		pose.Orientation.x = static_cast<float>(camera.orientation.x());
+		pose.Orientation.y = static_cast<float>(camera.orientation.y());
+		pose.Orientation.z = static_cast<float>(camera.orientation.z());
+		pose.PositionCm.x = static_cast<float>(camera.position.x());
+		pose.PositionCm.y = static_cast<float>(camera.position.y());
+		pose.PositionCm.z = static_cast<float>(camera.position.z());
+		tracker_view->setTrackerPose(&pose, true);
+
+		if (m_bOptimizeIntrinsics)
+		{
+			float focal_length_x, focal_length_y, principal_x, principal_y;
+			float distortion_k1, distortion_k2, distortion_k3, distortion_p1, distortion_p2;
+			tracker_view->getCameraIntrinsics(
+				focal_length_x, focal_length_y, principal_x, principal_y,
+				distortion_k1, distortion_k2, distortion_k3, distortion_p1, distortion_p2);
+
+			const float focal_scale = static_cast<float>(camera.focal_scale);
+			tracker_view->setCameraIntrinsics(
+				focal_length_x*focal_scale, focal_length_y*focal_scale, principal_x, principal_y,
+				distortion_k1, distortion_k2, distortion_k3, distortion_p1, distortion_p2);
+		}
+
+		tracker_view->saveSettings();
+
+		const TrackerPoseCalibrationCamera &initial_camera = m_initialCameras[tracker_id];
+		SERVER_LOG_INFO("TrackerPoseCalibrator::applyResult")
+			<< "Tracker " << tracker_id << " moved " << (camera.position - initial_camera.position).norm() << "cm, rotated "
+			<< initial_camera.orientation.angularDistance(camera.orientation) * 180.0 / 3.14159265358979323846 << "deg"
+			<< (m_bOptimizeIntrinsics ? ", focal length scale " : "") << (m_bOptimizeIntrinsics ? camera.focal_scale : 1.0);
+	}
+}
+
+bool TrackerPoseCalibrator::doWork()
+{
+	const bool bSolved = solve();
+
+	m_state.store(bSolved ? TrackerPoseCalibration_Solved : TrackerPoseCalibration_Failed);
+
+	// One solve per thread start
+	return false;
+}
+
+bool TrackerPoseCalibrator::solve()
+{
+	TrackerPoseSolverResult result;
+	const bool bSolved = tracker_pose_solver_solve(
+		m_samplePositions, m_observations, m_initialCameras, m_bOptimizeIntrinsics, &m_exitSignaled,
+		m_solvedCameras, result);
+
+	m_iterationCount = result.iteration_count;
+	m_initialRMSErrorPx = result.initial_rms_error_px;
+	m_finalRMSErrorPx = result.final_rms_error_px;
+
+	if (result.bCanceled)
+	{
+		SERVER_LOG_INFO("TrackerPoseCalibrator::solve") << "Tracker pose calibration canceled";
+		return false;
+	}
+
+	SERVER_LOG_INFO("TrackerPoseCalibrator::solve")
+		<< "Tracker pose calibration finished after " << m_iterationCount << " iterations, rms reprojection error "
+		<< m_initialRMSErrorPx << "px -> " << m_finalRMSErrorPx << "px";
+
+	return bSolved;
+}
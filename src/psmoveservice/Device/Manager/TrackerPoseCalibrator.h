@@ -0,0 +1,94 @@
+#ifndef TRACKER_POSE_CALIBRATOR_H
+#define TRACKER_POSE_CALIBRATOR_H
+
+//-- includes -----
+#include "TrackerPoseSolver.h"
+#include "WorkerThread.h"
+
+#include <atomic>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+//-- constants -----
+enum eTrackerPoseCalibrationState
+{
+	TrackerPoseCalibration_Idle,
+	TrackerPoseCalibration_Sampling,
+	TrackerPoseCalibration_Solving,
+	TrackerPoseCalibration_Solved,
+	TrackerPoseCalibration_Failed
+};
+
+//-- definitions -----
+/// Summary of the current (or last) calibration
+struct TrackerPoseCalibrationStatus
+{
+	eTrackerPoseCalibrationState state;
+	int sample_count;
+	int observation_count;
+	int iteration_count;
+	float initial_rms_error_px;
+	float final_rms_error_px;
+};
+
+/// Jointly refines the poses of all trackers from a controller waved around the tracking space.
+/// While sampling, every frame group in which at least two trackers see the controller sphere
+/// adds one sample: the sphere center seen by each of those trackers plus the triangulated position.
+/// Stopping hands the samples to a worker thread that runs a sparse Levenberg-Marquardt bundle adjustment
+/// over all tracker poses (and optionally their focal lengths) and all sample positions.
+/// A weak prior towards the current calibration pins down the overall position, rotation and scale
+/// of the tracking space, which the reprojection error alone can't see.
+/// All of the public methods must be called from the main thread, results are applied in update().
+class TrackerPoseCalibrator : public WorkerThread
+{
+public:
+	TrackerPoseCalibrator();
+	virtual ~TrackerPoseCalibrator();
+
+	bool startSampling(const int controller_id, const bool bOptimizeIntrinsics);
+	bool stopSampling(const bool bApplyResult);
+	void cancel();
+
+	/// Adds samples while sampling, applies the result once the worker thread finishes solving
+	void update(class ControllerManager *controller_manager, class TrackerManager *tracker_manager);
+
+	void getStatus(TrackerPoseCalibrationStatus &out_status) const;
+	inline eTrackerPoseCalibrationState getState() const { return m_state.load(); }
+
+protected:
+	void addSample(const class ServerControllerView *controller_view, class TrackerManager *tracker_manager);
+
+	bool snapshotCameras(class TrackerManager *tracker_manager);
+	void applyResult(class TrackerManager *tracker_manager);
+
+	// Solver
+	virtual bool doWork() override;
+	bool solve();
+
+private:
+	// Shared State
+	std::atomic<eTrackerPoseCalibrationState> m_state;
+
+	// Main Thread State
+	int m_controllerId;
+	bool m_bOptimizeIntrinsics;
+	bool m_bSolvePending;
+	bool m_bApplyResult;
+	Eigen::Vector3d m_lastSamplePosition;
+
+	// Owned by the main thread while sampling, by the worker thread while solving
+	std::vector<Eigen::Vector3d> m_samplePositions;
+	std::vector<TrackerPoseCalibrationObservation> m_observations;
+	TrackerPoseCalibrationCamera m_initialCameras[k_tracker_pose_calibration_max_trackers];
+	TrackerPoseCalibrationCamera m_solvedCameras[k_tracker_pose_calibration_max_trackers];
+	int m_iterationCount;
+	float m_initialRMSErrorPx;
+	float m_finalRMSErrorPx;
+
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+#endif // TRACKER_POSE_CALIBRATOR_H
@@ -0,0 +1,405 @@
+//-- includes -----
+#include "TrackerPoseSolver.h"
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+//-- constants -----
+static const int k_max_iteration_count = 50;
+static const double k_initial_damping = 1e-3;
+static const double k_max_damping = 1e8;
+static const double k_min_relative_cost_decrease = 1e-6;
+static const double k_huber_threshold_px = 3.0; // Reprojection errors past this are down-weighted as outliers
+static const double k_min_tracker_depth_cm = 1.0;
+
+// Standard deviations of the prior towards the current calibration.
+// Loose enough that the samples decide the relative tracker poses,
+// but they are all that fixes the overall position, rotation and scale of the tracking space.
+static const double k_prior_position_sigma_cm = 10.0;
+static const double k_prior_rotation_sigma_radians = 5.0 * 3.14159265358979323846 / 180.0;
+static const double k_prior_focal_scale_sigma = 0.05;
+
+//-- private methods -----
+static int get_camera_parameter_count(const bool bOptimizeIntrinsics);
+static bool project_sample_position(
+	const TrackerPoseCalibrationCamera &camera, const Eigen::Vector3d &world_position,
+	Eigen::Vector2d &out_screen_location, Eigen::Vector3d &out_tracker_position);
+static double compute_robust_cost(
+	const TrackerPoseCalibrationCamera *initial_cameras,
+	const TrackerPoseCalibrationCamera *cameras,
+	const std::vector<Eigen::Vector3d> &positions,
+	const std::vector<TrackerPoseCalibrationObservation> &observations,
+	double *out_rms_error_px);
+static Eigen::Matrix3d skew_symmetric(const Eigen::Vector3d &v);
+static bool is_canceled(const std::atomic_bool *exit_signaled);
+
+//-- public interface -----
+// Levenberg-Marquardt over the stacked parameter vector
+// [sample positions (3 each) | tracker rotation delta, position (and focal scale) for each optimized tracker].
+// Each reprojection residual only touches one sample and one tracker,
+// so the normal equations are very sparse and solved with a sparse Cholesky factorization.
+// Rotations are updated multiplicatively, R <- R*exp(delta), so delta is always near zero.
+bool tracker_pose_solver_solve(
+	const std::vector<Eigen::Vector3d> &sample_positions,
+	const std::vector<TrackerPoseCalibrationObservation> &all_observations,
+	const TrackerPoseCalibrationCamera *initial_cameras,
+	const bool bOptimizeIntrinsics,
+	const std::atomic_bool *exit_signaled,
+	TrackerPoseCalibrationCamera *out_solved_cameras,
+	TrackerPoseSolverResult &out_result)
+{
+	const int camera_parameter_count = get_camera_parameter_count(bOptimizeIntrinsics);
+	const int sample_count = static_cast<int>(sample_positions.size());
+
+	out_result.iteration_count = 0;
+	out_result.initial_rms_error_px = 0.f;
+	out_result.final_rms_error_px = 0.f;
+	out_result.bCanceled = false;
+
+	// Only observations from optimized trackers take part
+	std::vector<TrackerPoseCalibrationObservation> observations;
+	observations.reserve(all_observations.size());
+	for (const TrackerPoseCalibrationObservation &observation : all_observations)
+	{
+		if (initial_cameras[observation.tracker_id].bIsOptimized)
+		{
+			observations.push_back(observation);
+		}
+	}
+
+	int camera_parameter_offsets[k_tracker_pose_calibration_max_trackers];
+	int parameter_count = 3 * sample_count;
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		camera_parameter_offsets[tracker_id] = -1;
+		out_solved_cameras[tracker_id] = initial_cameras[tracker_id];
+
+		if (initial_cameras[tracker_id].bIsOptimized)
+		{
+			camera_parameter_offsets[tracker_id] = parameter_count;
+			parameter_count += camera_parameter_count;
+		}
+	}
+	const int residual_count = 2 * static_cast<int>(observations.size()) + (parameter_count - 3 * sample_count);
+
+	std::vector<Eigen::Vector3d> positions = sample_positions;
+	double rms_error_px = 0.0;
+	double cost = compute_robust_cost(initial_cameras, out_solved_cameras, positions, observations, &rms_error_px);
+	out_result.initial_rms_error_px = static_cast<float>(rms_error_px);
+
+	std::vector<Eigen::Triplet<double> > jacobian_entries;
+	jacobian_entries.reserve(observations.size() * 2 * (3 + camera_parameter_count) + (parameter_count - 3 * sample_count));
+	Eigen::SparseMatrix<double> J(residual_count, parameter_count);
+	Eigen::VectorXd residuals(residual_count);
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > solver;
+	bool bAnalyzedPattern = false;
+
+	double damping = k_initial_damping;
+	int iteration = 0;
+	for (; iteration < k_max_iteration_count && !is_canceled(exit_signaled); ++iteration)
+	{
+		// Linearize the reprojection residuals, Huber weighted, then the priors
+		jacobian_entries.clear();
+		residuals.setZero();
+
+		int row = 0;
+		for (const TrackerPoseCalibrationObservation &observation : observations)
+		{
+			const TrackerPoseCalibrationCamera &camera = out_solved_cameras[observation.tracker_id];
+			const Eigen::Vector3d &world_position = positions[observation.sample_index];
+
+			Eigen::Vector2d screen_location;
+			Eigen::Vector3d p;
+			if (project_sample_position(camera, world_position, screen_location, p))
+			{
+				const Eigen::Vector2d error = screen_location - Eigen::Vector2d(observation.screen_x, observation.screen_y);
+				const double error_norm = error.norm();
+				const double weight = (error_norm > k_huber_threshold_px) ? sqrt(k_huber_threshold_px / error_norm) : 1.0;
+				const double fx = camera.focal_scale * camera.focal_length_x;
+				const double fy = camera.focal_scale * camera.focal_length_y;
+				const double inv_z = 1.0 / p.z();
+
+				// d(screen)/d(tracker space position)
+				Eigen::Matrix<double, 2, 3> J_p;
+				J_p << fx*inv_z, 0.0, -fx*p.x()*inv_z*inv_z,
+					0.0, fy*inv_z, -fy*p.y()*inv_z*inv_z;
+
+				// p = R^T*(X - C)
+				const Eigen::Matrix3d Rt = camera.orientation.toRotationMatrix().transpose();
+				const Eigen::Matrix<double, 2, 3> J_position = weight * J_p * Rt;
+				const Eigen::Matrix<double, 2, 3> J_rotation = weight * J_p * skew_symmetric(p);
+
+				const int sample_offset = 3 * observation.sample_index;
+				const int camera_offset = camera_parameter_offsets[observation.tracker_id];
+				for (int r = 0; r < 2; ++r)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						jacobian_entries.push_back(Eigen::Triplet<double>(row + r, sample_offset + c, J_position(r, c)));
+						jacobian_entries.push_back(Eigen::Triplet<double>(row + r, camera_offset + c, J_rotation(r, c)));
+						jacobian_entries.push_back(Eigen::Triplet<double>(row + r, camera_offset + 3 + c, -J_position(r, c)));
+					}
+				}
+
+				if (bOptimizeIntrinsics)
+				{
+					jacobian_entries.push_back(Eigen::Triplet<double>(row, camera_offset + 6, weight*camera.focal_length_x*p.x()*inv_z));
+					jacobian_entries.push_back(Eigen::Triplet<double>(row + 1, camera_offset + 6, weight*camera.focal_length_y*p.y()*inv_z));
+				}
+
+				residuals.segment<2>(row) = weight * error;
+			}
+
+			row += 2;
+		}
+
+		for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+		{
+			const int camera_offset = camera_parameter_offsets[tracker_id];
+			if (camera_offset < 0)
+			{
+				continue;
+			}
+
+			const TrackerPoseCalibrationCamera &camera = out_solved_cameras[tracker_id];
+			const TrackerPoseCalibrationCamera &initial_camera = initial_cameras[tracker_id];
+			const Eigen::AngleAxisd rotation_error(initial_camera.orientation.conjugate() * camera.orientation);
+
+			residuals.segment<3>(row) = rotation_error.angle() * rotation_error.axis() / k_prior_rotation_sigma_radians;
+			residuals.segment<3>(row + 3) = (camera.position - initial_camera.position) / k_prior_position_sigma_cm;
+			for (int index = 0; index < 3; ++index)
+			{
+				jacobian_entries.push_back(Eigen::Triplet<double>(row + index, camera_offset + index, 1.0 / k_prior_rotation_sigma_radians));
+				jacobian_entries.push_back(Eigen::Triplet<double>(row + 3 + index, camera_offset + 3 + index, 1.0 / k_prior_position_sigma_cm));
+			}
+
+			if (bOptimizeIntrinsics)
+			{
+				residuals[row + 6] = (camera.focal_scale - 1.0) / k_prior_focal_scale_sigma;
+				jacobian_entries.push_back(Eigen::Triplet<double>(row + 6, camera_offset + 6, 1.0 / k_prior_focal_scale_sigma));
+			}
+
+			row += camera_parameter_count;
+		}
+		assert(row == residual_count);
+
+		J.setFromTriplets(jacobian_entries.begin(), jacobian_entries.end());
+
+		const Eigen::SparseMatrix<double> JtJ = Eigen::SparseMatrix<double>(J.transpose() * J);
+		const Eigen::VectorXd gradient = J.transpose() * residuals;
+		const Eigen::VectorXd JtJ_diagonal = JtJ.diagonal();
+
+		if (!bAnalyzedPattern)
+		{
+			// The sparsity pattern is the same for every iteration
+			solver.analyzePattern(JtJ);
+			bAnalyzedPattern = true;
+		}
+
+		// Raise the damping until a step lowers the cost
+		bool bStepAccepted = false;
+		double new_cost = cost;
+		while (!bStepAccepted && damping < k_max_damping && !is_canceled(exit_signaled))
+		{
+			Eigen::SparseMatrix<double> damped_JtJ = JtJ;
+			for (int index = 0; index < parameter_count; ++index)
+			{
+				damped_JtJ.coeffRef(index, index) += damping * JtJ_diagonal[index] + 1e-9;
+			}
+
+			solver.factorize(damped_JtJ);
+			if (solver.info() != Eigen::Success)
+			{
+				damping *= 10.0;
+				continue;
+			}
+
+			const Eigen::VectorXd delta = -solver.solve(gradient);
+
+			// Candidate parameters
+			std::vector<Eigen::Vector3d> new_positions = positions;
+			for (int sample_index = 0; sample_index < sample_count; ++sample_index)
+			{
+				new_positions[sample_index] += delta.segment<3>(3 * sample_index);
+			}
+
+			TrackerPoseCalibrationCamera new_cameras[k_tracker_pose_calibration_max_trackers];
+			for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+			{
+				TrackerPoseCalibrationCamera &new_camera = new_cameras[tracker_id];
+				new_camera = out_solved_cameras[tracker_id];
+
+				const int camera_offset = camera_parameter_offsets[tracker_id];
+				if (camera_offset < 0)
+				{
+					continue;
+				}
+
+				const Eigen::Vector3d rotation_delta = delta.segment<3>(camera_offset);
+				const double rotation_angle = rotation_delta.norm();
+				if (rotation_angle > 0.0)
+				{
+					new_camera.orientation =
+						(new_camera.orientation * Eigen::Quaterniond(Eigen::AngleAxisd(rotation_angle, rotation_delta / rotation_angle))).normalized();
+				}
+				new_camera.position += delta.segment<3>(camera_offset + 3);
+
+				if (bOptimizeIntrinsics)
+				{
+					new_camera.focal_scale += delta[camera_offset + 6];
+				}
+			}
+
+			new_cost = compute_robust_cost(initial_cameras, new_cameras, new_positions, observations, nullptr);
+			if (new_cost < cost)
+			{
+				positions.swap(new_positions);
+				for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+				{
+					out_solved_cameras[tracker_id] = new_cameras[tracker_id];
+				}
+
+				damping = std::max(damping * 0.1, 1e-9);
+				bStepAccepted = true;
+			}
+			else
+			{
+				damping *= 10.0;
+			}
+		}
+
+		if (!bStepAccepted)
+		{
+			// No step lowers the cost any more
+			break;
+		}
+
+		const double relative_cost_decrease = (cost - new_cost) / cost;
+		cost = new_cost;
+
+		if (relative_cost_decrease < k_min_relative_cost_decrease)
+		{
+			break;
+		}
+	}
+
+	out_result.iteration_count = iteration;
+
+	if (is_canceled(exit_signaled))
+	{
+		out_result.bCanceled = true;
+		return false;
+	}
+
+	compute_robust_cost(initial_cameras, out_solved_cameras, positions, observations, &rms_error_px);
+	out_result.final_rms_error_px = static_cast<float>(rms_error_px);
+
+	return out_result.final_rms_error_px <= out_result.initial_rms_error_px;
+}
+
+//-- private methods -----
+static int get_camera_parameter_count(const bool bOptimizeIntrinsics)
+{
+	// rotation delta, position, focal scale
+	return bOptimizeIntrinsics ? 7 : 6;
+}
+
+static bool project_sample_position(
+	const TrackerPoseCalibrationCamera &camera,
+	const Eigen::Vector3d &world_position,
+	Eigen::Vector2d &out_screen_location,
+	Eigen::Vector3d &out_tracker_position)
+{
+	out_tracker_position = camera.orientation.conjugate() * (world_position - camera.position);
+
+	// Behind the tracker, can't have been seen
+	if (out_tracker_position.z() < k_min_tracker_depth_cm)
+	{
+		return false;
+	}
+
+	const double inv_z = 1.0 / out_tracker_position.z();
+	out_screen_location.x() =
+		camera.focal_scale * camera.focal_length_x * out_tracker_position.x() * inv_z + camera.principal_x;
+	out_screen_location.y() =
+		camera.focal_scale * camera.focal_length_y * out_tracker_position.y() * inv_z + camera.principal_y;
+
+	return true;
+}
+
+static double compute_robust_cost(
+	const TrackerPoseCalibrationCamera *initial_cameras,
+	const TrackerPoseCalibrationCamera *cameras,
+	const std::vector<Eigen::Vector3d> &positions,
+	const std::vector<TrackerPoseCalibrationObservation> &observations,
+	double *out_rms_error_px)
+{
+	double cost = 0.0;
+	double squared_error_sum = 0.0;
+	int projected_count = 0;
+
+	for (const TrackerPoseCalibrationObservation &observation : observations)
+	{
+		Eigen::Vector2d screen_location;
+		Eigen::Vector3d tracker_position;
+		if (!project_sample_position(
+				cameras[observation.tracker_id], positions[observation.sample_index], screen_location, tracker_position))
+		{
+			continue;
+		}
+
+		const double squared_error =
+			(screen_location - Eigen::Vector2d(observation.screen_x, observation.screen_y)).squaredNorm();
+		const double error = sqrt(squared_error);
+
+		// Huber loss
+		cost += (error > k_huber_threshold_px)
+			? 2.0*k_huber_threshold_px*error - k_huber_threshold_px*k_huber_threshold_px
+			: squared_error;
+		squared_error_sum += squared_error;
+		++projected_count;
+	}
+
+	// Priors towards the calibration the samples were taken with
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		const TrackerPoseCalibrationCamera &camera = cameras[tracker_id];
+		const TrackerPoseCalibrationCamera &initial_camera = initial_cameras[tracker_id];
+		if (!camera.bIsOptimized)
+		{
+			continue;
+		}
+
+		const double rotation_error = initial_camera.orientation.angularDistance(camera.orientation) / k_prior_rotation_sigma_radians;
+		const double position_error = (camera.position - initial_camera.position).norm() / k_prior_position_sigma_cm;
+		const double focal_scale_error = (camera.focal_scale - 1.0) / k_prior_focal_scale_sigma;
+
+		cost += rotation_error*rotation_error + position_error*position_error + focal_scale_error*focal_scale_error;
+	}
+
+	if (out_rms_error_px != nullptr)
+	{
+		*out_rms_error_px = (projected_count > 0) ? sqrt(squared_error_sum / projected_count) : 0.0;
+	}
+
+	return cost;
+}
+
+static Eigen::Matrix3d skew_symmetric(const Eigen::Vector3d &v)
+{
+	Eigen::Matrix3d result;
+	result << 0.0, -v.z(), v.y(),
+		v.z(), 0.0, -v.x(),
+		-v.y(), v.x(), 0.0;
+
+	return result;
+}
+
+static bool is_canceled(const std::atomic_bool *exit_signaled)
+{
+	return exit_signaled != nullptr && exit_signaled->load();
+}
@@ -0,0 +1,66 @@
+#ifndef TRACKER_POSE_SOLVER_H
+#define TRACKER_POSE_SOLVER_H
+
+//-- includes -----
+#include "SharedConstants.h"
+
+#include <atomic>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+//-- constants -----
+static const int k_tracker_pose_calibration_max_trackers = PSMOVESERVICE_MAX_TRACKER_COUNT;
+
+//-- definitions -----
+/// A controller sphere center seen by one tracker, in undistorted pixels
+struct TrackerPoseCalibrationObservation
+{
+	int sample_index;
+	int tracker_id;
+	double screen_x;
+	double screen_y;
+};
+
+/// Pose and pinhole intrinsics of one tracker as seen by the solver
+struct TrackerPoseCalibrationCamera
+{
+	bool bIsOptimized;
+	Eigen::Quaterniond orientation; // tracker -> world rotation
+	Eigen::Vector3d position; // world space, cm
+	double focal_length_x; // pixels
+	double focal_length_y; // pixels, negated since screen space has +Y down
+	double principal_x;
+	double principal_y;
+	double focal_scale; // Only solved for when optimizing intrinsics
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/// Outcome of a tracker_pose_solver_solve() run
+struct TrackerPoseSolverResult
+{
+	int iteration_count;
+	float initial_rms_error_px;
+	float final_rms_error_px;
+	bool bCanceled;
+};
+
+//-- interface -----
+/// Sparse Levenberg-Marquardt bundle adjustment behind TrackerPoseCalibrator.
+/// Jointly refines every sample position and the pose (and optionally the focal length scale)
+/// of every camera with bIsOptimized set, starting from the given sample positions and cameras.
+/// Both camera arrays have k_tracker_pose_calibration_max_trackers entries.
+/// Stops early, returning false, once *exit_signaled is set (if given).
+/// Returns true if the rms reprojection error didn't get worse.
+bool tracker_pose_solver_solve(
+	const std::vector<Eigen::Vector3d> &sample_positions,
+	const std::vector<TrackerPoseCalibrationObservation> &observations,
+	const TrackerPoseCalibrationCamera *initial_cameras,
+	const bool bOptimizeIntrinsics,
+	const std::atomic_bool *exit_signaled,
+	TrackerPoseCalibrationCamera *out_solved_cameras,
+	TrackerPoseSolverResult &out_result);
+
+#endif // TRACKER_POSE_SOLVER_H
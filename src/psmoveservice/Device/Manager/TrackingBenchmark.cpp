@@ -0,0 +1,632 @@
+//-- includes -----
+#include "TrackingBenchmark.h"
+#include "ControllerManager.h"
+#include "DeviceManager.h"
+#include "MathEigen.h"
+#include "MathUtility.h"
+#include "PS3EyeTracker.h"
+#include "ServerControllerView.h"
+#include "ServerLog.h"
+#include "ServerTrackerView.h"
+#include "TrackerManager.h"
+#include "TrackingStageProfiler.h"
+#include "VirtualControllerEnumerator.h"
+#include "VirtualTrackerEnumerator.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include <opencv2/imgproc.hpp>
+
+//-- constants -----
+// Trackers sit on a ring around the play space origin looking at its center
+static const float k_rig_radius_cm = 150.f;
+static const float k_rig_height_cm = 50.f;
+
+// Controllers follow a figure eight loop around the origin, one lap every few seconds
+static const float k_path_radius_cm = 25.f;
+static const float k_path_height_cm = 15.f;
+static const float k_path_period_seconds = 4.f;
+
+// Default scene rate used to advance the paths when the benchmark runs unpaced
+static const float k_default_scene_frame_rate = 60.f;
+
+// Time allowed for the virtual devices to show up and for the filters to lock on
+static const float k_device_timeout_seconds = 10.f;
+static const float k_settle_seconds = 1.f;
+
+static const int k_sphere_outline_point_count = 32;
+static const float k_default_bulb_radius_cm = 2.25f;
+
+//-- private methods -----
+static CommonDevicePose computeRigTrackerPose(int tracker_index, int tracker_count);
+static cv::Scalar computeBlobColor(const CommonHSVColorRange &preset);
+
+//-- public implementation -----
+TrackingBenchmark::TrackingBenchmark(const TrackingBenchmarkSettings &settings)
+	: m_settings(settings)
+	, m_state(_BenchmarkState_WaitingForDevices)
+	, m_frameIndex(0)
+	, m_settleFramesLeft(0)
+	, m_updateDurationsNs()
+	, m_segmentedPixelCounts()
+	, m_lastSegmentedPixelTotal(0)
+	, m_outputFile(nullptr)
+{
+}
+
+TrackingBenchmark::~TrackingBenchmark()
+{
+	if (m_outputFile != nullptr)
+	{
+		fclose(m_outputFile);
+		m_outputFile = nullptr;
+	}
+}
+
+bool TrackingBenchmark::startup()
+{
+	if (m_settings.frame_count <= 0 ||
+		m_settings.tracker_count < 1 || m_settings.tracker_count > TRACKING_BENCHMARK_MAX_TRACKERS ||
+		m_settings.controller_count < 1 || m_settings.controller_count > TRACKING_BENCHMARK_MAX_CONTROLLERS)
+	{
+		SERVER_LOG_ERROR("TrackingBenchmark::startup") << "Invalid benchmark settings: "
+			<< m_settings.frame_count << " frames, "
+			<< m_settings.tracker_count << " trackers (max " << TRACKING_BENCHMARK_MAX_TRACKERS << "), "
+			<< m_settings.controller_count << " controllers (max " << TRACKING_BENCHMARK_MAX_CONTROLLERS << ")";
+		m_state = _BenchmarkState_Failed;
+		return false;
+	}
+
+	if (m_settings.output_filename.length() > 0)
+	{
+		m_outputFile = fopen(m_settings.output_filename.c_str(), "wt");
+		if (m_outputFile == nullptr)
+		{
+			SERVER_LOG_ERROR("TrackingBenchmark::startup") << "Failed to open " << m_settings.output_filename << " for writing";
+			m_state = _BenchmarkState_Failed;
+			return false;
+		}
+
+		fprintf(m_outputFile, "FRAME, SCENE_TIME, UPDATE_US, CONTROLLER_ID, TRACKED, TRUE_X_CM, TRUE_Y_CM, TRUE_Z_CM, POS_X_CM, POS_Y_CM, POS_Z_CM, ERROR_CM, SEGMENTED_PIXELS\n");
+	}
+
+	// Make sure enough virtual devices get enumerated on the first device manager update.
+	// This only overrides the in-memory counts, the manager configs on disk are left alone.
+	VirtualTrackerEnumerator::virtual_tracker_count =
+		std::max(VirtualTrackerEnumerator::virtual_tracker_count, m_settings.tracker_count);
+	VirtualControllerEnumerator::virtual_controller_count =
+		std::max(VirtualControllerEnumerator::virtual_controller_count, m_settings.controller_count);
+
+	// Virtual trackers opened from now on render the benchmark scene instead of their video stream
+	PSEyeVideoCapture::setVirtualFrameSource(this);
+
+	m_startupTime = std::chrono::high_resolution_clock::now();
+	m_state = _BenchmarkState_WaitingForDevices;
+
+	SERVER_LOG_INFO("TrackingBenchmark::startup") << "Starting tracking benchmark: "
+		<< m_settings.frame_count << " frames, "
+		<< m_settings.tracker_count << " virtual trackers, "
+		<< m_settings.controller_count << " virtual controllers, "
+		<< m_settings.frame_rate << " fps";
+
+	return true;
+}
+
+void TrackingBenchmark::shutdown()
+{
+	TrackingStageProfiler::setIsEnabled(false);
+
+	if (m_updateDurationsNs.size() > 0)
+	{
+		report();
+	}
+
+	releaseDevices();
+
+	PSEyeVideoCapture::setVirtualFrameSource(nullptr);
+
+	if (m_outputFile != nullptr)
+	{
+		fclose(m_outputFile);
+		m_outputFile = nullptr;
+	}
+}
+
+void TrackingBenchmark::beginFrame()
+{
+	switch (m_state)
+	{
+	case _BenchmarkState_WaitingForDevices:
+		{
+			if (bindDevices())
+			{
+				const float scene_frame_rate = (m_settings.frame_rate > 0.f) ? m_settings.frame_rate : k_default_scene_frame_rate;
+
+				m_settleFramesLeft = static_cast<int>(ceilf(k_settle_seconds * scene_frame_rate));
+				m_state = _BenchmarkState_Settling;
+			}
+			else
+			{
+				const std::chrono::duration<float> time_waiting = std::chrono::high_resolution_clock::now() - m_startupTime;
+
+				if (time_waiting.count() > k_device_timeout_seconds)
+				{
+					SERVER_LOG_ERROR("TrackingBenchmark::beginFrame") << "Timed out waiting for "
+						<< m_settings.tracker_count << " virtual trackers and "
+						<< m_settings.controller_count << " virtual controllers";
+					m_state = _BenchmarkState_Failed;
+				}
+			}
+		} break;
+	case _BenchmarkState_Settling:
+	case _BenchmarkState_Measuring:
+		++m_frameIndex;
+		break;
+	default:
+		break;
+	}
+}
+
+void TrackingBenchmark::endFrame(const std::chrono::nanoseconds &update_duration)
+{
+	switch (m_state)
+	{
+	case _BenchmarkState_Settling:
+		{
+			--m_settleFramesLeft;
+			if (m_settleFramesLeft <= 0)
+			{
+				// Only profile the frames we report on
+				TrackingStageProfiler::reset();
+				TrackingStageProfiler::setIsEnabled(true);
+				m_lastSegmentedPixelTotal = 0;
+				m_state = _BenchmarkState_Measuring;
+			}
+		} break;
+	case _BenchmarkState_Measuring:
+		{
+			measureFrame(update_duration);
+
+			if (static_cast<int>(m_updateDurationsNs.size()) >= m_settings.frame_count)
+			{
+				TrackingStageProfiler::setIsEnabled(false);
+				m_state = _BenchmarkState_Complete;
+			}
+		} break;
+	default:
+		break;
+	}
+}
+
+bool TrackingBenchmark::renderVirtualTrackerFrame(int camera_index, cv::Mat &bgr_frame)
+{
+	if (m_state != _BenchmarkState_Settling && m_state != _BenchmarkState_Measuring)
+	{
+		return false;
+	}
+
+	std::map<int, int>::const_iterator iter = m_cameraIndexToTrackerIndex.find(camera_index);
+	if (iter == m_cameraIndexToTrackerIndex.end())
+	{
+		return false;
+	}
+
+	const int tracker_index = iter->second;
+	BenchmarkTracker &tracker = m_trackers[tracker_index];
+
+	// Render each scene frame once, the capture holds on to it until every tracker consumed theirs
+	if (tracker.last_rendered_frame == m_frameIndex)
+	{
+		return false;
+	}
+
+	ServerTrackerViewPtr tracker_view = DeviceManager::getInstance()->getTrackerViewPtr(tracker.tracker_id);
+	if (!tracker_view || !tracker_view->getIsOpen())
+	{
+		return false;
+	}
+
+	struct RenderedBlob
+	{
+		float depth;
+		std::vector<cv::Point> outline;
+		cv::Scalar color;
+
+		bool operator < (const RenderedBlob &other) const
+		{ return depth > other.depth; }
+	};
+
+	const float scene_time = getSceneTime();
+	std::vector<RenderedBlob> blobs;
+
+	for (int controller_index = 0; controller_index < static_cast<int>(m_controllers.size()); ++controller_index)
+	{
+		const float radius = m_controllers[controller_index].radius_cm;
+		const CommonDevicePosition world_center = computeGroundTruthPosition(controller_index, scene_time);
+		const CommonDevicePosition tracker_center = tracker_view->computeTrackerPosition(&world_center);
+		const Eigen::Vector3f center(tracker_center.x, tracker_center.y, tracker_center.z);
+		const float distance = center.norm();
+
+		// Skip spheres behind (or around) the camera
+		if (tracker_center.z <= radius || distance <= radius)
+		{
+			continue;
+		}
+
+		// The silhouette of a sphere is bounded by the circle where the view rays graze its surface
+		const float radius_ratio_sq = (radius * radius) / (distance * distance);
+		const Eigen::Vector3f outline_center = center * (1.f - radius_ratio_sq);
+		const float outline_radius = radius * sqrtf(1.f - radius_ratio_sq);
+
+		const Eigen::Vector3f view_dir = center / distance;
+		const Eigen::Vector3f helper = (fabsf(view_dir.y()) < 0.9f) ? Eigen::Vector3f::UnitY() : Eigen::Vector3f::UnitX();
+		const Eigen::Vector3f u = view_dir.cross(helper).normalized();
+		const Eigen::Vector3f v = view_dir.cross(u);
+
+		std::vector<CommonDevicePosition> outline_points(k_sphere_outline_point_count);
+		for (int point_index = 0; point_index < k_sphere_outline_point_count; ++point_index)
+		{
+			const float angle = k_real_two_pi * static_cast<float>(point_index) / static_cast<float>(k_sphere_outline_point_count);
+			const Eigen::Vector3f point = outline_center + outline_radius * (cosf(angle) * u + sinf(angle) * v);
+
+			outline_points[point_index].set(point.x(), point.y(), point.z());
+		}
+
+		const std::vector<CommonDeviceScreenLocation> screen_points = tracker_view->projectTrackerRelativePositions(outline_points);
+
+		RenderedBlob blob;
+		blob.depth = distance;
+		blob.color = m_blobColors[tracker_index][controller_index];
+		blob.outline.reserve(screen_points.size());
+		for (const CommonDeviceScreenLocation &screen_point : screen_points)
+		{
+			blob.outline.push_back(cv::Point(cvRound(screen_point.x), cvRound(screen_point.y)));
+		}
+
+		blobs.push_back(blob);
+	}
+
+	// Paint far to near so closer controllers occlude the ones behind them
+	std::sort(blobs.begin(), blobs.end());
+
+	bgr_frame.setTo(cv::Scalar(0, 0, 0));
+	for (const RenderedBlob &blob : blobs)
+	{
+		cv::fillConvexPoly(bgr_frame, blob.outline, blob.color, cv::LINE_AA);
+	}
+
+	tracker.last_rendered_frame = m_frameIndex;
+
+	return true;
+}
+
+//-- protected implementation -----
+bool TrackingBenchmark::bindDevices()
+{
+	DeviceManager *device_manager = DeviceManager::getInstance();
+
+	std::vector<ServerTrackerViewPtr> tracker_views;
+	for (int tracker_id = 0;
+		tracker_id < device_manager->m_tracker_manager->getMaxDevices() &&
+		static_cast<int>(tracker_views.size()) < m_settings.tracker_count;
+		++tracker_id)
+	{
+		ServerTrackerViewPtr tracker_view = device_manager->getTrackerViewPtr(tracker_id);
+
+		if (tracker_view && tracker_view->getIsOpen() &&
+			tracker_view->getDevice()->getDeviceType() == CommonDeviceState::VirtualTracker)
+		{
+			tracker_views.push_back(tracker_view);
+		}
+	}
+
+	std::vector<ServerControllerViewPtr> controller_views;
+	for (int controller_id = 0;
+		controller_id < device_manager->m_controller_manager->getMaxDevices() &&
+		static_cast<int>(controller_views.size()) < m_settings.controller_count;
+		++controller_id)
+	{
+		ServerControllerViewPtr controller_view = device_manager->getControllerViewPtr(controller_id);
+
+		if (controller_view && controller_view->getIsOpen() && controller_view->getIsVirtualController())
+		{
+			controller_views.push_back(controller_view);
+		}
+	}
+
+	if (static_cast<int>(tracker_views.size()) < m_settings.tracker_count ||
+		static_cast<int>(controller_views.size()) < m_settings.controller_count)
+	{
+		return false;
+	}
+
+	// Arrange the trackers in a ring. The rig poses and colors are never written to the configs,
+	// so a benchmark that doesn't get to shut down leaves the saved calibration alone.
+	for (int tracker_index = 0; tracker_index < m_settings.tracker_count; ++tracker_index)
+	{
+		ServerTrackerViewPtr tracker_view = tracker_views[tracker_index];
+		const CommonDevicePose rig_pose = computeRigTrackerPose(tracker_index, m_settings.tracker_count);
+
+		BenchmarkTracker tracker;
+		tracker.tracker_id = tracker_view->getDeviceID();
+		tracker.camera_index = static_cast<PS3EyeTracker *>(tracker_view->getDevice())->getCameraIndex();
+		tracker.last_rendered_frame = -1;
+
+		tracker_view->setTrackerPose(&rig_pose, false);
+
+		m_cameraIndexToTrackerIndex[tracker.camera_index] = tracker_index;
+		m_trackers.push_back(tracker);
+	}
+
+	// Give every controller its own builtin tracking color
+	for (int controller_index = 0; controller_index < m_settings.controller_count; ++controller_index)
+	{
+		ServerControllerViewPtr controller_view = controller_views[controller_index];
+
+		BenchmarkController controller;
+		controller.controller_id = controller_view->getDeviceID();
+		controller.radius_cm = k_default_bulb_radius_cm;
+		controller.tracked_frame_count = 0;
+		controller.error_sum_cm = 0.0;
+		controller.error_sq_sum_cm = 0.0;
+		controller.error_max_cm = 0.0;
+
+		CommonDeviceTrackingShape tracking_shape;
+		if (controller_view->getTrackingShape(tracking_shape) &&
+			tracking_shape.shape_type == eCommonTrackingShapeType::Sphere)
+		{
+			controller.radius_cm = tracking_shape.shape.sphere.radius_cm;
+		}
+		else
+		{
+			SERVER_LOG_WARNING("TrackingBenchmark::bindDevices") << "Controller " << controller.controller_id
+				<< " isn't tracked as a sphere, rendering it as a " << k_default_bulb_radius_cm << "cm bulb";
+		}
+
+		controller_view->setTrackingColorID(
+			static_cast<eCommonTrackingColorID>(eCommonTrackingColorID::Magenta + controller_index), false);
+		controller_view->startTracking();
+
+		m_controllers.push_back(controller);
+	}
+
+	// Paint each blob with the center of the color preset the tracker segments it with
+	m_blobColors.resize(m_trackers.size());
+	for (int tracker_index = 0; tracker_index < static_cast<int>(m_trackers.size()); ++tracker_index)
+	{
+		for (int controller_index = 0; controller_index < static_cast<int>(m_controllers.size()); ++controller_index)
+		{
+			CommonHSVColorRange preset;
+
+			tracker_views[tracker_index]->getControllerTrackingColorPreset(
+				controller_views[controller_index].get(),
+				controller_views[controller_index]->getTrackingColorID(),
+				&preset);
+			m_blobColors[tracker_index].push_back(computeBlobColor(preset));
+		}
+	}
+
+	SERVER_LOG_INFO("TrackingBenchmark::bindDevices") << "Bound "
+		<< m_trackers.size() << " virtual trackers and "
+		<< m_controllers.size() << " virtual controllers";
+
+	return true;
+}
+
+void TrackingBenchmark::releaseDevices()
+{
+	DeviceManager *device_manager = DeviceManager::getInstance();
+
+	for (const BenchmarkController &controller : m_controllers)
+	{
+		ServerControllerViewPtr controller_view = device_manager->getControllerViewPtr(controller.controller_id);
+
+		if (controller_view && controller_view->getIsOpen())
+		{
+			controller_view->stopTracking();
+		}
+	}
+
+	m_trackers.clear();
+	m_controllers.clear();
+	m_cameraIndexToTrackerIndex.clear();
+	m_blobColors.clear();
+}
+
+void TrackingBenchmark::measureFrame(const std::chrono::nanoseconds &update_duration)
+{
+	DeviceManager *device_manager = DeviceManager::getInstance();
+	const float scene_time = getSceneTime();
+
+	m_updateDurationsNs.push_back(update_duration.count());
+
+	const int64_t segmented_pixel_total = TrackingStageProfiler::getSegmentedPixelCount();
+	const int64_t segmented_pixel_count = segmented_pixel_total - m_lastSegmentedPixelTotal;
+	m_segmentedPixelCounts.push_back(segmented_pixel_count);
+	m_lastSegmentedPixelTotal = segmented_pixel_total;
+
+	for (int controller_index = 0; controller_index < static_cast<int>(m_controllers.size()); ++controller_index)
+	{
+		BenchmarkController &controller = m_controllers[controller_index];
+		ServerControllerViewPtr controller_view = device_manager->getControllerViewPtr(controller.controller_id);
+
+		// The error includes the latency of the pipeline since the frames
+		// processed this update were rendered at most an update earlier
+		const CommonDevicePosition true_position = computeGroundTruthPosition(controller_index, scene_time);
+		const bool bIsTracked = controller_view && controller_view->getIsCurrentlyTracking();
+
+		CommonDevicePosition position;
+		double error_cm = 0.0;
+
+		position.clear();
+		if (bIsTracked)
+		{
+			position = controller_view->getFilteredPose().PositionCm;
+
+			const double dx = position.x - true_position.x;
+			const double dy = position.y - true_position.y;
+			const double dz = position.z - true_position.z;
+			error_cm = sqrt(dx*dx + dy*dy + dz*dz);
+
+			++controller.tracked_frame_count;
+			controller.error_sum_cm += error_cm;
+			controller.error_sq_sum_cm += error_cm*error_cm;
+			controller.error_max_cm = std::max(controller.error_max_cm, error_cm);
+		}
+
+		if (m_outputFile != nullptr)
+		{
+			fprintf(m_outputFile, "%d, %f, %f, %d, %d, %f, %f, %f, %f, %f, %f, %f, %lld\n",
+				m_frameIndex,
+				scene_time,
+				static_cast<double>(update_duration.count()) / 1000.0,
+				controller.controller_id,
+				bIsTracked ? 1 : 0,
+				true_position.x, true_position.y, true_position.z,
+				position.x, position.y, position.z,
+				error_cm,
+				static_cast<long long>(segmented_pixel_count));
+		}
+	}
+}
+
+void TrackingBenchmark::report()
+{
+	const int frame_count = static_cast<int>(m_updateDurationsNs.size());
+
+	SERVER_LOG_INFO("TrackingBenchmark") << "Measured " << frame_count << " frames with "
+		<< m_settings.tracker_count << " trackers and " << m_settings.controller_count << " controllers";
+
+	for (int stage_index = 0; stage_index < TrackingStage_COUNT; ++stage_index)
+	{
+		const eTrackingStage stage = static_cast<eTrackingStage>(stage_index);
+		const TrackingStageStats stats = TrackingStageProfiler::getStats(stage);
+
+		if (stats.sample_count > 0)
+		{
+			SERVER_LOG_INFO("TrackingBenchmark") << "  " << TrackingStageProfiler::getStageName(stage) << ": "
+				<< static_cast<double>(stats.total_ns) / (1000000.0 * frame_count) << " ms/frame, "
+				<< static_cast<double>(stats.total_ns) / (1000000.0 * stats.sample_count) << " ms avg, "
+				<< static_cast<double>(stats.max_ns) / 1000000.0 << " ms max ("
+				<< stats.sample_count << " samples)";
+		}
+	}
+
+	if (TrackingStageProfiler::getDroppedSampleCount() > 0)
+	{
+		SERVER_LOG_WARNING("TrackingBenchmark") << "  " << TrackingStageProfiler::getDroppedSampleCount()
+			<< " stage samples dropped since the service started, more than "
+			<< k_tracking_stage_profiler_max_threads << " threads timed stages";
+	}
+
+	std::vector<int64_t> sorted_durations = m_updateDurationsNs;
+	std::sort(sorted_durations.begin(), sorted_durations.end());
+
+	double total_ns = 0.0;
+	for (int64_t duration_ns : sorted_durations)
+	{
+		total_ns += static_cast<double>(duration_ns);
+	}
+
+	const size_t p50_index = (sorted_durations.size() - 1) / 2;
+	const size_t p99_index = ((sorted_durations.size() - 1) * 99) / 100;
+
+	SERVER_LOG_INFO("TrackingBenchmark") << "  update: "
+		<< total_ns / (1000000.0 * frame_count) << " ms avg, "
+		<< static_cast<double>(sorted_durations[p50_index]) / 1000000.0 << " ms p50, "
+		<< static_cast<double>(sorted_durations[p99_index]) / 1000000.0 << " ms p99, "
+		<< static_cast<double>(sorted_durations.back()) / 1000000.0 << " ms max";
+
+	int64_t total_segmented_pixels = 0;
+	int64_t max_segmented_pixels = 0;
+	for (int64_t pixel_count : m_segmentedPixelCounts)
+	{
+		total_segmented_pixels += pixel_count;
+		max_segmented_pixels = std::max(max_segmented_pixels, pixel_count);
+	}
+
+	SERVER_LOG_INFO("TrackingBenchmark") << "  segmented pixels: "
+		<< static_cast<double>(total_segmented_pixels) / frame_count << " avg/frame, "
+		<< max_segmented_pixels << " max/frame";
+
+	for (const BenchmarkController &controller : m_controllers)
+	{
+		if (controller.tracked_frame_count > 0)
+		{
+			SERVER_LOG_INFO("TrackingBenchmark") << "  controller " << controller.controller_id << ": tracked "
+				<< (100.0 * controller.tracked_frame_count) / frame_count << "% of frames, error "
+				<< controller.error_sum_cm / controller.tracked_frame_count << " cm avg, "
+				<< sqrt(controller.error_sq_sum_cm / controller.tracked_frame_count) << " cm rms, "
+				<< controller.error_max_cm << " cm max";
+		}
+		else
+		{
+			SERVER_LOG_WARNING("TrackingBenchmark") << "  controller " << controller.controller_id << ": never tracked";
+		}
+	}
+}
+
+float TrackingBenchmark::getSceneTime() const
+{
+	const float scene_frame_rate = (m_settings.frame_rate > 0.f) ? m_settings.frame_rate : k_default_scene_frame_rate;
+
+	return static_cast<float>(m_frameIndex) / scene_frame_rate;
+}
+
+CommonDevicePosition TrackingBenchmark::computeGroundTruthPosition(int controller_index, float scene_time) const
+{
+	// Controllers share the loop but are spread out evenly in phase so they never collide
+	const float phase = k_real_two_pi * static_cast<float>(controller_index) / static_cast<float>(m_controllers.size());
+	const float angle = k_real_two_pi * scene_time / k_path_period_seconds + phase;
+
+	CommonDevicePosition result;
+	result.set(
+		k_path_radius_cm * cosf(angle),
+		k_path_height_cm * sinf(2.f * angle),
+		k_path_radius_cm * sinf(angle));
+
+	return result;
+}
+
+//-- private methods -----
+static CommonDevicePose computeRigTrackerPose(int tracker_index, int tracker_count)
+{
+	const float angle = k_real_two_pi * static_cast<float>(tracker_index) / static_cast<float>(tracker_count);
+	const Eigen::Vector3f position(k_rig_radius_cm * cosf(angle), k_rig_height_cm, k_rig_radius_cm * sinf(angle));
+
+	// Trackers look down their +Z axis with +Y up
+	const Eigen::Vector3f forward = (-position).normalized();
+	const Eigen::Vector3f right = Eigen::Vector3f::UnitY().cross(forward).normalized();
+	const Eigen::Vector3f up = forward.cross(right);
+
+	Eigen::Matrix3f rotation;
+	rotation.col(0) = right;
+	rotation.col(1) = up;
+	rotation.col(2) = forward;
+
+	const Eigen::Quaternionf orientation(rotation);
+
+	CommonDevicePose pose;
+	pose.PositionCm.set(position.x(), position.y(), position.z());
+	pose.Orientation.w = orientation.w();
+	pose.Orientation.x = orientation.x();
+	pose.Orientation.y = orientation.y();
+	pose.Orientation.z = orientation.z();
+
+	return pose;
+}
+
+static cv::Scalar computeBlobColor(const CommonHSVColorRange &preset)
+{
+	const cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(
+		std::min(std::max(preset.hue_range.center, 0.f), 179.f),
+		std::min(std::max(preset.saturation_range.center, 0.f), 255.f),
+		std::min(std::max(preset.value_range.center, 0.f), 255.f)));
+	cv::Mat bgr;
+
+	cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+
+	const cv::Vec3b color = bgr.at<cv::Vec3b>(0, 0);
+	return cv::Scalar(color[0], color[1], color[2]);
+}
@@ -0,0 +1,120 @@
+#ifndef TRACKING_BENCHMARK_H
+#define TRACKING_BENCHMARK_H
+
+//-- includes -----
+#include "DeviceInterface.h"
+#include "PSEyeVideoCapture.h"
+
+#include <chrono>
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//-- constants -----
+#define TRACKING_BENCHMARK_MAX_TRACKERS		8
+#define TRACKING_BENCHMARK_MAX_CONTROLLERS	6 // One per builtin tracking color
+
+//-- definitions -----
+struct TrackingBenchmarkSettings
+{
+	int frame_count;		// Number of measured frames
+	int tracker_count;		// Virtual trackers arranged in a ring around the play space
+	int controller_count;	// Virtual controllers following the ground truth paths
+	float frame_rate;		// Scene frames per second, <= 0 runs the updates back to back
+	std::string output_filename; // Optional per frame csv
+
+	TrackingBenchmarkSettings()
+		: frame_count(0)
+		, tracker_count(4)
+		, controller_count(2)
+		, frame_rate(60.f)
+		, output_filename()
+	{}
+};
+
+/// Drives the optical tracking pipeline end to end with synthetic data:
+/// renders every virtual tracker frame from known controller paths and
+/// measures the per stage cost and the resulting pose error.
+class TrackingBenchmark : public IVirtualTrackerFrameSource
+{
+public:
+	TrackingBenchmark(const TrackingBenchmarkSettings &settings);
+	virtual ~TrackingBenchmark();
+
+	/// Call after the device manager started but before the first update
+	bool startup();
+	/// Reports the results and stops tracking the benchmark controllers.
+	/// Call before the device manager shuts down.
+	void shutdown();
+
+	/// Advances the scene, call before every service update
+	void beginFrame();
+	/// Records the results of the service update that just ran
+	void endFrame(const std::chrono::nanoseconds &update_duration);
+
+	inline bool getIsComplete() const { return m_state == _BenchmarkState_Complete; }
+	inline bool getHasFailed() const { return m_state == _BenchmarkState_Failed; }
+
+	// -- IVirtualTrackerFrameSource
+	bool renderVirtualTrackerFrame(int camera_index, cv::Mat &bgr_frame) override;
+
+protected:
+	enum eBenchmarkState
+	{
+		_BenchmarkState_WaitingForDevices,
+		_BenchmarkState_Settling,
+		_BenchmarkState_Measuring,
+		_BenchmarkState_Complete,
+		_BenchmarkState_Failed
+	};
+
+	struct BenchmarkTracker
+	{
+		int tracker_id;
+		int camera_index;
+		int last_rendered_frame;
+	};
+
+	struct BenchmarkController
+	{
+		int controller_id;
+		float radius_cm;
+
+		// Pose error statistics over the measured frames
+		int tracked_frame_count;
+		double error_sum_cm;
+		double error_sq_sum_cm;
+		double error_max_cm;
+	};
+
+	bool bindDevices();
+	void releaseDevices();
+	void measureFrame(const std::chrono::nanoseconds &update_duration);
+	void report();
+
+	float getSceneTime() const;
+	CommonDevicePosition computeGroundTruthPosition(int controller_index, float scene_time) const;
+
+	TrackingBenchmarkSettings m_settings;
+	eBenchmarkState m_state;
+
+	std::vector<BenchmarkTracker> m_trackers;
+	std::vector<BenchmarkController> m_controllers;
+	std::map<int, int> m_cameraIndexToTrackerIndex;
+
+	// Rendered color of each controller as seen by each tracker, [tracker][controller]
+	std::vector<std::vector<cv::Scalar>> m_blobColors;
+
+	int m_frameIndex;
+	int m_settleFramesLeft;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_startupTime;
+
+	std::vector<int64_t> m_updateDurationsNs;
+	std::vector<int64_t> m_segmentedPixelCounts; // Pixels segmented by every tracker, per frame
+	int64_t m_lastSegmentedPixelTotal;
+	FILE *m_outputFile;
+};
+
+#endif // TRACKING_BENCHMARK_H
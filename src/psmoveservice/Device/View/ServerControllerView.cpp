@@ -16,8 +16,11 @@
 #include "VirtualController.h"
 #include "PSMoveProtocolInterface.h"
 #include "PSMoveProtocol.pb.h"
+#include "SensorSessionRecorder.h"
 #include "ServerUtility.h"
 #include "ServerTrackerView.h"
+#include "TrackerCameraModel.h"
+#include "TrackingStageProfiler.h"
 
 #include <glm/glm.hpp>
 
@@ -43,15 +46,18 @@ static IPoseFilter *pose_filter_factory(
 static void init_filters_for_psmove(
     const PSMoveController *psmoveController, 
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter);
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc);
 static void init_filters_for_psdualshock4(
     const PSDualShock4Controller *psdualshock4Controller,
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter);
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc);
 static void init_filters_for_virtual_controller(
     const VirtualController *psmoveController, 
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter);
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc);
 
 static void post_imu_filter_packets_for_psmove(
     const PSMoveController *psmove,
@@ -131,6 +137,7 @@ ServerControllerView::ServerControllerView(const int device_id)
     , m_roi_disable_count(0)
     , m_LED_override_active(false)
     , m_device(nullptr)
+    , m_lastReportedIMUPacketLossCount(0)
     , m_tracker_pose_estimations(nullptr)
     , m_multicam_pose_estimation(nullptr)
     , m_pose_filter(nullptr)
@@ -141,10 +148,23 @@ ServerControllerView::ServerControllerView(const int device_id)
 {
     m_tracking_color = std::make_tuple(0x00, 0x00, 0x00);
     m_LED_override_color = std::make_tuple(0x00, 0x00, 0x00);
+    m_pose_filter_desc.clear();
 }
 
 ServerControllerView::~ServerControllerView()
 {
+    // Replay views never open a device, so the filter isn't freed by free_device_interface()
+    if (m_pose_filter != nullptr)
+    {
+        delete m_pose_filter;
+        m_pose_filter = nullptr;
+    }
+
+    if (m_pose_filter_space != nullptr)
+    {
+        delete m_pose_filter_space;
+        m_pose_filter_space = nullptr;
+    }
 }
 
 bool ServerControllerView::allocate_device_interface(
@@ -210,6 +230,18 @@ bool ServerControllerView::allocate_device_interface(
         break;
     }
 
+    // Size the IMU packet queue before the device starts posting to it
+    if (m_device != nullptr && m_device->getDeviceType() != CommonDeviceState::PSNavi)
+    {
+        const ControllerManagerConfig &cfg = DeviceManager::getInstance()->m_controller_manager->getConfig();
+
+        m_PoseSensorIMUPacketQueue.allocate(
+            cfg.imu_queue_capacity,
+            PoseSensorPacketQueue::findOverflowPolicyByName(cfg.imu_queue_overflow_policy, PoseSensorQueueOverflow_DropOldest));
+        m_timeSortedPackets.reserve(m_PoseSensorIMUPacketQueue.getCapacity() + 1); // + the optical packet
+        m_lastReportedIMUPacketLossCount = 0;
+    }
+
     return m_device != nullptr;
 }
 
@@ -326,7 +358,7 @@ bool ServerControllerView::open(const class DeviceEnumerator *enumerator)
             eCommonTrackingColorID allocatedColorID= DeviceManager::getInstance()->m_tracker_manager->allocateTrackingColorID();
 
             // Attempt to assign the tracking color id to the controller
-            if (!m_device->setTrackingColorID(allocatedColorID))
+            if (!m_device->setTrackingColorID(allocatedColorID, true))
             {
                 // If the device can't be assigned a tracking color, release the color back to the pool
                 DeviceManager::getInstance()->m_tracker_manager->freeTrackingColorID(allocatedColorID);
@@ -420,25 +452,27 @@ void ServerControllerView::resetPoseFilter()
         m_pose_filter_space = nullptr;
     }
 
+    m_pose_filter_desc.clear();
+
     switch (m_device->getDeviceType())
     {
     case CommonDeviceState::PSMove:
         {
             init_filters_for_psmove(
                 static_cast<PSMoveController *>(m_device),
-                &m_pose_filter_space, &m_pose_filter);
+                &m_pose_filter_space, &m_pose_filter, &m_pose_filter_desc);
         } break;
     case CommonDeviceState::PSDualShock4:
         {
             init_filters_for_psdualshock4(
                 static_cast<PSDualShock4Controller *>(m_device),
-                &m_pose_filter_space, &m_pose_filter);
+                &m_pose_filter_space, &m_pose_filter, &m_pose_filter_desc);
         } break;
     case CommonDeviceState::VirtualController:
         {
             init_filters_for_virtual_controller(
                 static_cast<VirtualController *>(m_device),
-                &m_pose_filter_space, &m_pose_filter);
+                &m_pose_filter_space, &m_pose_filter, &m_pose_filter_desc);
         } break;
 	case CommonDeviceState::PSNavi:
 		// No pose filter
@@ -446,12 +480,53 @@ void ServerControllerView::resetPoseFilter()
     default:
         assert(false && "unreachable");
     }
+
+    // Let an in-progress sensor session know how to rebuild this filter
+    SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+    if (recorder != nullptr && m_pose_filter != nullptr)
+    {
+        recorder->recordFilterDesc(SensorSessionDevice_Controller, getDeviceID(), m_pose_filter_desc);
+    }
+}
+
+bool ServerControllerView::openForReplay(const SensorSessionFilterDesc &filter_desc)
+{
+    if (m_device != nullptr || m_pose_filter != nullptr)
+    {
+        // Replay views only ever get their filter from a sensor session log
+        return false;
+    }
+
+    m_pose_filter_desc = filter_desc;
+
+    m_pose_filter_space = new PoseFilterSpace();
+    filter_desc.applyToSpace(m_pose_filter_space);
+
+    m_pose_filter = pose_filter_factory(
+        static_cast<CommonDeviceState::eDeviceType>(filter_desc.device_type),
+        filter_desc.position_filter_type,
+        filter_desc.orientation_filter_type,
+        filter_desc.constants);
+
+    return m_pose_filter != nullptr;
+}
+
+void ServerControllerView::replayPoseSensorPacket(
+    const PoseSensorPacket &sensorPacket,
+    const float time_delta_seconds,
+    const bool bIsSynced)
+{
+    if (m_pose_filter != nullptr)
+    {
+        update_pose_filter(sensorPacket, time_delta_seconds, bIsSynced);
+        markStateAsUnpublished();
+    }
 }
 
 void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
 {
     const std::chrono::time_point<std::chrono::high_resolution_clock> now= std::chrono::high_resolution_clock::now();
-	const TrackerManagerConfig &trackerMgrConfig = DeviceManager::getInstance()->m_tracker_manager->getConfig();
+	const TrackerManagerTunables &trackerMgrConfig = *DeviceManager::getInstance()->m_tracker_manager->getTunables();
 
     // TODO: Probably need to first update IMU state to get velocity.
     // If velocity is too high, don't bother getting a new position.
@@ -536,9 +611,9 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
                     // Initially the newTrackerPoseEstimate is a copy of the existing pose
                     bool bIsVisibleThisUpdate= false;
 
-					// If a new video frame is available this tick, 
+					// If this tracker's frame made it into this tick's frame group, 
 					// attempt to update the tracking location
-					if (tracker->getHasUnpublishedState())
+					if (TrackerManager::isTrackerInFrameGroup(tracker_id))
 					{
 						// Create a copy of the pose estimate state so that in event of a 
 						// failure part way through computing the projection we don't
@@ -552,6 +627,14 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
 						{
 							bIsVisibleThisUpdate= true;
 
+							SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+							if (recorder != nullptr)
+							{
+								recorder->recordTrackerProjection(
+									SensorSessionDevice_Controller, this->getDeviceID(), tracker_id,
+									newTrackerPoseEstimate.projection, true);
+							}
+
 							// Actually apply the pose estimate state
 							trackerPoseEstimateRef= newTrackerPoseEstimate;
 							trackerPoseEstimateRef.last_visible_timestamp = now;
@@ -616,7 +699,7 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
 
 						// If the projection isn't too old (or updated this tick), 
 						// say we have a valid tracked location
-						if ((bWasTracking && !tracker->getHasUnpublishedState()) || bIsVisibleThisUpdate)
+						if ((bWasTracking && !TrackerManager::isTrackerInFrameGroup(tracker_id)) || bIsVisibleThisUpdate)
 						{
 							// If this tracker has a valid projection for the controller
 							// add it to the tracker id list
@@ -646,6 +729,8 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
         // * The kind of projection shape (psmove sphere or ds4 lightbar)
         if (projections_found > 1)
         {
+            TrackingStageScope triangulation_scope(TrackingStage_Triangulation);
+
             // If multiple trackers can see the controller, 
             // triangulate all pairs of projections and average the results
             switch (trackingShape.shape_type)
@@ -674,6 +759,8 @@ void ServerControllerView::updateOpticalPoseEstimation(TrackerManager* tracker_m
         }
         else if (projections_found == 1 && (available_trackers == 1 || !trackerMgrConfig.ignore_pose_from_one_tracker))
         {
+            TrackingStageScope triangulation_scope(TrackingStage_Triangulation);
+
             const int tracker_id = valid_projection_tracker_ids[0];
             const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
 
@@ -771,6 +858,7 @@ ServerControllerView::notifySensorDataReceived(const CommonDeviceState *sensor_s
 	}
 	m_lastSensorDataTimestamp= now;
 	m_bIsLastSensorDataTimestampValid= true;
+	m_imuPacketCounter.add();
 
 	// Apply device specific filtering
     switch (sensor_state->DeviceType)
@@ -821,14 +909,11 @@ ServerControllerView::notifySensorDataReceived(const CommonDeviceState *sensor_s
 
 void ServerControllerView::updateStateAndPredict()
 {
-	std::vector<PoseSensorPacket> timeSortedPackets;
+	std::vector<PoseSensorPacket> &timeSortedPackets= m_timeSortedPackets;
+	timeSortedPackets.clear();
 
 	// Drain the packet queues filled by the threads
-	PoseSensorPacket packet;
-	while (m_PoseSensorIMUPacketQueue.try_dequeue(packet))
-	{
-		timeSortedPackets.push_back(packet);
-	}
+	m_PoseSensorIMUPacketQueue.drain(std::chrono::high_resolution_clock::now(), timeSortedPackets);
 
 	//TODO: m_PoseSensorOpticalPacketQueue is currently getting filled on the main thread by
 	// updateOpticalPoseEstimation() when triangulating the optical pose estimates.
@@ -849,22 +934,22 @@ void ServerControllerView::updateStateAndPredict()
 			{
 				return a.timestamp < b.timestamp; 
 			});
+	}
 
-		t_high_resolution_duration duration= 
-			timeSortedPackets[timeSortedPackets.size()-1].timestamp - timeSortedPackets[0].timestamp;
-		std::chrono::duration<float, std::milli> milli_duration= duration;
+	// The IMU packet queue is bounded, so a stalled main loop costs packets rather than memory.
+	// Let the log know when that happens, the stats request has the full counts.
+	{
+		PoseSensorPacketQueueStats queueStats;
+		m_PoseSensorIMUPacketQueue.getStats(queueStats);
 
-		const size_t k_max_process_count= 100;
-		if (timeSortedPackets.size() > k_max_process_count)
+		const int lossCount= queueStats.dropped_count + queueStats.merged_count;
+		if (lossCount != m_lastReportedIMUPacketLossCount)
 		{
-			const size_t excess= timeSortedPackets.size() - k_max_process_count;
-
-			SERVER_LOG_WARNING("updatePoseFilter()") << "Incoming packet count: " << timeSortedPackets.size() << " (" << milli_duration.count() << "ms)" << ", trimming: " << excess;
-			timeSortedPackets.erase(timeSortedPackets.begin(), timeSortedPackets.begin()+excess);
-		}
-		else
-		{
-			//SERVER_LOG_DEBUG("updatePoseFilter()") << "Incoming packet count: " << timeSortedPackets.size() << " (" << milli_duration.count() << "ms)";
+			SERVER_LOG_WARNING("updatePoseFilter()") << "IMU packet queue overflowed (" 
+				<< PoseSensorPacketQueue::getOverflowPolicyName(queueStats.overflow_policy) << "): "
+				<< (lossCount - m_lastReportedIMUPacketLossCount) << " packets dropped or merged, "
+				<< queueStats.last_lag_ms << "ms behind";
+			m_lastReportedIMUPacketLossCount= lossCount;
 		}
 	}
 
@@ -889,30 +974,46 @@ void ServerControllerView::updateStateAndPredict()
 		m_last_filter_update_timestamp = sensorPacket.timestamp;
 		m_last_filter_update_timestamp_valid = true;
 
-		{
-			PoseFilterPacket filter_packet;
-			filter_packet.clear();
-
-			// Ship device id with the packet. We ned it for "OrientationExternal" filter.
-			filter_packet.controllerDeviceId = this->getDeviceID();
-			filter_packet.isSynced = TrackerManager::trackersSynced();
-
-			// Create a filter input packet from the sensor data 
-			// and the filter's previous orientation and position
-			m_pose_filter_space->createFilterPacket(
-				sensorPacket,
-				m_pose_filter,
-				filter_packet);
-
-			// Process the filter packet
-			m_pose_filter->update(time_delta_seconds, filter_packet);
-		}
+		update_pose_filter(sensorPacket, time_delta_seconds, TrackerManager::trackersSynced());
 		
 		// Flag the state as unpublished, which will trigger an update to the client
 		markStateAsUnpublished();
 	}
 }
 
+void ServerControllerView::update_pose_filter(
+	const PoseSensorPacket &sensorPacket,
+	const float time_delta_seconds,
+	const bool bIsSynced)
+{
+	TrackingStageScope filtering_scope(TrackingStage_Filtering);
+
+	// Capture the exact filter input if a sensor session is being recorded
+	SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+	if (recorder != nullptr)
+	{
+		recorder->recordPoseSensorPacket(
+			SensorSessionDevice_Controller, this->getDeviceID(), sensorPacket, time_delta_seconds, bIsSynced);
+	}
+
+	PoseFilterPacket filter_packet;
+	filter_packet.clear();
+
+	// Ship device id with the packet. We ned it for "OrientationExternal" filter.
+	filter_packet.controllerDeviceId = this->getDeviceID();
+	filter_packet.isSynced = bIsSynced;
+
+	// Create a filter input packet from the sensor data 
+	// and the filter's previous orientation and position
+	m_pose_filter_space->createFilterPacket(
+		sensorPacket,
+		m_pose_filter,
+		filter_packet);
+
+	// Process the filter packet
+	m_pose_filter->update(time_delta_seconds, filter_packet);
+}
+
 bool ServerControllerView::setHostBluetoothAddress(
     const std::string &address)
 {
@@ -1133,7 +1234,7 @@ eCommonTrackingColorID ServerControllerView::getTrackingColorID() const
     return tracking_color_id;
 }
 
-bool ServerControllerView::setTrackingColorID(eCommonTrackingColorID colorID)
+bool ServerControllerView::setTrackingColorID(eCommonTrackingColorID colorID, bool bUpdateConfig)
 {
     bool bSuccess= true;
 
@@ -1141,7 +1242,7 @@ bool ServerControllerView::setTrackingColorID(eCommonTrackingColorID colorID)
     {
         if (m_device != nullptr)
         {
-            bSuccess= m_device->setTrackingColorID(colorID);
+            bSuccess= m_device->setTrackingColorID(colorID, bUpdateConfig);
 
             if (bSuccess && getIsTrackingEnabled())
             {
@@ -2340,7 +2441,8 @@ static void
 init_filters_for_psmove(
     const PSMoveController *psmoveController, 
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter)
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc)
 {
     const PSMoveControllerConfig *psmove_config = psmoveController->getConfig();
 
@@ -2396,13 +2498,20 @@ init_filters_for_psmove(
         psmove_config->position_filter_type,
         psmove_config->orientation_filter_type,
         constants);
+    out_pose_filter_desc->set(
+        CommonDeviceState::eDeviceType::PSMove,
+        psmove_config->position_filter_type,
+        psmove_config->orientation_filter_type,
+        pose_filter_space,
+        constants);
     }
 
 static void
 init_filters_for_psdualshock4(
     const PSDualShock4Controller *ds4Controller,
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter)
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc)
 {
     const PSDualShock4ControllerConfig *ds4_config = ds4Controller->getConfig();
 
@@ -2459,12 +2568,19 @@ init_filters_for_psdualshock4(
         ds4_config->position_filter_type,
         ds4_config->orientation_filter_type,
         constants);
+    out_pose_filter_desc->set(
+        CommonDeviceState::eDeviceType::PSDualShock4,
+        ds4_config->position_filter_type,
+        ds4_config->orientation_filter_type,
+        pose_filter_space,
+        constants);
 }
 
 static void init_filters_for_virtual_controller(
     const VirtualController *virtualController,
     PoseFilterSpace **out_pose_filter_space,
-    IPoseFilter **out_pose_filter)
+    IPoseFilter **out_pose_filter,
+    SensorSessionFilterDesc *out_pose_filter_desc)
 {
     const VirtualControllerConfig *controller_config = virtualController->getConfig();
 
@@ -2511,6 +2627,12 @@ static void init_filters_for_virtual_controller(
 		controller_config->position_filter_type,
 		"OrientationExternal",
 		constants);
+	out_pose_filter_desc->set(
+		CommonDeviceState::eDeviceType::VirtualController,
+		controller_config->position_filter_type,
+		"OrientationExternal",
+		pose_filter_space,
+		constants);
 }
 
 static void post_imu_filter_packets_for_psmove(
@@ -2849,7 +2971,7 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
 		}
 	}
 	
-	const TrackerManagerConfig &cfg = tracker_manager->getConfig();
+	const TrackerManagerTunables &cfg = *tracker_manager->getTunables();
     float screen_area_sum = 0;
 	
 	struct projectionInfo
@@ -2857,6 +2979,7 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
 		int index;
 		int tracker_id;
 		CommonDeviceScreenLocation position2d_list;
+		CommonDevicePosition world_position;
 		float screen_area;
 	};
 	std::vector<projectionInfo> sorted_projections;
@@ -2873,6 +2996,7 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
 		info.index = list_index;
 		info.tracker_id = tracker_id;
 		info.position2d_list = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+		info.world_position = tracker->computeWorldPosition(&poseEstimate.position_cm);
 		info.screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
 		sorted_projections.push_back(info);
 
@@ -2889,89 +3013,94 @@ static void computeSpherePoseForControllerFromMultipleTrackers(
 		return a.screen_area > b.screen_area;
 	});
 
-	// Compute triangulations amongst all pairs of projections
+	// Only triangulate the pairs of trackers expected to give the best results
+	const ServerTrackerView *pair_trackers[TrackerManager::k_max_devices];
+	CommonDevicePosition pair_world_estimates[TrackerManager::k_max_devices];
+	for (int list_index = 0; list_index < projections_found; ++list_index)
+	{
+		pair_trackers[list_index] = tracker_manager->getTrackerViewPtr(sorted_projections[list_index].tracker_id).get();
+		pair_world_estimates[list_index] = sorted_projections[list_index].world_position;
+	}
+
+	TrackerTriangulationPair triangulation_pairs[ServerTrackerView::k_max_triangulation_pairs];
+	const int triangulation_pair_count =
+		ServerTrackerView::selectTriangulationPairs(
+			pair_trackers, pair_world_estimates, projections_found,
+			cfg.max_triangulation_pairs, cfg.exclude_opposed_cameras,
+			triangulation_pairs);
+
+	int tracker_pair_counts[TrackerManager::k_max_devices] = { 0 };
+	int tracker_bad_deviations[TrackerManager::k_max_devices] = { 0 };
+
+	// Compute triangulations amongst the selected pairs of projections, best pair first
 	int pair_count = 0;
 
     CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
-    for (int list_index = 0; list_index < projections_found; ++list_index)
+    for (int pair_index = 0; pair_index < triangulation_pair_count; ++pair_index)
     {
-		int bad_deviations = 0;
-
-		const int tracker_id = sorted_projections[list_index].tracker_id;
+		const int list_index = triangulation_pairs[pair_index].list_index;
+		const int other_list_index = triangulation_pairs[pair_index].other_list_index;
 		const CommonDeviceScreenLocation &screen_location = sorted_projections[list_index].position2d_list;
-		const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
-		
-		for (int other_list_index = 0; other_list_index < projections_found; ++other_list_index)
-        {
-			if (list_index == other_list_index)
-				continue;
-
-            const int other_tracker_id = sorted_projections[other_list_index].tracker_id;
-            const CommonDeviceScreenLocation &other_screen_location = sorted_projections[other_list_index].position2d_list;
-            const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
+		const CommonDeviceScreenLocation &other_screen_location = sorted_projections[other_list_index].position2d_list;
 
-            // if trackers are on poposite sides
-            if (cfg.exclude_opposed_cameras)
-            {
-				//TODO: Use tracker FOV instead.
-                if ((tracker->getTrackerPose().PositionCm.x > 0) == (other_tracker->getTrackerPose().PositionCm.x < 0) &&
-                    (tracker->getTrackerPose().PositionCm.z > 0) == (other_tracker->getTrackerPose().PositionCm.z < 0))
-                {
-                    continue;
-                }
-            }
+		++tracker_pair_counts[list_index];
+		++tracker_pair_counts[other_list_index];
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
-
-			// Check how much the trangulation deviates from other trackers.
-			// Ignore its position if it deviates too much and renew its ROI.
-			if (pair_count > 0 && cfg.max_tracker_position_deviation > 0.01f)
-			{
-				const float N = static_cast<float>(pair_count);
+        // Using the screen locations on two different trackers we can triangulate a world position
+        CommonDevicePosition world_position =
+            ServerTrackerView::triangulateWorldPosition(
+                pair_trackers[list_index], &screen_location,
+                pair_trackers[other_list_index], &other_screen_location);
 
-				if (abs((average_world_position.x / N) - world_position.x) < cfg.max_tracker_position_deviation
-					&& abs((average_world_position.y / N) - world_position.y) < cfg.max_tracker_position_deviation
-					&& abs((average_world_position.z / N) - world_position.z) < cfg.max_tracker_position_deviation)
-				{ 
-					average_world_position.x += world_position.x;
-					average_world_position.y += world_position.y;
-					average_world_position.z += world_position.z;
+		// Check how much the trangulation deviates from other trackers.
+		// Ignore its position if it deviates too much and renew its ROI.
+		if (pair_count > 0 && cfg.max_tracker_position_deviation > 0.01f)
+		{
+			const float N = static_cast<float>(pair_count);
 
-					++pair_count;
-				}
-				else
-				{
-					++bad_deviations;
-				}
-			}
-			else
-			{
+			if (abs((average_world_position.x / N) - world_position.x) < cfg.max_tracker_position_deviation
+				&& abs((average_world_position.y / N) - world_position.y) < cfg.max_tracker_position_deviation
+				&& abs((average_world_position.z / N) - world_position.z) < cfg.max_tracker_position_deviation)
+			{ 
 				average_world_position.x += world_position.x;
 				average_world_position.y += world_position.y;
 				average_world_position.z += world_position.z;
 
 				++pair_count;
 			}
-        }
-
-		// What happend to that trackers projection? Its probably stuck somewhere on some color noise.
-		// Enforce new ROI on this tracker to make it unstuck.
-		if (bad_deviations >= projections_found - 1)
+			else
+			{
+				++tracker_bad_deviations[list_index];
+				++tracker_bad_deviations[other_list_index];
+			}
+		}
+		else
 		{
-			tracker_pose_estimations[tracker_id].bEnforceNewROI = true;
+			average_world_position.x += world_position.x;
+			average_world_position.y += world_position.y;
+			average_world_position.z += world_position.z;
+
+			++pair_count;
 		}
     }
 
+	// What happend to that trackers projection? Its probably stuck somewhere on some color noise.
+	// Enforce new ROI on any tracker whose every pair deviated to make it unstuck.
+	for (int list_index = 0; list_index < projections_found; ++list_index)
+	{
+		if (tracker_pair_counts[list_index] > 0 &&
+			tracker_bad_deviations[list_index] >= tracker_pair_counts[list_index])
+		{
+			tracker_pose_estimations[sorted_projections[list_index].tracker_id].bEnforceNewROI = true;
+		}
+	}
+
     if (pair_count == 0 
 		&& sorted_projections.size() > 0 
 		&& sorted_projections[0].tracker_id > -1 
 		&& (available_trackers == 1 || !cfg.ignore_pose_from_one_tracker))
     {
-        // Position not triangulated from opposed camera, estimate from one tracker only.
+        // No tracker pair was usable for triangulation, estimate from one tracker only.
         computeSpherePoseForControllerFromSingleTracker(
             controllerView,
             tracker_manager->getTrackerViewPtr(sorted_projections[0].tracker_id),
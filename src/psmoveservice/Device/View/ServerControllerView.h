@@ -5,7 +5,10 @@
 #include "DeviceInterface.h"
 #include "ServerDeviceView.h"
 #include "PoseFilterInterface.h"
+#include "PoseSensorPacketQueue.h"
 #include "PSMoveProtocolInterface.h"
+#include "SensorSessionLog.h"
+#include "ServiceMetrics.h"
 #include "TrackerManager.h"
 
 #include <atomic>
@@ -13,12 +16,10 @@
 #include <deque>
 #include <vector>
 
-#include "readerwriterqueue.h" // lockfree queue
-
 // -- pre-declarations -----
 class TrackerManager;
 
-using t_controller_pose_sensor_queue= moodycamel::ReaderWriterQueue<PoseSensorPacket, 1024>;
+using t_controller_pose_sensor_queue= PoseSensorPacketQueue;
 using t_controller_pose_optical_queue= std::deque<PoseSensorPacket>;
 
 template<typename t_object_type>
@@ -84,10 +85,26 @@ public:
 	// Recreate and initialize the pose filter for the controller
 	void resetPoseFilter();
 
+	// Create the pose filter from a recorded filter description rather than an opened device.
+	// Used by the sensor session replayer, which has no hardware to open.
+	bool openForReplay(const SensorSessionFilterDesc &filter_desc);
+
+	// Apply a recorded sensor packet to the pose filter exactly as updateStateAndPredict() did
+	void replayPoseSensorPacket(const PoseSensorPacket &sensorPacket, const float time_delta_seconds, const bool bIsSynced);
+
+	// Get the description of the current pose filter (filter types, filter space and constants)
+	inline const SensorSessionFilterDesc &getPoseFilterDesc() const { return m_pose_filter_desc; }
+
     // Compute pose/prediction of tracking blob+IMU state
     void updateOpticalPoseEstimation(TrackerManager* tracker_manager);
     void updateStateAndPredict();
 
+	// Get the fill level, overflow counts and processing lag of the IMU packet queue
+	inline void getIMUPacketQueueStats(PoseSensorPacketQueueStats &out_stats) const { m_PoseSensorIMUPacketQueue.getStats(out_stats); }
+
+	// Get how many sensor reports arrived from the controller
+	inline void getIMUPacketMetrics(MetricCounterStats &out_stats) const { m_imuPacketCounter.getStats(out_stats); }
+
     // Registers the address of the bluetooth adapter on the host PC with the controller
     bool setHostBluetoothAddress(const std::string &address);
     
@@ -155,8 +172,8 @@ public:
     // Get the currently assigned tracking color ID for the controller
 	eCommonTrackingColorID getTrackingColorID() const;
 
-    // Set the assigned tracking color ID for the controller
-    bool setTrackingColorID(eCommonTrackingColorID colorID);
+    // Set the assigned tracking color ID for the controller, also saved to its config with bUpdateConfig
+    bool setTrackingColorID(eCommonTrackingColorID colorID, bool bUpdateConfig);
 
     // Get the tracking is enabled on this controller
 	inline bool getIsTrackingEnabled() const { return m_tracking_enabled && m_multicam_pose_estimation != nullptr; }
@@ -220,6 +237,7 @@ protected:
     bool allocate_device_interface(const class DeviceEnumerator *enumerator) override;
     void free_device_interface() override;
     void publish_device_data_frame() override;
+    void update_pose_filter(const PoseSensorPacket &sensorPacket, const float time_delta_seconds, const bool bIsSynced);
 
 private:
     // Tracking color state
@@ -240,16 +258,22 @@ private:
 	// Filter State (IMU Thread)
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastSensorDataTimestamp;
 	bool m_bIsLastSensorDataTimestampValid;
+	MetricCounter m_imuPacketCounter;
 
 	// Filter State (Shared)
 	t_controller_pose_sensor_queue m_PoseSensorIMUPacketQueue;
 	t_controller_pose_optical_queue m_PoseSensorOpticalPacketQueue; // TODO: Currently on main thread
+
+	// Filter State (Main Thread)
+	std::vector<PoseSensorPacket> m_timeSortedPackets; // reused every update
+	int m_lastReportedIMUPacketLossCount;
     
     // Filter state
     ControllerOpticalPoseEstimation *m_tracker_pose_estimations; // array of size TrackerManager::k_max_devices
     ControllerOpticalPoseEstimation *m_multicam_pose_estimation;
     class IPoseFilter *m_pose_filter;
     class PoseFilterSpace *m_pose_filter_space;
+    SensorSessionFilterDesc m_pose_filter_desc;
     int m_lastPollSeqNumProcessed;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_last_filter_update_timestamp;
     bool m_last_filter_update_timestamp_valid;
@@ -7,9 +7,11 @@
 #include "CompoundPoseFilter.h"
 #include "PoseFilterInterface.h"
 #include "PSMoveProtocol.pb.h"
+#include "SensorSessionRecorder.h"
 #include "ServerLog.h"
 #include "ServerRequestHandler.h"
 #include "ServerTrackerView.h"
+#include "TrackerCameraModel.h"
 #include "TrackerManager.h"
 
 //-- constants -----
@@ -18,9 +20,11 @@ static const float k_max_time_delta_seconds = 1 / 30.f;
 
 //-- private methods -----
 static void init_filters_for_morpheus_hmd(
-	const MorpheusHMD *morpheusHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter);
+	const MorpheusHMD *morpheusHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter,
+	SensorSessionFilterDesc *out_pose_filter_desc);
 static void init_filters_for_virtual_hmd(
-	const VirtualHMD *virtualHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter);
+	const VirtualHMD *virtualHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter,
+	SensorSessionFilterDesc *out_pose_filter_desc);
 static IPoseFilter *pose_filter_factory(
 	const CommonDeviceState::eDeviceType deviceType,
 	const std::string &position_filter_type, const std::string &orientation_filter_type,
@@ -35,6 +39,10 @@ static void update_filters_for_virtual_hmd(
 	const VirtualHMD *virtualHMD, const VirtualHMDState *virtualHMDState,
 	const float delta_time,
 	const HMDOpticalPoseEstimation *poseEstimation, const PoseFilterSpace *poseFilterSpace, IPoseFilter *poseFilter);
+static void apply_sensor_packet_to_hmd_filter(
+	const int hmd_id, const PoseSensorPacket &sensorPacket,
+	const float delta_time, const bool bIsSynced,
+	const PoseFilterSpace *poseFilterSpace, IPoseFilter *poseFilter);
 static void generate_morpheus_hmd_data_frame_for_stream(
     const ServerHMDView *hmd_view, const HMDStreamInfo *stream_info,
     DeviceOutputDataFramePtr &data_frame);
@@ -89,10 +97,23 @@ ServerHMDView::ServerHMDView(const int device_id)
 	, m_last_filter_update_timestamp()
 	, m_last_filter_update_timestamp_valid(false)
 {
+	m_pose_filter_desc.clear();
 }
 
 ServerHMDView::~ServerHMDView()
 {
+	// Replay views never open a device, so the filter isn't freed by free_device_interface()
+	if (m_pose_filter_space != nullptr)
+	{
+		delete m_pose_filter_space;
+		m_pose_filter_space = nullptr;
+	}
+
+	if (m_pose_filter != nullptr)
+	{
+		delete m_pose_filter;
+		m_pose_filter = nullptr;
+	}
 }
 
 bool ServerHMDView::allocate_device_interface(const class DeviceEnumerator *enumerator)
@@ -257,23 +278,67 @@ void ServerHMDView::resetPoseFilter()
 		m_pose_filter_space = nullptr;
 	}
 
+	m_pose_filter_desc.clear();
+
 	switch (m_device->getDeviceType())
 	{
 	case CommonDeviceState::Morpheus:
 		{
 			const MorpheusHMD *morpheusHMD = this->castCheckedConst<MorpheusHMD>();
 
-			init_filters_for_morpheus_hmd(morpheusHMD, &m_pose_filter_space, &m_pose_filter);
+			init_filters_for_morpheus_hmd(morpheusHMD, &m_pose_filter_space, &m_pose_filter, &m_pose_filter_desc);
 		} break;
 	case CommonDeviceState::VirtualHMD:
 		{
 			const VirtualHMD *virtualHMD = this->castCheckedConst<VirtualHMD>();
 
-			init_filters_for_virtual_hmd(virtualHMD, &m_pose_filter_space, &m_pose_filter);
+			init_filters_for_virtual_hmd(virtualHMD, &m_pose_filter_space, &m_pose_filter, &m_pose_filter_desc);
 		} break;
 	default:
 		break;
 	}
+
+	// Let an in-progress sensor session know how to rebuild this filter
+	SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+	if (recorder != nullptr && m_pose_filter != nullptr)
+	{
+		recorder->recordFilterDesc(SensorSessionDevice_HMD, getDeviceID(), m_pose_filter_desc);
+	}
+}
+
+bool ServerHMDView::openForReplay(const SensorSessionFilterDesc &filter_desc)
+{
+	if (m_device != nullptr || m_pose_filter != nullptr)
+	{
+		// Replay views only ever get their filter from a sensor session log
+		return false;
+	}
+
+	m_pose_filter_desc = filter_desc;
+
+	m_pose_filter_space = new PoseFilterSpace();
+	filter_desc.applyToSpace(m_pose_filter_space);
+
+	m_pose_filter = pose_filter_factory(
+		static_cast<CommonDeviceState::eDeviceType>(filter_desc.device_type),
+		filter_desc.position_filter_type,
+		filter_desc.orientation_filter_type,
+		filter_desc.constants);
+
+	return m_pose_filter != nullptr;
+}
+
+void ServerHMDView::replayPoseSensorPacket(
+	const PoseSensorPacket &sensorPacket,
+	const float time_delta_seconds,
+	const bool bIsSynced)
+{
+	if (m_pose_filter != nullptr)
+	{
+		apply_sensor_packet_to_hmd_filter(
+			getDeviceID(), sensorPacket, time_delta_seconds, bIsSynced, m_pose_filter_space, m_pose_filter);
+		markStateAsUnpublished();
+	}
 }
 
 void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
@@ -317,7 +382,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                 const std::chrono::duration<float, std::milli> timeSinceNewDataMillis= 
                     now - tracker->getLastNewDataTimestamp();
                 const float timeoutMilli= 
-                    static_cast<float>(DeviceManager::getInstance()->m_tracker_manager->getConfig().optical_tracking_timeout);
+                    static_cast<float>(DeviceManager::getInstance()->m_tracker_manager->getTunables()->optical_tracking_timeout);
 
                 // Can't compute tracking on video data that's too old
                 if (timeSinceNewDataMillis.count() < timeoutMilli)
@@ -325,9 +390,9 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                     // Initially the newTrackerPoseEstimate is a copy of the existing pose
                     bool bIsVisibleThisUpdate= false;
 
-					// If a new video frame is available this tick, 
+					// If this tracker's frame made it into this tick's frame group, 
 					// attempt to update the tracking location
-					if (tracker->getHasUnpublishedState())
+					if (TrackerManager::isTrackerInFrameGroup(tracker_id))
 					{
 						// Create a copy of the pose estimate state so that in event of a 
 						// failure part way through computing the projection we don't
@@ -341,6 +406,14 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
 						{
 							bIsVisibleThisUpdate = true;
 
+							SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+							if (recorder != nullptr)
+							{
+								recorder->recordTrackerProjection(
+									SensorSessionDevice_HMD, this->getDeviceID(), tracker_id,
+									newTrackerPoseEstimate.projection, true);
+							}
+
 							// Actually apply the pose estimate state
 							trackerPoseEstimateRef = newTrackerPoseEstimate;
 							trackerPoseEstimateRef.last_visible_timestamp = now;
@@ -349,7 +422,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
 
                     // If the projection isn't too old (or updated this tick), 
                     // say we have a valid tracked location
-					if ((bWasTracking && !tracker->getHasUnpublishedState()) || bIsVisibleThisUpdate)
+					if ((bWasTracking && !TrackerManager::isTrackerInFrameGroup(tracker_id)) || bIsVisibleThisUpdate)
                     {
                         // If this tracker has a valid projection for the controller
                         // add it to the tracker id list
@@ -399,7 +472,7 @@ void ServerHMDView::updateOpticalPoseEstimation(TrackerManager* tracker_manager)
                 assert(false && "unreachable");
             }
         }
-        else if (projections_found == 1 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker))
+        else if (projections_found == 1 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getTunables()->ignore_pose_from_one_tracker))
         {
             const int tracker_id = valid_projection_tracker_ids[0];
             const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
@@ -769,7 +842,8 @@ static void
 init_filters_for_morpheus_hmd(
     const MorpheusHMD *morpheusHMD,
 	PoseFilterSpace **out_pose_filter_space,
-	IPoseFilter **out_pose_filter)
+	IPoseFilter **out_pose_filter,
+	SensorSessionFilterDesc *out_pose_filter_desc)
 {
     const MorpheusHMDConfig *hmd_config = morpheusHMD->getConfig();
 
@@ -817,10 +891,17 @@ init_filters_for_morpheus_hmd(
 		hmd_config->position_filter_type,
 		hmd_config->orientation_filter_type,
 		constants);
+	out_pose_filter_desc->set(
+		CommonDeviceState::eDeviceType::PSMove,
+		hmd_config->position_filter_type,
+		hmd_config->orientation_filter_type,
+		pose_filter_space,
+		constants);
 }
 
 static void init_filters_for_virtual_hmd(
-    const VirtualHMD *virtualHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter)
+    const VirtualHMD *virtualHMD, PoseFilterSpace **out_pose_filter_space, IPoseFilter **out_pose_filter,
+	SensorSessionFilterDesc *out_pose_filter_desc)
 {
     const VirtualHMDConfig *hmd_config = virtualHMD->getConfig();
 
@@ -864,6 +945,12 @@ static void init_filters_for_virtual_hmd(
 		hmd_config->position_filter_type,
 		"",
 		constants);
+	out_pose_filter_desc->set(
+		CommonDeviceState::eDeviceType::VirtualHMD,
+		hmd_config->position_filter_type,
+		"",
+		pose_filter_space,
+		constants);
 }
 
 static IPoseFilter *
@@ -984,8 +1071,10 @@ update_filters_for_morpheus_hmd(
 	if (poseFilter != nullptr)
 	{
 		PoseSensorPacket sensorPacket;
+		sensorPacket.clear();
 
-		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
+		sensorPacket.has_accelerometer_measurement = true;
+		sensorPacket.has_gyroscope_measurement = true;
 
 		if (poseEstimation->bOrientationValid)
 		{
@@ -1033,22 +1122,10 @@ update_filters_for_morpheus_hmd(
 					sensorFrame.CalibratedGyro.k);
 			sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 
-			{
-				PoseFilterPacket filterPacket;
-				filterPacket.clear();
-
-				filterPacket.hmdDeviceId = hmd->getDeviceID();
-				filterPacket.isSynced = TrackerManager::trackersSynced();
-
-				// Create a filter input packet from the sensor data 
-				// and the filter's previous orientation and position
-				poseFilterSpace->createFilterPacket(
-					sensorPacket,
-					poseFilter,
-					filterPacket);
-
-				poseFilter->update(delta_time / 2.f, filterPacket);
-			}
+			apply_sensor_packet_to_hmd_filter(
+				hmd->getDeviceID(), sensorPacket,
+				delta_time / 2.f, TrackerManager::trackersSynced(),
+				poseFilterSpace, poseFilter);
 		}
 	}
 }
@@ -1069,8 +1146,8 @@ update_filters_for_virtual_hmd(
 	if (poseFilter != nullptr)
 	{
 		PoseSensorPacket sensorPacket;
+		sensorPacket.clear();
 
-		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 		sensorPacket.optical_orientation = Eigen::Quaternionf::Identity();
 
 		if (poseEstimation->bCurrentlyTracking)
@@ -1092,20 +1169,40 @@ update_filters_for_virtual_hmd(
 		sensorPacket.imu_gyroscope_rad_per_sec = Eigen::Vector3f::Zero();
 		sensorPacket.imu_magnetometer_unit = Eigen::Vector3f::Zero();
 
-		{
-			PoseFilterPacket filterPacket;
-			filterPacket.clear();
+		apply_sensor_packet_to_hmd_filter(
+			hmd->getDeviceID(), sensorPacket,
+			delta_time, TrackerManager::trackersSynced(),
+			poseFilterSpace, poseFilter);
+	}
+}
+
+static void
+apply_sensor_packet_to_hmd_filter(
+	const int hmd_id,
+	const PoseSensorPacket &sensorPacket,
+	const float delta_time,
+	const bool bIsSynced,
+	const PoseFilterSpace *poseFilterSpace,
+	IPoseFilter *poseFilter)
+{
+	// Capture the exact filter input if a sensor session is being recorded
+	SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+	if (recorder != nullptr)
+	{
+		recorder->recordPoseSensorPacket(SensorSessionDevice_HMD, hmd_id, sensorPacket, delta_time, bIsSynced);
+	}
 
-			filterPacket.hmdDeviceId = hmd->getDeviceID();
-			filterPacket.isSynced = TrackerManager::trackersSynced();
+	PoseFilterPacket filterPacket;
+	filterPacket.clear();
 
-			// Create a filter input packet from the sensor data 
-			// and the filter's previous orientation and position
-			poseFilterSpace->createFilterPacket(sensorPacket, poseFilter, filterPacket);
+	filterPacket.hmdDeviceId = hmd_id;
+	filterPacket.isSynced = bIsSynced;
 
-			poseFilter->update(delta_time, filterPacket);
-		}
-	}
+	// Create a filter input packet from the sensor data 
+	// and the filter's previous orientation and position
+	poseFilterSpace->createFilterPacket(sensorPacket, poseFilter, filterPacket);
+
+	poseFilter->update(delta_time, filterPacket);
 }
 
 static void generate_morpheus_hmd_data_frame_for_stream(
@@ -1493,12 +1590,15 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
 		}
 	}
 
-    const TrackerManagerConfig &cfg = tracker_manager->getConfig();
+    const TrackerManagerTunables &cfg = *tracker_manager->getTunables();
     float screen_area_sum = 0;
 
     // Project the tracker relative 3d tracking position back on to the tracker camera plane
     // and sum up the total controller projection area across all trackers
     CommonDeviceScreenLocation position2d_list[TrackerManager::k_max_devices];
+    const ServerTrackerView *pair_trackers[TrackerManager::k_max_devices];
+    CommonDevicePosition pair_world_estimates[TrackerManager::k_max_devices];
+    int biggest_prjection_id = -1;
     for (int list_index = 0; list_index < projections_found; ++list_index)
     {
         const int tracker_id = valid_projection_tracker_ids[list_index];
@@ -1506,56 +1606,49 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
         const HMDOpticalPoseEstimation &poseEstimate = tracker_pose_estimations[tracker_id];
 
         position2d_list[list_index] = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+        pair_trackers[list_index] = tracker.get();
+        pair_world_estimates[list_index] = tracker->computeWorldPosition(&poseEstimate.position_cm);
         screen_area_sum += poseEstimate.projection.screen_area;
+
+        if (biggest_prjection_id == -1 ||
+            poseEstimate.projection.screen_area > tracker_pose_estimations[biggest_prjection_id].projection.screen_area)
+        {
+            biggest_prjection_id = tracker_id;
+        }
     }
 
-    // Compute triangulations amongst all pairs of projections
+    // Only triangulate the pairs of trackers expected to give the best results
+    TrackerTriangulationPair triangulation_pairs[ServerTrackerView::k_max_triangulation_pairs];
+    const int triangulation_pair_count =
+        ServerTrackerView::selectTriangulationPairs(
+            pair_trackers, pair_world_estimates, projections_found,
+            cfg.max_triangulation_pairs, cfg.exclude_opposed_cameras,
+            triangulation_pairs);
+
+    // Compute triangulations amongst the selected pairs of projections
     int pair_count = 0;
-    int biggest_prjection_id = -1;
     CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
-    for (int list_index = 0; list_index < projections_found; ++list_index)
+    for (int pair_index = 0; pair_index < triangulation_pair_count; ++pair_index)
     {
-        const int tracker_id = valid_projection_tracker_ids[list_index];
-        const CommonDeviceScreenLocation &screen_location = position2d_list[list_index];
-        const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
-
-        for (int other_list_index = list_index + 1; other_list_index < projections_found; ++other_list_index)
-        {
-            const int other_tracker_id = valid_projection_tracker_ids[other_list_index];
-            const CommonDeviceScreenLocation &other_screen_location = position2d_list[other_list_index];
-            const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
-            // if trackers are on opposite sides
-            if (cfg.exclude_opposed_cameras)
-            {
-                if ((tracker->getTrackerPose().PositionCm.x > 0) == (other_tracker->getTrackerPose().PositionCm.x < 0) &&
-                    (tracker->getTrackerPose().PositionCm.z > 0) == (other_tracker->getTrackerPose().PositionCm.z < 0))
-                {
-                    float screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
-                    float other_screen_area = tracker_pose_estimations[other_tracker_id].projection.screen_area;
-
-                    biggest_prjection_id = screen_area > other_screen_area ? tracker_id : other_tracker_id;
-
-                    continue;
-                }
-            }
+        const int list_index = triangulation_pairs[pair_index].list_index;
+        const int other_list_index = triangulation_pairs[pair_index].other_list_index;
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
+        // Using the screen locations on two different trackers we can triangulate a world position
+        CommonDevicePosition world_position =
+            ServerTrackerView::triangulateWorldPosition(
+                pair_trackers[list_index], &position2d_list[list_index],
+                pair_trackers[other_list_index], &position2d_list[other_list_index]);
 
-            average_world_position.x += world_position.x;
-            average_world_position.y += world_position.y;
-            average_world_position.z += world_position.z;
+        average_world_position.x += world_position.x;
+        average_world_position.y += world_position.y;
+        average_world_position.z += world_position.z;
 
-            ++pair_count;
-        }
+        ++pair_count;
     }
 
-    if (pair_count == 0 && biggest_prjection_id >= 0 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker))
+    if (pair_count == 0 && biggest_prjection_id >= 0 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getTunables()->ignore_pose_from_one_tracker))
     {
-        // Position not triangulated from opposed camera, estimate from one tracker only.
+        // No tracker pair was usable for triangulation, estimate from one tracker only.
         computeSpherePoseForHmdFromSingleTracker(
             hmdView,
             tracker_manager->getTrackerViewPtr(biggest_prjection_id),
@@ -1572,7 +1665,7 @@ static void computeSpherePoseForHmdFromMultipleTrackers(
         average_world_position.z /= N;
 
         // Store the averaged tracking position
-        const float q = tracker_manager->getConfig().controller_position_smoothing;
+        const float q = tracker_manager->getTunables()->controller_position_smoothing;
         if (q <= 0.01f)
         {
             multicam_pose_estimation->position_cm = average_world_position;
@@ -1617,12 +1710,15 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
 		}
 	}
 
-    const TrackerManagerConfig &cfg = tracker_manager->getConfig();
+    const TrackerManagerTunables &cfg = *tracker_manager->getTunables();
     float screen_area_sum = 0;
 
     // Project the tracker relative 3d tracking position back on to the tracker camera plane
     // and sum up the total controller projection area across all trackers
     CommonDeviceScreenLocation position2d_list[TrackerManager::k_max_devices];
+    const ServerTrackerView *pair_trackers[TrackerManager::k_max_devices];
+    CommonDevicePosition pair_world_estimates[TrackerManager::k_max_devices];
+    int biggest_prjection_id = -1;
     for (int list_index = 0; list_index < projections_found; ++list_index)
     {
         const int tracker_id = valid_projection_tracker_ids[list_index];
@@ -1630,56 +1726,49 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
         const HMDOpticalPoseEstimation &poseEstimate = tracker_pose_estimations[tracker_id];
 
         position2d_list[list_index] = tracker->projectTrackerRelativePosition(&poseEstimate.position_cm);
+        pair_trackers[list_index] = tracker.get();
+        pair_world_estimates[list_index] = tracker->computeWorldPosition(&poseEstimate.position_cm);
         screen_area_sum += poseEstimate.projection.screen_area;
+
+        if (biggest_prjection_id == -1 ||
+            poseEstimate.projection.screen_area > tracker_pose_estimations[biggest_prjection_id].projection.screen_area)
+        {
+            biggest_prjection_id = tracker_id;
+        }
     }
 
-    // Compute triangulations amongst all pairs of projections
+    // Only triangulate the pairs of trackers expected to give the best results
+    TrackerTriangulationPair triangulation_pairs[ServerTrackerView::k_max_triangulation_pairs];
+    const int triangulation_pair_count =
+        ServerTrackerView::selectTriangulationPairs(
+            pair_trackers, pair_world_estimates, projections_found,
+            cfg.max_triangulation_pairs, cfg.exclude_opposed_cameras,
+            triangulation_pairs);
+
+    // Compute triangulations amongst the selected pairs of projections
     int pair_count = 0;
-    int biggest_prjection_id = -1;
     CommonDevicePosition average_world_position = { 0.f, 0.f, 0.f };
-    for (int list_index = 0; list_index < projections_found; ++list_index)
+    for (int pair_index = 0; pair_index < triangulation_pair_count; ++pair_index)
     {
-        const int tracker_id = valid_projection_tracker_ids[list_index];
-        const CommonDeviceScreenLocation &screen_location = position2d_list[list_index];
-        const ServerTrackerViewPtr tracker = tracker_manager->getTrackerViewPtr(tracker_id);
-
-        for (int other_list_index = list_index + 1; other_list_index < projections_found; ++other_list_index)
-        {
-            const int other_tracker_id = valid_projection_tracker_ids[other_list_index];
-            const CommonDeviceScreenLocation &other_screen_location = position2d_list[other_list_index];
-            const ServerTrackerViewPtr other_tracker = tracker_manager->getTrackerViewPtr(other_tracker_id);
-            // if trackers are on opposite sides
-            if (cfg.exclude_opposed_cameras)
-            {
-                if ((tracker->getTrackerPose().PositionCm.x > 0) == (other_tracker->getTrackerPose().PositionCm.x < 0) &&
-                    (tracker->getTrackerPose().PositionCm.z > 0) == (other_tracker->getTrackerPose().PositionCm.z < 0))
-                {
-                    float screen_area = tracker_pose_estimations[tracker_id].projection.screen_area;
-                    float other_screen_area = tracker_pose_estimations[other_tracker_id].projection.screen_area;
-
-                    biggest_prjection_id = screen_area > other_screen_area ? tracker_id : other_tracker_id;
-
-                    continue;
-                }
-            }
+        const int list_index = triangulation_pairs[pair_index].list_index;
+        const int other_list_index = triangulation_pairs[pair_index].other_list_index;
 
-            // Using the screen locations on two different trackers we can triangulate a world position
-            CommonDevicePosition world_position =
-                ServerTrackerView::triangulateWorldPosition(
-                    tracker.get(), &screen_location,
-                    other_tracker.get(), &other_screen_location);
+        // Using the screen locations on two different trackers we can triangulate a world position
+        CommonDevicePosition world_position =
+            ServerTrackerView::triangulateWorldPosition(
+                pair_trackers[list_index], &position2d_list[list_index],
+                pair_trackers[other_list_index], &position2d_list[other_list_index]);
 
-            average_world_position.x += world_position.x;
-            average_world_position.y += world_position.y;
-            average_world_position.z += world_position.z;
+        average_world_position.x += world_position.x;
+        average_world_position.y += world_position.y;
+        average_world_position.z += world_position.z;
 
-            ++pair_count;
-        }
+        ++pair_count;
     }
 
-    if (pair_count == 0 && biggest_prjection_id >= 0 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getConfig().ignore_pose_from_one_tracker))
+    if (pair_count == 0 && biggest_prjection_id >= 0 && (available_trackers == 1 || !DeviceManager::getInstance()->m_tracker_manager->getTunables()->ignore_pose_from_one_tracker))
     {
-        // Position not triangulated from opposed camera, estimate from one tracker only.
+        // No tracker pair was usable for triangulation, estimate from one tracker only.
         computePointCloudPoseForHmdFromSingleTracker(
             hmdView,
             tracker_manager->getTrackerViewPtr(biggest_prjection_id),
@@ -1696,7 +1785,7 @@ static void computePointCloudPoseForHmdFromMultipleTrackers(
         average_world_position.z /= N;
 
         // Store the averaged tracking position
-        const float q = tracker_manager->getConfig().controller_position_smoothing;
+        const float q = tracker_manager->getTunables()->controller_position_smoothing;
         if (q <= 0.01f)
         {
             multicam_pose_estimation->position_cm = average_world_position;
@@ -4,6 +4,7 @@
 //-- includes -----
 #include "ServerDeviceView.h"
 #include "PSMoveProtocolInterface.h"
+#include "SensorSessionLog.h"
 #include <cstring>
 
 // -- pre-declarations -----
@@ -52,6 +53,16 @@ public:
 	// Recreate and initialize the pose filter for the HMD
 	void resetPoseFilter();
 
+	// Create the pose filter from a recorded filter description rather than an opened device.
+	// Used by the sensor session replayer, which has no hardware to open.
+	bool openForReplay(const SensorSessionFilterDesc &filter_desc);
+
+	// Apply a recorded sensor packet to the pose filter exactly as updateStateAndPredict() did
+	void replayPoseSensorPacket(const PoseSensorPacket &sensorPacket, const float time_delta_seconds, const bool bIsSynced);
+
+	// Get the description of the current pose filter (filter types, filter space and constants)
+	inline const SensorSessionFilterDesc &getPoseFilterDesc() const { return m_pose_filter_desc; }
+
 	// Compute pose/prediction of tracking blob+IMU state
 	void updateOpticalPoseEstimation(TrackerManager* tracker_manager);
     void updateStateAndPredict();
@@ -152,6 +163,7 @@ private:
 	HMDOpticalPoseEstimation *m_multicam_pose_estimation;
 	class IPoseFilter *m_pose_filter;
 	class PoseFilterSpace *m_pose_filter_space;
+	SensorSessionFilterDesc m_pose_filter_desc;
     int m_lastPollSeqNumProcessed;
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_last_filter_update_timestamp;
 	bool m_last_filter_update_timestamp_valid;
@@ -10,11 +10,16 @@
 #include "MathAlignment.h"
 #include "PS3EyeTracker.h"
 #include "PSMoveProtocol.pb.h"
+#include "SensorSessionRecorder.h"
+#include "SphereEdgeSampler.h"
 #include "ServerUtility.h"
 #include "ServerLog.h"
 #include "ServerRequestHandler.h"
 #include "SharedTrackerState.h"
+#include "TrackerCameraModel.h"
 #include "TrackerManager.h"
+#include "TrackingStageProfiler.h"
+#include "UndistortionGrid.h"
 #include "ControllerManager.h"
 #include "PoseFilterInterface.h"
 
@@ -33,6 +38,21 @@
 //-- constants ----
 static const int k_min_roi_size= 32;
 
+// Full resolution pixels added around the blobs found by a downscaled search
+static const int k_coarse_search_padding= 8;
+
+// How much of the disagreement between the filter and the last measurement is added to the ROI
+static const float k_roi_uncertainty_scale= 2.f;
+
+// Pairs whose rays to the device are closer than ~3 degrees to parallel can't resolve depth
+static const float k_min_triangulation_sin_angle= 0.05f;
+
+// Score kept by a pair whose position guess falls outside either tracker's frustum
+static const float k_outside_frustum_score_scale= 0.5f;
+
+// Frame width of the automatic frame mode's fast mode, the PS3 Eye's 320x240 mode
+static const double k_fast_frame_mode_width= 320.0;
+
 //-- typedefs ----
 typedef std::vector<cv::Point> t_opencv_int_contour;
 typedef std::vector<t_opencv_int_contour> t_opencv_int_contour_list;
@@ -343,6 +363,11 @@ public:
         , gsLowerBuffer(nullptr)
         , gsUpperBuffer(nullptr)
         , maskedBuffer(nullptr)
+        , coarseScale(1)
+        , bCoarseHsvValid(false)
+        , overlayContourCount(0)
+        , bOverlayEnabled(false)
+        , bOverlayDirty(true)
     {
         device->getVideoFrameDimensions(&frameWidth, &frameHeight, nullptr);
 
@@ -410,11 +435,66 @@ public:
         const cv::Mat videoBufferMat(frameHeight, frameWidth, CV_8UC3, const_cast<unsigned char *>(video_buffer));
 
         videoBufferMat.copyTo(*bgrBuffer);
-        videoBufferMat.copyTo(*bgrShmemBuffer);
+
+        // The downscaled search buffer is rebuilt on demand for the new frame
+        bCoarseHsvValid = false;
+
+        // The overlay gets recorded again for the new frame
+        overlayOps.clear();
+        overlayContourCount = 0;
+        bOverlayDirty = true;
+    }
+
+    // Debug overlay ops are only recorded while a video stream wants them
+    void setOverlayEnabled(bool bEnabled)
+    {
+        if (bOverlayEnabled != bEnabled)
+        {
+            overlayOps.clear();
+            overlayContourCount = 0;
+            bOverlayEnabled = bEnabled;
+            bOverlayDirty = true;
+        }
+    }
+
+    // Composite the recorded debug overlay on top of the video frame in bgrShmemBuffer.
+    // Only done for frames that are actually streamed to a client.
+    void rasterizeOverlay()
+    {
+        if (!bOverlayDirty)
+        {
+            return;
+        }
+
+        bgrBuffer->copyTo(*bgrShmemBuffer);
+
+        for (const OverlayDrawOp &op : overlayOps)
+        {
+            switch (op.type)
+            {
+            case OverlayDrawOp_ROI:
+                cv::rectangle(*bgrShmemBuffer, op.rect, cv::Scalar(255, 0, 0));
+                break;
+            case OverlayDrawOp_Contour:
+                rasterize_contour(overlayContours[op.contour_index]);
+                break;
+            case OverlayDrawOp_PoseProjection:
+                rasterize_pose_projection(op.projection);
+                break;
+            case OverlayDrawOp_PoseOcclusion:
+                rasterize_pose_occlusion(op.center, op.size);
+                break;
+            }
+        }
+
+        bOverlayDirty = false;
     }
     
     void updateHsvBuffer()
     {
+        TrackingStageScope segmentation_scope(TrackingStage_Segmentation);
+        TrackingStageProfiler::addSegmentedPixels(static_cast<int64_t>(bgrROI.total()));
+
         // Convert the video buffer to the HSV color space
         if (bgr2hsv != nullptr)
         {
@@ -425,6 +505,169 @@ public:
             cv::cvtColor(bgrROI, hsvROI, cv::COLOR_BGR2HSV);
         }
     }
+
+    // Automatic color calibration works on the whole frame, regardless of the tracking ROI.
+    // The tracking passes convert their own ROI again before using hsvBuffer.
+    void updateFullFrameHsvBuffer()
+    {
+        if (bgr2hsv != nullptr)
+        {
+            bgr2hsv->cvtColor(*bgrBuffer, *hsvBuffer);
+        }
+        else
+        {
+            cv::cvtColor(*bgrBuffer, *hsvBuffer, cv::COLOR_BGR2HSV);
+        }
+    }
+
+    // Remember the brightness of the current frame, taken with the calibrated bulb turned off
+    void captureColorCalibrationBackground()
+    {
+        updateFullFrameHsvBuffer();
+        cv::extractChannel(*hsvBuffer, colorCalibrationBackground, 2);
+    }
+
+    // Add every pixel inside search_range that got at least min_value_increase brighter
+    // than the background to the histogram, i.e. the pixels lit by the bulb
+    int accumulateColorCalibrationHistogram(
+        const CommonHSVColorRange &search_range,
+        const int min_value_increase,
+        TrackerColorHistogram &histogram)
+    {
+        // No background yet, or the frame size changed since it was taken
+        if (colorCalibrationBackground.rows != frameHeight || colorCalibrationBackground.cols != frameWidth)
+        {
+            return 0;
+        }
+
+        updateFullFrameHsvBuffer();
+        thresholdHSV(search_range, *hsvBuffer, *gsLowerBuffer, *gsUpperBuffer);
+
+        int added_pixel_count = 0;
+        for (int y = 0; y < frameHeight; ++y)
+        {
+            const OpenCVBGRToHSVMapper::ColorTuple *hsv_row = hsvBuffer->ptr<OpenCVBGRToHSVMapper::ColorTuple>(y);
+            const unsigned char *mask_row = gsLowerBuffer->ptr<unsigned char>(y);
+            const unsigned char *background_row = colorCalibrationBackground.ptr<unsigned char>(y);
+
+            for (int x = 0; x < frameWidth; ++x)
+            {
+                const OpenCVBGRToHSVMapper::ColorTuple &hsv = hsv_row[x];
+
+                if (mask_row[x] != 0 && static_cast<int>(hsv.z) >= static_cast<int>(background_row[x]) + min_value_increase)
+                {
+                    ++histogram.hue[std::min(static_cast<int>(hsv.x), TrackerColorHistogram::k_hue_bin_count - 1)];
+                    ++histogram.saturation[hsv.y];
+                    ++histogram.value[hsv.z];
+                    ++added_pixel_count;
+                }
+            }
+        }
+
+        histogram.pixel_count += added_pixel_count;
+
+        return added_pixel_count;
+    }
+
+    // Search a downscaled copy of the frame for blobs of the given color inside search_rect.
+    // On success out_region is the full resolution region, within search_rect,
+    // covering the biggest max_blob_count blobs.
+    bool findCoarseSearchRegion(
+        const CommonHSVColorRange &hsvColorRange,
+        const cv::Rect2i search_rect,
+        const int downscale,
+        const int max_blob_count,
+        cv::Rect2i &out_region)
+    {
+        t_opencv_int_contour_list contours;
+
+        {
+            TrackingStageScope segmentation_scope(TrackingStage_Segmentation);
+
+            // The downscaled HSV frame is shared by every device searched for during this frame
+            if (!bCoarseHsvValid || coarseScale != downscale)
+            {
+                const cv::Size coarse_size(std::max(frameWidth / downscale, 1), std::max(frameHeight / downscale, 1));
+
+                // Nearest neighbor keeps the bulb colors intact, averaging would blend them into the background
+                cv::resize(*bgrBuffer, coarseBgrBuffer, coarse_size, 0, 0, cv::INTER_NEAREST);
+                coarseHsvBuffer.create(coarse_size, CV_8UC3);
+                coarseLowerBuffer.create(coarse_size, CV_8UC1);
+                coarseUpperBuffer.create(coarse_size, CV_8UC1);
+
+                if (bgr2hsv != nullptr)
+                {
+                    bgr2hsv->cvtColor(coarseBgrBuffer, coarseHsvBuffer);
+                }
+                else
+                {
+                    cv::cvtColor(coarseBgrBuffer, coarseHsvBuffer, cv::COLOR_BGR2HSV);
+                }
+
+                TrackingStageProfiler::addSegmentedPixels(static_cast<int64_t>(coarse_size.area()));
+                coarseScale = downscale;
+                bCoarseHsvValid = true;
+            }
+
+            // Search rect in downscaled pixels, rounded outwards
+            const cv::Point2i coarse_tl(search_rect.x / downscale, search_rect.y / downscale);
+            const cv::Point2i coarse_br(
+                (search_rect.x + search_rect.width + downscale - 1) / downscale,
+                (search_rect.y + search_rect.height + downscale - 1) / downscale);
+            const cv::Rect2i coarse_rect =
+                cv::Rect2i(coarse_tl, coarse_br) & cv::Rect2i(0, 0, coarseHsvBuffer.cols, coarseHsvBuffer.rows);
+
+            if (coarse_rect.area() <= 0)
+            {
+                return false;
+            }
+
+            cv::Mat coarseLowerROI = coarseLowerBuffer(coarse_rect);
+            cv::Mat coarseUpperROI = coarseUpperBuffer(coarse_rect);
+            thresholdHSV(hsvColorRange, coarseHsvBuffer(coarse_rect), coarseLowerROI, coarseUpperROI);
+
+            cv::findContours(coarseLowerROI,
+                             contours,
+                             CV_RETR_EXTERNAL,
+                             CV_CHAIN_APPROX_SIMPLE,
+                             coarse_rect.tl());
+        }
+
+        if (contours.size() == 0)
+        {
+            return false;
+        }
+
+        // Biggest blobs first
+        std::vector<cv::Rect2i> blob_rects;
+        blob_rects.reserve(contours.size());
+        for (const t_opencv_int_contour &contour : contours)
+        {
+            blob_rects.push_back(cv::boundingRect(contour));
+        }
+        std::sort(
+            blob_rects.begin(), blob_rects.end(),
+            [](const cv::Rect2i &a, const cv::Rect2i &b) {
+                return b.area() < a.area();
+        });
+
+        cv::Rect2i coarse_region = blob_rects[0];
+        for (int blob_index = 1; blob_index < std::min(max_blob_count, static_cast<int>(blob_rects.size())); ++blob_index)
+        {
+            coarse_region |= blob_rects[blob_index];
+        }
+
+        // Back to full resolution, padded so the blob edges lost to the downscale
+        // and some background around the blob end up in the region
+        const int padding = k_coarse_search_padding + downscale;
+        out_region = cv::Rect2i(
+            coarse_region.x*downscale - padding,
+            coarse_region.y*downscale - padding,
+            coarse_region.width*downscale + 2*padding,
+            coarse_region.height*downscale + 2*padding) & search_rect;
+
+        return out_region.area() > 0;
+    }
     
     void applyROI(cv::Rect2i ROI)
     {
@@ -464,7 +707,67 @@ public:
         updateHsvBuffer();
         
         //Draw ROI.
-        cv::rectangle(*bgrShmemBuffer, ROI, cv::Scalar(255, 0, 0));
+        if (bOverlayEnabled)
+        {
+            OverlayDrawOp op;
+            op.type = OverlayDrawOp_ROI;
+            op.rect = ROI;
+            overlayOps.push_back(op);
+            bOverlayDirty = true;
+        }
+    }
+
+    // Clamp an HSV image into a grayscale mask, taking into account wrapping the hue angle.
+    // scratch_mask must be the same size as out_mask.
+    static void thresholdHSV(
+        const CommonHSVColorRange &hsvColorRange,
+        const cv::Mat &hsv,
+        cv::Mat &out_mask,
+        cv::Mat &scratch_mask)
+    {
+        const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
+        const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
+        const float saturation_min = clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
+        const float saturation_max = clampf(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255);
+        const float value_min = clampf(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255);
+        const float value_max = clampf(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255);
+
+        if (hue_min < 0)
+        {
+            cv::inRange(
+                hsv,
+                cv::Scalar(0, saturation_min, value_min),
+                cv::Scalar(clampf(hue_max, 0, 180), saturation_max, value_max),
+                out_mask);
+            cv::inRange(
+                hsv,
+                cv::Scalar(clampf(180 + hue_min, 0, 180), saturation_min, value_min),
+                cv::Scalar(180, saturation_max, value_max),
+                scratch_mask);
+            cv::bitwise_or(out_mask, scratch_mask, out_mask);
+        }
+        else if (hue_max > 180)
+        {
+            cv::inRange(
+                hsv,
+                cv::Scalar(0, saturation_min, value_min),
+                cv::Scalar(clampf(hue_max - 180, 0, 180), saturation_max, value_max),
+                out_mask);
+            cv::inRange(
+                hsv,
+                cv::Scalar(clampf(hue_min, 0, 180), saturation_min, value_min),
+                cv::Scalar(180, saturation_max, value_max),
+                scratch_mask);
+            cv::bitwise_or(out_mask, scratch_mask, out_mask);
+        }
+        else
+        {
+            cv::inRange(
+                hsv,
+                cv::Scalar(hue_min, saturation_min, value_min),
+                cv::Scalar(hue_max, saturation_max, value_max),
+                out_mask);
+        }
     }
 
     // Return points in raw image space:
@@ -477,8 +780,7 @@ public:
         int min_points_in_contour = -1)
     {
 		if (min_points_in_contour < 1) {
-			const TrackerManagerConfig &cfg = DeviceManager::getInstance()->m_tracker_manager->getConfig();
-			min_points_in_contour = static_cast<int>(fmax(cfg.min_points_in_contour, 1));
+			min_points_in_contour = DeviceManager::getInstance()->m_tracker_manager->getTunables()->min_points_in_contour;
 		}
 
 		out_biggest_N_contours.clear();
@@ -486,55 +788,17 @@ public:
         
         // Clamp the HSV image, taking into account wrapping the hue angle
         {
-            const float hue_min = hsvColorRange.hue_range.center - hsvColorRange.hue_range.range;
-            const float hue_max = hsvColorRange.hue_range.center + hsvColorRange.hue_range.range;
-            const float saturation_min = clampf(hsvColorRange.saturation_range.center - hsvColorRange.saturation_range.range, 0, 255);
-            const float saturation_max = clampf(hsvColorRange.saturation_range.center + hsvColorRange.saturation_range.range, 0, 255);
-            const float value_min = clampf(hsvColorRange.value_range.center - hsvColorRange.value_range.range, 0, 255);
-            const float value_max = clampf(hsvColorRange.value_range.center + hsvColorRange.value_range.range, 0, 255);
+            TrackingStageScope segmentation_scope(TrackingStage_Segmentation);
 
-            if (hue_min < 0)
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(0, saturation_min, value_min),
-                    cv::Scalar(clampf(hue_max, 0, 180), saturation_max, value_max),
-                    gsLowerROI);
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(clampf(180 + hue_min, 0, 180), saturation_min, value_min),
-                    cv::Scalar(180, saturation_max, value_max),
-                    gsUpperROI);
-                cv::bitwise_or(gsLowerROI, gsUpperROI, gsLowerROI);
-            }
-            else if (hue_max > 180)
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(0, saturation_min, value_min),
-                    cv::Scalar(clampf(hue_max - 180, 0, 180), saturation_max, value_max),
-                    gsLowerROI);
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(clampf(hue_min, 0, 180), saturation_min, value_min),
-                    cv::Scalar(180, saturation_max, value_max),
-                    gsUpperROI);
-                cv::bitwise_or(gsLowerROI, gsUpperROI, gsLowerROI);
-            }
-            else
-            {
-                cv::inRange(
-                    hsvROI,
-                    cv::Scalar(hue_min, saturation_min, value_min),
-                    cv::Scalar(hue_max, saturation_max, value_max),
-                    gsLowerROI);
-            }
+            thresholdHSV(hsvColorRange, hsvROI, gsLowerROI, gsUpperROI);
         }
         
         //TODO: Why no blurring of the gsLowerBuffer?
 
         // Find the largest convex blob in the filtered grayscale buffer
         {
+            TrackingStageScope contours_scope(TrackingStage_Contours);
+
             struct ContourInfo
             {
                 int contour_index;
@@ -650,6 +914,61 @@ public:
     
     void
     draw_contour(const t_opencv_int_contour &contour)
+    {
+        if (!bOverlayEnabled)
+        {
+            return;
+        }
+
+        // Reuse the contour storage from earlier frames
+        if (overlayContourCount >= static_cast<int>(overlayContours.size()))
+        {
+            overlayContours.resize(overlayContourCount + 1);
+        }
+        overlayContours[overlayContourCount] = contour;
+
+        OverlayDrawOp op;
+        op.type = OverlayDrawOp_Contour;
+        op.contour_index = overlayContourCount;
+        overlayOps.push_back(op);
+
+        ++overlayContourCount;
+        bOverlayDirty = true;
+    }
+
+    void
+    draw_pose_projection(const CommonDeviceTrackingProjection &pose_projection)
+    {
+        if (!bOverlayEnabled)
+        {
+            return;
+        }
+
+        OverlayDrawOp op;
+        op.type = OverlayDrawOp_PoseProjection;
+        op.projection = pose_projection;
+        overlayOps.push_back(op);
+        bOverlayDirty = true;
+    }
+
+    void
+    draw_pose_occlusion(CommonDeviceScreenLocation center, float size)
+    {
+        if (!bOverlayEnabled)
+        {
+            return;
+        }
+
+        OverlayDrawOp op;
+        op.type = OverlayDrawOp_PoseOcclusion;
+        op.center = center;
+        op.size = size;
+        overlayOps.push_back(op);
+        bOverlayDirty = true;
+    }
+
+    void
+    rasterize_contour(const t_opencv_int_contour &contour)
     {
         // Draws the contour directly onto the shared mem buffer.
         // This is useful for debugging
@@ -663,7 +982,7 @@ public:
     }
 
 	void
-	draw_pose_projection(const CommonDeviceTrackingProjection &pose_projection)
+	rasterize_pose_projection(const CommonDeviceTrackingProjection &pose_projection)
 	{
 		// Draw the projection of the pose onto the shared mem buffer.
 		switch (pose_projection.shape_type)
@@ -740,7 +1059,7 @@ public:
 	}
 
 	void
-	draw_pose_occlusion(CommonDeviceScreenLocation center, float size)
+	rasterize_pose_occlusion(CommonDeviceScreenLocation center, float size)
 	{
 		cv::Rect rec;
 		rec.x = static_cast<int>(center.x - size);
@@ -768,24 +1087,54 @@ public:
     cv::Mat gsUpperROI;
     cv::Mat *maskedBuffer; // bgr image ANDed together with grayscale mask
     OpenCVBGRToHSVMapper *bgr2hsv; // Used to convert an rgb image to an hsv image
+    UndistortionGrid undistortionGrid; // Cached contour point undistortion for the current intrinsics
+    SphereEdgeSampler sphereEdgeSampler; // Fixed capacity sphere contour samples for the focal cone fit
+
+    // Downscaled copy of the frame used to find lost devices before segmenting at full resolution
+    cv::Mat coarseBgrBuffer;
+    cv::Mat coarseHsvBuffer;
+    cv::Mat coarseLowerBuffer;
+    cv::Mat coarseUpperBuffer;
+    int coarseScale;
+    bool bCoarseHsvValid; // coarseHsvBuffer matches the current frame
+
+    // Brightness (HSV value) of the frame with the bulb off, taken during automatic color calibration
+    cv::Mat colorCalibrationBackground;
+
+    // Debug overlay recorded during tracking, replayed onto bgrShmemBuffer when streamed
+    enum eOverlayDrawOpType
+    {
+        OverlayDrawOp_ROI,
+        OverlayDrawOp_Contour,
+        OverlayDrawOp_PoseProjection,
+        OverlayDrawOp_PoseOcclusion
+    };
+
+    struct OverlayDrawOp
+    {
+        eOverlayDrawOpType type;
+        cv::Rect2i rect; // ROI
+        int contour_index; // Contour, index into overlayContours
+        CommonDeviceTrackingProjection projection; // PoseProjection
+        CommonDeviceScreenLocation center; // PoseOcclusion
+        float size; // PoseOcclusion
+    };
+
+    std::vector<OverlayDrawOp> overlayOps;
+    std::vector<t_opencv_int_contour> overlayContours;
+    int overlayContourCount;
+    bool bOverlayEnabled;
+    bool bOverlayDirty;
 };
 
 // -- Utility Methods -----
-static glm::quat computeGLMCameraTransformQuaternion(const ITrackerInterface *tracker_device);
-static glm::mat4 computeGLMCameraTransformMatrix(const ITrackerInterface *tracker_device);
-static void computeOpenCVCameraExtrinsicMatrix(const ITrackerInterface *tracker_device,
-                                                      cv::Matx34f &extrinsicOut);
 cv::Mat cvDistCoeffs = cv::Mat(4, 1, cv::DataType<float>::type, 0.f);
-static void computeOpenCVCameraIntrinsicMatrix(const ITrackerInterface *tracker_device,
-                                               cv::Matx33f &intrinsicOut,
-                                               cv::Matx<float, 5, 1> &distortionOut);
-static cv::Matx34f computeOpenCVCameraPinholeMatrix(const ITrackerInterface *tracker_device);
 static bool computeTrackerRelativeLightBarProjection(
     const CommonDeviceTrackingShape *tracking_shape,
     const t_opencv_float_contour &opencv_contour,
     CommonDeviceTrackingProjection *out_projection);
 static bool computeTrackerRelativeLightBarPose(
-    const ITrackerInterface *tracker_device,
+    const TrackerCameraModel &camera_model,
     const CommonDeviceTrackingShape *tracking_shape,
     const CommonDeviceTrackingProjection *projection,
     const CommonDevicePose *tracker_relative_pose_guess,
@@ -835,8 +1184,16 @@ ServerTrackerView::ServerTrackerView(const int device_id)
     : ServerDeviceView(device_id)
     , m_shared_memory_accesor(nullptr)
     , m_shared_memory_video_stream_count(0)
+    , m_shared_memory_overlay_stream_count(0)
     , m_opencv_buffer_state(nullptr)
+    , m_camera_model(new TrackerCameraModel)
     , m_device(nullptr)
+    , m_bInFastFrameMode(false)
+    , m_bFrameModeFixed(false)
+    , m_configured_frame_width(0.0)
+    , m_configured_frame_rate(0.0)
+    , m_frame_mode_switch_count(0)
+    , m_last_frame_mode_switch()
 {
     ServerUtility::format_string(m_shared_memory_name, sizeof(m_shared_memory_name), "tracker_view_%d", device_id);
 }
@@ -853,6 +1210,8 @@ ServerTrackerView::~ServerTrackerView()
         delete m_opencv_buffer_state;
     }
 
+    delete m_camera_model;
+
     if (m_device != nullptr)
     {
         delete m_device;
@@ -915,6 +1274,8 @@ bool ServerTrackerView::open(const class DeviceEnumerator *enumerator)
         {
             SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to video frame dimensions";
         }
+
+        rebuildCameraModel();
     }
 
     return bSuccess;
@@ -928,18 +1289,33 @@ void ServerTrackerView::close()
         m_shared_memory_accesor = nullptr;
     }
 
+    // The device comes back in its configured frame mode
+    m_bInFastFrameMode = false;
+    m_bFrameModeFixed = false;
+
     ServerDeviceView::close();
 }
 
-void ServerTrackerView::startSharedMemoryVideoStream()
+void ServerTrackerView::startSharedMemoryVideoStream(bool bIncludeDebugOverlay)
 {
     ++m_shared_memory_video_stream_count;
+
+    if (bIncludeDebugOverlay)
+    {
+        ++m_shared_memory_overlay_stream_count;
+    }
 }
 
-void ServerTrackerView::stopSharedMemoryVideoStream()
+void ServerTrackerView::stopSharedMemoryVideoStream(bool bIncludeDebugOverlay)
 {
     assert(m_shared_memory_video_stream_count > 0);
     --m_shared_memory_video_stream_count;
+
+    if (bIncludeDebugOverlay)
+    {
+        assert(m_shared_memory_overlay_stream_count > 0);
+        --m_shared_memory_overlay_stream_count;
+    }
 }
 
 bool ServerTrackerView::poll()
@@ -955,8 +1331,22 @@ bool ServerTrackerView::poll()
             // Cache the raw video frame
             if (m_opencv_buffer_state != nullptr)
             {
+                // The shared video frame is one buffer, so one client asking for the overlay draws it for everyone
+                m_opencv_buffer_state->setOverlayEnabled(
+                    m_shared_memory_accesor != nullptr && m_shared_memory_overlay_stream_count > 0);
                 m_opencv_buffer_state->writeVideoFrame(buffer);
             }
+
+            // Optionally capture the raw frame into an in-progress sensor session
+            SensorSessionRecorder *recorder = SensorSessionRecorder::getActiveRecorder();
+            if (recorder != nullptr && recorder->getIsRecordingVideoFrames())
+            {
+                int width, height, stride;
+                if (m_device->getVideoFrameDimensions(&width, &height, &stride))
+                {
+                    recorder->recordTrackerFrame(getDeviceID(), buffer, width, height, stride);
+                }
+            }
         }
     }
 
@@ -970,7 +1360,7 @@ bool ServerTrackerView::allocate_device_interface(const class DeviceEnumerator *
 	case CommonDeviceState::PS3EYE:
 	case CommonDeviceState::VirtualTracker:
 	{
-		m_device = new PS3EyeTracker();
+		m_device = new PS3EyeTracker(getDeviceID());
 	} break;
     default:
         break;
@@ -996,6 +1386,7 @@ void ServerTrackerView::publish_device_data_frame()
     // Copy the video frame to shared memory (if requested)
     if (m_shared_memory_accesor != nullptr && m_shared_memory_video_stream_count > 0)
     {
+        m_opencv_buffer_state->rasterizeOverlay();
         m_shared_memory_accesor->writeVideoFrame(m_opencv_buffer_state->bgrShmemBuffer->data);
     }
     
@@ -1034,6 +1425,7 @@ void ServerTrackerView::generate_tracker_data_frame_for_stream(
 void ServerTrackerView::loadSettings()
 {
     m_device->loadSettings();
+    rebuildCameraModel();
 }
 
 void ServerTrackerView::saveSettings()
@@ -1050,43 +1442,16 @@ void ServerTrackerView::setFrameWidth(double value, bool bUpdateConfig)
 {
     if (value == m_device->getFrameWidth()) return;
 
-    // close buffer
-    if (m_shared_memory_accesor != nullptr)
-    {
-        delete m_shared_memory_accesor;
-        m_shared_memory_accesor = nullptr;
-    }
+    // A manual change replaces whatever mode the automatic frame mode picked
+    m_bInFastFrameMode = false;
 
     // change frame width
     m_device->setFrameWidth(value, bUpdateConfig);
 
-    // reopen buffer
-    int width, height, stride;
+    // The intrinsics are scaled to the frame size
+    rebuildCameraModel();
 
-    // Make sure the shared memory block has been removed first
-    boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
-
-    // Query the video frame first so that we know how big to make the buffer
-    if (m_device->getVideoFrameDimensions(&width, &height, &stride))
-    {
-        assert(m_shared_memory_accesor == nullptr);
-        m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
-
-        if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
-        {
-            delete m_shared_memory_accesor;
-            m_shared_memory_accesor = nullptr;
-
-            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to allocated shared memory: " << m_shared_memory_name;
-        }
-
-        // Allocate the OpenCV scratch buffers used for finding tracking blobs
-        m_opencv_buffer_state = new OpenCVBufferState(m_device);
-    }
-    else
-    {
-        SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to video frame dimensions";
-    }
+    reallocateFrameBuffers();
 }
 
 double ServerTrackerView::getFrameHeight() const
@@ -1098,43 +1463,16 @@ void ServerTrackerView::setFrameHeight(double value, bool bUpdateConfig)
 {
     if (value == m_device->getFrameHeight()) return;
 
-    // close buffer
-    if (m_shared_memory_accesor != nullptr)
-    {
-        delete m_shared_memory_accesor;
-        m_shared_memory_accesor = nullptr;
-    }
+    // A manual change replaces whatever mode the automatic frame mode picked
+    m_bInFastFrameMode = false;
 
     // change frame height
     m_device->setFrameHeight(value, bUpdateConfig);
 
-    // reopen buffer
-    int width, height, stride;
-
-    // Make sure the shared memory block has been removed first
-    boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
-
-    // Query the video frame first so that we know how big to make the buffer
-    if (m_device->getVideoFrameDimensions(&width, &height, &stride))
-    {
-        assert(m_shared_memory_accesor == nullptr);
-        m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
-
-        if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
-        {
-            delete m_shared_memory_accesor;
-            m_shared_memory_accesor = nullptr;
-
-            SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to allocated shared memory: " << m_shared_memory_name;
-        }
+    // The intrinsics are scaled to the frame size
+    rebuildCameraModel();
 
-        // Allocate the OpenCV scratch buffers used for finding tracking blobs
-        m_opencv_buffer_state = new OpenCVBufferState(m_device);
-    }
-    else
-    {
-        SERVER_LOG_ERROR("ServerTrackerView::open()") << "Failed to video frame dimensions";
-    }
+    reallocateFrameBuffers();
 }
 
 double ServerTrackerView::getFrameRate() const
@@ -1142,11 +1480,81 @@ double ServerTrackerView::getFrameRate() const
     return m_device->getFrameRate();
 }
 
+void ServerTrackerView::getCaptureMetrics(
+	MetricCounterStats &out_captured_frames,
+	MetricCounterStats &out_dropped_frames) const
+{
+	m_device->getCaptureMetrics(out_captured_frames, out_dropped_frames);
+}
+
 void ServerTrackerView::setFrameRate(double value, bool bUpdateConfig)
 {
+    // A manual change replaces whatever mode the automatic frame mode picked
+    m_bInFastFrameMode = false;
+
     m_device->setFrameRate(value, bUpdateConfig);
 }
 
+void ServerTrackerView::updateAutoFrameMode(float max_close_and_fast_ratio)
+{
+    const TrackerManagerTunables &cfg = *DeviceManager::getInstance()->m_tracker_manager->getTunables();
+
+    if (!cfg.auto_frame_mode)
+    {
+        // Go back to the configured mode if the automatic mode was turned off while in the fast mode
+        if (m_bInFastFrameMode)
+        {
+            applyFrameMode(m_configured_frame_width, m_configured_frame_rate);
+            m_bInFastFrameMode = false;
+        }
+
+        return;
+    }
+
+    if (m_bFrameModeFixed)
+    {
+        return;
+    }
+
+    // Switching restarts the camera stream, don't flip back and forth
+    const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<float, std::milli> time_since_switch = now - m_last_frame_mode_switch;
+    if (m_frame_mode_switch_count > 0 && time_since_switch.count() < static_cast<float>(cfg.auto_frame_mode_hold_ms))
+    {
+        return;
+    }
+
+    if (!m_bInFastFrameMode)
+    {
+        // Close objects are still big enough to track at half resolution
+        if (max_close_and_fast_ratio >= 1.f &&
+            m_device->getFrameWidth() > k_fast_frame_mode_width)
+        {
+            m_configured_frame_width = m_device->getFrameWidth();
+            m_configured_frame_rate = m_device->getFrameRate();
+
+            if (applyFrameMode(k_fast_frame_mode_width, cfg.auto_frame_mode_fast_frame_rate))
+            {
+                m_bInFastFrameMode = true;
+            }
+            else
+            {
+                // Don't keep asking a camera that can't change its mode
+                m_bFrameModeFixed = true;
+            }
+        }
+    }
+    else
+    {
+        // Leave at half the thresholds we entered at
+        if (max_close_and_fast_ratio < 0.5f)
+        {
+            applyFrameMode(m_configured_frame_width, m_configured_frame_rate);
+            m_bInFastFrameMode = false;
+        }
+    }
+}
+
 double ServerTrackerView::getExposure() const
 {
     return m_device->getExposure();
@@ -1191,6 +1599,7 @@ void ServerTrackerView::setCameraIntrinsics(
         principalX, principalY,
         distortionK1, distortionK2, distortionK3,
         distortionP1, distortionP2);
+    rebuildCameraModel();
 }
 
 CommonDevicePose ServerTrackerView::getTrackerPose() const
@@ -1199,9 +1608,101 @@ CommonDevicePose ServerTrackerView::getTrackerPose() const
 }
 
 void ServerTrackerView::setTrackerPose(
-    const struct CommonDevicePose *pose)
+    const struct CommonDevicePose *pose,
+    bool bUpdateConfig)
+{
+    m_device->setTrackerPose(pose, bUpdateConfig);
+    rebuildCameraModel();
+}
+
+const TrackerCameraModel &ServerTrackerView::getCameraModel() const
 {
-    m_device->setTrackerPose(pose);
+    return *m_camera_model;
+}
+
+void ServerTrackerView::reallocateFrameBuffers()
+{
+    // close buffer
+    if (m_shared_memory_accesor != nullptr)
+    {
+        delete m_shared_memory_accesor;
+        m_shared_memory_accesor = nullptr;
+    }
+
+    if (m_opencv_buffer_state != nullptr)
+    {
+        delete m_opencv_buffer_state;
+        m_opencv_buffer_state = nullptr;
+    }
+
+    // reopen buffer
+    int width, height, stride;
+
+    // Make sure the shared memory block has been removed first
+    boost::interprocess::shared_memory_object::remove(m_shared_memory_name);
+
+    // Query the video frame first so that we know how big to make the buffer
+    if (m_device->getVideoFrameDimensions(&width, &height, &stride))
+    {
+        assert(m_shared_memory_accesor == nullptr);
+        m_shared_memory_accesor = new SharedVideoFrameReadWriteAccessor();
+
+        if (!m_shared_memory_accesor->initialize(m_shared_memory_name, width, height, stride))
+        {
+            delete m_shared_memory_accesor;
+            m_shared_memory_accesor = nullptr;
+
+            SERVER_LOG_ERROR("ServerTrackerView::reallocateFrameBuffers()") << "Failed to allocated shared memory: " << m_shared_memory_name;
+        }
+
+        // Allocate the OpenCV scratch buffers used for finding tracking blobs
+        m_opencv_buffer_state = new OpenCVBufferState(m_device);
+    }
+    else
+    {
+        SERVER_LOG_ERROR("ServerTrackerView::reallocateFrameBuffers()") << "Failed to video frame dimensions";
+    }
+}
+
+bool ServerTrackerView::applyFrameMode(double frame_width, double frame_rate)
+{
+    const double old_frame_width = m_device->getFrameWidth();
+    const double old_frame_height = m_device->getFrameHeight();
+    const double old_frame_rate = m_device->getFrameRate();
+
+    // Neither is saved to the config, the configured mode is what we come back to
+    m_device->setFrameWidth(frame_width, false);
+    m_device->setFrameRate(frame_rate, false);
+
+    // Read back what the camera actually runs at, some ignore the request
+    if (m_device->getFrameWidth() == old_frame_width &&
+        m_device->getFrameHeight() == old_frame_height &&
+        m_device->getFrameRate() == old_frame_rate)
+    {
+        return false;
+    }
+
+    // The intrinsics are scaled to the frame size
+    rebuildCameraModel();
+
+    reallocateFrameBuffers();
+
+    m_last_frame_mode_switch = std::chrono::high_resolution_clock::now();
+    ++m_frame_mode_switch_count;
+
+    SERVER_LOG_INFO("ServerTrackerView::applyFrameMode") <<
+        "Tracker " << getDeviceID() << " switched to " << m_device->getFrameWidth() << "x" << m_device->getFrameHeight() <<
+        " @ " << m_device->getFrameRate() << "fps (" << m_frame_mode_switch_count << " switches)";
+
+    return true;
+}
+
+void ServerTrackerView::rebuildCameraModel()
+{
+    if (m_device != nullptr)
+    {
+        m_camera_model->rebuild(m_device);
+    }
 }
 
 void ServerTrackerView::getPixelDimensions(float &outWidth, float &outHeight) const
@@ -1297,6 +1798,30 @@ void ServerTrackerView::getHMDTrackingColorPreset(
     return m_device->getTrackingColorPreset(hmd_id, color, out_preset);
 }
 
+void ServerTrackerView::captureColorCalibrationBackground()
+{
+    if (m_opencv_buffer_state != nullptr)
+    {
+        m_opencv_buffer_state->captureColorCalibrationBackground();
+    }
+}
+
+int ServerTrackerView::accumulateColorCalibrationHistogram(
+    const CommonHSVColorRange &search_range,
+    const int min_value_increase,
+    TrackerColorHistogram &histogram)
+{
+    int added_pixel_count = 0;
+
+    if (m_opencv_buffer_state != nullptr)
+    {
+        added_pixel_count =
+            m_opencv_buffer_state->accumulateColorCalibrationHistogram(search_range, min_value_increase, histogram);
+    }
+
+    return added_pixel_count;
+}
+
 bool
 ServerTrackerView::computeProjectionForController(
     const ServerControllerView* tracked_controller,
@@ -1322,10 +1847,12 @@ ServerTrackerView::computeProjectionForController(
     }
 
     // Compute a region of interest in the tracker buffer around where we expect to find the tracking shape
-    const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const TrackerManagerTunables &trackerMgrConfig= *DeviceManager::getInstance()->m_tracker_manager->getTunables();
 	const bool bRoiDisabled = tracked_controller->getIsROIDisabled() || trackerMgrConfig.disable_roi;
-	const bool bRoiOptimized = trackerMgrConfig.optimized_roi;
-	const int iRoiEdgeOffset = static_cast<int>(std::fmax(0, std::fmin(64, trackerMgrConfig.roi_edge_offset)));
+	const int iRoiEdgeOffset = trackerMgrConfig.roi_edge_offset;
+	const int iRoiSearchDownscale = trackerMgrConfig.roi_search_downscale;
+	// A downscaled search covers the whole frame in one go, so the ROI tiles aren't needed with it
+	const bool bRoiOptimized = trackerMgrConfig.optimized_roi && iRoiSearchDownscale <= 1;
 
     const ControllerOpticalPoseEstimation *priorPoseEst= 
         tracked_controller->getTrackerPoseEstimate(this->getDeviceID());
@@ -1334,17 +1861,29 @@ ServerTrackerView::computeProjectionForController(
 	const bool bIsOccluded = priorPoseEst->bIsOccluded;
 	const CommonDeviceScreenLocation mOcclusionAreaPos = priorPoseEst->occlusionAreaPos;
 	const float fOcclusionAreaSize = priorPoseEst->occlusionAreaSize;
+	const bool bHasPriorProjection = (bIsTracking || bIsOccluded) && !bEnforceNewROI;
 
     cv::Rect2i ROI= computeTrackerROIForPoseProjection(
 		(bRoiOptimized) ? tracked_controller->getDeviceID() : -1,
         bRoiDisabled,
 		iRoiEdgeOffset,
         this,		
-        ((bIsTracking || bIsOccluded) && !bEnforceNewROI) ? (tracked_controller->getPoseFilter()) : (nullptr),
-        ((bIsTracking || bIsOccluded) && !bEnforceNewROI) ? (&priorPoseEst->projection) : (nullptr),
+        (bHasPriorProjection) ? (tracked_controller->getPoseFilter()) : (nullptr),
+        (bHasPriorProjection) ? (&priorPoseEst->projection) : (nullptr),
         tracking_shape);
 
-    m_opencv_buffer_state->applyROI(ROI);
+    // Without a prior projection to go on the ROI spans the whole frame.
+    // Find the controller in a downscaled frame first and only segment around it at full resolution.
+    if (bSuccess && iRoiSearchDownscale > 1 && (bRoiDisabled || !bHasPriorProjection))
+    {
+        bSuccess = m_opencv_buffer_state->findCoarseSearchRegion(hsvColorRange, ROI, iRoiSearchDownscale, 1, ROI);
+    }
+
+    // Nothing to segment when the downscaled search came up empty
+    if (bSuccess)
+    {
+        m_opencv_buffer_state->applyROI(ROI);
+    }
 
     // Find the contour associated with the controller
     t_opencv_int_contour_list biggest_contours;
@@ -1357,13 +1896,18 @@ ServerTrackerView::computeProjectionForController(
     // Process the contour for its 2D and 3D pose.
     if (bSuccess)
     {
+        TrackingStageScope shape_fit_scope(TrackingStage_ShapeFit);
+
 		out_pose_estimate->bEnforceNewROI = false;
 
         // Get camera parameters.
         // Needed for undistortion.
-        cv::Matx33f camera_matrix;
-        cv::Matx<float, 5, 1> distortions;
-        computeOpenCVCameraIntrinsicMatrix(m_device, camera_matrix, distortions);
+        const cv::Matx33f &camera_matrix = m_camera_model->intrinsicMatrix;
+        const cv::Matx<float, 5, 1> &distortions = m_camera_model->distortionCoefficients;
+
+        // Only re-solves the undistortion when the intrinsics changed
+        UndistortionGrid &undistortion_grid = m_opencv_buffer_state->undistortionGrid;
+        undistortion_grid.update(camera_matrix, distortions, m_opencv_buffer_state->frameWidth, m_opencv_buffer_state->frameHeight);
                 
         // Compute the tracker relative 3d position of the controller from the contour
         switch (tracking_shape->shape_type)
@@ -1371,42 +1915,28 @@ ServerTrackerView::computeProjectionForController(
         // For the sphere projection we can go ahead and compute the full pose estimation now
         case eCommonTrackingShapeType::Sphere:
             {
-                // Compute the convex hull of the contour
-                t_opencv_int_contour convex_contour;
-                cv::convexHull(biggest_contours[0], convex_contour);
-                m_opencv_buffer_state->draw_contour(convex_contour);
-
-                // Convert integer to float
-                t_opencv_float_contour convex_contour_f;
-                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
-
-                // Undistort points
-                t_opencv_float_contour undistort_contour;  //destination for undistorted contour
-                cv::undistortPoints(convex_contour_f, undistort_contour,
-                                    camera_matrix,
-                                    distortions);//,
-                                    //cv::noArray(),
-                                    //camera_matrix);
-                // Note: if we omit the last two arguments, then
-                // undistort_contour points are in 'normalized' space.
+                // Spread a fixed number of sub-pixel edge points along the convex hull of the contour.
+                // Note: the points come out undistorted in 'normalized' space,
                 // i.e., they are relative to their F_PX,F_PY
+                SphereEdgeSampler &edge_sampler = m_opencv_buffer_state->sphereEdgeSampler;
+                const int edge_point_count =
+                    edge_sampler.sampleContour(biggest_contours[0], m_opencv_buffer_state->gsLowerROI, undistortion_grid);
+                m_opencv_buffer_state->draw_contour(edge_sampler.getConvexHull());
                 
                 // Compute the sphere center AND the projected ellipse
                 Eigen::Vector3f sphere_center;
                 EigenFitEllipse ellipse_projection;
+                ellipse_projection.clear();
 
-                std::vector<Eigen::Vector2f> eigen_contour;
-                std::for_each(undistort_contour.begin(),
-                              undistort_contour.end(),
-                              [&eigen_contour](cv::Point2f& p) {
-                                  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
-                              });
-                eigen_alignment_fit_focal_cone_to_sphere(eigen_contour.data(),
-                                                         static_cast<int>(eigen_contour.size()),
-                                                         tracking_shape->shape.sphere.radius_cm,
-                                                         1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
-                                                         &sphere_center,
-                                                         &ellipse_projection);
+                if (edge_point_count >= 3)
+                {
+                    eigen_alignment_fast_fit_focal_cone_to_sphere(edge_sampler.getNormalizedPoints(),
+                                                                  edge_point_count,
+                                                                  tracking_shape->shape.sphere.radius_cm,
+                                                                  1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
+                                                                  &sphere_center,
+                                                                  &ellipse_projection);
+                }
                 
                 if (ellipse_projection.area > k_real_epsilon)
                 {
@@ -1453,11 +1983,7 @@ ServerTrackerView::computeProjectionForController(
 
                 // Compute an undistorted version of the contour
                 t_opencv_float_contour undistort_contour;
-                cv::undistortPoints(biggest_contour_f, undistort_contour,
-                                    camera_matrix,
-                                    distortions,
-                                    cv::noArray(),
-                                    camera_matrix);
+                undistortion_grid.undistortPointsToPixels(biggest_contour_f, undistort_contour);
 
                 // Compute the lightbar tracking projection from the undistored contour
                 bSuccess=
@@ -1522,9 +2048,10 @@ bool ServerTrackerView::computeProjectionForHMD(
     }
     
     // Compute a region of interest in the tracker buffer around where we expect to find the tracking shape
-    const TrackerManagerConfig &trackerMgrConfig= DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const TrackerManagerTunables &trackerMgrConfig= *DeviceManager::getInstance()->m_tracker_manager->getTunables();
     const bool bRoiDisabled = tracked_hmd->getIsROIDisabled() || trackerMgrConfig.disable_roi;
-	const int iRoiEdgeOffset = static_cast<int>(std::fmax(0, std::fmin(64, trackerMgrConfig.roi_edge_offset)));
+	const int iRoiEdgeOffset = trackerMgrConfig.roi_edge_offset;
+	const int iRoiSearchDownscale = trackerMgrConfig.roi_search_downscale;
 
     const HMDOpticalPoseEstimation *priorPoseEst= 
         tracked_hmd->getTrackerPoseEstimate(this->getDeviceID());
@@ -1538,7 +2065,19 @@ bool ServerTrackerView::computeProjectionForHMD(
         bIsTracking ? tracked_hmd->getPoseFilter() : nullptr,
         bIsTracking ? &priorPoseEst->projection : nullptr,
         tracking_shape);
-    m_opencv_buffer_state->applyROI(ROI);
+
+    // Find all of the HMD's LEDs in a downscaled frame first when searching the whole frame
+    if (bSuccess && iRoiSearchDownscale > 1 && (bRoiDisabled || !bIsTracking))
+    {
+        bSuccess = 
+            m_opencv_buffer_state->findCoarseSearchRegion(
+                hsvColorRange, ROI, iRoiSearchDownscale, CommonDeviceTrackingProjection::MAX_POINT_CLOUD_POINT_COUNT, ROI);
+    }
+
+    if (bSuccess)
+    {
+        m_opencv_buffer_state->applyROI(ROI);
+    }
 
     // Find the N best contours associated with the HMD
     t_opencv_int_contour_list biggest_contours;
@@ -1553,51 +2092,40 @@ bool ServerTrackerView::computeProjectionForHMD(
     // Compute the tracker relative 3d position of the controller from the contour
     if (bSuccess)
     {
-        cv::Matx33f camera_matrix;
-        cv::Matx<float, 5, 1> distortions;
-        computeOpenCVCameraIntrinsicMatrix(m_device, camera_matrix, distortions);
+        const cv::Matx33f &camera_matrix = m_camera_model->intrinsicMatrix;
+        const cv::Matx<float, 5, 1> &distortions = m_camera_model->distortionCoefficients;
+
+        // Only re-solves the undistortion when the intrinsics changed
+        UndistortionGrid &undistortion_grid = m_opencv_buffer_state->undistortionGrid;
+        undistortion_grid.update(camera_matrix, distortions, m_opencv_buffer_state->frameWidth, m_opencv_buffer_state->frameHeight);
 
         switch (tracking_shape->shape_type)
         {
         // For the sphere projection we can go ahead and compute the full pose estimation now
         case eCommonTrackingShapeType::Sphere:
             {
-                // Compute the convex hull of the contour
-                t_opencv_int_contour convex_contour;
-                cv::convexHull(biggest_contours[0], convex_contour);
-                m_opencv_buffer_state->draw_contour(convex_contour);
-
-                // Convert integer to float
-                t_opencv_float_contour convex_contour_f;
-                cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
-
-                // Undistort points
-                t_opencv_float_contour undistorted_contour;  //destination for undistorted contour
-                cv::undistortPoints(convex_contour_f, undistorted_contour,
-                                    camera_matrix,
-                                    distortions);//,
-                                    //cv::noArray(),
-                                    //camera_matrix);
-                // Note: if we omit the last two arguments, then
-                // undistort_contour points are in 'normalized' space.
+                // Spread a fixed number of sub-pixel edge points along the convex hull of the contour.
+                // Note: the points come out undistorted in 'normalized' space,
                 // i.e., they are relative to their F_PX,F_PY
+                SphereEdgeSampler &edge_sampler = m_opencv_buffer_state->sphereEdgeSampler;
+                const int edge_point_count =
+                    edge_sampler.sampleContour(biggest_contours[0], m_opencv_buffer_state->gsLowerROI, undistortion_grid);
+                m_opencv_buffer_state->draw_contour(edge_sampler.getConvexHull());
                 
                 // Compute the sphere center AND the projected ellipse
                 Eigen::Vector3f sphere_center;
                 EigenFitEllipse ellipse_projection;
+                ellipse_projection.clear();
 
-                std::vector<Eigen::Vector2f> eigen_contour;
-                std::for_each(undistorted_contour.begin(),
-                              undistorted_contour.end(),
-                              [&eigen_contour](const cv::Point2f& p) {
-                                  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
-                              });
-                eigen_alignment_fit_focal_cone_to_sphere(eigen_contour.data(),
-                                                         static_cast<int>(eigen_contour.size()),
-                                                         tracking_shape->shape.sphere.radius_cm,
-                                                         1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
-                                                         &sphere_center,
-                                                         &ellipse_projection);
+                if (edge_point_count >= 3)
+                {
+                    eigen_alignment_fast_fit_focal_cone_to_sphere(edge_sampler.getNormalizedPoints(),
+                                                                  edge_point_count,
+                                                                  tracking_shape->shape.sphere.radius_cm,
+                                                                  1, //I was expecting this to be -1. Is it +1 because we're using -F_PY?
+                                                                  &sphere_center,
+                                                                  &ellipse_projection);
+                }
                 
                 if (ellipse_projection.area > k_real_epsilon)
                 {
@@ -1649,11 +2177,7 @@ bool ServerTrackerView::computeProjectionForHMD(
 
                     // Compute an undistorted version of the contour
                     t_opencv_float_contour undistort_contour;
-                    cv::undistortPoints(biggest_contour_f, undistort_contour,
-                        camera_matrix,
-                        distortions,
-                        cv::noArray(),
-                        camera_matrix);
+                    undistortion_grid.undistortPointsToPixels(biggest_contour_f, undistort_contour);
 
                     undistorted_contours.push_back(biggest_contour_f);
                 }
@@ -1698,7 +2222,7 @@ ServerTrackerView::computePoseForProjection(
         {
             bSuccess =
                 computeTrackerRelativeLightBarPose(
-                    m_device,
+                    *m_camera_model,
                     tracking_shape,
                     projection,
                     pose_guess,
@@ -1716,8 +2240,7 @@ ServerTrackerView::computeWorldPosition(
     const CommonDevicePosition *tracker_relative_position) const
 {
     const glm::vec4 rel_pos(tracker_relative_position->x, tracker_relative_position->y, tracker_relative_position->z, 1.f);
-    const glm::mat4 cameraTransform= computeGLMCameraTransformMatrix(m_device);
-    const glm::vec4 world_pos = cameraTransform * rel_pos;
+    const glm::vec4 world_pos = m_camera_model->cameraTransform * rel_pos;
     
     CommonDevicePosition result;
     result.set(world_pos.x, world_pos.y, world_pos.z);
@@ -1730,7 +2253,7 @@ ServerTrackerView::computeWorldOrientation(
     const CommonDeviceQuaternion *tracker_relative_orientation) const
 {
     // Compute a rotations that rotates from +X to global "forward"
-    const TrackerManagerConfig &cfg = DeviceManager::getInstance()->m_tracker_manager->getConfig();
+    const TrackerManagerTunables &cfg = *DeviceManager::getInstance()->m_tracker_manager->getTunables();
     const float global_forward_yaw_radians = cfg.global_forward_degrees*k_degrees_to_radians;
     const glm::quat global_forward_quat= glm::quat(glm::vec3(0.f, global_forward_yaw_radians, 0.f));
     
@@ -1739,7 +2262,7 @@ ServerTrackerView::computeWorldOrientation(
         tracker_relative_orientation->x,
         tracker_relative_orientation->y,
         tracker_relative_orientation->z);    
-    const glm::quat camera_quat= computeGLMCameraTransformQuaternion(m_device);
+    const glm::quat &camera_quat= m_camera_model->cameraOrientation;
     const glm::quat world_quat = global_forward_quat * camera_quat * rel_orientation;
     
     CommonDeviceQuaternion result;
@@ -1756,8 +2279,7 @@ ServerTrackerView::computeTrackerPosition(
     const CommonDevicePosition *world_relative_position) const
 {
     const glm::vec4 world_pos(world_relative_position->x, world_relative_position->y, world_relative_position->z, 1.f);
-    const glm::mat4 invCameraTransform= glm::inverse(computeGLMCameraTransformMatrix(m_device));
-    const glm::vec4 rel_pos = invCameraTransform * world_pos;
+    const glm::vec4 rel_pos = m_camera_model->invCameraTransform * world_pos;
     
     CommonDevicePosition result;
     result.set(rel_pos.x, rel_pos.y, rel_pos.z);
@@ -1774,7 +2296,7 @@ ServerTrackerView::computeTrackerOrientation(
         world_relative_orientation->x,
         world_relative_orientation->y,
         world_relative_orientation->z);    
-    const glm::quat camera_inv_quat= glm::conjugate(computeGLMCameraTransformQuaternion(m_device));
+    const glm::quat camera_inv_quat= glm::conjugate(m_camera_model->cameraOrientation);
     // combined_rotation = second_rotation * first_rotation;
     const glm::quat rel_quat = camera_inv_quat * world_orientation;
     
@@ -1859,8 +2381,8 @@ ServerTrackerView::triangulateWorldPose(
                 // Since the projection is planar and both trackers can see the projection
                 // it doesn't matter which tracker we use for the facing test.
                 {
-                    const CommonDevicePosition commonTrackerPosition= tracker->getTrackerPose().PositionCm;
-                    const Eigen::Vector3f trackerPosition(commonTrackerPosition.x, commonTrackerPosition.y, commonTrackerPosition.z);
+                    const glm::vec3 &glmTrackerPosition= tracker->getCameraModel().cameraPosition;
+                    const Eigen::Vector3f trackerPosition(glmTrackerPosition.x, glmTrackerPosition.y, glmTrackerPosition.z);
                     const Eigen::Vector3f centroidToTracker= trackerPosition - centroid;
 
                     if (centroidToTracker.dot(normal) < 0.f)
@@ -1885,9 +2407,9 @@ ServerTrackerView::triangulateWorldPose(
                     const Eigen::Vector3f right= mid_right_vertex - mid_left_vertex;
 
                     // Get the global definition of tracking space "forward" and "right"
-                    const TrackerManagerConfig &cfg= DeviceManager::getInstance()->m_tracker_manager->getConfig();
-                    const CommonDeviceVector &global_forward = cfg.get_global_forward_axis();
-                    const CommonDeviceVector &global_right = cfg.get_global_right_axis();
+                    const TrackerManagerTunables &cfg= *DeviceManager::getInstance()->m_tracker_manager->getTunables();
+                    const CommonDeviceVector &global_forward = cfg.global_forward_axis;
+                    const CommonDeviceVector &global_right = cfg.global_right_axis;
                     const Eigen::Vector3f eigen_global_forward(global_forward.i, global_forward.j, global_forward.k);
                     const Eigen::Vector3f eigen_global_right(global_right.i, global_right.j, global_right.k);
 
@@ -1928,6 +2450,101 @@ ServerTrackerView::triangulateWorldPose(
     return pose;
 }
 
+int
+ServerTrackerView::selectTriangulationPairs(
+    const ServerTrackerView * const *trackers,
+    const CommonDevicePosition *world_estimates,
+    const int tracker_count,
+    const int max_pairs,
+    const bool bExcludeOpposedTrackers,
+    TrackerTriangulationPair *out_pairs)
+{
+    const int max_triangulation_pairs = k_max_triangulation_pairs;
+    const int pair_limit =
+        (max_pairs > 0) ? std::min(max_pairs, max_triangulation_pairs) : max_triangulation_pairs;
+    int pair_count = 0;
+
+    for (int list_index = 0; list_index < tracker_count; ++list_index)
+    {
+        const TrackerCameraModel &camera = trackers[list_index]->getCameraModel();
+        const CommonDevicePosition &estimate = world_estimates[list_index];
+
+        for (int other_list_index = list_index + 1; other_list_index < tracker_count; ++other_list_index)
+        {
+            const TrackerCameraModel &other_camera = trackers[other_list_index]->getCameraModel();
+            const CommonDevicePosition &other_estimate = world_estimates[other_list_index];
+
+            // Trackers that can see each other are facing each other,
+            // so they see a device between them along nearly the same line
+            if (bExcludeOpposedTrackers &&
+                camera.isWorldPointInFrustum(other_camera.cameraPosition) &&
+                other_camera.isWorldPointInFrustum(camera.cameraPosition))
+            {
+                continue;
+            }
+
+            // Each tracker only gets the depth right to within a few cm on its own,
+            // but that's plenty to tell how the two rays to the device meet
+            const glm::vec3 world_guess(
+                (estimate.x + other_estimate.x)*0.5f,
+                (estimate.y + other_estimate.y)*0.5f,
+                (estimate.z + other_estimate.z)*0.5f);
+            const glm::vec3 ray = world_guess - camera.cameraPosition;
+            const glm::vec3 other_ray = world_guess - other_camera.cameraPosition;
+            const float distance = glm::length(ray);
+            const float other_distance = glm::length(other_ray);
+            const float focal_length = fabsf(camera.intrinsicMatrix(0, 0));
+            const float other_focal_length = fabsf(other_camera.intrinsicMatrix(0, 0));
+
+            if (distance <= k_real_epsilon || other_distance <= k_real_epsilon ||
+                focal_length <= k_real_epsilon || other_focal_length <= k_real_epsilon)
+            {
+                continue;
+            }
+
+            const float sin_angle = glm::length(glm::cross(ray, other_ray)) / (distance*other_distance);
+            if (sin_angle < k_min_triangulation_sin_angle)
+            {
+                continue;
+            }
+
+            // A pixel of error on a tracker moves its ray by about distance/focal_length at the device,
+            // which moves the triangulated point by that much over the sine of the angle between the rays.
+            // Score by the inverse of the worse of the two.
+            const float pixel_error = std::max(distance / focal_length, other_distance / other_focal_length);
+            float score = sin_angle / pixel_error;
+
+            // A guess outside of a frustum means at least one of the estimates is off,
+            // e.g. a reflection, so prefer the other pairs
+            if (!camera.isWorldPointInFrustum(world_guess) || !other_camera.isWorldPointInFrustum(world_guess))
+            {
+                score *= k_outside_frustum_score_scale;
+            }
+
+            if (pair_count == pair_limit && score <= out_pairs[pair_count - 1].score)
+            {
+                continue;
+            }
+
+            // Insert into the list sorted by descending score, dropping the worst pair when full
+            int insert_index = std::min(pair_count, pair_limit - 1);
+            while (insert_index > 0 && out_pairs[insert_index - 1].score < score)
+            {
+                out_pairs[insert_index] = out_pairs[insert_index - 1];
+                --insert_index;
+            }
+
+            out_pairs[insert_index].list_index = list_index;
+            out_pairs[insert_index].other_list_index = other_list_index;
+            out_pairs[insert_index].score = score;
+
+            pair_count = std::min(pair_count + 1, pair_limit);
+        }
+    }
+
+    return pair_count;
+}
+
 CommonDevicePosition
 ServerTrackerView::triangulateWorldPosition(
     const ServerTrackerView *tracker, 
@@ -1935,20 +2552,14 @@ ServerTrackerView::triangulateWorldPosition(
     const ServerTrackerView *other_tracker,
     const CommonDeviceScreenLocation *other_screen_location)
 {
-    float screenWidth, screenHeight;
-    tracker->getPixelDimensions(screenWidth, screenHeight);
-    
-    float otherScreenWidth, otherScreenHeight;
-    tracker->getPixelDimensions(otherScreenWidth, otherScreenHeight);
-
     cv::Mat projPoints1 = cv::Mat(cv::Point2f(screen_location->x, screen_location->y));
     cv::Mat projPoints2 = cv::Mat(cv::Point2f(other_screen_location->x, other_screen_location->y));
 
     // Compute the pinhole camera matrix for each tracker that allows you to raycast
     // from the tracker center in world space through the screen location, into the world
     // See: http://docs.opencv.org/2.4/modules/calib3d/doc/camera_calibration_and_3d_reconstruction.html
-    cv::Mat projMat1 = cv::Mat(computeOpenCVCameraPinholeMatrix(tracker->m_device));
-    cv::Mat projMat2 = cv::Mat(computeOpenCVCameraPinholeMatrix(other_tracker->m_device));
+    cv::Mat projMat1 = cv::Mat(tracker->m_camera_model->pinholeMatrix);
+    cv::Mat projMat2 = cv::Mat(other_tracker->m_camera_model->pinholeMatrix);
 
     // Triangulate the world position from the two cameras
     cv::Mat point3D(1, 1, CV_32FC4);
@@ -1973,12 +2584,6 @@ ServerTrackerView::triangulateWorldPositions(
     const int screen_location_count,
     CommonDevicePosition *out_result)
 {
-    float screenWidth, screenHeight;
-    tracker->getPixelDimensions(screenWidth, screenHeight);
-
-    float otherScreenWidth, otherScreenHeight;
-    tracker->getPixelDimensions(otherScreenWidth, otherScreenHeight);
-
     std::vector<cv::Point2f> projPoints1;
     std::vector<cv::Point2f> projPoints2;
     for (int point_index = 0; point_index < screen_location_count; ++point_index)
@@ -1993,8 +2598,8 @@ ServerTrackerView::triangulateWorldPositions(
     // Compute the pinhole camera matrix for each tracker that allows you to raycast
     // from the tracker center in world space through the screen location, into the world
     // See: http://docs.opencv.org/2.4/modules/calib3d/doc/camera_calibration_and_3d_reconstruction.html
-    cv::Mat projMat1 = cv::Mat(computeOpenCVCameraPinholeMatrix(tracker->m_device));
-    cv::Mat projMat2 = cv::Mat(computeOpenCVCameraPinholeMatrix(other_tracker->m_device));
+    cv::Mat projMat1 = cv::Mat(tracker->m_camera_model->pinholeMatrix);
+    cv::Mat projMat2 = cv::Mat(other_tracker->m_camera_model->pinholeMatrix);
 
     // Triangulate the world positions from the two cameras
     cv::Mat points3D(1, screen_location_count, CV_32FC4);
@@ -2016,9 +2621,8 @@ ServerTrackerView::triangulateWorldPositions(
 std::vector<CommonDeviceScreenLocation>
 ServerTrackerView::projectTrackerRelativePositions(const std::vector<CommonDevicePosition> &objectPositions) const
 {
-    cv::Matx33f camera_matrix;
-    cv::Matx<float, 5, 1> distortions;
-    computeOpenCVCameraIntrinsicMatrix(m_device, camera_matrix, distortions);
+    const cv::Matx33f &camera_matrix = m_camera_model->intrinsicMatrix;
+    const cv::Matx<float, 5, 1> &distortions = m_camera_model->distortionCoefficients;
     
     // Use the identity transform for tracker relative positions
     cv::Mat rvec(3, 1, cv::DataType<double>::type, double(0));
@@ -2062,72 +2666,6 @@ ServerTrackerView::projectTrackerRelativePosition(const CommonDevicePosition *tr
 
 
 // -- Tracker Utility Methods -----
-static glm::quat computeGLMCameraTransformQuaternion(const ITrackerInterface *tracker_device)
-{
-
-    const CommonDevicePose pose = tracker_device->getTrackerPose();
-    const CommonDeviceQuaternion &quat = pose.Orientation;
-
-    const glm::quat glm_quat(quat.w, quat.x, quat.y, quat.z);
-
-    return glm_quat;
-}
-
-static glm::mat4 computeGLMCameraTransformMatrix(const ITrackerInterface *tracker_device)
-{
-
-    const CommonDevicePose pose = tracker_device->getTrackerPose();
-    const CommonDeviceQuaternion &quat = pose.Orientation;
-    const CommonDevicePosition &pos = pose.PositionCm;
-
-    const glm::quat glm_quat(quat.w, quat.x, quat.y, quat.z);
-    const glm::vec3 glm_pos(pos.x, pos.y, pos.z);
-    const glm::mat4 glm_camera_xform = glm_mat4_from_pose(glm_quat, glm_pos);
-
-    return glm_camera_xform;
-}
-
-static void computeOpenCVCameraExtrinsicMatrix(const ITrackerInterface *tracker_device,
-                                               cv::Matx34f &out)
-{
-    // Extrinsic matrix is the inverse of the camera pose matrix
-    const glm::mat4 glm_camera_xform = computeGLMCameraTransformMatrix(tracker_device);
-    const glm::mat4 glm_mat = glm::inverse(glm_camera_xform);
-
-    out(0, 0) = glm_mat[0][0]; out(0, 1) = glm_mat[1][0]; out(0, 2) = glm_mat[2][0]; out(0, 3) = glm_mat[3][0];
-    out(1, 0) = glm_mat[0][1]; out(1, 1) = glm_mat[1][1]; out(1, 2) = glm_mat[2][1]; out(1, 3) = glm_mat[3][1];
-    out(2, 0) = glm_mat[0][2]; out(2, 1) = glm_mat[1][2]; out(2, 2) = glm_mat[2][2]; out(2, 3) = glm_mat[3][2];
-}
-
-static void computeOpenCVCameraIntrinsicMatrix(const ITrackerInterface *tracker_device,
-                                               cv::Matx33f &intrinsicOut,
-                                               cv::Matx<float, 5, 1> &distortionOut)
-{
-    tracker_device->getCameraIntrinsics(intrinsicOut(0, 0), intrinsicOut(1, 1),  //F_PX, F_PY
-                                        intrinsicOut(0, 2), intrinsicOut(1, 2), //PrincipalX, Y
-                                        distortionOut(0, 0), distortionOut(1, 0), distortionOut(4, 0), //K1, K2, K3
-                                        distortionOut(2, 0), distortionOut(3, 0));  //P1, P2
-    
-    intrinsicOut(1, 1) *= -1;  //Negate F_PY because the screen coordinate system has +Y down.
-
-    // Fill the rest of the matrix with corrext values.
-                                intrinsicOut(0, 1) = 0.f;
-    intrinsicOut(1, 0) = 0.f;
-    intrinsicOut(2, 0) = 0.f;   intrinsicOut(2, 1) = 0.f;   intrinsicOut(2, 2) = 1.f;
-}
-
-static cv::Matx34f computeOpenCVCameraPinholeMatrix(const ITrackerInterface *tracker_device)
-{
-    cv::Matx34f extrinsic_matrix;
-    computeOpenCVCameraExtrinsicMatrix(tracker_device, extrinsic_matrix);
-    cv::Matx33f intrinsic_matrix;
-    cv::Matx<float, 5, 1> distortion;
-    computeOpenCVCameraIntrinsicMatrix(tracker_device, intrinsic_matrix, distortion);
-    cv::Matx34f pinhole_matrix = intrinsic_matrix * extrinsic_matrix;
-
-    return pinhole_matrix;
-}
-
 static bool computeTrackerRelativeLightBarProjection(
     const CommonDeviceTrackingShape *tracking_shape,
     const t_opencv_float_contour &opencv_contour,
@@ -2210,7 +2748,7 @@ static bool computeTrackerRelativeLightBarProjection(
 }
 
 static bool computeTrackerRelativeLightBarPose(
-    const ITrackerInterface *tracker_device,
+    const TrackerCameraModel &camera_model,
     const CommonDeviceTrackingShape *tracking_shape,
     const CommonDeviceTrackingProjection *projection,
     const CommonDevicePose *tracker_relative_pose_guess,
@@ -2260,9 +2798,8 @@ static bool computeTrackerRelativeLightBarPose(
         }
 
         // Get the tracker "intrinsic" matrix that encodes the camera FOV
-        cv::Matx33f cvCameraMatrix;
-        cv::Matx<float, 5, 1> cvDistCoeffs;
-        computeOpenCVCameraIntrinsicMatrix(tracker_device, cvCameraMatrix, cvDistCoeffs);
+        const cv::Matx33f &cvCameraMatrix = camera_model.intrinsicMatrix;
+        const cv::Matx<float, 5, 1> &cvDistCoeffs = camera_model.distortionCoefficients;
 
         // Fill out the initial guess in OpenCV format for the contour pose
         // if a guess pose was provided
@@ -2406,7 +2943,6 @@ static cv::Rect2i computeTrackerROIForPoseProjection(
     const CommonDeviceTrackingShape *tracking_shape)
 {
 	static int roi_counter[TrackerManager::k_max_devices][ControllerManager::k_max_devices];
-	static int last_roi_center[TrackerManager::k_max_devices][ControllerManager::k_max_devices][2];
 
     // Get expected ROI
     // Default to full screen.
@@ -2613,9 +3149,17 @@ static cv::Rect2i computeTrackerROIForPoseProjection(
         }
 
         {
-			// The center of the ROI is the pixel projection center from last frame
+            // Where the filter puts the object now and at the time of the next frame
+            const double frame_rate = tracker->getFrameRate();
+            const float frame_time = (frame_rate > 0.0) ? static_cast<float>(1.0 / frame_rate) : 0.f;
+            const Eigen::Vector3f velocity_cm_per_sec = pose_filter->getVelocityCmPerSec();
+            const Eigen::Vector3f predicted_position_cm = position_cm + velocity_cm_per_sec*frame_time;
+            CommonDevicePosition predicted_world_position_cm;
+            predicted_world_position_cm.set(predicted_position_cm.x(), predicted_position_cm.y(), predicted_position_cm.z());
+
 			// The size of the ROI computed by projecting the bounding box 
-            std::vector<CommonDevicePosition> trps{ tl, br };
+            std::vector<CommonDevicePosition> trps{ 
+                tl, br, tracker_position_cm, tracker->computeTrackerPosition(&predicted_world_position_cm) };
             std::vector<CommonDeviceScreenLocation> screen_locs = tracker->projectTrackerRelativePositions(trps);
 
             const int proj_min_x = static_cast<int>(std::min(screen_locs[0].x, screen_locs[1].x));
@@ -2626,40 +3170,32 @@ static cv::Rect2i computeTrackerROIForPoseProjection(
             const int proj_width = proj_max_x - proj_min_x;
             const int proj_height = proj_max_y - proj_min_y;
 
-            const cv::Point2i roi_center(static_cast<int>(projection_pixel_center.x), static_cast<int>(projection_pixel_center.y));
-
             const int safe_proj_width = std::max(proj_width, k_min_roi_size);
             const int safe_proj_height = std::max(proj_height, k_min_roi_size);
 
-
-			// Increase ROI size if the projection is moving
-			// This help fast controller movements on lower tracker Hz
-			float scale_axis = 0.f;
-
-			if (roi_index > -1)
-			{
-				const float scale_x = static_cast<float>(fmax(0, abs(roi_center.x - last_roi_center[trackerId][roi_index][0]) - (k_min_roi_size / 3)) / fmax(1, fmax(safe_proj_width, safe_proj_height) / 2));
-				const float scale_y = static_cast<float>(fmax(0, abs(roi_center.y - last_roi_center[trackerId][roi_index][1]) - (k_min_roi_size / 3)) / fmax(1, fmax(safe_proj_width, safe_proj_height) / 2));
-
-				scale_axis = fmin(1.f, fmax(0.f, fmax(scale_x, scale_y)));
-			}
-
-            const cv::Point2i roi_top_left = roi_center + (cv::Point2i(-safe_proj_width, -safe_proj_height) * (1 + scale_axis));
-            const cv::Size2f roi_size(
-				static_cast<float>(2 * (safe_proj_width * (1 + scale_axis))),
-				static_cast<float>(2 * (safe_proj_height * (1 + scale_axis)))
-			);
-
-            ROI = cv::Rect2i(roi_top_left, roi_size);
+            // Pixels the object is expected to move by the next frame, from the filter velocity
+            const float motion_x = screen_locs[3].x - screen_locs[2].x;
+            const float motion_y = screen_locs[3].y - screen_locs[2].y;
+
+            // How far the filtered position is from last frame's measured projection.
+            // The filter doesn't expose its covariance, so this stands in for its position uncertainty.
+            const float uncertainty_x = fabsf(screen_locs[2].x - projection_pixel_center.x);
+            const float uncertainty_y = fabsf(screen_locs[2].y - projection_pixel_center.y);
+
+            // Center on where last frame's projection should be by the next frame.
+            // The ROI spans the projected size on either side, grown by the expected motion and the uncertainty.
+            const cv::Point2f roi_center(projection_pixel_center.x + motion_x, projection_pixel_center.y + motion_y);
+            const float roi_half_width = safe_proj_width + 0.5f*fabsf(motion_x) + k_roi_uncertainty_scale*uncertainty_x;
+            const float roi_half_height = safe_proj_height + 0.5f*fabsf(motion_y) + k_roi_uncertainty_scale*uncertainty_y;
+
+            ROI = cv::Rect2i(
+                static_cast<int>(roi_center.x - roi_half_width),
+                static_cast<int>(roi_center.y - roi_half_height),
+                static_cast<int>(2.f*roi_half_width),
+                static_cast<int>(2.f*roi_half_height));
         }
     }
 
-	if (roi_index > -1)
-	{
-		last_roi_center[trackerId][roi_index][0] = (ROI.x + (ROI.width / 2));
-		last_roi_center[trackerId][roi_index][1] = (ROI.y + (ROI.height / 2));
-	}
-
     return ROI;
 }
 
@@ -14,6 +14,26 @@ namespace PSMoveProtocol
 };
 
 // -- declarations -----
+/// Two trackers picked to triangulate a device from, by index into the tracker list
+struct TrackerTriangulationPair
+{
+    int list_index;
+    int other_list_index;
+    float score;
+};
+
+/// HSV histograms of the pixels lit up by a controller bulb, gathered by the automatic color calibration
+struct TrackerColorHistogram
+{
+    static const int k_hue_bin_count = 180; // OpenCV's 8-bit hue is in [0, 180)
+    static const int k_channel_bin_count = 256;
+
+    int hue[k_hue_bin_count];
+    int saturation[k_channel_bin_count];
+    int value[k_channel_bin_count];
+    int pixel_count;
+};
+
 class ServerTrackerView : public ServerDeviceView
 {
 public:
@@ -24,9 +44,10 @@ public:
     void close() override;
 
     // Starts or stops streaming of the video feed to the shared memory buffer.
-    // Keep a ref count of how many clients are following the stream.
-    void startSharedMemoryVideoStream();
-    void stopSharedMemoryVideoStream();
+    // Keep a ref count of how many clients are following the stream,
+    // and of how many of them want the tracking debug overlay drawn onto it.
+    void startSharedMemoryVideoStream(bool bIncludeDebugOverlay);
+    void stopSharedMemoryVideoStream(bool bIncludeDebugOverlay);
 
     // Fetch the next video frame and copy to shared memory
     bool poll() override;
@@ -57,6 +78,18 @@ public:
 	double getFrameRate() const;
 	void setFrameRate(double value, bool bUpdateConfig);
 
+	// Frames handed to the tracking pipeline and frames the camera replaced before they were taken
+	void getCaptureMetrics(MetricCounterStats &out_captured_frames, MetricCounterStats &out_dropped_frames) const;
+
+    // Drops to a low resolution, high frame rate mode while the tracked objects are close
+    // and moving fast, and goes back to the configured mode once they are far or slow again.
+    // max_close_and_fast_ratio is the largest, over the objects this tracker sees, of
+    // min(projection area in 640x480 pixels / near area, speed / fast speed).
+    // The fast mode is entered at 1 and left below 0.5.
+    void updateAutoFrameMode(float max_close_and_fast_ratio);
+    inline bool getIsInFastFrameMode() const { return m_bInFastFrameMode; }
+    inline int getFrameModeSwitchCount() const { return m_frame_mode_switch_count; }
+
     double getExposure() const;
     void setExposure(double value, bool bUpdateConfig);
 
@@ -102,6 +135,19 @@ public:
 		const int screen_location_count,
 		CommonDevicePosition *out_result);
 
+    /// Scores every pair of trackers that can see a device by how well conditioned triangulating
+    /// from that pair should be and writes the best max_pairs of them, best first, to out_pairs.
+    /// world_estimates are the device's world positions estimated by each tracker on its own.
+    /// A max_pairs of 0 keeps every usable pair. Returns the number of pairs written.
+    static const int k_max_triangulation_pairs = PSMOVESERVICE_MAX_TRACKER_COUNT*(PSMOVESERVICE_MAX_TRACKER_COUNT - 1)/2;
+    static int selectTriangulationPairs(
+        const ServerTrackerView * const *trackers,
+        const CommonDevicePosition *world_estimates,
+        const int tracker_count,
+        const int max_pairs,
+        const bool bExcludeOpposedTrackers,
+        TrackerTriangulationPair *out_pairs);
+
     /// Given screen projections on two different trackers, compute the triangulated world space location
     static CommonDevicePose triangulateWorldPose(
         const ServerTrackerView *tracker, const CommonDeviceTrackingProjection *tracker_relative_projection,
@@ -119,7 +165,10 @@ public:
         float distortionP1, float distortionP2);
 
     CommonDevicePose getTrackerPose() const;
-    void setTrackerPose(const struct CommonDevicePose *pose);
+    void setTrackerPose(const struct CommonDevicePose *pose, bool bUpdateConfig);
+
+    // Camera matrices and frustum derived from the current pose and intrinsics
+    const class TrackerCameraModel &getCameraModel() const;
 
     void getPixelDimensions(float &outWidth, float &outHeight) const;
     void getFOV(float &outHFOV, float &outVFOV) const;
@@ -138,7 +187,22 @@ public:
 	void setHMDTrackingColorPreset(const class ServerHMDView *controller, eCommonTrackingColorID color, const CommonHSVColorRange *preset);
 	void getHMDTrackingColorPreset(const class ServerHMDView *controller, eCommonTrackingColorID color, CommonHSVColorRange *out_preset) const;
 
+    // Automatic color calibration, see TrackerColorCalibrator.
+    // Takes the brightness of the current frame as the background with the bulb off,
+    // then adds the pixels of later frames that are inside search_range and at least
+    // min_value_increase brighter than that background to the histogram.
+    // Returns the number of pixels added.
+    void captureColorCalibrationBackground();
+    int accumulateColorCalibrationHistogram(
+        const CommonHSVColorRange &search_range,
+        const int min_value_increase,
+        TrackerColorHistogram &histogram);
+
 protected:
+    void rebuildCameraModel();
+    void reallocateFrameBuffers();
+    bool applyFrameMode(double frame_width, double frame_rate);
+
     bool allocate_device_interface(const class DeviceEnumerator *enumerator) override;
     void free_device_interface() override;
     void publish_device_data_frame() override;
@@ -150,8 +214,18 @@ private:
     char m_shared_memory_name[256];
     class SharedVideoFrameReadWriteAccessor *m_shared_memory_accesor;
     int m_shared_memory_video_stream_count;
+    int m_shared_memory_overlay_stream_count;
     class OpenCVBufferState *m_opencv_buffer_state;
+    class TrackerCameraModel *m_camera_model; // Rebuilt when the pose, intrinsics or frame size change
     ITrackerInterface *m_device;
+
+    // Automatic frame mode state
+    bool m_bInFastFrameMode;
+    bool m_bFrameModeFixed; // The camera ignored a frame mode switch (e.g. virtual trackers)
+    double m_configured_frame_width; // The mode to go back to when leaving the fast mode
+    double m_configured_frame_rate;
+    int m_frame_mode_switch_count;
+    std::chrono::time_point<std::chrono::high_resolution_clock> m_last_frame_mode_switch;
 };
 
 #endif // SERVER_TRACKER_VIEW_H
@@ -0,0 +1,279 @@
+#ifndef FIXED_SIZE_SRUKF_H
+#define FIXED_SIZE_SRUKF_H
+
+//-- includes -----
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <cmath>
+
+//-- definitions -----
+/// Square Root Unscented Kalman Filter specialized for compile-time state sizes.
+///
+/// This is a drop-in replacement for Kalman::SquareRootUnscentedKalmanFilter<StateType>
+/// (same init/predict/update/getState interface and the same system/measurement model types)
+/// that keeps every intermediate in fixed size Eigen storage so that a filter step never
+/// touches the heap. The scalar type is taken from the state vector so the same
+/// filter can run in single or double precision.
+///
+/// See "The Square-Root Unscented Kalman Filter for State and Parameter-Estimation" (van der Merwe & Wan)
+template<class StateType>
+class FixedSizeSRUKF
+{
+public:
+	typedef StateType State;
+	typedef typename StateType::Scalar T;
+
+	enum
+	{
+		StateSize = StateType::RowsAtCompileTime,
+		SigmaPointCount = 2 * StateSize + 1
+	};
+
+	/// Lower triangular square root of a covariance matrix
+	typedef Eigen::Matrix<T, StateSize, StateSize> StateSquareRoot;
+	typedef Eigen::Matrix<T, SigmaPointCount, 1> SigmaWeights;
+	typedef Eigen::Matrix<T, StateSize, SigmaPointCount> StateSigmaPoints;
+
+	FixedSizeSRUKF(T alpha = T(1), T beta = T(2), T kappa = T(0))
+	{
+		const T L = static_cast<T>(StateSize);
+		const T lambda = alpha*alpha*(L + kappa) - L;
+
+		m_gamma = std::sqrt(L + lambda);
+
+		// Weights for the mean (W_m) and covariance (W_c) reconstruction
+		const T W_m_0 = lambda / (L + lambda);
+		const T W_c_0 = W_m_0 + (T(1) - alpha*alpha + beta);
+		const T W_i = T(1) / (T(2) * (L + lambda));
+
+		m_sigma_weights_m[0] = W_m_0;
+		m_sigma_weights_c[0] = W_c_0;
+		for (int i = 1; i < SigmaPointCount; ++i)
+		{
+			m_sigma_weights_m[i] = W_i;
+			m_sigma_weights_c[i] = W_i;
+		}
+
+		x.setZero();
+		m_S.setIdentity();
+		m_sigma_state_points.setZero();
+		m_covariance_reset_count = 0;
+	}
+
+	void init(const State &initial_state)
+	{
+		x = initial_state;
+		m_S.setIdentity();
+	}
+
+	const State &getState() const { return x; }
+
+	/// Lower triangular square root of the state covariance
+	const StateSquareRoot &getCovarianceSquareRoot() const { return m_S; }
+
+	Eigen::Matrix<T, StateSize, StateSize> getCovariance() const
+	{
+		return m_S * m_S.transpose();
+	}
+
+	/// Number of times the covariance lost positive definiteness and was reset to identity
+	int getCovarianceResetCount() const { return m_covariance_reset_count; }
+
+	/// Advance the state with a zero control input
+	template<class SystemModelType>
+	const State &predict(const SystemModelType &s)
+	{
+		typename SystemModelType::Control u;
+		u.setZero();
+
+		return predict(s, u);
+	}
+
+	/// Advance the state using the system model f(x, u) and the process noise of the model
+	template<class SystemModelType, class ControlType>
+	const State &predict(const SystemModelType &s, const ControlType &u)
+	{
+		compute_sigma_points();
+
+		// Push every sigma point through the system model
+		for (int i = 0; i < SigmaPointCount; ++i)
+		{
+			const State sigma_state = m_sigma_state_points.col(i);
+
+			m_sigma_state_points.col(i) = s.f(sigma_state, u);
+		}
+
+		// Predicted state is the weighted mean of the transformed sigma points
+		x = m_sigma_state_points * m_sigma_weights_m;
+
+		const StateSquareRoot process_noise_sqrt = s.getCovarianceSquareRoot().matrixL();
+		if (!compute_covariance_square_root<StateSize>(x, m_sigma_state_points, process_noise_sqrt, m_S))
+		{
+			// Covariance lost positive definiteness. Restart from a unit covariance.
+			m_S.setIdentity();
+			++m_covariance_reset_count;
+		}
+
+		return x;
+	}
+
+	/// Correct the state with the measurement z using the measurement model h(x)
+	/// NOTE: Like Kalman::SquareRootUnscentedKalmanFilter this re-uses the sigma points
+	/// from the last predict() call rather than re-sampling after each update.
+	template<class MeasurementModelType, class MeasurementType>
+	const State &update(const MeasurementModelType &m, const MeasurementType &z)
+	{
+		enum { MeasurementSize = MeasurementType::RowsAtCompileTime };
+		typedef Eigen::Matrix<T, MeasurementSize, 1> MeasurementVector;
+		typedef Eigen::Matrix<T, MeasurementSize, MeasurementSize> MeasurementSquareRoot;
+		typedef Eigen::Matrix<T, MeasurementSize, SigmaPointCount> MeasurementSigmaPoints;
+		typedef Eigen::Matrix<T, StateSize, MeasurementSize> KalmanGain;
+
+		// Predict the measurement for every sigma point
+		MeasurementSigmaPoints sigma_measurement_points;
+		for (int i = 0; i < SigmaPointCount; ++i)
+		{
+			const State sigma_state = m_sigma_state_points.col(i);
+
+			sigma_measurement_points.col(i) = m.h(sigma_state);
+		}
+		const MeasurementVector y = sigma_measurement_points * m_sigma_weights_m;
+
+		// Square root of the innovation covariance
+		const MeasurementSquareRoot measurement_noise_sqrt = m.getCovarianceSquareRoot().matrixL();
+		MeasurementSquareRoot S_y;
+		if (!compute_covariance_square_root<MeasurementSize>(y, sigma_measurement_points, measurement_noise_sqrt, S_y))
+		{
+			// Can't form a valid innovation covariance so skip this measurement
+			return x;
+		}
+
+		// Cross covariance between the state and the measurement
+		const KalmanGain P_xy =
+			(m_sigma_state_points.colwise() - x)
+			* m_sigma_weights_c.asDiagonal()
+			* (sigma_measurement_points.colwise() - y).transpose();
+
+		// K = P_xy * (S_y * S_y^T)^-1, solved with two triangular solves
+		const Eigen::Matrix<T, MeasurementSize, StateSize> K_tmp =
+			S_y.template triangularView<Eigen::Lower>().solve(P_xy.transpose());
+		const KalmanGain K =
+			S_y.transpose().template triangularView<Eigen::Upper>().solve(K_tmp).transpose();
+
+		// Update the state
+		const MeasurementVector innovation = z - y;
+		x += K * innovation;
+
+		// Downdate the state covariance by each column of U = K * S_y
+		const KalmanGain U = K * S_y.template triangularView<Eigen::Lower>();
+		for (int i = 0; i < MeasurementSize; ++i)
+		{
+			if (!cholesky_rank_update<StateSize>(m_S, U.col(i), T(-1)))
+			{
+				m_S.setIdentity();
+				++m_covariance_reset_count;
+				break;
+			}
+		}
+
+		return x;
+	}
+
+protected:
+	void compute_sigma_points()
+	{
+		const StateSquareRoot scaled_S = m_gamma * m_S;
+
+		m_sigma_state_points.col(0) = x;
+		m_sigma_state_points.template block<StateSize, StateSize>(0, 1) = scaled_S.colwise() + x;
+		m_sigma_state_points.template block<StateSize, StateSize>(0, StateSize + 1) = (-scaled_S).colwise() + x;
+	}
+
+	/// Builds the lower triangular square root of the covariance of a set of sigma points
+	/// (plus additive noise) using a QR decomposition followed by a rank-1 update for the 0th point
+	template<int D>
+	bool compute_covariance_square_root(
+		const Eigen::Matrix<T, D, 1> &mean,
+		const Eigen::Matrix<T, D, SigmaPointCount> &sigma_points,
+		const Eigen::Matrix<T, D, D> &noise_sqrt,
+		Eigen::Matrix<T, D, D> &out_sqrt) const
+	{
+		typedef Eigen::Matrix<T, 2 * StateSize + D, D> CompoundMatrix;
+
+		CompoundMatrix compound;
+		compound.template topRows<2 * StateSize>() =
+			std::sqrt(m_sigma_weights_c[1])
+			* (sigma_points.template rightCols<SigmaPointCount - 1>().colwise() - mean).transpose();
+		compound.template bottomRows<D>() = noise_sqrt.transpose();
+
+		Eigen::HouseholderQR<CompoundMatrix> qr(compound);
+		out_sqrt = qr.matrixQR().template topRows<D>().template triangularView<Eigen::Upper>().transpose();
+
+		// The 0th sigma weight can be negative so it has to be applied as an up/down-date.
+		// Same signed square root weighting as Kalman::SquareRootUnscentedKalmanFilter
+		// so both implementations produce the same covariance.
+		const Eigen::Matrix<T, D, 1> deviation = sigma_points.col(0) - mean;
+		const T nu = std::copysign(std::sqrt(std::abs(m_sigma_weights_c[0])), m_sigma_weights_c[0]);
+
+		return cholesky_rank_update<D>(out_sqrt, deviation, nu);
+	}
+
+	/// In place rank-1 update of a lower triangular Cholesky factor: L*L^T + sigma*v*v^T
+	/// Returns false if the result would no longer be positive definite.
+	template<int D, typename VectorType>
+	static bool cholesky_rank_update(
+		Eigen::Matrix<T, D, D> &L,
+		const VectorType &v,
+		const T sigma)
+	{
+		Eigen::Matrix<T, D, 1> w = v;
+		T beta = T(1);
+
+		for (int j = 0; j < D; ++j)
+		{
+			const T Ljj = L(j, j);
+			const T wj = w[j];
+			const T swj2 = sigma*wj*wj;
+			const T gamma = Ljj*Ljj*beta + swj2;
+			const T x = Ljj*Ljj + swj2 / beta;
+
+			if (x <= T(0) || Ljj == T(0))
+			{
+				return false;
+			}
+
+			const T nLjj = std::sqrt(x);
+			L(j, j) = nLjj;
+			beta += swj2 / (Ljj*Ljj);
+
+			for (int i = j + 1; i < D; ++i)
+			{
+				w[i] -= (wj / Ljj) * L(i, j);
+				if (gamma != T(0))
+				{
+					L(i, j) = (nLjj / Ljj)*L(i, j) + (nLjj*sigma*wj / gamma)*w[i];
+				}
+			}
+		}
+
+		return true;
+	}
+
+protected:
+	/// Estimated state
+	State x;
+
+	/// Lower triangular square root of the state covariance
+	StateSquareRoot m_S;
+
+	/// Sigma points from the last predict() call
+	StateSigmaPoints m_sigma_state_points;
+
+	SigmaWeights m_sigma_weights_m;
+	SigmaWeights m_sigma_weights_c;
+	T m_gamma;
+
+	int m_covariance_reset_count;
+};
+
+#endif // FIXED_SIZE_SRUKF_H
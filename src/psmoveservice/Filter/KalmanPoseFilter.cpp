@@ -1,6 +1,8 @@
 //-- includes --
 #include "KalmanPoseFilter.h"
+#include "FixedSizeSRUKF.h"
 #include "MathAlignment.h"
+#include "ServerLog.h"
 
 #include <kalman/MeasurementModel.hpp>
 #include <kalman/SystemModel.hpp>
@@ -18,6 +20,18 @@
 //-- constants --
 #define MEASUREMENT_LED_COUNT   9
 
+// Scalar type the pose filter runs in.
+// Define KALMAN_POSE_FILTER_USE_FLOAT to run the whole filter in single precision.
+#ifdef KALMAN_POSE_FILTER_USE_FLOAT
+typedef float PoseReal;
+#else
+typedef double PoseReal;
+#endif
+
+typedef Eigen::Matrix<PoseReal, 3, 1> PoseVector3;
+typedef Eigen::Quaternion<PoseReal> PoseQuaternion;
+typedef Eigen::Transform<PoseReal, 3, Eigen::Affine> PoseAffine3;
+
 enum PoseFilterStateEnum
 {
     // Position State
@@ -99,6 +113,8 @@ enum PoseOpticalMeasurementEnum
 #define k_ukf_kappa -10.0 // 3 - POSE_STATE_PARAMETER_COUNT
 
 //-- private methods ---
+inline PoseVector3 pose_clockwise_rotate(const PoseQuaternion &q, const PoseVector3 &v);
+inline PoseQuaternion pose_angular_velocity_to_quaternion_derivative(const PoseQuaternion &q, const PoseVector3 &ang_vel);
 template <class StateType>
 void Q_discrete_1st_order_white_noise(const double dT, const double var, const int state_index, Kalman::Covariance<StateType> &Q);
 template <class StateType>
@@ -121,37 +137,37 @@ public:
     }
 
     // Accessors
-    Eigen::Vector3d get_position_meters() const { 
-        return Eigen::Vector3d((*this)[POSE_POSITION_X], (*this)[POSE_POSITION_Y], (*this)[POSE_POSITION_Z]); 
+    PoseVector3 get_position_meters() const { 
+        return PoseVector3((*this)[POSE_POSITION_X], (*this)[POSE_POSITION_Y], (*this)[POSE_POSITION_Z]); 
     }
-    Eigen::Vector3d get_linear_velocity_m_per_sec() const {
-        return Eigen::Vector3d((*this)[POSE_LINEAR_VELOCITY_X], (*this)[POSE_LINEAR_VELOCITY_Y], (*this)[POSE_LINEAR_VELOCITY_Z]);
+    PoseVector3 get_linear_velocity_m_per_sec() const {
+        return PoseVector3((*this)[POSE_LINEAR_VELOCITY_X], (*this)[POSE_LINEAR_VELOCITY_Y], (*this)[POSE_LINEAR_VELOCITY_Z]);
     }
-    Eigen::Vector3d get_linear_acceleration_m_per_sec_sqr() const {
-        return Eigen::Vector3d((*this)[POSE_LINEAR_ACCELERATION_X], (*this)[POSE_LINEAR_ACCELERATION_Y], (*this)[POSE_LINEAR_ACCELERATION_Z]);
+    PoseVector3 get_linear_acceleration_m_per_sec_sqr() const {
+        return PoseVector3((*this)[POSE_LINEAR_ACCELERATION_X], (*this)[POSE_LINEAR_ACCELERATION_Y], (*this)[POSE_LINEAR_ACCELERATION_Z]);
     }
-    Eigen::Quaterniond get_error_quaterniond() const {
-        return Eigen::Quaterniond((*this)[POSE_ERROR_QUATERNION_W], (*this)[POSE_ERROR_QUATERNION_X], (*this)[POSE_ERROR_QUATERNION_Y], (*this)[POSE_ERROR_QUATERNION_Z]);
+    PoseQuaternion get_error_quaternion() const {
+        return PoseQuaternion((*this)[POSE_ERROR_QUATERNION_W], (*this)[POSE_ERROR_QUATERNION_X], (*this)[POSE_ERROR_QUATERNION_Y], (*this)[POSE_ERROR_QUATERNION_Z]);
     }
 
     // Mutators
-    void set_position_meters(const Eigen::Vector3d &p) {
+    void set_position_meters(const PoseVector3 &p) {
         (*this)[POSE_POSITION_X] = p.x(); (*this)[POSE_POSITION_Y] = p.y(); (*this)[POSE_POSITION_Z] = p.z();
     }
-    void set_linear_velocity_m_per_sec(const Eigen::Vector3d &v) {
+    void set_linear_velocity_m_per_sec(const PoseVector3 &v) {
         (*this)[POSE_LINEAR_VELOCITY_X] = v.x(); (*this)[POSE_LINEAR_VELOCITY_Y] = v.y(); (*this)[POSE_LINEAR_VELOCITY_Z] = v.z();
     }
-    void set_linear_acceleration_m_per_sec_sqr(const Eigen::Vector3d &a) {
+    void set_linear_acceleration_m_per_sec_sqr(const PoseVector3 &a) {
         (*this)[POSE_LINEAR_ACCELERATION_X] = a.x(); (*this)[POSE_LINEAR_ACCELERATION_Y] = a.y(); (*this)[POSE_LINEAR_ACCELERATION_Z] = a.z();
     }
-    void set_error_quaterniond(const Eigen::Quaterniond &q) {
+    void set_error_quaternion(const PoseQuaternion &q) {
         (*this)[POSE_ERROR_QUATERNION_W] = q.w();
         (*this)[POSE_ERROR_QUATERNION_X] = q.x();
         (*this)[POSE_ERROR_QUATERNION_Y] = q.y();
         (*this)[POSE_ERROR_QUATERNION_Z] = q.z();
     }
 };
-typedef PoseStateVector<double> PoseStateVectord;
+typedef PoseStateVector<PoseReal> PoseStateVectorReal;
 
 template<typename T>
 class PoseControlVector : public Kalman::Vector<T, POSE_CONTROL_PARAMETER_COUNT>
@@ -160,18 +176,18 @@ public:
 	KALMAN_VECTOR(PoseControlVector, T, POSE_CONTROL_PARAMETER_COUNT)
 
 	// Accessors
-	Eigen::Vector3d get_angular_rates() const {
-		return Eigen::Vector3d((*this)[POSE_CONTROL_GYROSCOPE_PITCH], (*this)[POSE_CONTROL_GYROSCOPE_YAW], (*this)[POSE_CONTROL_GYROSCOPE_ROLL]);
+	PoseVector3 get_angular_rates() const {
+		return PoseVector3((*this)[POSE_CONTROL_GYROSCOPE_PITCH], (*this)[POSE_CONTROL_GYROSCOPE_YAW], (*this)[POSE_CONTROL_GYROSCOPE_ROLL]);
 	}
 
 	// Mutators
-	void set_angular_rates(const Eigen::Vector3d &v) {
+	void set_angular_rates(const PoseVector3 &v) {
 		(*this)[POSE_CONTROL_GYROSCOPE_PITCH] = v.x();
 		(*this)[POSE_CONTROL_GYROSCOPE_YAW] = v.y();
 		(*this)[POSE_CONTROL_GYROSCOPE_ROLL] = v.z();
 	}
 };
-typedef PoseControlVector<double> PoseControlVectord;
+typedef PoseControlVector<PoseReal> PoseControlVectorReal;
 
 /**
 * @brief System model for a controller
@@ -179,16 +195,16 @@ typedef PoseControlVector<double> PoseControlVectord;
 * This is the system model defining how a controller advances from one
 * time-step to the next, i.e. how the system state evolves over time.
 */
-class PoseSystemModel : public Kalman::SystemModel<PoseStateVectord, PoseControlVectord, Kalman::SquareRootBase>
+class PoseSystemModel : public Kalman::SystemModel<PoseStateVectorReal, PoseControlVectorReal, Kalman::SquareRootBase>
 {
 public:
-    inline void set_time_step(const double dt) { m_time_step = dt; }
+    inline void set_time_step(const PoseReal dt) { m_time_step = dt; }
 
     void init(const PoseFilterConstants &constants)
     {
         use_linear_acceleration = constants.position_constants.use_linear_acceleration;
         m_last_tracking_projection_area_px_sqr = -1.f;
-		m_gyro_bias = constants.orientation_constants.gyro_drift.cast<double>();
+		m_gyro_bias = constants.orientation_constants.gyro_drift.cast<PoseReal>();
         update_process_noise(constants, 0.f);
     }
 
@@ -220,14 +236,14 @@ public:
                 k_centimeters_to_meters*k_centimeters_to_meters*position_variance_cm_sqr;
 
             // Initialize the process covariance matrix Q
-            Kalman::Covariance<PoseStateVectord> Q = Kalman::Covariance<PoseStateVectord>::Zero();
-            Q_discrete_3rd_order_white_noise<PoseStateVectord>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_X, Q);
-            Q_discrete_3rd_order_white_noise<PoseStateVectord>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_Y, Q);
-            Q_discrete_3rd_order_white_noise<PoseStateVectord>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_Z, Q);
-			Q_discrete_1st_order_white_noise<PoseStateVectord>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_W, Q);
-			Q_discrete_1st_order_white_noise<PoseStateVectord>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_X, Q);
-			Q_discrete_1st_order_white_noise<PoseStateVectord>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_Y, Q);
-			Q_discrete_1st_order_white_noise<PoseStateVectord>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_Z, Q);
+            Kalman::Covariance<PoseStateVectorReal> Q = Kalman::Covariance<PoseStateVectorReal>::Zero();
+            Q_discrete_3rd_order_white_noise<PoseStateVectorReal>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_X, Q);
+            Q_discrete_3rd_order_white_noise<PoseStateVectorReal>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_Y, Q);
+            Q_discrete_3rd_order_white_noise<PoseStateVectorReal>(mean_position_dT, position_variance_m_sqr, POSE_POSITION_Z, Q);
+			Q_discrete_1st_order_white_noise<PoseStateVectorReal>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_W, Q);
+			Q_discrete_1st_order_white_noise<PoseStateVectorReal>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_X, Q);
+			Q_discrete_1st_order_white_noise<PoseStateVectorReal>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_Y, Q);
+			Q_discrete_1st_order_white_noise<PoseStateVectorReal>(mean_orientation_dT, orientation_variance, POSE_ERROR_QUATERNION_Z, Q);
             setCovariance(Q);
 
             // Keep track last tracking projection area we built the covariance matrix for
@@ -247,25 +263,25 @@ public:
     * @param [in] u The control vector input
     * @returns The (predicted) system state in the next time-step
     */
-    PoseStateVectord f(const PoseStateVectord& old_state, const PoseControlVectord& control) const
+    PoseStateVectorReal f(const PoseStateVectorReal& old_state, const PoseControlVectorReal& control) const
     {
         // Predicted state vector after transition
-        PoseStateVectord new_state;
+        PoseStateVectorReal new_state;
 
         // Extract parameters from the old state
-        const Eigen::Vector3d old_position_meters = old_state.get_position_meters();
-        const Eigen::Vector3d old_linear_velocity_m_per_sec = old_state.get_linear_velocity_m_per_sec();
-        const Eigen::Vector3d old_linear_acceleration_m_per_sec_sqr = old_state.get_linear_acceleration_m_per_sec_sqr();
+        const PoseVector3 old_position_meters = old_state.get_position_meters();
+        const PoseVector3 old_linear_velocity_m_per_sec = old_state.get_linear_velocity_m_per_sec();
+        const PoseVector3 old_linear_acceleration_m_per_sec_sqr = old_state.get_linear_acceleration_m_per_sec_sqr();
 
         // Extract parameters from the old state
-        const Eigen::Quaterniond error_q_old = old_state.get_error_quaterniond();
+        const PoseQuaternion error_q_old = old_state.get_error_quaternion();
 
 		// Compute the true angular rate from the control vector
-		const Eigen::Vector3d omega = control - m_gyro_bias;
+		const PoseVector3 omega = control - m_gyro_bias;
 
         // Compute the position state update
-        Eigen::Vector3d new_position_meters;
-        Eigen::Vector3d new_linear_velocity_m_per_sec;
+        PoseVector3 new_position_meters;
+        PoseVector3 new_linear_velocity_m_per_sec;
         if (use_linear_acceleration)
         {
             new_position_meters =
@@ -287,13 +303,13 @@ public:
                 : old_linear_velocity_m_per_sec;
         }
 
-        const Eigen::Vector3d &new_linear_acceleration_m_per_sec_sqr = old_linear_acceleration_m_per_sec_sqr;
+        const PoseVector3 &new_linear_acceleration_m_per_sec_sqr = old_linear_acceleration_m_per_sec_sqr;
 
 		// Compute the quaternion derivative of the current state
 		// q_new= q + q_dot*dT
-		const Eigen::Quaterniond q_dot = eigen_angular_velocity_to_quaterniond_derivative(error_q_old, omega);
-		const Eigen::Quaterniond error_q_step = Eigen::Quaterniond(q_dot.coeffs() * m_time_step);
-		const Eigen::Quaterniond error_q_new = Eigen::Quaterniond(error_q_old.coeffs() + error_q_step.coeffs());
+		const PoseQuaternion q_dot = pose_angular_velocity_to_quaternion_derivative(error_q_old, omega);
+		const PoseQuaternion error_q_step = PoseQuaternion(q_dot.coeffs() * m_time_step);
+		const PoseQuaternion error_q_new = PoseQuaternion(error_q_old.coeffs() + error_q_step.coeffs());
 
         // Save results to the new state
         new_state.set_position_meters(new_position_meters);
@@ -301,23 +317,31 @@ public:
         new_state.set_linear_acceleration_m_per_sec_sqr(new_linear_acceleration_m_per_sec_sqr);
 
         // Save results to the new state
-        new_state.set_error_quaterniond(error_q_new.normalized());
+        new_state.set_error_quaternion(error_q_new.normalized());
 
         return new_state;
     }
 
 protected:
     bool use_linear_acceleration;
-    double m_time_step;
+    PoseReal m_time_step;
     float m_last_tracking_projection_area_px_sqr;
-	Eigen::Vector3d m_gyro_bias;
+	PoseVector3 m_gyro_bias;
 };
 
-class PoseSRUKF : public Kalman::SquareRootUnscentedKalmanFilter<PoseStateVectord>
+// The fixed size SRUKF keeps every filter step off the heap.
+// Define KALMAN_POSE_FILTER_USE_GENERIC_SRUKF to fall back to the mherb/kalman implementation.
+#ifdef KALMAN_POSE_FILTER_USE_GENERIC_SRUKF
+typedef Kalman::SquareRootUnscentedKalmanFilter<PoseStateVectorReal> PoseSRUKFBase;
+#else
+typedef FixedSizeSRUKF<PoseStateVectorReal> PoseSRUKFBase;
+#endif
+
+class PoseSRUKF : public PoseSRUKFBase
 {
 public:
-    PoseSRUKF(double alpha = 1.0, double beta = 2.0, double kappa = 0.0)
-        : Kalman::SquareRootUnscentedKalmanFilter<PoseStateVectord>(alpha, beta, kappa)
+    PoseSRUKF(PoseReal alpha = 1.0, PoseReal beta = 2.0, PoseReal kappa = 0.0)
+        : PoseSRUKFBase(alpha, beta, kappa)
     {
     }
 
@@ -325,6 +349,48 @@ public:
     {
         return x;
     }
+
+#ifndef KALMAN_POSE_FILTER_USE_GENERIC_SRUKF
+    template<class SystemModelType>
+    const State &predict(const SystemModelType &s)
+    {
+        const int last_reset_count = m_covariance_reset_count;
+        PoseSRUKFBase::predict(s);
+        warn_on_covariance_reset(last_reset_count, "predict");
+
+        return x;
+    }
+
+    template<class SystemModelType, class ControlType>
+    const State &predict(const SystemModelType &s, const ControlType &u)
+    {
+        const int last_reset_count = m_covariance_reset_count;
+        PoseSRUKFBase::predict(s, u);
+        warn_on_covariance_reset(last_reset_count, "predict");
+
+        return x;
+    }
+
+    template<class MeasurementModelType, class MeasurementType>
+    const State &update(const MeasurementModelType &m, const MeasurementType &z)
+    {
+        const int last_reset_count = m_covariance_reset_count;
+        PoseSRUKFBase::update(m, z);
+        warn_on_covariance_reset(last_reset_count, "update");
+
+        return x;
+    }
+
+private:
+    void warn_on_covariance_reset(const int last_reset_count, const char *step) const
+    {
+        if (m_covariance_reset_count != last_reset_count)
+        {
+            SERVER_LOG_WARNING("PoseSRUKF") << "Covariance lost positive definiteness in " << step
+                << ", reset to identity (" << m_covariance_reset_count << " resets so far)";
+        }
+    }
+#endif
 };
 
 template<typename T>
@@ -334,26 +400,26 @@ public:
 	KALMAN_VECTOR(PoseGravMeasurementVector, T, POSE_G_MEASUREMENT_PARAMETER_COUNT)
 
 		// Accessors
-		Eigen::Vector3d get_accelerometer() const {
-		return Eigen::Vector3d((*this)[POSE_ACCELEROMETER_X], (*this)[POSE_ACCELEROMETER_Y], (*this)[POSE_ACCELEROMETER_Z]);
+		PoseVector3 get_accelerometer() const {
+		return PoseVector3((*this)[POSE_ACCELEROMETER_X], (*this)[POSE_ACCELEROMETER_Y], (*this)[POSE_ACCELEROMETER_Z]);
 	}
 
 	// Mutators
-	void set_accelerometer(const Eigen::Vector3d &a) {
+	void set_accelerometer(const PoseVector3 &a) {
 		(*this)[POSE_ACCELEROMETER_X] = a.x(); (*this)[POSE_ACCELEROMETER_Y] = a.y(); (*this)[POSE_ACCELEROMETER_Z] = a.z();
 	}
 };
-typedef PoseGravMeasurementVector<double> PoseGravMeasurementVectord;
+typedef PoseGravMeasurementVector<PoseReal> PoseGravMeasurementVectorReal;
 
 class PoseGravMeasurementModel :
-	public Kalman::MeasurementModel<PoseStateVectord, PoseGravMeasurementVectord, Kalman::SquareRootBase>
+	public Kalman::MeasurementModel<PoseStateVectorReal, PoseGravMeasurementVectorReal, Kalman::SquareRootBase>
 {
 public:
-	void init(const OrientationFilterConstants &constants, const Eigen::Quaterniond *last_world_orientation_ptr)
+	void init(const OrientationFilterConstants &constants, const PoseQuaternion *last_world_orientation_ptr)
 	{
 		// Update the measurement covariance R
-		Kalman::Covariance<PoseGravMeasurementVectord> R =
-			Kalman::Covariance<PoseGravMeasurementVectord>::Zero();
+		Kalman::Covariance<PoseGravMeasurementVectorReal> R =
+			Kalman::Covariance<PoseGravMeasurementVectorReal>::Zero();
 
 		// Only diagonals used so no need to compute Cholesky
 		static float r_accelerometer_scale = R_SCALE;
@@ -362,7 +428,7 @@ public:
 		R(POSE_ACCELEROMETER_Z, POSE_ACCELEROMETER_Z) = r_accelerometer_scale*constants.accelerometer_variance.z();
 		setCovariance(R);
 
-		identity_gravity_direction = constants.gravity_calibration_direction.cast<double>();
+		identity_gravity_direction = constants.gravity_calibration_direction.cast<PoseReal>();
 		m_last_world_orientation_ptr = last_world_orientation_ptr;
 	}
 
@@ -376,25 +442,25 @@ public:
 	* @param [in] x The system state in current time-step
 	* @returns The (predicted) sensor measurement for the system state
 	*/
-	PoseGravMeasurementVectord h(const PoseStateVectord& x) const
+	PoseGravMeasurementVectorReal h(const PoseStateVectorReal& x) const
 	{
-		PoseGravMeasurementVectord predicted_measurement;
+		PoseGravMeasurementVectorReal predicted_measurement;
 
 		// Use the orientation + linear acceleration state from the state for prediction
-		const Eigen::Quaterniond error_orientation = x.get_error_quaterniond();
-		const Eigen::Quaterniond world_to_local_orientation = 
+		const PoseQuaternion error_orientation = x.get_error_quaternion();
+		const PoseQuaternion world_to_local_orientation = 
 			eigen_quaternion_concatenate(*m_last_world_orientation_ptr, error_orientation).normalized();
 
 		// Convert the world space linear acceleration in the state into a local space predicted measurement in the accelerometer 
-		const Eigen::Vector3d world_linear_accel_g_units = x.get_linear_acceleration_m_per_sec_sqr() * k_ms2_to_g_units;
-		const Eigen::Vector3d local_linear_accel_g_units = eigen_vector3d_clockwise_rotate(world_to_local_orientation, world_linear_accel_g_units);
+		const PoseVector3 world_linear_accel_g_units = x.get_linear_acceleration_m_per_sec_sqr() * k_ms2_to_g_units;
+		const PoseVector3 local_linear_accel_g_units = pose_clockwise_rotate(world_to_local_orientation, world_linear_accel_g_units);
 
 		// Convert the world space gravitational acceleration in the state into a local space predicted measurement in the accelerometer 
-		const Eigen::Vector3d &world_gravity_accel_g_units = identity_gravity_direction;
-		const Eigen::Vector3d local_gravity_accel_g_units = eigen_vector3d_clockwise_rotate(world_to_local_orientation, world_gravity_accel_g_units);
+		const PoseVector3 &world_gravity_accel_g_units = identity_gravity_direction;
+		const PoseVector3 local_gravity_accel_g_units = pose_clockwise_rotate(world_to_local_orientation, world_gravity_accel_g_units);
 		
 		// Combine the linear and gravitational accelerometer predictions into the final predicted accelerometer reading
-		const Eigen::Vector3d accel_local = local_linear_accel_g_units + local_gravity_accel_g_units;
+		const PoseVector3 accel_local = local_linear_accel_g_units + local_gravity_accel_g_units;
 
 		// Save the predictions into the measurement vector
 		predicted_measurement.set_accelerometer(accel_local);
@@ -403,8 +469,8 @@ public:
 	}
 
 public:
-	Eigen::Vector3d identity_gravity_direction;
-	const Eigen::Quaterniond *m_last_world_orientation_ptr;
+	PoseVector3 identity_gravity_direction;
+	const PoseQuaternion *m_last_world_orientation_ptr;
 };
 
 template<typename T>
@@ -414,32 +480,32 @@ public:
 	KALMAN_VECTOR(PoseMagGravMeasurementVector, T, POSE_MG_MEASUREMENT_PARAMETER_COUNT)
 
 	// Accessors
-	Eigen::Vector3d get_accelerometer() const {
-		return Eigen::Vector3d((*this)[POSE_ACCELEROMETER_X], (*this)[POSE_ACCELEROMETER_Y], (*this)[POSE_ACCELEROMETER_Z]);
+	PoseVector3 get_accelerometer() const {
+		return PoseVector3((*this)[POSE_ACCELEROMETER_X], (*this)[POSE_ACCELEROMETER_Y], (*this)[POSE_ACCELEROMETER_Z]);
 	}
-	Eigen::Vector3d get_magnetometer() const {
-		return Eigen::Vector3d((*this)[POSE_MAGNETOMETER_X], (*this)[POSE_MAGNETOMETER_Y], (*this)[POSE_MAGNETOMETER_Z]);
+	PoseVector3 get_magnetometer() const {
+		return PoseVector3((*this)[POSE_MAGNETOMETER_X], (*this)[POSE_MAGNETOMETER_Y], (*this)[POSE_MAGNETOMETER_Z]);
 	}
 
 	// Mutators
-	void set_accelerometer(const Eigen::Vector3d &a) {
+	void set_accelerometer(const PoseVector3 &a) {
 		(*this)[POSE_ACCELEROMETER_X] = a.x(); (*this)[POSE_ACCELEROMETER_Y] = a.y(); (*this)[POSE_ACCELEROMETER_Z] = a.z();
 	}
-	void set_magnetometer(const Eigen::Vector3d &m) {
+	void set_magnetometer(const PoseVector3 &m) {
 		(*this)[POSE_MAGNETOMETER_X] = m.x(); (*this)[POSE_MAGNETOMETER_Y] = m.y(); (*this)[POSE_MAGNETOMETER_Z] = m.z();
 	}
 };
-typedef PoseMagGravMeasurementVector<double> PoseMagGravMeasurementVectord;
+typedef PoseMagGravMeasurementVector<PoseReal> PoseMagGravMeasurementVectorReal;
 
 class PoseMagGravMeasurementModel :
-	public Kalman::MeasurementModel<PoseStateVectord, PoseMagGravMeasurementVectord, Kalman::SquareRootBase>
+	public Kalman::MeasurementModel<PoseStateVectorReal, PoseMagGravMeasurementVectorReal, Kalman::SquareRootBase>
 {
 public:
-	void init(const OrientationFilterConstants &constants, const Eigen::Quaterniond *last_world_orientation_ptr)
+	void init(const OrientationFilterConstants &constants, const PoseQuaternion *last_world_orientation_ptr)
 	{
 		// Update the measurement covariance R
-		Kalman::Covariance<PoseMagGravMeasurementVectord> R =
-			Kalman::Covariance<PoseMagGravMeasurementVectord>::Zero();
+		Kalman::Covariance<PoseMagGravMeasurementVectorReal> R =
+			Kalman::Covariance<PoseMagGravMeasurementVectorReal>::Zero();
 
 		// Only diagonals used so no need to compute Cholesky
 		static float r_accelerometer_scale = R_SCALE;
@@ -452,8 +518,8 @@ public:
 		R(POSE_MAGNETOMETER_Z, POSE_MAGNETOMETER_Z) = r_magnetometer_scale*constants.magnetometer_variance.z();
 		setCovariance(R);
 
-		identity_gravity_direction = constants.gravity_calibration_direction.cast<double>();
-		identity_magnetometer_direction = constants.magnetometer_calibration_direction.cast<double>();
+		identity_gravity_direction = constants.gravity_calibration_direction.cast<PoseReal>();
+		identity_magnetometer_direction = constants.magnetometer_calibration_direction.cast<PoseReal>();
 		m_last_world_orientation_ptr = last_world_orientation_ptr;
 	}
 
@@ -467,30 +533,30 @@ public:
 	* @param [in] x The system state in current time-step
 	* @returns The (predicted) sensor measurement for the system state
 	*/
-	PoseMagGravMeasurementVectord h(const PoseStateVectord& x) const
+	PoseMagGravMeasurementVectorReal h(const PoseStateVectorReal& x) const
 	{
-		PoseMagGravMeasurementVectord predicted_measurement;
+		PoseMagGravMeasurementVectorReal predicted_measurement;
 
 		// Use the orientation + linear acceleration state from the state for prediction
-		const Eigen::Quaterniond error_orientation = x.get_error_quaterniond();
-		const Eigen::Quaterniond world_to_local_orientation = 
+		const PoseQuaternion error_orientation = x.get_error_quaternion();
+		const PoseQuaternion world_to_local_orientation = 
 			eigen_quaternion_concatenate(*m_last_world_orientation_ptr, error_orientation).normalized();
 
 		// Convert the world space linear acceleration in the state into a local space predicted measurement in the accelerometer 
-		const Eigen::Vector3d world_linear_accel_g_units = x.get_linear_acceleration_m_per_sec_sqr() * k_ms2_to_g_units;
-		const Eigen::Vector3d local_linear_accel_g_units = eigen_vector3d_clockwise_rotate(world_to_local_orientation, world_linear_accel_g_units);
+		const PoseVector3 world_linear_accel_g_units = x.get_linear_acceleration_m_per_sec_sqr() * k_ms2_to_g_units;
+		const PoseVector3 local_linear_accel_g_units = pose_clockwise_rotate(world_to_local_orientation, world_linear_accel_g_units);
 
 		// Convert the world space gravitational acceleration in the state into a local space predicted measurement in the accelerometer 
-		const Eigen::Vector3d &world_gravity_accel_g_units = identity_gravity_direction;
-		const Eigen::Vector3d local_gravity_accel_g_units = eigen_vector3d_clockwise_rotate(world_to_local_orientation, world_gravity_accel_g_units);
+		const PoseVector3 &world_gravity_accel_g_units = identity_gravity_direction;
+		const PoseVector3 local_gravity_accel_g_units = pose_clockwise_rotate(world_to_local_orientation, world_gravity_accel_g_units);
 
 		// Combine the linear and gravitational accelerometer predictions into the final predicted accelerometer reading
-		const Eigen::Vector3d accel_local = local_linear_accel_g_units + local_gravity_accel_g_units;
+		const PoseVector3 accel_local = local_linear_accel_g_units + local_gravity_accel_g_units;
 
 		// Use the orientation from the state to predict
 		// what the magnetometer reading should be (in the space of the controller)
-		const Eigen::Vector3d &mag_world = identity_magnetometer_direction;
-		const Eigen::Vector3d mag_local = eigen_vector3d_clockwise_rotate(world_to_local_orientation, mag_world);
+		const PoseVector3 &mag_world = identity_magnetometer_direction;
+		const PoseVector3 mag_local = pose_clockwise_rotate(world_to_local_orientation, mag_world);
 
 		// Save the predictions into the measurement vector
 		predicted_measurement.set_accelerometer(accel_local);
@@ -500,10 +566,10 @@ public:
 	}
 
 public:
-	Eigen::Vector3d identity_gravity_direction;
-	Eigen::Vector3d identity_magnetometer_direction;
-	const Eigen::Quaterniond *m_last_world_orientation_ptr;
-	//Eigen::Vector3d m_last_world_linear_acceleration_m_per_sec_sqr;
+	PoseVector3 identity_gravity_direction;
+	PoseVector3 identity_magnetometer_direction;
+	const PoseQuaternion *m_last_world_orientation_ptr;
+	//PoseVector3 m_last_world_linear_acceleration_m_per_sec_sqr;
 };
 
 template<typename T>
@@ -513,21 +579,21 @@ public:
     KALMAN_VECTOR(PoseLEDMeasurementVector, T, POSE_LED_MEASUREMENT_PARAMETER_COUNT)
 
     // Accessors
-    Eigen::Vector3d get_LED_position_meters() const {
-        return Eigen::Vector3d(
+    PoseVector3 get_LED_position_meters() const {
+        return PoseVector3(
                 (*this)[POSE_LED_POSITION_X], 
                 (*this)[POSE_LED_POSITION_Y],
                 (*this)[POSE_LED_POSITION_Z]);
     }
 
     // Mutators
-    void set_LED_position_meters(const Eigen::Vector3d &p) {
+    void set_LED_position_meters(const PoseVector3 &p) {
         (*this)[POSE_LED_POSITION_X] = p.x();
 		(*this)[POSE_LED_POSITION_Y] = p.y();
 		(*this)[POSE_LED_POSITION_Z] = p.z();
     }
 };
-typedef PoseLEDMeasurementVector<double> PoseLEDMeasurementVectord;
+typedef PoseLEDMeasurementVector<PoseReal> PoseLEDMeasurementVectorReal;
 
 /**
 * @brief LED Measurement model for measuring PSVR controller
@@ -536,10 +602,10 @@ typedef PoseLEDMeasurementVector<double> PoseLEDMeasurementVectord;
 * The measurement is given by the optical trackers.
 */
 class PoseLEDMeasurementModel : 
-    public Kalman::MeasurementModel<PoseStateVectord, PoseLEDMeasurementVectord, Kalman::SquareRootBase>
+    public Kalman::MeasurementModel<PoseStateVectorReal, PoseLEDMeasurementVectorReal, Kalman::SquareRootBase>
 {
 public:
-    void init(const PoseFilterConstants &constants, int led_index, const Eigen::Quaterniond *last_world_orientation)
+    void init(const PoseFilterConstants &constants, int led_index, const PoseQuaternion *last_world_orientation)
     {
         m_last_world_orientation_ptr = last_world_orientation;
 		m_last_tracking_projection_area_px_sqr = -1.f;
@@ -551,7 +617,7 @@ public:
 
 		// LED model is in centimeters while filter is in meters
         m_LED_model_vertex= 
-			Eigen::Vector3d(
+			PoseVector3(
 				static_cast<double>(p.x * k_centimeters_to_meters),
 				static_cast<double>(p.y * k_centimeters_to_meters),
 				static_cast<double>(p.z * k_centimeters_to_meters));
@@ -577,7 +643,7 @@ public:
 			// Update the measurement covariance R
             // Only diagonals used so no need to compute Cholesky
             static float r_position_scale = R_SCALE;
-			Kalman::Covariance<PoseLEDMeasurementVectord> R = Kalman::Covariance<PoseLEDMeasurementVectord>::Zero();
+			Kalman::Covariance<PoseLEDMeasurementVectorReal> R = Kalman::Covariance<PoseLEDMeasurementVectorReal>::Zero();
 			R(POSE_LED_POSITION_X, POSE_LED_POSITION_X) = fmax(r_position_scale*position_variance_m_sqr, R_MIN);
 			R(POSE_LED_POSITION_Y, POSE_LED_POSITION_Y) = fmax(r_position_scale*position_variance_m_sqr, R_MIN);
 			R(POSE_LED_POSITION_Z, POSE_LED_POSITION_Z) = fmax(r_position_scale*position_variance_m_sqr, R_MIN);
@@ -598,29 +664,29 @@ public:
     * @param [in] x The system state in current time-step
     * @returns The (predicted) sensor measurement for the system state
     */
-    PoseLEDMeasurementVectord h(const PoseStateVectord& x) const
+    PoseLEDMeasurementVectorReal h(const PoseStateVectorReal& x) const
     {
-		PoseLEDMeasurementVectord predicted_measurement;
+		PoseLEDMeasurementVectorReal predicted_measurement;
 
         // Use the position and orientation from the state for predictions
-        const Eigen::Vector3d position_meters= x.get_position_meters();
-        const Eigen::Quaterniond error_orientation = x.get_error_quaterniond();
-        const Eigen::Quaterniond local_to_world_orientation = 
+        const PoseVector3 position_meters= x.get_position_meters();
+        const PoseQuaternion error_orientation = x.get_error_quaternion();
+        const PoseQuaternion local_to_world_orientation = 
 			eigen_quaternion_concatenate(*m_last_world_orientation_ptr, error_orientation).normalized();
 
 		//predicted_measurement.set_optical_orientation(local_to_world_orientation);
 		//predicted_measurement.set_optical_position_meters(position_meters);
         // Compute where we expect to find the tracking LEDs
-        Eigen::Affine3d local_to_world= Eigen::Affine3d::Identity();
+        PoseAffine3 local_to_world= PoseAffine3::Identity();
         local_to_world.linear()= local_to_world_orientation.toRotationMatrix();
         local_to_world.translation()= x.get_position_meters();
 
-		const Eigen::Vector3d led_model_vertex=
-			Eigen::Vector3d(
+		const PoseVector3 led_model_vertex=
+			PoseVector3(
 				m_LED_model_vertex.x(),
 				m_LED_model_vertex.y(),
 				m_LED_model_vertex.z());
-        const Eigen::Vector3d predicted_led_position= local_to_world * led_model_vertex;
+        const PoseVector3 predicted_led_position= local_to_world * led_model_vertex;
 
         predicted_measurement.set_LED_position_meters(predicted_led_position);
 
@@ -628,8 +694,8 @@ public:
     }
 
 public:
-    Eigen::Vector3d m_LED_model_vertex; // in meters!
-    const Eigen::Quaterniond *m_last_world_orientation_ptr;
+    PoseVector3 m_LED_model_vertex; // in meters!
+    const PoseQuaternion *m_last_world_orientation_ptr;
     double m_time_step;
 	float m_last_tracking_projection_area_px_sqr;
 };
@@ -641,8 +707,8 @@ public:
 	KALMAN_VECTOR(PoseOrientationMeasurementVector, T, POSE_OPTICAL_MEASUREMENT_PARAMETER_COUNT)
 
     // Accessors
-	Eigen::Quaterniond get_optical_quaterniond() const {
-		return Eigen::Quaterniond(
+	PoseQuaternion get_optical_quaternion() const {
+		return PoseQuaternion(
 			(*this)[POSE_OPTICAL_QUATERNION_W], 
 			(*this)[POSE_OPTICAL_QUATERNION_X],
 			(*this)[POSE_OPTICAL_QUATERNION_Y], 
@@ -650,20 +716,20 @@ public:
 	}
 
     // Mutators
-	void set_optical_quaterniond(const Eigen::Quaterniond &q) {
+	void set_optical_quaternion(const PoseQuaternion &q) {
 		(*this)[POSE_OPTICAL_QUATERNION_W] = q.w();
 		(*this)[POSE_OPTICAL_QUATERNION_X] = q.x();
 		(*this)[POSE_OPTICAL_QUATERNION_Y] = q.y();
 		(*this)[POSE_OPTICAL_QUATERNION_Z] = q.z();
 	}
 };
-typedef PoseOrientationMeasurementVector<double> PoseOrientationMeasurementVectord;
+typedef PoseOrientationMeasurementVector<PoseReal> PoseOrientationMeasurementVectorReal;
 
 class PoseOrientationMeasurementModel
-	: public Kalman::MeasurementModel<PoseStateVectord, PoseOrientationMeasurementVectord, Kalman::SquareRootBase>
+	: public Kalman::MeasurementModel<PoseStateVectorReal, PoseOrientationMeasurementVectorReal, Kalman::SquareRootBase>
 {
 public:
-	void init(const OrientationFilterConstants &constants, const Eigen::Quaterniond *last_world_orientation)
+	void init(const OrientationFilterConstants &constants, const PoseQuaternion *last_world_orientation)
 	{
 		m_last_tracking_projection_area = -1.f;
 		m_last_world_orientation_ptr= last_world_orientation;
@@ -679,8 +745,8 @@ public:
 			!is_nearly_equal(tracking_projection_area, m_last_tracking_projection_area, 10.f))
 		{
 			// Update the measurement covariance R
-			Kalman::Covariance<PoseOrientationMeasurementVectord> R =
-				Kalman::Covariance<PoseOrientationMeasurementVectord>::Zero();
+			Kalman::Covariance<PoseOrientationMeasurementVectorReal> R =
+				Kalman::Covariance<PoseOrientationMeasurementVectorReal>::Zero();
 			const float orientation_variance = constants.orientation_variance_curve.evaluate(tracking_projection_area);
 
 			static float r_scale = R_SCALE;
@@ -705,24 +771,24 @@ public:
 	* @param [in] x The system state in current time-step
 	* @returns The (predicted) sensor measurement for the system state
 	*/
-	PoseOrientationMeasurementVectord h(const PoseStateVectord& x) const
+	PoseOrientationMeasurementVectorReal h(const PoseStateVectorReal& x) const
 	{
-		PoseOrientationMeasurementVectord predicted_measurement;
+		PoseOrientationMeasurementVectorReal predicted_measurement;
 
 		// Use the orientation from the state for prediction
-		const Eigen::Quaterniond error_orientation = x.get_error_quaterniond();
-		const Eigen::Quaterniond world_to_local_orientation = 
+		const PoseQuaternion error_orientation = x.get_error_quaternion();
+		const PoseQuaternion world_to_local_orientation = 
 			eigen_quaternion_concatenate(*m_last_world_orientation_ptr, error_orientation).normalized();
 
 		// Save the predictions into the measurement vector
-		predicted_measurement.set_optical_quaterniond(world_to_local_orientation);
+		predicted_measurement.set_optical_quaternion(world_to_local_orientation);
 
 		return predicted_measurement;
 	}
 
 public:
 	float m_last_tracking_projection_area;
-	const Eigen::Quaterniond *m_last_world_orientation_ptr;
+	const PoseQuaternion *m_last_world_orientation_ptr;
 };
 
 
@@ -754,7 +820,7 @@ public:
     /// This isn't part of the UKF state vector because it's non-linear.
     /// Instead we store an "error quaternion" in the UKF state vector and then apply it 
     /// to this quaternion after a time step and then zero out the error.
-    Eigen::Quaterniond world_orientation;
+    PoseQuaternion world_orientation;
 
     KalmanPoseFilterImpl()
         : bIsValid(false)
@@ -772,11 +838,11 @@ public:
         bSeenOrientationMeasurement = false;
         bSeenPositionMeasurement= false;
 
-        world_orientation = Eigen::Quaterniond::Identity();
+        world_orientation = PoseQuaternion::Identity();
         origin_position_meters = Eigen::Vector3f::Zero();
 
         system_model.init(constants);
-        ukf.init(PoseStateVectord::Identity());
+        ukf.init(PoseStateVectorReal::Identity());
     }
 
     virtual void init(
@@ -789,29 +855,29 @@ public:
         bSeenPositionMeasurement= true;
 
         origin_position_meters = Eigen::Vector3f::Zero();
-        world_orientation = orientation.cast<double>();
+        world_orientation = orientation.cast<PoseReal>();
 
-        PoseStateVectord state_vector = PoseStateVectord::Identity();
-        state_vector.set_position_meters(initial_position_meters.cast<double>());
+        PoseStateVectorReal state_vector = PoseStateVectorReal::Identity();
+        state_vector.set_position_meters(initial_position_meters.cast<PoseReal>());
 
         system_model.init(constants);
-        ukf.init(PoseStateVectord::Identity());
+        ukf.init(PoseStateVectorReal::Identity());
         apply_error_to_world_quaternion();
     }
 
     // -- World Quaternion Accessors --
-    inline Eigen::Quaterniond compute_net_world_quaternion() const
+    inline PoseQuaternion compute_net_world_quaternion() const
     {
-        const Eigen::Quaterniond error_quaternion= ukf.getState().get_error_quaterniond();
-        const Eigen::Quaterniond output_quaternion = eigen_quaternion_concatenate(world_orientation, error_quaternion).normalized();
+        const PoseQuaternion error_quaternion= ukf.getState().get_error_quaternion();
+        const PoseQuaternion output_quaternion = eigen_quaternion_concatenate(world_orientation, error_quaternion).normalized();
         return output_quaternion;
     }
 
     // -- World Quaternion Mutators --
-    inline void set_world_quaternion(const Eigen::Quaterniond &orientation)
+    inline void set_world_quaternion(const PoseQuaternion &orientation)
     {
         world_orientation = orientation;
-        ukf.getStateMutable().set_error_quaterniond(Eigen::Quaterniond::Identity());
+        ukf.getStateMutable().set_error_quaternion(PoseQuaternion::Identity());
     }
 
     void apply_error_to_world_quaternion()
@@ -1062,8 +1128,8 @@ void KalmanPoseFilter::resetState()
 
 void KalmanPoseFilter::recenterOrientation(const Eigen::Quaternionf& q_pose)
 {
-    m_filter->world_orientation = q_pose.cast<double>();
-    m_filter->ukf.init(PoseStateVectord::Identity());
+    m_filter->world_orientation = q_pose.cast<PoseReal>();
+    m_filter->ukf.init(PoseStateVectorReal::Identity());
 }
 
 Eigen::Quaternionf KalmanPoseFilter::getOrientation(float time) const
@@ -1093,7 +1159,7 @@ Eigen::Quaternionf KalmanPoseFilter::getOrientation(float time) const
 
 Eigen::Vector3f KalmanPoseFilter::getAngularVelocityRadPerSec() const
 {
-	Eigen::Vector3d ang_vel = Eigen::Vector3d::Zero(); //m_filter->ukf.getState().get_angular_velocity_rad_per_sec();
+	PoseVector3 ang_vel = PoseVector3::Zero(); //m_filter->ukf.getState().get_angular_velocity_rad_per_sec();
 
     return ang_vel.cast<float>();
 }
@@ -1124,14 +1190,14 @@ Eigen::Vector3f KalmanPoseFilter::getPositionCm(float time) const
 
 Eigen::Vector3f KalmanPoseFilter::getVelocityCmPerSec() const
 {
-	Eigen::Vector3d vel= m_filter->ukf.getState().get_linear_velocity_m_per_sec() * k_meters_to_centimeters;
+	PoseVector3 vel= m_filter->ukf.getState().get_linear_velocity_m_per_sec() * k_meters_to_centimeters;
 
     return vel.cast<float>();
 }
 
 Eigen::Vector3f KalmanPoseFilter::getAccelerationCmPerSecSqr() const
 {
-    Eigen::Vector3d accel= m_filter->ukf.getState().get_linear_acceleration_m_per_sec_sqr() * k_meters_to_centimeters;
+    PoseVector3 accel= m_filter->ukf.getState().get_linear_acceleration_m_per_sec_sqr() * k_meters_to_centimeters;
 
 	return accel.cast<float>();
 }
@@ -1185,7 +1251,7 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 			// If this is the first time we have seen the position, snap the position state
 			if (!m_filter->bSeenPositionMeasurement)
 			{
-				const Eigen::Vector3d optical_position_meters = packet.get_optical_position_in_meters().cast<double>();
+				const PoseVector3 optical_position_meters = packet.get_optical_position_in_meters().cast<PoseReal>();
 
 				m_filter->ukf.getStateMutable().set_position_meters(optical_position_meters);
 				m_filter->bSeenPositionMeasurement = true;
@@ -1194,7 +1260,7 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 			// If this is the first time we have seen the orientation, snap the orientation state
 			if (!m_filter->bSeenOrientationMeasurement)
 			{
-				const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+				const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 				filter->set_world_quaternion(world_quaternion);
 				m_filter->bSeenOrientationMeasurement = true;
@@ -1204,8 +1270,8 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 		// Apply a physics update to the filter state
 		if (packet.has_imu_measurements())
 		{
-			PoseControlVectord control;
-			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<double>());
+			PoseControlVectorReal control;
+			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<PoseReal>());
 
 			filter->ukf.predict(filter->system_model, control);
 		}
@@ -1218,7 +1284,7 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 		if (packet.has_optical_measurement())
 		{
 			assert(packet.tracking_projection_area_px_sqr > 0.f);
-			const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+			const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 			//TODO: Port over point area and shape point index
 			//for (int model_led_index = 0; model_led_index < packet.optical_tracking_shape_cm.shape.pointcloud.point_count; ++model_led_index)
@@ -1234,9 +1300,9 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 			//		PoseLEDMeasurementModel *led_model= filter->led_measurement_models[model_led_index];
 			//		led_model->updateMeasurementCovariance(m_constants, led_screen_area);
 
-			//		PoseLEDMeasurementVectord led_measurement = PoseLEDMeasurementVectord::Zero();
+			//		PoseLEDMeasurementVectorReal led_measurement = PoseLEDMeasurementVectorReal::Zero();
 			//		led_measurement.set_LED_position_meters(
-			//			Eigen::Vector3d(
+			//			PoseVector3(
 			//				static_cast<double>(p.x * k_centimeters_to_meters), 
 			//				static_cast<double>(p.y * k_centimeters_to_meters),
 			//				static_cast<double>(p.z * k_centimeters_to_meters)));
@@ -1245,8 +1311,8 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
 			//	}
 			//}
 
-			PoseOrientationMeasurementVectord measurement = PoseOrientationMeasurementVectord::Zero();
-			measurement.set_optical_quaterniond(world_quaternion);
+			PoseOrientationMeasurementVectorReal measurement = PoseOrientationMeasurementVectorReal::Zero();
+			measurement.set_optical_quaternion(world_quaternion);
 			filter->ukf.update(optical_measurement_model, measurement);
 		}
 
@@ -1258,7 +1324,7 @@ void KalmanPoseFilterPointCloud::update(const float delta_time, const PoseFilter
     }
     else
     {
-        m_filter->ukf.init(PoseStateVectord::Identity());
+        m_filter->ukf.init(PoseStateVectorReal::Identity());
         m_filter->time= 0.0;
         m_filter->bIsValid = true;
     }
@@ -1314,7 +1380,7 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 			// If this is the first time we have seen the position, snap the position state
 			if (!m_filter->bSeenPositionMeasurement)
 			{
-				const Eigen::Vector3d optical_position_meters = packet.get_optical_position_in_meters().cast<double>();
+				const PoseVector3 optical_position_meters = packet.get_optical_position_in_meters().cast<PoseReal>();
 
 				m_filter->ukf.getStateMutable().set_position_meters(optical_position_meters);
 				m_filter->bSeenPositionMeasurement = true;
@@ -1323,7 +1389,7 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 			// If this is the first time we have seen the orientation, snap the orientation state
 			if (!m_filter->bSeenOrientationMeasurement)
 			{
-				const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+				const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 				filter->set_world_quaternion(world_quaternion);
 				m_filter->bSeenOrientationMeasurement = true;
@@ -1333,8 +1399,8 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 		// Apply a physics update to the filter state
 		if (packet.has_imu_measurements())
 		{
-			PoseControlVectord control;
-			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<double>());
+			PoseControlVectorReal control;
+			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<PoseReal>());
 
 			filter->ukf.predict(filter->system_model, control);
 		}
@@ -1347,7 +1413,7 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 		if (packet.has_optical_measurement())
 		{
 			assert(packet.tracking_projection_area_px_sqr > 0.f);
-			const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+			const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 			//TODO: Port over point area and shape point index
 			//for (int model_led_index = 0; model_led_index < packet.optical_tracking_shape_cm.shape.pointcloud.point_count; ++model_led_index)
@@ -1364,9 +1430,9 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 			//		PoseLEDMeasurementModel *led_model = filter->led_measurement_models[model_led_index];
 			//		led_model->updateMeasurementCovariance(m_constants, led_screen_area);
 
-			//		PoseLEDMeasurementVectord led_measurement = PoseLEDMeasurementVectord::Zero();
+			//		PoseLEDMeasurementVectorReal led_measurement = PoseLEDMeasurementVectorReal::Zero();
 			//		led_measurement.set_LED_position_meters(
-			//			Eigen::Vector3d(
+			//			PoseVector3(
 			//				static_cast<double>(p.x * k_centimeters_to_meters),
 			//				static_cast<double>(p.y * k_centimeters_to_meters),
 			//				static_cast<double>(p.z * k_centimeters_to_meters)));
@@ -1375,8 +1441,8 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 			//	}
 			//}
 
-			PoseOrientationMeasurementVectord measurement = PoseOrientationMeasurementVectord::Zero();
-			measurement.set_optical_quaterniond(world_quaternion);
+			PoseOrientationMeasurementVectorReal measurement = PoseOrientationMeasurementVectorReal::Zero();
+			measurement.set_optical_quaternion(world_quaternion);
 			filter->ukf.update(optical_measurement_model, measurement);
 		}
 
@@ -1385,8 +1451,8 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 		{
 			assert(packet.has_accelerometer_measurement);
 
-			PoseGravMeasurementVectord measurement = PoseGravMeasurementVectord::Zero();
-			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<double>());
+			PoseGravMeasurementVectorReal measurement = PoseGravMeasurementVectorReal::Zero();
+			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<PoseReal>());
 			filter->ukf.update(filter->imu_measurement_model, measurement);
 		}
 
@@ -1397,7 +1463,7 @@ void KalmanPoseFilterMorpheus::update(const float delta_time, const PoseFilterPa
 	}
 	else
 	{
-		m_filter->ukf.init(PoseStateVectord::Identity());
+		m_filter->ukf.init(PoseStateVectorReal::Identity());
 		m_filter->time = 0.0;
 		m_filter->bIsValid = true;
 	}
@@ -1454,7 +1520,7 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 			// If this is the first time we have seen the position, snap the position state
 			if (!m_filter->bSeenPositionMeasurement)
 			{
-				const Eigen::Vector3d optical_position_meters = packet.get_optical_position_in_meters().cast<double>();
+				const PoseVector3 optical_position_meters = packet.get_optical_position_in_meters().cast<PoseReal>();
 
 				m_filter->ukf.getStateMutable().set_position_meters(optical_position_meters);
 				m_filter->bSeenPositionMeasurement = true;
@@ -1463,7 +1529,7 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 			// If this is the first time we have seen the orientation, snap the orientation state
 			if (!m_filter->bSeenOrientationMeasurement)
 			{
-				const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+				const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 				filter->set_world_quaternion(world_quaternion);
 				m_filter->bSeenOrientationMeasurement = true;
@@ -1473,8 +1539,8 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 		// Apply a physics update to the filter state
 		if (packet.has_imu_measurements())
 		{
-			PoseControlVectord control;
-			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<double>());
+			PoseControlVectorReal control;
+			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<PoseReal>());
 
 			filter->ukf.predict(filter->system_model, control);
 		}
@@ -1487,9 +1553,9 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 		if (packet.has_optical_measurement())
 		{
 			assert(packet.tracking_projection_area_px_sqr > 0.f);
-			const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
-			PoseOrientationMeasurementVectord measurement = PoseOrientationMeasurementVectord::Zero();
-			measurement.set_optical_quaterniond(world_quaternion);
+			const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
+			PoseOrientationMeasurementVectorReal measurement = PoseOrientationMeasurementVectorReal::Zero();
+			measurement.set_optical_quaternion(world_quaternion);
 			filter->ukf.update(optical_measurement_model, measurement);
 		}
 
@@ -1498,8 +1564,8 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 		{
 			assert(packet.has_accelerometer_measurement);
 
-			PoseGravMeasurementVectord measurement = PoseGravMeasurementVectord::Zero();
-			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<double>());
+			PoseGravMeasurementVectorReal measurement = PoseGravMeasurementVectorReal::Zero();
+			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<PoseReal>());
 			filter->ukf.update(filter->imu_measurement_model, measurement);
 		}
 
@@ -1510,7 +1576,7 @@ void KalmanPoseFilterDS4::update(const float delta_time, const PoseFilterPacket
 	}
 	else
 	{
-		m_filter->ukf.init(PoseStateVectord::Identity());
+		m_filter->ukf.init(PoseStateVectorReal::Identity());
 		m_filter->time = 0.0;
 		m_filter->bIsValid = true;
 	}
@@ -1567,7 +1633,7 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 			// If this is the first time we have seen the position, snap the position state
 			if (!m_filter->bSeenPositionMeasurement)
 			{
-				const Eigen::Vector3d optical_position_meters = packet.get_optical_position_in_meters().cast<double>();
+				const PoseVector3 optical_position_meters = packet.get_optical_position_in_meters().cast<PoseReal>();
 
 				m_filter->ukf.getStateMutable().set_position_meters(optical_position_meters);
 				m_filter->bSeenPositionMeasurement = true;
@@ -1576,7 +1642,7 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 			// If this is the first time we have seen the orientation, snap the orientation state
 			if (!m_filter->bSeenOrientationMeasurement)
 			{
-				const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
+				const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
 
 				filter->set_world_quaternion(world_quaternion);
 				m_filter->bSeenOrientationMeasurement = true;
@@ -1586,8 +1652,8 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 		// Apply a physics update to the filter state
 		if (packet.has_imu_measurements())
 		{
-			PoseControlVectord control;
-			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<double>());
+			PoseControlVectorReal control;
+			control.set_angular_rates(packet.imu_gyroscope_rad_per_sec.cast<PoseReal>());
 
 			filter->ukf.predict(filter->system_model, control);
 		}
@@ -1600,9 +1666,9 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 		if (packet.has_optical_measurement())
 		{
 			assert(packet.tracking_projection_area_px_sqr > 0.f);
-			const Eigen::Quaterniond world_quaternion = packet.optical_orientation.cast<double>();
-			PoseOrientationMeasurementVectord measurement = PoseOrientationMeasurementVectord::Zero();
-			measurement.set_optical_quaterniond(world_quaternion);
+			const PoseQuaternion world_quaternion = packet.optical_orientation.cast<PoseReal>();
+			PoseOrientationMeasurementVectorReal measurement = PoseOrientationMeasurementVectorReal::Zero();
+			measurement.set_optical_quaternion(world_quaternion);
 			filter->ukf.update(optical_measurement_model, measurement);
 		}
 
@@ -1611,9 +1677,9 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 		{
 			assert(packet.has_accelerometer_measurement);
 
-			PoseMagGravMeasurementVectord measurement = PoseMagGravMeasurementVectord::Zero();
-			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<double>());
-			measurement.set_magnetometer(packet.imu_magnetometer_unit.cast<double>());
+			PoseMagGravMeasurementVectorReal measurement = PoseMagGravMeasurementVectorReal::Zero();
+			measurement.set_accelerometer(packet.imu_accelerometer_g_units.cast<PoseReal>());
+			measurement.set_magnetometer(packet.imu_magnetometer_unit.cast<PoseReal>());
 			filter->ukf.update(filter->imu_measurement_model, measurement);
 		}
 
@@ -1624,13 +1690,31 @@ void KalmanPoseFilterPSMove::update(const float delta_time, const PoseFilterPack
 	}
 	else
 	{
-		m_filter->ukf.init(PoseStateVectord::Identity());
+		m_filter->ukf.init(PoseStateVectorReal::Identity());
 		m_filter->time = 0.0;
 		m_filter->bIsValid = true;
 	}
 }
 
 //-- Private functions --
+inline PoseVector3 pose_clockwise_rotate(const PoseQuaternion &q, const PoseVector3 &v)
+{
+#ifdef KALMAN_POSE_FILTER_USE_FLOAT
+	return eigen_vector3f_clockwise_rotate(q, v);
+#else
+	return eigen_vector3d_clockwise_rotate(q, v);
+#endif
+}
+
+inline PoseQuaternion pose_angular_velocity_to_quaternion_derivative(const PoseQuaternion &q, const PoseVector3 &ang_vel)
+{
+#ifdef KALMAN_POSE_FILTER_USE_FLOAT
+	return eigen_angular_velocity_to_quaternion_derivative(q, ang_vel);
+#else
+	return eigen_angular_velocity_to_quaterniond_derivative(q, ang_vel);
+#endif
+}
+
 // Sets the Q matrix entry with 1st order Discrete Constant White Noise
 // - dT is the time step
 // - var is the variance in the process noise
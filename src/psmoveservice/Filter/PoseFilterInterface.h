@@ -170,6 +170,15 @@ public:
     inline void setSensorTransform(const Eigen::Matrix3f &sensorTransform)
     { m_SensorTransform= sensorTransform; }
 
+    inline const Eigen::Vector3f &getIdentityGravity() const
+    { return m_IdentityGravity; }
+    inline const Eigen::Vector3f &getIdentityMagnetometer() const
+    { return m_IdentityMagnetometer; }
+    inline const Eigen::Matrix3f &getCalibrationTransform() const
+    { return m_CalibrationTransform; }
+    inline const Eigen::Matrix3f &getSensorTransform() const
+    { return m_SensorTransform; }
+
     Eigen::Vector3f getGravityCalibrationDirection() const;
     Eigen::Vector3f getMagnetometerCalibrationDirection() const;
 
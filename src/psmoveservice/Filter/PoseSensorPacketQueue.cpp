@@ -0,0 +1,220 @@
+//-- includes -----
+#include "PoseSensorPacketQueue.h"
+
+#include <algorithm>
+
+//-- constants -----
+static const char *k_overflow_policy_names[PoseSensorQueueOverflow_COUNT] = {
+	"drop_oldest",
+	"merge_oldest"
+};
+
+//-- public interface -----
+PoseSensorPacketQueue::PoseSensorPacketQueue()
+	: m_overflowPolicy(PoseSensorQueueOverflow_DropOldest)
+	, m_highWaterMark(0)
+	, m_overflowCount(0)
+	, m_droppedCount(0)
+	, m_mergedCount(0)
+	, m_lastLagMilliseconds(0.f)
+	, m_maxLagMilliseconds(0.f)
+{
+}
+
+void PoseSensorPacketQueue::allocate(int capacity, ePoseSensorQueueOverflowPolicy overflow_policy)
+{
+	// Merging needs two packets to fold together
+	m_queue.allocate(static_cast<size_t>(std::max(capacity, 2)));
+	m_overflowPolicy = overflow_policy;
+
+	m_highWaterMark.store(0);
+	m_overflowCount.store(0);
+	m_droppedCount.store(0);
+	m_mergedCount.store(0);
+	m_lastLagMilliseconds = 0.f;
+	m_maxLagMilliseconds = 0.f;
+}
+
+void PoseSensorPacketQueue::enqueue(const PoseSensorPacket &packet)
+{
+	QueuedPacket queued_packet;
+	queued_packet.packet = packet;
+	queued_packet.sample_count = 1;
+
+	if (!m_queue.tryEnqueue(queued_packet))
+	{
+		m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+
+		if (m_overflowPolicy == PoseSensorQueueOverflow_MergeOldest)
+		{
+			mergeOldestPackets();
+		}
+		else
+		{
+			dropOldestPacket();
+		}
+
+		// Room was made above, or the main thread drained the queue in the meantime
+		if (!m_queue.tryEnqueue(queued_packet))
+		{
+			m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Only this thread ever raises the high water mark
+	const int depth = static_cast<int>(m_queue.getSizeApprox());
+	if (depth > m_highWaterMark.load(std::memory_order_relaxed))
+	{
+		m_highWaterMark.store(depth, std::memory_order_relaxed);
+	}
+}
+
+size_t PoseSensorPacketQueue::drain(
+	const std::chrono::time_point<std::chrono::high_resolution_clock> &now,
+	std::vector<PoseSensorPacket> &out_packets)
+{
+	// Don't chase packets that keep arriving while draining, they go with the next drain
+	const size_t max_drain_count = m_queue.getCapacity();
+	size_t drain_count = 0;
+	QueuedPacket queued_packet;
+	std::chrono::time_point<std::chrono::high_resolution_clock> oldest_timestamp;
+
+	while (drain_count < max_drain_count && m_queue.tryDequeue(queued_packet))
+	{
+		// Merging puts packets back at the end of the queue,
+		// so the first packet isn't necessarily the one that waited the longest
+		if (drain_count == 0 || queued_packet.packet.timestamp < oldest_timestamp)
+		{
+			oldest_timestamp = queued_packet.packet.timestamp;
+		}
+
+		out_packets.push_back(queued_packet.packet);
+		++drain_count;
+	}
+
+	if (drain_count > 0)
+	{
+		const std::chrono::duration<float, std::milli> lag = now - oldest_timestamp;
+
+		m_lastLagMilliseconds = std::max(lag.count(), 0.f);
+		m_maxLagMilliseconds = std::max(m_maxLagMilliseconds, m_lastLagMilliseconds);
+	}
+	else
+	{
+		m_lastLagMilliseconds = 0.f;
+	}
+
+	return drain_count;
+}
+
+void PoseSensorPacketQueue::getStats(PoseSensorPacketQueueStats &out_stats) const
+{
+	out_stats.capacity = static_cast<int>(m_queue.getCapacity());
+	out_stats.depth = static_cast<int>(m_queue.getSizeApprox());
+	out_stats.high_water_mark = m_highWaterMark.load(std::memory_order_relaxed);
+	out_stats.overflow_count = m_overflowCount.load(std::memory_order_relaxed);
+	out_stats.dropped_count = m_droppedCount.load(std::memory_order_relaxed);
+	out_stats.merged_count = m_mergedCount.load(std::memory_order_relaxed);
+	out_stats.last_lag_ms = m_lastLagMilliseconds;
+	out_stats.max_lag_ms = m_maxLagMilliseconds;
+	out_stats.overflow_policy = m_overflowPolicy;
+}
+
+const char *PoseSensorPacketQueue::getOverflowPolicyName(ePoseSensorQueueOverflowPolicy overflow_policy)
+{
+	return (overflow_policy >= 0 && overflow_policy < PoseSensorQueueOverflow_COUNT)
+		? k_overflow_policy_names[overflow_policy]
+		: "unknown";
+}
+
+ePoseSensorQueueOverflowPolicy PoseSensorPacketQueue::findOverflowPolicyByName(
+	const std::string &name,
+	ePoseSensorQueueOverflowPolicy default_policy)
+{
+	for (int policy_index = 0; policy_index < PoseSensorQueueOverflow_COUNT; ++policy_index)
+	{
+		if (name == k_overflow_policy_names[policy_index])
+		{
+			return static_cast<ePoseSensorQueueOverflowPolicy>(policy_index);
+		}
+	}
+
+	return default_policy;
+}
+
+//-- private methods -----
+void PoseSensorPacketQueue::mergeOldestPackets()
+{
+	QueuedPacket oldest_packet;
+	QueuedPacket next_packet;
+
+	if (!m_queue.tryDequeue(oldest_packet))
+	{
+		// The main thread drained the queue in the meantime
+		return;
+	}
+
+	if (m_queue.tryDequeue(next_packet))
+	{
+		merge_packets(oldest_packet, next_packet);
+		m_queue.tryEnqueue(next_packet);
+		m_mergedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		// Nothing left to merge with, the main thread drained the rest.
+		// The main thread sorts the packets by time and measures the lag from the oldest one,
+		// so going to the back of the queue is fine.
+		m_queue.tryEnqueue(oldest_packet);
+	}
+}
+
+void PoseSensorPacketQueue::dropOldestPacket()
+{
+	QueuedPacket oldest_packet;
+
+	if (m_queue.tryDequeue(oldest_packet))
+	{
+		m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void PoseSensorPacketQueue::merge_packets(const QueuedPacket &older, QueuedPacket &newer)
+{
+	PoseSensorPacket &merged = newer.packet;
+	const int merged_sample_count = older.sample_count + newer.sample_count;
+
+	// The IMU samples are evenly spaced, so weighting the gyro rates by sample count
+	// gives a rate that integrates to the same rotation over the merged time span.
+	// The filter measures that span from its last update to the newer timestamp.
+	if (older.packet.has_gyroscope_measurement && newer.packet.has_gyroscope_measurement)
+	{
+		merged.imu_gyroscope_rad_per_sec =
+			(older.packet.imu_gyroscope_rad_per_sec * static_cast<float>(older.sample_count)
+			 + newer.packet.imu_gyroscope_rad_per_sec * static_cast<float>(newer.sample_count))
+			/ static_cast<float>(merged_sample_count);
+	}
+	else if (older.packet.has_gyroscope_measurement)
+	{
+		merged.raw_imu_gyroscope = older.packet.raw_imu_gyroscope;
+		merged.imu_gyroscope_rad_per_sec = older.packet.imu_gyroscope_rad_per_sec;
+		merged.has_gyroscope_measurement = true;
+	}
+
+	// Accelerometer and magnetometer readings are absolute, the newest one wins
+	if (!merged.has_accelerometer_measurement && older.packet.has_accelerometer_measurement)
+	{
+		merged.raw_imu_accelerometer = older.packet.raw_imu_accelerometer;
+		merged.imu_accelerometer_g_units = older.packet.imu_accelerometer_g_units;
+		merged.has_accelerometer_measurement = true;
+	}
+
+	if (!merged.has_magnetometer_measurement && older.packet.has_magnetometer_measurement)
+	{
+		merged.raw_imu_magnetometer = older.packet.raw_imu_magnetometer;
+		merged.imu_magnetometer_unit = older.packet.imu_magnetometer_unit;
+		merged.has_magnetometer_measurement = true;
+	}
+
+	newer.sample_count = merged_sample_count;
+}
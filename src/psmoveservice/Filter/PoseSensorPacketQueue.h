@@ -0,0 +1,104 @@
+#ifndef POSE_SENSOR_PACKET_QUEUE_H
+#define POSE_SENSOR_PACKET_QUEUE_H
+
+//-- includes -----
+#include "AtomicPrimitives.h"
+#include "PoseFilterInterface.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+//-- constants -----
+enum ePoseSensorQueueOverflowPolicy
+{
+	PoseSensorQueueOverflow_DropOldest,		// Throw away the oldest packet to make room
+	PoseSensorQueueOverflow_MergeOldest,	// Fold the two oldest packets into one, keeping their rotation
+
+	PoseSensorQueueOverflow_COUNT
+};
+
+//-- definitions -----
+struct PoseSensorPacketQueueStats
+{
+	int capacity;
+	int depth;
+	int high_water_mark;
+	int overflow_count;		// Times a packet arrived with the queue full
+	int dropped_count;		// Packets thrown away to make room
+	int merged_count;		// Packets folded into their successor to make room
+	float last_lag_ms;		// Age of the oldest packet in the last drain
+	float max_lag_ms;
+	ePoseSensorQueueOverflowPolicy overflow_policy;
+
+	inline void clear()
+	{
+		capacity = 0;
+		depth = 0;
+		high_water_mark = 0;
+		overflow_count = 0;
+		dropped_count = 0;
+		merged_count = 0;
+		last_lag_ms = 0.f;
+		max_lag_ms = 0.f;
+		overflow_policy = PoseSensorQueueOverflow_DropOldest;
+	}
+};
+
+/// Fixed capacity queue of the IMU sensor packets a controller posts from its device thread
+/// for the main thread to feed the pose filter with. Posting never allocates or blocks:
+/// when the main thread falls behind and the queue is full the overflow policy makes room.
+class PoseSensorPacketQueue
+{
+public:
+	PoseSensorPacketQueue();
+
+	/// Not thread safe, only call while the device thread isn't posting packets.
+	/// Discards any queued packets and resets the stats.
+	void allocate(int capacity, ePoseSensorQueueOverflowPolicy overflow_policy);
+
+	/// Device thread only
+	void enqueue(const PoseSensorPacket &packet);
+
+	/// Main thread only. Appends the queued packets to out_packets, oldest first,
+	/// and returns how many were appended.
+	size_t drain(
+		const std::chrono::time_point<std::chrono::high_resolution_clock> &now,
+		std::vector<PoseSensorPacket> &out_packets);
+
+	inline size_t getCapacity() const { return m_queue.getCapacity(); }
+
+	/// Main thread only
+	void getStats(PoseSensorPacketQueueStats &out_stats) const;
+
+	static const char *getOverflowPolicyName(ePoseSensorQueueOverflowPolicy overflow_policy);
+	static ePoseSensorQueueOverflowPolicy findOverflowPolicyByName(
+		const std::string &name, ePoseSensorQueueOverflowPolicy default_policy);
+
+private:
+	struct QueuedPacket
+	{
+		PoseSensorPacket packet;
+		int sample_count; // How many IMU samples were merged into the packet
+	};
+
+	void mergeOldestPackets();
+	void dropOldestPacket();
+	static void merge_packets(const QueuedPacket &older, QueuedPacket &newer);
+
+	AtomicBoundedQueue<QueuedPacket> m_queue;
+	ePoseSensorQueueOverflowPolicy m_overflowPolicy;
+
+	// Device Thread State (read by the main thread)
+	std::atomic<int> m_highWaterMark;
+	std::atomic<int> m_overflowCount;
+	std::atomic<int> m_droppedCount;
+	std::atomic<int> m_mergedCount;
+
+	// Main Thread State
+	float m_lastLagMilliseconds;
+	float m_maxLagMilliseconds;
+};
+
+#endif // POSE_SENSOR_PACKET_QUEUE_H
@@ -263,6 +263,7 @@ public:
 		, m_hidDevice(nullptr)
 		, m_controllerListener(nullptr)
 		, m_bSupportsMagnetometer(false)
+		, m_fetchedInputGeneration(0)
 		, m_nextPollSequenceNumber(0)
 	{
 		setConfig(cfg);
@@ -276,12 +277,16 @@ public:
 
 	void setConfig(const PSDualShock4ControllerConfig &cfg)
 	{
-		m_cfg.storeValue(cfg);
+		PSDualShock4SensorTunables tunables;
+		tunables.applyConfig(cfg);
+
+		m_sensorTunables.publish(tunables);
 	}
 
+	// Leaves input_state alone if no packet came in since the last fetch
 	void fetchLatestInputData(DualShock4ControllerInputState &input_state)
 	{
-		m_currentInputState.fetchValue(input_state);
+		m_currentInputState.fetchValueIfNewer(input_state, m_fetchedInputGeneration);
 	}
 
 	void postOutputState(const DualShock4ControllerOutputState &output_state)
@@ -330,8 +335,7 @@ protected:
 
 		if (res > 0)
 		{
-			PSDualShock4ControllerConfig cfg;
-			m_cfg.fetchValue(cfg);
+			const PSDualShock4SensorTunables *tunables = m_sensorTunables.get();
 
 			// https://github.com/hrl7/node-psvr/blob/master/lib/psvr.js
 			DualShock4ControllerInputState newState;
@@ -341,7 +345,7 @@ protected:
 			++m_nextPollSequenceNumber;
 
 			// Processes the IMU data
-			newState.parseDataInput(&cfg, &m_previousHIDInputPacket, &m_currentHIDInputPacket);
+			newState.parseDataInput(tunables, &m_previousHIDInputPacket, &m_currentHIDInputPacket);
 
 			// Store a copy of the parsed input date for functions
 			// that want to query input state off of the worker thread
@@ -377,8 +381,8 @@ protected:
             std::chrono::duration<double, std::milli> led_update_diff = now - m_lastHIDOutputTimestamp;
             if (led_update_diff.count() >= PSDS4_WRITE_DATA_INTERVAL_MS)
             {
-				DualShock4ControllerOutputState output_state;
-				m_currentOutputState.fetchValue(output_state);
+				AtomicObject<DualShock4ControllerOutputState>::ReadView output_view(m_currentOutputState);
+				const DualShock4ControllerOutputState &output_state = *output_view;
 
 				if (output_state.r != m_previousOutputState.r ||
 					output_state.g != m_previousOutputState.g ||
@@ -450,7 +454,10 @@ protected:
 	bool m_bSupportsMagnetometer;
 	AtomicObject<DualShock4ControllerInputState> m_currentInputState;
 	AtomicObject<DualShock4ControllerOutputState> m_currentOutputState;
-	AtomicObject<PSDualShock4ControllerConfig> m_cfg;
+	AtomicSnapshot<PSDualShock4SensorTunables> m_sensorTunables;
+
+	// Main thread state
+	unsigned int m_fetchedInputGeneration;
 
     // Worker thread state
     int m_nextPollSequenceNumber;
@@ -577,6 +584,14 @@ PSDualShock4ControllerConfig::ptree2config(const boost::property_tree::ptree &pt
     }
 }
 
+// -- PSDualShock4SensorTunables --
+void PSDualShock4SensorTunables::applyConfig(const PSDualShock4ControllerConfig &config)
+{
+	accelerometer_gain = config.accelerometer_gain;
+	accelerometer_bias = config.accelerometer_bias;
+	gyro_gain = config.gyro_gain;
+}
+
 // -- DualShock4ControllerInputState --
 DualShock4ControllerInputState::DualShock4ControllerInputState()
 {
@@ -630,7 +645,7 @@ void DualShock4ControllerInputState::clear()
 }
 
 void DualShock4ControllerInputState::parseDataInput(
-	const PSDualShock4ControllerConfig *config,
+	const PSDualShock4SensorTunables *tunables,
 	const struct DualShock4DataInput *previous_hid_packet,
 	const struct DualShock4DataInput *current_hid_input)
 {
@@ -738,19 +753,19 @@ void DualShock4ControllerInputState::parseDataInput(
 
         // calibrated_acc= raw_acc*acc_gain + acc_bias
         CalibratedAccelerometer.i = 
-            static_cast<float>(RawAccelerometer[0]) * config->accelerometer_gain.i 
-            + config->accelerometer_bias.i;
+            static_cast<float>(RawAccelerometer[0]) * tunables->accelerometer_gain.i 
+            + tunables->accelerometer_bias.i;
         CalibratedAccelerometer.j =
-            static_cast<float>(RawAccelerometer[1]) * config->accelerometer_gain.j
-            + config->accelerometer_bias.j;
+            static_cast<float>(RawAccelerometer[1]) * tunables->accelerometer_gain.j
+            + tunables->accelerometer_bias.j;
         CalibratedAccelerometer.k =
-            static_cast<float>(RawAccelerometer[2]) * config->accelerometer_gain.k
-            + config->accelerometer_bias.k;
+            static_cast<float>(RawAccelerometer[2]) * tunables->accelerometer_gain.k
+            + tunables->accelerometer_bias.k;
 
         // calibrated_gyro= raw_gyro*gyro_gain + gyro_bias
-        CalibratedGyro.i = static_cast<float>(RawGyro[0]) * config->gyro_gain;
-        CalibratedGyro.j = static_cast<float>(RawGyro[1]) * config->gyro_gain;
-        CalibratedGyro.k = static_cast<float>(RawGyro[2]) * config->gyro_gain;
+        CalibratedGyro.i = static_cast<float>(RawGyro[0]) * tunables->gyro_gain;
+        CalibratedGyro.j = static_cast<float>(RawGyro[1]) * tunables->gyro_gain;
+        CalibratedGyro.k = static_cast<float>(RawGyro[2]) * tunables->gyro_gain;
     }
 
     // Sequence and timestamp
@@ -810,6 +825,7 @@ PSDualShock4Controller::PSDualShock4Controller()
 	HIDDetails.vendor_id = -1;
 	HIDDetails.product_id = -1;
     HIDDetails.Handle = nullptr;
+	TrackingColorID = eCommonTrackingColorID::INVALID_COLOR;
 	memset(&m_cachedInputState, 0, sizeof(DualShock4ControllerInputState));
 	memset(&m_cachedOutputState, 0, sizeof(DualShock4ControllerOutputState));
 }
@@ -953,6 +969,8 @@ bool PSDualShock4Controller::open(
 
 				// Save it back out again in case any defaults changed
 				cfg.save();
+
+				TrackingColorID = cfg.tracking_color_id;
             }
         }
         else
@@ -1043,14 +1061,20 @@ PSDualShock4Controller::setHostBluetoothAddress(const std::string &new_host_bt_a
 }
 
 bool 
-PSDualShock4Controller::setTrackingColorID(const eCommonTrackingColorID tracking_color_id)
+PSDualShock4Controller::setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig)
 {
 	bool bSuccess = false;
 
 	if (getIsOpen() && getIsBluetooth())
 	{
-		cfg.tracking_color_id = tracking_color_id;
-		cfg.save();
+		TrackingColorID = tracking_color_id;
+
+		if (bUpdateConfig)
+		{
+			cfg.tracking_color_id = tracking_color_id;
+			cfg.save();
+		}
+
 		bSuccess = true;
 	}
 
@@ -1256,7 +1280,7 @@ PSDualShock4Controller::getTrackingColorID(eCommonTrackingColorID &out_tracking_
 
 	if (getIsOpen() && getIsBluetooth())
 	{
-		out_tracking_color_id = cfg.tracking_color_id;
+		out_tracking_color_id = TrackingColorID;
 		bSuccess = true;
 	}
 
@@ -1291,6 +1315,7 @@ void
 PSDualShock4Controller::setConfig(const PSDualShock4ControllerConfig *config)
 {
 	cfg= *config;
+	TrackingColorID = cfg.tracking_color_id;
 
 	if (m_HIDPacketProcessor != nullptr)
 	{
@@ -178,6 +178,20 @@ public:
 	std::string hand;
 };
 
+// The part of the config the HID packet processor reads for every packet.
+// It gets its own immutable copy whenever the config changes,
+// rather than copying the whole config (strings and all) out for each packet.
+struct PSDualShock4SensorTunables
+{
+	unsigned int snapshot_version;
+
+	CommonDeviceVector accelerometer_gain;
+	CommonDeviceVector accelerometer_bias;
+	float gyro_gain;
+
+	void applyConfig(const PSDualShock4ControllerConfig &config);
+};
+
 struct DualShock4ControllerInputState : public CommonControllerState
 {
     int RawSequence;                               // 6-bit  (counts up by 1 per report)
@@ -224,7 +238,7 @@ struct DualShock4ControllerInputState : public CommonControllerState
 
     void clear();
 	void parseDataInput(
-		const PSDualShock4ControllerConfig *config, 
+		const PSDualShock4SensorTunables *tunables, 
 		const struct DualShock4DataInput *previous_hid_packet,
 		const struct DualShock4DataInput *new_hid_packet);
 };
@@ -271,7 +285,7 @@ public:
 
     // -- IControllerInterface
     virtual bool setHostBluetoothAddress(const std::string &address) override;
-	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id) override;
+	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig) override;
     virtual bool getIsBluetooth() const override;
     virtual std::string getUSBDevicePath() const override;
 	virtual int getVendorID() const override;
@@ -307,6 +321,8 @@ private:
     bool IsBluetooth;                               // true if valid serial number on device opening
 
     // Cached MainThread Controller State
+	// Only the same as cfg.tracking_color_id while that is the last color set with bUpdateConfig
+	eCommonTrackingColorID TrackingColorID;
 	DualShock4ControllerInputState m_cachedInputState;
     DualShock4ControllerOutputState m_cachedOutputState;
 
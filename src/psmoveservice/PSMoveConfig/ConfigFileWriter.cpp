@@ -0,0 +1,226 @@
+//-- includes -----
+#include "ConfigFileWriter.h"
+#include "ServerLog.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+
+//-- constants -----
+// A file gets written once it has had no new saves for this long ...
+static const int k_save_debounce_ms = 500;
+// ... but no later than this after the first save that is still pending
+static const int k_max_save_delay_ms = 2000;
+
+//-- statics -----
+ConfigFileWriter *ConfigFileWriter::m_instance = nullptr;
+
+//-- public implementation -----
+bool ConfigFileWriter::startup()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new ConfigFileWriter();
+		m_instance->startThread();
+	}
+
+	return true;
+}
+
+void ConfigFileWriter::shutdown()
+{
+	if (m_instance != nullptr)
+	{
+		// The writer thread leaves whatever isn't due yet to the final flush
+		m_instance->stopThread();
+		m_instance->writeAllPendingSaves();
+
+		delete m_instance;
+		m_instance = nullptr;
+	}
+}
+
+void ConfigFileWriter::enqueueSave(const std::string &config_path, const boost::property_tree::ptree &pt)
+{
+	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto iter = m_pendingSaves.find(config_path);
+		if (iter == m_pendingSaves.end())
+		{
+			iter = m_pendingSaves.insert(std::make_pair(config_path, PendingSave())).first;
+			iter->second.firstSaveTime = now;
+		}
+
+		iter->second.pt = pt;
+		iter->second.lastSaveTime = now;
+	}
+
+	m_condition.notify_one();
+}
+
+bool ConfigFileWriter::getPendingSave(const std::string &config_path, boost::property_tree::ptree &out_pt)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// A pending save is always newer than the one being written
+	auto pending_iter = m_pendingSaves.find(config_path);
+	if (pending_iter != m_pendingSaves.end())
+	{
+		out_pt = pending_iter->second.pt;
+		return true;
+	}
+
+	auto writing_iter = m_writingSaves.find(config_path);
+	if (writing_iter != m_writingSaves.end())
+	{
+		out_pt = writing_iter->second;
+		return true;
+	}
+
+	return false;
+}
+
+bool ConfigFileWriter::writeConfigFile(const std::string &config_path, const boost::property_tree::ptree &pt)
+{
+	const std::string temp_path = config_path + ".tmp";
+
+	try
+	{
+		boost::property_tree::write_json(temp_path, pt);
+	}
+	catch (const boost::property_tree::json_parser_error &error)
+	{
+		SERVER_MT_LOG_ERROR("ConfigFileWriter::writeConfigFile") << "Failed to write " << temp_path << ": " << error.what();
+		return false;
+	}
+
+	// Replaces the old config in one step, readers see either the old or the new file
+	boost::system::error_code error_code;
+	boost::filesystem::rename(temp_path, config_path, error_code);
+	if (error_code)
+	{
+		SERVER_MT_LOG_ERROR("ConfigFileWriter::writeConfigFile") << "Failed to replace " << config_path << ": " << error_code.message();
+		return false;
+	}
+
+	return true;
+}
+
+//-- protected methods -----
+ConfigFileWriter::ConfigFileWriter()
+	: WorkerThread("ConfigFileWriter")
+	, m_mutex()
+	, m_condition()
+	, m_pendingSaves()
+	, m_writingSaves()
+{
+}
+
+ConfigFileWriter::~ConfigFileWriter()
+{
+	stopThread();
+}
+
+void ConfigFileWriter::onThreadHaltBegin()
+{
+	// Taking the lock makes sure the writer thread is either waiting or yet to see the exit flag
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+	}
+
+	m_condition.notify_all();
+}
+
+bool ConfigFileWriter::doWork()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (m_exitSignaled)
+		{
+			return false;
+		}
+
+		// Sleep until the earliest pending save is due, or a new save comes in
+		if (m_pendingSaves.empty())
+		{
+			m_condition.wait(lock);
+		}
+		else
+		{
+			std::chrono::time_point<std::chrono::high_resolution_clock> wake_time = std::chrono::time_point<std::chrono::high_resolution_clock>::max();
+			for (const auto &entry : m_pendingSaves)
+			{
+				const PendingSave &pending_save = entry.second;
+				const std::chrono::time_point<std::chrono::high_resolution_clock> due_time =
+					std::min(
+						pending_save.lastSaveTime + std::chrono::milliseconds(k_save_debounce_ms),
+						pending_save.firstSaveTime + std::chrono::milliseconds(k_max_save_delay_ms));
+
+				wake_time = std::min(wake_time, due_time);
+			}
+
+			m_condition.wait_until(lock, wake_time);
+		}
+
+		if (m_exitSignaled)
+		{
+			return false;
+		}
+
+		// Take every save that is due
+		const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+		for (auto iter = m_pendingSaves.begin(); iter != m_pendingSaves.end(); )
+		{
+			const PendingSave &pending_save = iter->second;
+
+			if (now >= pending_save.lastSaveTime + std::chrono::milliseconds(k_save_debounce_ms) ||
+				now >= pending_save.firstSaveTime + std::chrono::milliseconds(k_max_save_delay_ms))
+			{
+				m_writingSaves[iter->first] = pending_save.pt;
+				iter = m_pendingSaves.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	// Only this thread changes m_writingSaves, so it can be walked without holding the lock
+	for (const auto &entry : m_writingSaves)
+	{
+		writeConfigFile(entry.first, entry.second);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_writingSaves.clear();
+	}
+
+	return true;
+}
+
+void ConfigFileWriter::writeAllPendingSaves()
+{
+	std::map<std::string, PendingSave> pending_saves;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		pending_saves.swap(m_pendingSaves);
+	}
+
+	for (const auto &entry : pending_saves)
+	{
+		writeConfigFile(entry.first, entry.second.pt);
+	}
+
+	if (!pending_saves.empty())
+	{
+		SERVER_LOG_INFO("ConfigFileWriter::writeAllPendingSaves") << "Flushed " << pending_saves.size() << " pending config file(s)";
+	}
+}
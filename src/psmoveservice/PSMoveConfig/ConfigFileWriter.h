@@ -0,0 +1,68 @@
+#ifndef CONFIG_FILE_WRITER_H
+#define CONFIG_FILE_WRITER_H
+
+//-- includes -----
+#include "WorkerThread.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <boost/property_tree/ptree.hpp>
+
+//-- definitions -----
+/// Writes config files on a background thread.
+/// PSMoveConfig::save() only hands over the serialized config, so a save from the
+/// tracking loop (e.g. a client dragging the exposure slider) never waits on the disk.
+/// Saves of the same file are coalesced: it gets written once no new save of it has
+/// come in for a short while, or at the latest a fixed time after its first pending save.
+/// Files are written to a temporary file first and then renamed over the config,
+/// so a crash in the middle of a write never leaves a truncated config behind.
+/// Without a running writer (e.g. in the tests) PSMoveConfig::save() writes right away.
+class ConfigFileWriter : public WorkerThread
+{
+public:
+	/// Starts the writer thread, saves go through it from then on
+	static bool startup();
+	/// Writes out every pending save and stops the writer thread
+	static void shutdown();
+
+	static inline ConfigFileWriter *getInstance() { return m_instance; }
+
+	/// Queues the config to be written to config_path, replacing any pending save of that file
+	void enqueueSave(const std::string &config_path, const boost::property_tree::ptree &pt);
+
+	/// Gets the newest config saved to config_path that may not be on disk yet
+	bool getPendingSave(const std::string &config_path, boost::property_tree::ptree &out_pt);
+
+	/// Writes the config to config_path through a temporary file
+	static bool writeConfigFile(const std::string &config_path, const boost::property_tree::ptree &pt);
+
+protected:
+	ConfigFileWriter();
+	virtual ~ConfigFileWriter();
+
+	virtual void onThreadHaltBegin() override;
+	virtual bool doWork() override;
+
+	void writeAllPendingSaves();
+
+private:
+	struct PendingSave
+	{
+		boost::property_tree::ptree pt;
+		std::chrono::time_point<std::chrono::high_resolution_clock> firstSaveTime;
+		std::chrono::time_point<std::chrono::high_resolution_clock> lastSaveTime;
+	};
+
+	static ConfigFileWriter *m_instance;
+
+	// Shared State, guarded by m_mutex
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::map<std::string, PendingSave> m_pendingSaves;
+	std::map<std::string, boost::property_tree::ptree> m_writingSaves; // Taken by the writer thread, not on disk yet
+};
+
+#endif // CONFIG_FILE_WRITER_H
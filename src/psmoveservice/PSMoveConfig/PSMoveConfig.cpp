@@ -1,4 +1,5 @@
 #include "PSMoveConfig.h"
+#include "ConfigFileWriter.h"
 #include "DeviceInterface.h"
 #include "ServerUtility.h"
 #include <boost/filesystem.hpp>
@@ -39,7 +40,7 @@ PSMoveConfig::PSMoveConfig(const std::string &fnamebase)
 }
 
 const std::string
-PSMoveConfig::getConfigPath()
+PSMoveConfig::getConfigDirectory()
 {
     const char *homedir;
 #ifdef _WIN32
@@ -56,18 +57,43 @@ PSMoveConfig::getConfigPath()
     }
 #endif
     
-    boost::filesystem::path configpath(homedir);
-    configpath /= "PSMoveService";
-    boost::filesystem::create_directory(configpath);
-    configpath /= ConfigFileBase + ".json";
-    std::cout << "Config file name: " << configpath << std::endl;
-    return configpath.string();
+    boost::filesystem::path configdir(homedir);
+    configdir /= "PSMoveService";
+    boost::filesystem::create_directory(configdir);
+    return configdir.string();
+}
+
+const std::string
+PSMoveConfig::getConfigPath()
+{
+    // Saves can come in every frame, so only look the directory up again when the file name changes
+    if (m_configPath.empty() || m_configPathFileBase != ConfigFileBase)
+    {
+        boost::filesystem::path configpath(getConfigDirectory());
+        configpath /= ConfigFileBase + ".json";
+        std::cout << "Config file name: " << configpath << std::endl;
+
+        m_configPath = configpath.string();
+        m_configPathFileBase = ConfigFileBase;
+    }
+
+    return m_configPath;
 }
 
 void
 PSMoveConfig::save()
 {
-    boost::property_tree::write_json(getConfigPath(), config2ptree());
+    ConfigFileWriter *writer = ConfigFileWriter::getInstance();
+
+    if (writer != nullptr)
+    {
+        // Written out on the writer thread, coalesced with any other save of this file
+        writer->enqueueSave(getConfigPath(), config2ptree());
+    }
+    else
+    {
+        ConfigFileWriter::writeConfigFile(getConfigPath(), config2ptree());
+    }
 }
 
 bool
@@ -76,8 +102,15 @@ PSMoveConfig::load()
     bool bLoadedOk = false;
     boost::property_tree::ptree pt;
     std::string configPath = getConfigPath();
+    ConfigFileWriter *writer = ConfigFileWriter::getInstance();
 
-    if ( boost::filesystem::exists( configPath ) )
+    if (writer != nullptr && writer->getPendingSave(configPath, pt))
+    {
+        // The file on disk is older than the last save
+        ptree2config(pt);
+        bLoadedOk = true;
+    }
+    else if ( boost::filesystem::exists( configPath ) )
     {
         boost::property_tree::read_json(configPath, pt);
         ptree2config(pt);
@@ -20,6 +20,9 @@ public:
     virtual const boost::property_tree::ptree config2ptree() = 0;  // Implement by each device class' own Config
     virtual void ptree2config(const boost::property_tree::ptree &pt) = 0;  // Implement by each device class' own Config
     
+    /// The directory holding every config file (created if it doesn't exist)
+    static const std::string getConfigDirectory();
+
     static void writeColorPreset(
         boost::property_tree::ptree &pt,
         const char *profile_name,
@@ -44,6 +47,9 @@ public:
 
 private:
     const std::string getConfigPath();
+
+    std::string m_configPath; // Cached for m_configPathFileBase
+    std::string m_configPathFileBase;
 };
 /*
 Note that PSMoveConfig is an abstract class because it has 2 pure virtual functions.
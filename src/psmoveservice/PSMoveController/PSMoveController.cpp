@@ -36,6 +36,7 @@ POSSIBILITY OF SUCH DAMAGE.
 //-- includes -----
 #include "AtomicPrimitives.h"
 #include "PSMoveController.h"
+#include "PSMoveSensorDecoding.h"
 #include "ControllerDeviceEnumerator.h"
 #include "ServerLog.h"
 #include "ServerUtility.h"
@@ -250,6 +251,7 @@ public:
 		, m_hidDevice(nullptr)
 		, m_controllerListener(nullptr)
 		, m_bSupportsMagnetometer(false)
+		, m_fetchedInputGeneration(0)
 		, m_nextPollSequenceNumber(0)
 	{
 		setConfig(cfg);
@@ -274,7 +276,10 @@ public:
 
 	void setConfig(const PSMoveControllerConfig &cfg)
 	{
-		m_cfg.storeValue(cfg);
+		PSMoveSensorTunables tunables;
+		tunables.applyConfig(cfg);
+
+		m_sensorTunables.publish(tunables);
 	}
 
 	bool getSupportsMagnetometer() const
@@ -282,9 +287,10 @@ public:
 		return m_bSupportsMagnetometer;
 	}
 
+	// Leaves input_state alone if no packet came in since the last fetch
 	void fetchLatestInputData(PSMoveControllerInputState &input_state)
 	{
-		m_currentInputState.fetchValue(input_state);
+		m_currentInputState.fetchValueIfNewer(input_state, m_fetchedInputGeneration);
 	}
 
 	void postOutputState(const PSMoveControllerOutputState &output_state)
@@ -326,8 +332,7 @@ protected:
 			const int k_max_poll_attempts = 10;
 			int poll_count = 0;
 
-			PSMoveControllerConfig cfg;
-			m_cfg.fetchValue(cfg);
+			const PSMoveSensorTunables *tunables = m_sensorTunables.get();
 
 			for (poll_count = 0; poll_count < k_max_poll_attempts; ++poll_count)
 			{
@@ -337,7 +342,7 @@ protected:
 				if (res > 0)
 				{
 					PSMoveControllerInputState newState;
-					newState.parseDataInput(&cfg, nullptr, &rawHIDPacket.data.zcm1);
+					newState.parseDataInput(tunables, nullptr, &rawHIDPacket.data.zcm1);
 
 					// See if we are getting valid magnetometer data
 					m_bSupportsMagnetometer = 
@@ -361,20 +366,19 @@ protected:
 
 	virtual bool doWork() override
     {
-		PSMoveControllerConfig cfg;
-		m_cfg.fetchValue(cfg);
+		const PSMoveSensorTunables *tunables = m_sensorTunables.get();
 
 		// Attempt to read the next sensor update packet from the HMD
         int res = -1;
 		if (m_model == _psmove_controller_ZCM2)
 		{
 			memcpy(&m_previousHIDInputPacket.data.zcm2, &m_currentHIDInputPacket.data.zcm2, sizeof(PSMoveDataInputZCM2));
-			res= hid_read_timeout(m_hidDevice, (unsigned char*)&m_currentHIDInputPacket.data.zcm2, sizeof(PSMoveDataInputZCM2), cfg.poll_timeout_ms);
+			res= hid_read_timeout(m_hidDevice, (unsigned char*)&m_currentHIDInputPacket.data.zcm2, sizeof(PSMoveDataInputZCM2), tunables->poll_timeout_ms);
 		}
 		else
 		{
 			memcpy(&m_previousHIDInputPacket.data.zcm1, &m_currentHIDInputPacket.data.zcm1, sizeof(PSMoveDataInputZCM1));
-			res= hid_read_timeout(m_hidDevice, (unsigned char*)&m_currentHIDInputPacket.data.zcm1, sizeof(PSMoveDataInputZCM1), cfg.poll_timeout_ms);
+			res= hid_read_timeout(m_hidDevice, (unsigned char*)&m_currentHIDInputPacket.data.zcm1, sizeof(PSMoveDataInputZCM1), tunables->poll_timeout_ms);
 		}
 
 		if (res > 0)
@@ -388,9 +392,9 @@ protected:
 
 			// Processes the IMU data
 			if (m_model == _psmove_controller_ZCM2)
-				newState.parseDataInput(&cfg, &m_previousHIDInputPacket.data.zcm2, &m_currentHIDInputPacket.data.zcm2);
+				newState.parseDataInput(tunables, &m_previousHIDInputPacket.data.zcm2, &m_currentHIDInputPacket.data.zcm2);
 			else
-				newState.parseDataInput(&cfg, &m_previousHIDInputPacket.data.zcm1, &m_currentHIDInputPacket.data.zcm1);
+				newState.parseDataInput(tunables, &m_previousHIDInputPacket.data.zcm1, &m_currentHIDInputPacket.data.zcm1);
 
 			// Store a copy of the parsed input date for functions
 			// that want to query input state off of the worker thread
@@ -426,8 +430,8 @@ protected:
             std::chrono::duration<double, std::milli> led_update_diff = now - m_lastHIDOutputTimestamp;
             if (led_update_diff.count() >= PSMOVE_WRITE_DATA_INTERVAL_MS)
             {
-				PSMoveControllerOutputState output_state;
-				m_currentOutputState.fetchValue(output_state);
+				AtomicObject<PSMoveControllerOutputState>::ReadView output_view(m_currentOutputState);
+				const PSMoveControllerOutputState &output_state = *output_view;
 
 				const bool bWriteStateChanged=
 					output_state.r != m_previousOutputState.r ||
@@ -483,7 +487,10 @@ protected:
 	bool m_bSupportsMagnetometer;
 	AtomicObject<PSMoveControllerInputState> m_currentInputState;
 	AtomicObject<PSMoveControllerOutputState> m_currentOutputState;
-	AtomicObject<PSMoveControllerConfig> m_cfg;
+	AtomicSnapshot<PSMoveSensorTunables> m_sensorTunables;
+
+	// Main thread state
+	unsigned int m_fetchedInputGeneration;
 
     // Worker thread state
     int m_nextPollSequenceNumber;
@@ -496,9 +503,6 @@ protected:
 // -- private prototypes -----
 static std::string PSMoveBTAddrUcharToString(const unsigned char* addr_buff);
 static bool stringToPSMoveBTAddrUchar(const std::string &addr, unsigned char *addr_buff, const int addr_buf_size);
-static short decode16bitSigned(char *data, int offset);
-static int decode16bitUnsignedToSigned(char *data, int offset);
-static int decode16bitTwosCompliment(char *data, int offset);
 inline enum CommonControllerState::ButtonState getButtonState(unsigned int buttons, unsigned int lastButtons, int buttonMask);
 inline unsigned int make_psmove_button_bitmask(const PSMoveDataInputZCM1 *hid_packet);
 inline unsigned int make_psmove_button_bitmask(const PSMoveDataInputZCM2 *hid_packet);
@@ -706,6 +710,14 @@ PSMoveControllerConfig::getMagnetometerEllipsoid(struct EigenFitEllipsoid *out_e
     out_ellipsoid->error= magnetometer_fit_error;
 }
 
+// -- PSMoveSensorTunables -----
+void PSMoveSensorTunables::applyConfig(const PSMoveControllerConfig &config)
+{
+	poll_timeout_ms = config.poll_timeout_ms;
+	cal_ag_xyz_kbd = config.cal_ag_xyz_kbd;
+	config.getMagnetometerEllipsoid(&magnetometer_ellipsoid);
+}
+
 // -- PSMoveControllerInputState -----
 PSMoveControllerInputState::PSMoveControllerInputState()
 {
@@ -747,7 +759,7 @@ void PSMoveControllerInputState::clear()
 }
 
 void PSMoveControllerInputState::parseDataInput(
-	const PSMoveControllerConfig *config,
+	const PSMoveSensorTunables *tunables,
 	const PSMoveDataInputZCM1 *previous_hid_packet,
 	const PSMoveDataInputZCM1 *current_hid_input)
 {
@@ -803,9 +815,9 @@ void PSMoveControllerInputState::parseDataInput(
 					const int raw_val = decode16bitUnsignedToSigned(data, totalOffset);
 
 					// Get the calibration parameters for this sensor value
-					const float k = config->cal_ag_xyz_kbd[s_ix][d_ix][0]; // calibration scale
-					const float b = config->cal_ag_xyz_kbd[s_ix][d_ix][1]; // calibration offset
-					const float d = config->cal_ag_xyz_kbd[s_ix][d_ix][2]; // calibration drift
+					const float k = tunables->cal_ag_xyz_kbd[s_ix][d_ix][0]; // calibration scale
+					const float b = tunables->cal_ag_xyz_kbd[s_ix][d_ix][1]; // calibration offset
+					const float d = tunables->cal_ag_xyz_kbd[s_ix][d_ix][2]; // calibration drift
 					const float calibrated_val= (static_cast<float>(raw_val) - d)*k + b;
 
 					// Save the raw sensor value
@@ -826,7 +838,6 @@ void PSMoveControllerInputState::parseDataInput(
 
     {
         Eigen::Vector3f raw_mag, calibrated_mag;
-        EigenFitEllipsoid ellipsoid;
 
         // Save the Raw Magnetometer sensor value (signed 12-bit values)
         RawMag[0] = TWELVE_BIT_SIGNED(((current_hid_input->templow_mXhigh & 0x0F) << 8) | current_hid_input->mXlow);
@@ -839,8 +850,7 @@ void PSMoveControllerInputState::parseDataInput(
         raw_mag = 
             Eigen::Vector3f(
                 static_cast<float>(RawMag[0]), static_cast<float>(RawMag[1]), static_cast<float>(RawMag[2]));
-        config->getMagnetometerEllipsoid(&ellipsoid);
-        calibrated_mag= eigen_alignment_project_point_on_ellipsoid_basis(raw_mag, ellipsoid);
+        calibrated_mag= eigen_alignment_project_point_on_ellipsoid_basis(raw_mag, tunables->magnetometer_ellipsoid);
 
         // Normalize the projected measurement (any deviation from unit length is error)
 		eigen_vector3f_normalize_with_default(calibrated_mag, Eigen::Vector3f(0.f, 1.f, 0.f));
@@ -859,7 +869,7 @@ void PSMoveControllerInputState::parseDataInput(
 }
 
 void PSMoveControllerInputState::parseDataInput(
-	const PSMoveControllerConfig *config,
+	const PSMoveSensorTunables *tunables,
 	const PSMoveDataInputZCM2 *previous_hid_packet,
 	const PSMoveDataInputZCM2 *current_hid_input)
 {
@@ -912,9 +922,9 @@ void PSMoveControllerInputState::parseDataInput(
 				const int raw_val = decode16bitTwosCompliment(data, totalOffset);
 
 				// Get the calibration parameters for this sensor value
-				const float k = config->cal_ag_xyz_kbd[s_ix][d_ix][0]; // calibration scale
-				const float b = config->cal_ag_xyz_kbd[s_ix][d_ix][1]; // calibration offset
-				const float d = config->cal_ag_xyz_kbd[s_ix][d_ix][2]; // calibration drift
+				const float k = tunables->cal_ag_xyz_kbd[s_ix][d_ix][0]; // calibration scale
+				const float b = tunables->cal_ag_xyz_kbd[s_ix][d_ix][1]; // calibration offset
+				const float d = tunables->cal_ag_xyz_kbd[s_ix][d_ix][2]; // calibration drift
 				const float calibrated_val= (static_cast<float>(raw_val) - d)*k + b;
 
 				// Save the raw sensor value
@@ -969,6 +979,7 @@ PSMoveController::PSMoveController()
 	HIDDetails.product_id = -1;
     HIDDetails.Handle = nullptr;
     HIDDetails.Handle_addr = nullptr;
+	TrackingColorID = eCommonTrackingColorID::INVALID_COLOR;
 	memset(&m_cachedInputState, 0, sizeof(PSMoveControllerInputState));
 	memset(&m_cachedOutputState, 0, sizeof(PSMoveControllerOutputState));
 }
@@ -1125,6 +1136,8 @@ bool PSMoveController::open(
 				// Always save the config back out in case some defaults changed
 				bSaveConfig = true;
 
+				TrackingColorID = cfg.tracking_color_id;
+
                 success= true;
             }
             else
@@ -1246,14 +1259,20 @@ PSMoveController::setHostBluetoothAddress(const std::string &new_host_bt_addr)
 }
 
 bool
-PSMoveController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id)
+PSMoveController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig)
 {
 	bool bSuccess = false;
 
 	if (getIsOpen() && getIsBluetooth())
 	{
-		cfg.tracking_color_id = tracking_color_id;
-		cfg.save();
+		TrackingColorID = tracking_color_id;
+
+		if (bUpdateConfig)
+		{
+			cfg.tracking_color_id = tracking_color_id;
+			cfg.save();
+		}
+
 		bSuccess = true;
 	}
 
@@ -1837,7 +1856,7 @@ PSMoveController::getTrackingColorID(eCommonTrackingColorID &out_tracking_color_
 
 	if (getIsOpen() && getIsBluetooth())
 	{
-		out_tracking_color_id = cfg.tracking_color_id;
+		out_tracking_color_id = TrackingColorID;
 		bSuccess = true;
 	}
 
@@ -1911,6 +1930,7 @@ void
 PSMoveController::setConfig(const PSMoveControllerConfig *config)
 {
 	cfg= *config;
+	TrackingColorID = cfg.tracking_color_id;
 
 	if (m_HIDPacketProcessor != nullptr)
 	{
@@ -2027,32 +2047,6 @@ stringToPSMoveBTAddrUchar(const std::string &addr, unsigned char *addr_buff, con
     return success;
 }
 
-static short
-decode16bitSigned(char *data, int offset)
-{
-    unsigned short low = data[offset] & 0xFF;
-    unsigned short high = (data[offset+1]) & 0xFF;
-    return (short)(low | (high << 8));
-}
-
-static int
-decode16bitUnsignedToSigned(char *data, int offset)
-{
-    unsigned char low = data[offset] & 0xFF;
-    unsigned char high = (data[offset+1]) & 0xFF;
-    return (low | (high << 8)) - 0x8000;
-}
-
-static int
-decode16bitTwosCompliment(char *data, int offset)
-{
-    unsigned char low = data[offset] & 0xFF;
-    unsigned char high = (data[offset+1]) & 0xFF;
-    int value= (low | (high << 8));
-
-	return (value & 0x8000) ? (-(~value & 0xFFFF) + 1) : value;
-}
-
 inline enum CommonControllerState::ButtonState
 getButtonState(unsigned int buttons, unsigned int lastButtons, int buttonMask)
 {
@@ -5,6 +5,7 @@
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
 #include "MathUtility.h"
+#include "MathAlignment.h"
 #include "hidapi.h"
 #include <string>
 #include <array>
@@ -180,6 +181,20 @@ public:
 	std::string hand;
 };
 
+// The part of the config the HID packet processor reads for every packet.
+// It gets its own immutable copy whenever the config changes,
+// rather than copying the whole config (strings and all) out for each packet.
+struct PSMoveSensorTunables
+{
+	unsigned int snapshot_version;
+
+	long poll_timeout_ms;
+	std::array<std::array<std::array<float, 3>, 3>, 2> cal_ag_xyz_kbd;
+	EigenFitEllipsoid magnetometer_ellipsoid;
+
+	void applyConfig(const PSMoveControllerConfig &config);
+};
+
 struct PSMoveControllerInputState : public CommonControllerState
 {
     int RawSequence;                            // 4-bit (1..16).
@@ -217,11 +232,11 @@ struct PSMoveControllerInputState : public CommonControllerState
 
     void clear();
 	void parseDataInput(
-		const PSMoveControllerConfig *config, 
+		const PSMoveSensorTunables *tunables, 
 		const struct PSMoveDataInputZCM1 *previous_hid_packet,
 		const struct PSMoveDataInputZCM1 *new_hid_packet);
 	void parseDataInput(
-		const PSMoveControllerConfig *config, 
+		const PSMoveSensorTunables *tunables, 
 		const struct PSMoveDataInputZCM2 *previous_hid_packet,
 		const struct PSMoveDataInputZCM2 *new_hid_packet);
 };
@@ -268,7 +283,7 @@ public:
     
     // -- IControllerInterface
     virtual bool setHostBluetoothAddress(const std::string &address) override;
-	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id) override;
+	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig) override;
     virtual bool getIsBluetooth() const override;
     virtual std::string getUSBDevicePath() const override;
 	virtual int getVendorID() const override;
@@ -314,6 +329,8 @@ private:
 
     // Cached MainThread Controller State
     unsigned long LedPWMF;
+	// Only the same as cfg.tracking_color_id while that is the last color set with bUpdateConfig
+	eCommonTrackingColorID TrackingColorID;
 	PSMoveControllerInputState m_cachedInputState;
 	PSMoveControllerOutputState m_cachedOutputState;
 
@@ -0,0 +1,30 @@
+#ifndef PSMOVE_SENSOR_DECODING_H
+#define PSMOVE_SENSOR_DECODING_H
+
+//-- interface -----
+/// Little endian 16-bit two's complement value at data[offset]
+inline short
+decode16bitSigned(char *data, int offset)
+{
+    unsigned short low = data[offset] & 0xFF;
+    unsigned short high = (data[offset+1]) & 0xFF;
+    return (short)(low | (high << 8));
+}
+
+/// Little endian 16-bit offset binary value (0x8000 is zero) at data[offset], as used by ZCM1 sensor reports
+inline int
+decode16bitUnsignedToSigned(char *data, int offset)
+{
+    unsigned char low = data[offset] & 0xFF;
+    unsigned char high = (data[offset+1]) & 0xFF;
+    return (low | (high << 8)) - 0x8000;
+}
+
+/// Little endian 16-bit two's complement value at data[offset], as used by ZCM2 sensor reports
+inline int
+decode16bitTwosCompliment(char *data, int offset)
+{
+    return decode16bitSigned(data, offset);
+}
+
+#endif // PSMOVE_SENSOR_DECODING_H
@@ -255,15 +255,22 @@ PS3EyeTrackerConfig::getOrAddColorRangeTable(const std::string &table_name)
 }
 
 // -- PS3EYE Tracker
-PS3EyeTracker::PS3EyeTracker()
+PS3EyeTracker::PS3EyeTracker(const int tracker_id)
     : cfg()
     , USBDevicePath()
     , VideoCapture(nullptr)
     , CaptureData(nullptr)
     , DriverType(PS3EyeTracker::Libusb)
+    , TrackerId(tracker_id)
     , NextPollSequenceNumber(0)
     , TrackerStates()
+    , FrameArrivalTime()
+    , bFrameArrivalTimeValid(false)
+    , CapturedFrameCounter()
+    , DroppedFrameCounter()
+    , LastDroppedFrameCount(0)
 {
+    TrackerPose.clear();
 }
 
 PS3EyeTracker::~PS3EyeTracker()
@@ -325,6 +332,9 @@ bool PS3EyeTracker::open(const DeviceEnumerator *enumerator)
 
         SERVER_LOG_INFO("PS3EyeTracker::open") << "Opening PS3EyeTracker(" << cur_dev_path << ", camera_index=" << camera_index << ")";
 
+        // A new capture counts its dropped frames from zero
+        LastDroppedFrameCount = 0;
+
 		switch (tracker_enumerator->get_device_type())
 		{
 			case CommonDeviceState::eDeviceType::PS3EYE:
@@ -379,6 +389,8 @@ bool PS3EyeTracker::open(const DeviceEnumerator *enumerator)
 		// Save the config back out again in case defaults changed
 		cfg.save();
 
+		TrackerPose = cfg.pose;
+
 		VideoCapture->set(cv::CAP_PROP_FRAME_WIDTH, cfg.frame_width);
 		VideoCapture->set(cv::CAP_PROP_EXPOSURE, cfg.exposure);
 		VideoCapture->set(cv::CAP_PROP_GAIN, cfg.gain);
@@ -407,13 +419,18 @@ IDeviceInterface::ePollResult PS3EyeTracker::poll()
 		// Prepare frames whenever we can.
 		if (VideoCapture->grab())
 		{
-			if ((bool)VideoCapture->get(CV_CAP_PROP_FRAMEAVAILABLE))
+			const bool bFrameAvailable = (bool)VideoCapture->get(CV_CAP_PROP_FRAMEAVAILABLE);
+
+			if (bFrameAvailable && !bFrameArrivalTimeValid)
 			{
-				TrackerManager::setTrackFrameAvailable(VideoCapture->getIndex());
+				FrameArrivalTime = std::chrono::high_resolution_clock::now();
+				bFrameArrivalTimeValid = true;
 			}
 
-			// Only poll frames when every tracker is ready to sync freams.
-			if (!TrackerManager::isReadyToReceive() ||
+			// Leave new frames in the capture while the last one we retrieved 
+			// is still waiting to be grouped with the other trackers' frames.
+			if (!bFrameAvailable ||
+				!TrackerManager::canReceiveFrame(TrackerId) ||
 				!VideoCapture->retrieve(CaptureData->frame, cv::CAP_OPENNI_BGR_IMAGE))
 			{
 				// Device still in valid state
@@ -424,8 +441,20 @@ IDeviceInterface::ePollResult PS3EyeTracker::poll()
 				// New data available. Keep iterating.
 				result = IControllerInterface::_PollResultSuccessNewData;
 
-				// We received the frame and every tracker polled. We need a new frame!
+				// We received the frame. We need a new frame!
 				VideoCapture->set(CV_CAP_PROP_FRAMEAVAILABLE, false);
+
+				TrackerManager::setTrackerFrameReceived(TrackerId, FrameArrivalTime);
+				bFrameArrivalTimeValid = false;
+
+				const int64_t dropped_frame_count = static_cast<int64_t>(VideoCapture->get(CV_CAP_PROP_DROPPEDFRAMES));
+
+				CapturedFrameCounter.add();
+				if (dropped_frame_count > LastDroppedFrameCount)
+				{
+					DroppedFrameCounter.add(dropped_frame_count - LastDroppedFrameCount);
+				}
+				LastDroppedFrameCount = dropped_frame_count;
 			}
 		}
 		else
@@ -506,6 +535,11 @@ std::string PS3EyeTracker::getUSBDevicePath() const
     return USBDevicePath;
 }
 
+int PS3EyeTracker::getCameraIndex() const
+{
+    return (VideoCapture != nullptr) ? VideoCapture->getIndex() : -1;
+}
+
 bool PS3EyeTracker::getVideoFrameDimensions(
     int *out_width,
     int *out_height,
@@ -585,6 +619,8 @@ void PS3EyeTracker::loadSettings()
 
     cfg.load();
 
+    TrackerPose = cfg.pose;
+
 	if (currentFrameWidth != cfg.frame_width)
 	{
 		VideoCapture->set(cv::CAP_PROP_FRAME_WIDTH, cfg.frame_width);
@@ -750,14 +786,20 @@ void PS3EyeTracker::setCameraIntrinsics(
 
 CommonDevicePose PS3EyeTracker::getTrackerPose() const
 {
-    return cfg.pose;
+    return TrackerPose;
 }
 
 void PS3EyeTracker::setTrackerPose(
-    const struct CommonDevicePose *pose)
+    const struct CommonDevicePose *pose,
+    bool bUpdateConfig)
 {
-    cfg.pose = *pose;
-    cfg.save();
+    TrackerPose = *pose;
+
+    if (bUpdateConfig)
+    {
+        cfg.pose = *pose;
+        cfg.save();
+    }
 }
 
 void PS3EyeTracker::getFOV(float &outHFOV, float &outVFOV) const
@@ -860,3 +902,11 @@ void PS3EyeTracker::getTrackingColorPreset(
 
     *out_preset = table->color_presets[color];
 }
+
+void PS3EyeTracker::getCaptureMetrics(
+	MetricCounterStats &out_captured_frames,
+	MetricCounterStats &out_dropped_frames) const
+{
+	CapturedFrameCounter.getStats(out_captured_frames);
+	DroppedFrameCounter.getStats(out_dropped_frames);
+}
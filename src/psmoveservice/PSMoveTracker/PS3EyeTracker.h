@@ -5,6 +5,8 @@
 #include "PSMoveConfig.h"
 #include "DeviceEnumerator.h"
 #include "DeviceInterface.h"
+#include "ServiceMetrics.h"
+#include <chrono>
 #include <string>
 #include <vector>
 #include <deque>
@@ -81,7 +83,7 @@ struct PS3EyeTrackerState : public CommonDeviceState
 
 class PS3EyeTracker : public ITrackerInterface {
 public:
-    PS3EyeTracker();
+    PS3EyeTracker(const int tracker_id);
     virtual ~PS3EyeTracker();
         
     // PSMoveTracker
@@ -128,7 +130,7 @@ public:
         float distortionK1, float distortionK2, float distortionK3,
         float distortionP1, float distortionP2) override;
     CommonDevicePose getTrackerPose() const override;
-    void setTrackerPose(const struct CommonDevicePose *pose) override;
+    void setTrackerPose(const struct CommonDevicePose *pose, bool bUpdateConfig) override;
     void getFOV(float &outHFOV, float &outVFOV) const override;
     void getZRange(float &outZNear, float &outZFar) const override;
     void gatherTrackerOptions(PSMoveProtocol::Response_ResultTrackerSettings* settings) const override;
@@ -137,10 +139,12 @@ public:
     void gatherTrackingColorPresets(const std::string &controller_serial, PSMoveProtocol::Response_ResultTrackerSettings* settings) const override;
     void setTrackingColorPreset(const std::string &controller_serial, eCommonTrackingColorID color, const CommonHSVColorRange *preset) override;
     void getTrackingColorPreset(const std::string &controller_serial, eCommonTrackingColorID color, CommonHSVColorRange *out_preset) const override;
+    void getCaptureMetrics(MetricCounterStats &out_captured_frames, MetricCounterStats &out_dropped_frames) const override;
 
     // -- Getters
     inline const PS3EyeTrackerConfig &getConfig() const
     { return cfg; }
+    int getCameraIndex() const;
 
 private:
     PS3EyeTrackerConfig cfg;
@@ -148,9 +152,26 @@ private:
     class PSEyeVideoCapture *VideoCapture;
     class PSEyeCaptureData *CaptureData;
     ITrackerInterface::eDriverType DriverType;    
+
+    // The pose in use, only the same as cfg.pose while that is the last pose set with bUpdateConfig
+    CommonDevicePose TrackerPose;
     
+    // Tracker device id, used for frame grouping in the tracker manager.
+    // Not the same as the video capture index when USB enumeration order differs from the tracker list order.
+    int TrackerId;
+
     // Read Controller State
     int NextPollSequenceNumber;
     std::deque<PS3EyeTrackerState> TrackerStates;
+
+    // When the frame waiting in the capture was first seen by grab().
+    // The PS3 Eye doesn't timestamp frames, this is as close to the capture time as we get.
+    std::chrono::time_point<std::chrono::high_resolution_clock> FrameArrivalTime;
+    bool bFrameArrivalTimeValid;
+
+    // Written on the thread polling the tracker
+    MetricCounter CapturedFrameCounter;
+    MetricCounter DroppedFrameCounter;
+    int64_t LastDroppedFrameCount;
 };
 #endif // PS3EYE_TRACKER_H
@@ -6,6 +6,8 @@
 #include <chrono>
 #ifdef HAVE_PS3EYE
 #include "ps3eye.h"
+#include <atomic>
+#include <thread>
 #endif
 #ifdef HAVE_CLEYE
 #include "CLEyeMulticam.h"
@@ -22,6 +24,14 @@ const char *CL_DRIVER_REG_PATH = "Software\\PS3EyeCamera\\Settings";  // [HKCU]
 #include <tchar.h>
 #include <strsafe.h>
 #include <fstream>
+#else
+#include "PSMoveConfig.h"
+#include "SharedTrackerState.h"
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 #endif
 
 enum
@@ -267,13 +277,28 @@ protected:
 #endif
 
 #ifdef HAVE_PS3EYE
+// Low bits of the shared buffer state hold the buffer index, this bit marks a frame not yet taken
+#define PS3EYE_BUFFER_INDEX_MASK 0x3
+#define PS3EYE_BUFFER_FRESH_FLAG 0x4
+
 /// Implementation of PS3EyeCapture when using PS3EYEDriver
+/**
+Each camera gets its own capture worker thread that pulls the bayer frames from the driver
+and debayers them, so that the debayering of several cameras runs in parallel
+instead of one after another on the service thread.
+The worker and grabFrame() share the converted frames as a triple buffer:
+the worker fills the back buffer and swaps it with the shared buffer,
+grabFrame() swaps the shared buffer with the front buffer when it holds a frame not taken yet.
+Neither side ever waits on the other and grabFrame() always gets the newest frame.
+*/
 class PSEYECaptureCAM_PS3EYE : public cv::IVideoCapture
 {
 public:
     PSEYECaptureCAM_PS3EYE(int _index)
     : m_index(-1), m_width(-1), m_height(-1), m_widthStep(-1), m_frameAvailable(false), m_waitFrame(false),
-    m_size(-1), m_MatBayer(0, 0, CV_8UC1)
+    m_size(-1), m_MatBayer(0, 0, CV_8UC1),
+    m_sharedBufferState(1), m_backBufferIndex(0), m_frontBufferIndex(2), m_droppedFrameCount(0),
+    m_workerExitSignaled(false), m_workerStarted(false)
     {
         //CoInitialize(NULL);
         open(_index);
@@ -313,6 +338,8 @@ public:
 			return (bool)m_frameAvailable;
 		case CV_CAP_PROP_WAITFRAME:
 			return (bool)m_waitFrame;
+		case CV_CAP_PROP_DROPPEDFRAMES:
+			return (double)m_droppedFrameCount.load(std::memory_order_relaxed);
         }
         return 0;
     }
@@ -324,6 +351,88 @@ public:
             return false;
         }
 
+		// Changing the stream settings restarts the stream and resizes the bayer frame the worker writes to
+		const bool bPauseWorker =
+			property_id == CV_CAP_PROP_FPS ||
+			property_id == CV_CAP_PROP_FRAME_HEIGHT ||
+			property_id == CV_CAP_PROP_FRAME_WIDTH;
+
+		if (bPauseWorker)
+		{
+			stopCaptureWorker();
+		}
+
+		const bool bSuccess = setEyeProperty(property_id, value);
+
+		if (bPauseWorker)
+		{
+			// Match the buffers to whatever mode the camera ended up in, even when the change failed
+			refreshDimensions();
+			startCaptureWorker();
+		}
+
+		return bSuccess;
+	}
+
+    bool grabFrame()
+    {
+		if (!eye->isStreaming())
+			return false;
+
+		if (!m_waitFrame && m_frameAvailable)
+			return true;
+
+		// Take the newest frame from the worker, or in wait mode block until it has one
+		while (!takeNewFrame())
+		{
+			if (!m_waitFrame || !eye->isStreaming())
+				return false;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		m_frameAvailable = true;
+		return true;
+    }
+
+    bool retrieveFrame(int outputType, cv::OutputArray outArray)
+    {
+		if (!m_waitFrame && !m_frameAvailable)
+			return false;
+
+		m_frameBuffers[m_frontBufferIndex].copyTo(outArray);
+        return true;
+    }
+
+    int getCaptureDomain() {
+        return PSEYE_CAP_PS3EYE;
+    }
+    
+    bool isOpened() const
+    {
+        return (m_index != -1);
+    }
+
+    std::string getUniqueIndentifier() const
+    {
+        std::string identifier = "ps3eye_";
+
+        if (isOpened())
+        {
+            char usb_port_path[128];
+
+            if (eye->getUSBPortPath(usb_port_path, sizeof(usb_port_path)))
+            {
+                identifier.append(usb_port_path);
+            }
+        }
+
+        return identifier;
+    }
+protected:
+
+    bool setEyeProperty(int property_id, double value)
+    {
 		int val;
 		bool refresh = true;
 
@@ -391,63 +500,8 @@ public:
         return true;
     }
 
-    bool grabFrame()
-    {
-		if (!eye->isStreaming())
-			return false;
-
-		if (!m_waitFrame && m_frameAvailable)
-			return true;
-
-		bool success = eye->getFrame(m_MatBayer.data, m_waitFrame);
-		if (!success)
-			return false;
-
-		cv::cvtColor(m_MatBayer, capFrame, CV_BayerGB2BGR);
-		m_frameAvailable = true;
-		return true;
-    }
-
-    bool retrieveFrame(int outputType, cv::OutputArray outArray)
-    {
-		if (!m_waitFrame && !m_frameAvailable)
-			return false;
-
-		capFrame.copyTo(outArray);
-        return true;
-    }
-
-    int getCaptureDomain() {
-        return PSEYE_CAP_PS3EYE;
-    }
-    
-    bool isOpened() const
-    {
-        return (m_index != -1);
-    }
-
-    std::string getUniqueIndentifier() const
-    {
-        std::string identifier = "ps3eye_";
-
-        if (isOpened())
-        {
-            char usb_port_path[128];
-
-            if (eye->getUSBPortPath(usb_port_path, sizeof(usb_port_path)))
-            {
-                identifier.append(usb_port_path);
-            }
-        }
-
-        return identifier;
-    }
-protected:
-    
     bool open(int _index)
     {
-		capFrame = cv::Mat(480, 640, CV_8UC3, CvScalar(0, 0, 0));
-
         // Enumerate libusb devices
         std::vector<ps3eye::PS3EYECam::PS3EYERef> devices = ps3eye::PS3EYECam::getDevices();
 		std::cout << "ps3eye::PS3EYECam::getDevices() found " << devices.size() << " devices." << std::endl;
@@ -469,6 +523,8 @@ protected:
                 
                 m_index = _index;
                 refreshDimensions();
+
+                startCaptureWorker();
                 
                 return true;
             }
@@ -478,33 +534,126 @@ protected:
     
     void close()
     {
+        stopCaptureWorker();
+
         // eye will close itself when going out of scope.
         m_index = -1;
     }
+
+    void startCaptureWorker()
+    {
+        if (!m_workerStarted && eye)
+        {
+            m_workerExitSignaled.store(false);
+            m_captureWorker = std::thread(&PSEYECaptureCAM_PS3EYE::captureWorkerFunc, this);
+            m_workerStarted = true;
+        }
+    }
+
+    void stopCaptureWorker()
+    {
+        if (m_workerStarted)
+        {
+            m_workerExitSignaled.store(true);
+            m_captureWorker.join();
+            m_workerStarted = false;
+
+            // Drop the frame waiting in the buffers, it belongs to the stream that just stopped
+            m_sharedBufferState.store(m_sharedBufferState.load() & PS3EYE_BUFFER_INDEX_MASK);
+            m_frameAvailable = false;
+        }
+    }
+
+    // Capture worker thread
+    void captureWorkerFunc()
+    {
+        while (!m_workerExitSignaled.load())
+        {
+            // Don't block in the driver so that the worker can be stopped at any time
+            if (eye->isStreaming() && eye->getFrame(m_MatBayer.data, false))
+            {
+                cv::cvtColor(m_MatBayer, m_frameBuffers[m_backBufferIndex], CV_BayerGB2BGR);
+
+                // Publish the new frame and take back whichever buffer was shared
+                const int old_state = m_sharedBufferState.exchange(m_backBufferIndex | PS3EYE_BUFFER_FRESH_FLAG);
+                m_backBufferIndex = old_state & PS3EYE_BUFFER_INDEX_MASK;
+
+                // The frame it replaced was never taken
+                if ((old_state & PS3EYE_BUFFER_FRESH_FLAG) != 0)
+                {
+                    m_droppedFrameCount.store(m_droppedFrameCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    // Swaps a frame the worker published since the last call into the front buffer
+    bool takeNewFrame()
+    {
+        if ((m_sharedBufferState.load() & PS3EYE_BUFFER_FRESH_FLAG) == 0)
+        {
+            return false;
+        }
+
+        const int old_state = m_sharedBufferState.exchange(m_frontBufferIndex);
+        m_frontBufferIndex = old_state & PS3EYE_BUFFER_INDEX_MASK;
+
+        return true;
+    }
     
     void refreshDimensions()
     {
+        const int old_width = m_width;
+        const int old_height = m_height;
+        const size_t old_size = m_size;
+
         m_width = eye->getWidth();
         m_widthStep = eye->getRowBytes(); // just width * 1 byte per pixel.
         m_height = eye->getHeight();
         m_size = m_widthStep * m_height;
         m_MatBayer.create(cv::Size(m_width, m_height), CV_8UC1);
+
+        // The frame size only changes while the worker is stopped (see setProperty).
+        // Every buffer has to match the new mode so a frame is never read back at the wrong size.
+        if (m_width != old_width || m_height != old_height || m_size != old_size)
+        {
+            for (int buffer_index = 0; buffer_index < 3; ++buffer_index)
+            {
+                m_frameBuffers[buffer_index] = cv::Mat(m_height, m_width, CV_8UC3, CvScalar(0, 0, 0));
+            }
+        }
     }
 
     int m_index, m_width, m_height, m_widthStep;
 	bool m_frameAvailable, m_waitFrame;
 
     size_t m_size;
-    cv::Mat m_MatBayer;
-	cv::Mat capFrame;
+    cv::Mat m_MatBayer; // Only touched by the worker while it runs
     ps3eye::PS3EYECam::PS3EYERef eye;
+
+    // Converted frames, see the class comment
+    cv::Mat m_frameBuffers[3];
+    std::atomic_int m_sharedBufferState; // Shared buffer index | PS3EYE_BUFFER_FRESH_FLAG
+    int m_backBufferIndex; // Worker owned
+    int m_frontBufferIndex; // grabFrame() owned
+    std::atomic<int64_t> m_droppedFrameCount; // Worker owned
+
+    std::thread m_captureWorker;
+    std::atomic_bool m_workerExitSignaled;
+    bool m_workerStarted;
 };
 
 #endif
 
-#ifdef WIN32
-#define VRIT_BUFF_SIZE (480 * 640 * 3)
+#define VRIT_FRAME_WIDTH 640
+#define VRIT_FRAME_HEIGHT 480
+#define VRIT_BUFF_SIZE (VRIT_FRAME_HEIGHT * VRIT_FRAME_WIDTH * 3)
 
+#ifdef WIN32
 /// Implementation of PS3EyeCapture using named pipes
 class PSEYECaptureCAM_VIRTUAL : public cv::IVideoCapture
 {
@@ -772,6 +921,412 @@ protected:
 	cv::Mat capFrame;
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastRequest;
 };
+#else
+#define VRIT_DEFAULT_FRAME_RATE 30.0
+#define VRIT_RECONNECT_INTERVAL_MS 1000
+
+/// Implementation of PS3EyeCapture using memory mapped frame sources.
+/// Frames come from a recording if one exists, i.e. "VirtPSeyeStream_<index>.raw" in the config directory
+/// holding back to back 640x480 BGR frames (the same payload the Windows named pipe carries).
+/// Otherwise frames come from a shared memory producer "PSMoveSerivceEx_VirtPSeyeStream_<index>"
+/// laid out as a SharedVideoFrameHeader followed by the frame, the same layout the service publishes.
+/// Frames are handed out at the configured frame rate, so a headless box can run N of these
+/// through the full optical pipeline.
+class PSEYECaptureCAM_VIRTUAL : public cv::IVideoCapture
+{
+public:
+	PSEYECaptureCAM_VIRTUAL(int _index) :
+		m_index(-1), m_frameAvailable(false), m_frameRate(VRIT_DEFAULT_FRAME_RATE),
+		m_recordingMapping(nullptr), m_recordingRegion(nullptr),
+		m_recordingFrameCount(0), m_recordingFrameIndex(0),
+		m_streamObject(nullptr), m_streamRegion(nullptr), m_lastStreamFrameIndex(-1)
+	{
+		open(_index);
+	}
+
+	~PSEYECaptureCAM_VIRTUAL()
+	{
+		close();
+	}
+
+	// Only the frame rate can be changed on virtual trackers.
+	double getProperty(int property_id) const
+	{
+		switch (property_id)
+		{
+		case CV_CAP_PROP_FPS:
+			return m_frameRate;
+		case CV_CAP_PROP_FRAME_HEIGHT:
+			return VRIT_FRAME_HEIGHT;
+		case CV_CAP_PROP_FRAME_WIDTH:
+			return VRIT_FRAME_WIDTH;
+		case CV_CAP_PROP_FORMAT:
+			return cv::CAP_MODE_RGB;
+		case CV_CAP_PROP_FRAMEAVAILABLE:
+			return (bool)m_frameAvailable;
+		}
+		return 0;
+	}
+
+	bool setProperty(int property_id, double value)
+	{
+		switch (property_id)
+		{
+		case CV_CAP_PROP_FPS:
+			if (value > 0)
+			{
+				m_frameRate = value;
+				return true;
+			}
+			break;
+		case CV_CAP_PROP_FRAMEAVAILABLE:
+			m_frameAvailable = (bool)value;
+			break;
+		}
+
+		return false;
+	}
+
+	bool grabFrame()
+	{
+		// Hold on to the current frame until it has been consumed
+		if (m_frameAvailable)
+			return true;
+
+		// Pace the frames at the configured frame rate
+		const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
+		if (now < m_nextFrameTime)
+			return true;
+
+		const std::chrono::nanoseconds frame_period(static_cast<long long>(1000000000.0 / m_frameRate));
+		m_nextFrameTime += frame_period;
+		if (m_nextFrameTime < now)
+		{
+			// Fell more than a frame behind (or this is the first frame), so don't try to catch up
+			m_nextFrameTime = now + frame_period;
+		}
+
+		if (m_recordingRegion != nullptr)
+		{
+			// Point straight into the mapping rather than copying the frame.
+			// retrieveFrame() only ever reads from it.
+			const unsigned char *recording = static_cast<const unsigned char *>(m_recordingRegion->get_address());
+			m_currentFrame = cv::Mat(
+				VRIT_FRAME_HEIGHT, VRIT_FRAME_WIDTH, CV_8UC3,
+				const_cast<unsigned char *>(recording + static_cast<size_t>(m_recordingFrameIndex) * VRIT_BUFF_SIZE));
+			m_recordingFrameIndex = (m_recordingFrameIndex + 1) % m_recordingFrameCount;
+
+			m_frameAvailable = true;
+			return true;
+		}
+
+		if (m_streamRegion == nullptr &&
+			now - m_lastConnectAttempt >= std::chrono::milliseconds(VRIT_RECONNECT_INTERVAL_MS))
+		{
+			m_lastConnectAttempt = now;
+			openStream();
+		}
+
+		if (m_streamRegion != nullptr)
+		{
+			SharedVideoFrameHeader *header = static_cast<SharedVideoFrameHeader *>(m_streamRegion->get_address());
+			boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(header->mutex);
+
+			if (header->width == VRIT_FRAME_WIDTH &&
+				header->height == VRIT_FRAME_HEIGHT &&
+				header->stride == VRIT_FRAME_WIDTH * 3)
+			{
+				// No new frame from the producer yet
+				if (header->frame_index == m_lastStreamFrameIndex)
+					return true;
+
+				memcpy((uchar*)capFrame.data, header->getBuffer(), VRIT_BUFF_SIZE);
+				m_lastStreamFrameIndex = header->frame_index;
+				m_currentFrame = capFrame;
+
+				m_frameAvailable = true;
+				return true;
+			}
+		}
+
+		capFrame.setTo(cv::Scalar(0, 0, 0));
+		cv::putText(
+			capFrame,
+			"Virtual tracker not connected.",
+			cv::Point(64, capFrame.rows / 2),
+			cv::FONT_HERSHEY_DUPLEX,
+			1.0,
+			CvScalar(255, 255, 255),
+			2
+		);
+		m_currentFrame = capFrame;
+
+		m_frameAvailable = true;
+		return true;
+	}
+
+	bool retrieveFrame(int outputType, cv::OutputArray outArray)
+	{
+		if (!m_frameAvailable)
+			return false;
+
+		m_currentFrame.copyTo(outArray);
+		return true;
+	}
+
+	int getCaptureDomain() {
+		return CV_CAP_IMAGES;
+	}
+
+	bool isOpened() const
+	{
+		return (m_index != -1);
+	}
+
+	std::string getUniqueIndentifier() const
+	{
+		std::string identifier = "virtual_";
+		identifier.append(std::to_string(m_index));
+
+		return identifier;
+	}
+
+protected:
+
+	bool open(int _index)
+	{
+		m_index = _index;
+		capFrame = cv::Mat(VRIT_FRAME_HEIGHT, VRIT_FRAME_WIDTH, CV_8UC3, CvScalar(0, 0, 0));
+		m_currentFrame = capFrame;
+		m_nextFrameTime = std::chrono::high_resolution_clock::now();
+		m_lastConnectAttempt = m_nextFrameTime - std::chrono::milliseconds(VRIT_RECONNECT_INTERVAL_MS);
+
+		std::cout << "ps3eye::VIRTUAL() index " << m_index << " open." << std::endl;
+
+		// Prefer a recording over a live producer
+		std::string stream_name = "VirtPSeyeStream_";
+		stream_name.append(std::to_string(m_index));
+
+		boost::filesystem::path recording_path(PSMoveConfig::getConfigDirectory());
+		recording_path /= stream_name + ".raw";
+
+		boost::system::error_code error;
+		const uintmax_t recording_size = boost::filesystem::file_size(recording_path, error);
+		if (!error && recording_size >= VRIT_BUFF_SIZE)
+		{
+			try
+			{
+				m_recordingMapping = new boost::interprocess::file_mapping(recording_path.string().c_str(), boost::interprocess::read_only);
+				m_recordingRegion = new boost::interprocess::mapped_region(*m_recordingMapping, boost::interprocess::read_only);
+				m_recordingFrameCount = static_cast<int>(m_recordingRegion->get_size() / VRIT_BUFF_SIZE);
+				m_recordingFrameIndex = 0;
+
+				std::cout << "ps3eye::VIRTUAL() " << recording_path.string() << " mapped, " << m_recordingFrameCount << " frames." << std::endl;
+			}
+			catch (boost::interprocess::interprocess_exception &e)
+			{
+				std::cout << "ps3eye::VIRTUAL() " << recording_path.string() << " mapping failed!, " << e.what() << std::endl;
+				closeRecording();
+			}
+		}
+
+		return true;
+	}
+
+	bool openStream()
+	{
+		std::string stream_name = "PSMoveSerivceEx_VirtPSeyeStream_";
+		stream_name.append(std::to_string(m_index));
+
+		try
+		{
+			m_streamObject = new boost::interprocess::shared_memory_object(
+				boost::interprocess::open_only,
+				stream_name.c_str(),
+				boost::interprocess::read_write);
+			m_streamRegion = new boost::interprocess::mapped_region(*m_streamObject, boost::interprocess::read_write);
+		}
+		catch (boost::interprocess::interprocess_exception &)
+		{
+			// The producer hasn't created the stream yet
+			closeStream();
+			return false;
+		}
+
+		if (m_streamRegion->get_size() < SharedVideoFrameHeader::computeTotalSize(VRIT_FRAME_WIDTH * 3, VRIT_FRAME_HEIGHT))
+		{
+			std::cout << "ps3eye::VIRTUAL() " << stream_name << " is too small for a 640x480 BGR frame." << std::endl;
+			closeStream();
+			return false;
+		}
+
+		std::cout << "ps3eye::VIRTUAL() " << stream_name << " connected." << std::endl;
+		m_lastStreamFrameIndex = -1;
+
+		return true;
+	}
+
+	void closeRecording()
+	{
+		if (m_recordingRegion != nullptr)
+		{
+			delete m_recordingRegion;
+			m_recordingRegion = nullptr;
+		}
+
+		if (m_recordingMapping != nullptr)
+		{
+			delete m_recordingMapping;
+			m_recordingMapping = nullptr;
+		}
+
+		m_recordingFrameCount = 0;
+		m_recordingFrameIndex = 0;
+	}
+
+	void closeStream()
+	{
+		if (m_streamRegion != nullptr)
+		{
+			delete m_streamRegion;
+			m_streamRegion = nullptr;
+		}
+
+		if (m_streamObject != nullptr)
+		{
+			delete m_streamObject;
+			m_streamObject = nullptr;
+		}
+	}
+
+	void close()
+	{
+		// Drop any view into the recording before unmapping it
+		m_currentFrame = capFrame;
+
+		closeRecording();
+		closeStream();
+
+		m_index = -1;
+	}
+
+	void refreshDimensions() {}
+
+	int m_index;
+	bool m_frameAvailable;
+	double m_frameRate;
+
+	boost::interprocess::file_mapping *m_recordingMapping;
+	boost::interprocess::mapped_region *m_recordingRegion;
+	int m_recordingFrameCount;
+	int m_recordingFrameIndex;
+
+	boost::interprocess::shared_memory_object *m_streamObject;
+	boost::interprocess::mapped_region *m_streamRegion;
+	int m_lastStreamFrameIndex;
+
+	cv::Mat capFrame;
+	cv::Mat m_currentFrame;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_nextFrameTime;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastConnectAttempt;
+};
+#endif
+
+/// Implementation of PS3EyeCapture pulling frames from an IVirtualTrackerFrameSource
+class PSEYECaptureCAM_SYNTHETIC : public cv::IVideoCapture
+{
+public:
+	PSEYECaptureCAM_SYNTHETIC(int _index, IVirtualTrackerFrameSource *frame_source) :
+		m_index(_index), m_frameAvailable(false), m_frameRate(30.0),
+		m_frameSource(frame_source),
+		capFrame(VRIT_FRAME_HEIGHT, VRIT_FRAME_WIDTH, CV_8UC3, CvScalar(0, 0, 0))
+	{
+		std::cout << "ps3eye::SYNTHETIC() index " << m_index << " open." << std::endl;
+	}
+
+	double getProperty(int property_id) const
+	{
+		switch (property_id)
+		{
+		case CV_CAP_PROP_FPS:
+			return m_frameRate;
+		case CV_CAP_PROP_FRAME_HEIGHT:
+			return VRIT_FRAME_HEIGHT;
+		case CV_CAP_PROP_FRAME_WIDTH:
+			return VRIT_FRAME_WIDTH;
+		case CV_CAP_PROP_FORMAT:
+			return cv::CAP_MODE_RGB;
+		case CV_CAP_PROP_FRAMEAVAILABLE:
+			return (bool)m_frameAvailable;
+		}
+		return 0;
+	}
+
+	bool setProperty(int property_id, double value)
+	{
+		switch (property_id)
+		{
+		case CV_CAP_PROP_FPS:
+			// The frame source decides when frames are produced
+			if (value > 0)
+			{
+				m_frameRate = value;
+				return true;
+			}
+			break;
+		case CV_CAP_PROP_FRAMEAVAILABLE:
+			m_frameAvailable = (bool)value;
+			break;
+		}
+
+		return false;
+	}
+
+	bool grabFrame()
+	{
+		// Hold on to the current frame until it has been consumed
+		if (!m_frameAvailable && m_frameSource->renderVirtualTrackerFrame(m_index, capFrame))
+		{
+			m_frameAvailable = true;
+		}
+
+		return true;
+	}
+
+	bool retrieveFrame(int outputType, cv::OutputArray outArray)
+	{
+		if (!m_frameAvailable)
+			return false;
+
+		capFrame.copyTo(outArray);
+		return true;
+	}
+
+	int getCaptureDomain() {
+		return CV_CAP_IMAGES;
+	}
+
+	bool isOpened() const
+	{
+		return (m_index != -1);
+	}
+
+	// Share the virtual tracker identifier so the same tracker config gets used
+	std::string getUniqueIndentifier() const
+	{
+		std::string identifier = "virtual_";
+		identifier.append(std::to_string(m_index));
+
+		return identifier;
+	}
+
+protected:
+	int m_index;
+	bool m_frameAvailable;
+	double m_frameRate;
+	IVirtualTrackerFrameSource *m_frameSource;
+	cv::Mat capFrame;
+};
 
 static bool usingCLEyeDriver()
 {
@@ -797,12 +1352,18 @@ static bool usingCLEyeDriver()
 #endif
     return cleyedriver_found;
 }
-#endif
 
 
 /*
 -- Definitions for PSEyeVideoCapture --
 */
+IVirtualTrackerFrameSource *PSEyeVideoCapture::m_virtualFrameSource = nullptr;
+
+void PSEyeVideoCapture::setVirtualFrameSource(IVirtualTrackerFrameSource *frame_source)
+{
+	m_virtualFrameSource = frame_source;
+}
+
 bool PSEyeVideoCapture::open(int index)
 {
 	if (isOpened())
@@ -850,15 +1411,19 @@ bool PSEyeVideoCapture::open(int index)
 
 	if (m_iVideoCaptureType == eVideoCaptureType::CaptureType_VIRTUAL || m_iVideoCaptureType == eVideoCaptureType::CaptureType_ALL)
 	{
-#ifdef WIN32
-		icap = cv::makePtr<PSEYECaptureCAM_VIRTUAL>(index);
-		m_indentifier = icap.dynamicCast<PSEYECaptureCAM_VIRTUAL>()->getUniqueIndentifier();
+		if (m_virtualFrameSource != nullptr)
+		{
+			icap = cv::makePtr<PSEYECaptureCAM_SYNTHETIC>(index, m_virtualFrameSource);
+			m_indentifier = icap.dynamicCast<PSEYECaptureCAM_SYNTHETIC>()->getUniqueIndentifier();
+		}
+		else
+		{
+			icap = cv::makePtr<PSEYECaptureCAM_VIRTUAL>(index);
+			m_indentifier = icap.dynamicCast<PSEYECaptureCAM_VIRTUAL>()->getUniqueIndentifier();
+		}
 		m_index = index;
 
 		return (!icap.empty());
-#else
-		return isOpened();
-#endif
 	}
 
 	return isOpened();
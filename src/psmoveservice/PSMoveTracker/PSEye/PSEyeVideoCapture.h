@@ -7,6 +7,18 @@ enum
 {
 	CV_CAP_PROP_FRAMEAVAILABLE = -999,
 	CV_CAP_PROP_WAITFRAME,
+	CV_CAP_PROP_DROPPEDFRAMES, // Frames the capture replaced before they were grabbed, since it opened
+};
+
+/// Supplies frames to virtual trackers in place of their video stream (i.e. a synthetic benchmark scene).
+class IVirtualTrackerFrameSource
+{
+public:
+	virtual ~IVirtualTrackerFrameSource() {}
+
+	/// Render the next frame for the given virtual camera into a 640x480 BGR buffer.
+	/// Return false if there isn't a new frame for this camera yet.
+	virtual bool renderVirtualTrackerFrame(int camera_index, cv::Mat &bgr_frame) = 0;
 };
 
 /// Video capture class that prioritizes PS3 Eye devices.
@@ -67,12 +79,17 @@ public:
 
     /// Get the unique identifier for the camera
     std::string getUniqueIndentifier() const;
+
+    /// Virtual trackers opened while a frame source is set pull their frames from it
+    static void setVirtualFrameSource(IVirtualTrackerFrameSource *frame_source);
     
 protected:
     int m_index; /**< Keep track of index. Necessary for PSEYE_CLEYE_DRIVER */
 	eVideoCaptureType m_iVideoCaptureType;
     std::string m_indentifier; /**< Filled in when the tracker is opened */
 
+    static IVirtualTrackerFrameSource *m_virtualFrameSource;
+
 private:
     /// Get the camera capture. If successful, we will have a functional cv::Ptr<CvCapture> \ref cap member variable.
     cv::Ptr<cv::IVideoCapture> pseyeVideoCapture_create(int index);
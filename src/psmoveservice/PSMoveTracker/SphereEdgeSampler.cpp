@@ -0,0 +1,178 @@
+//-- includes -----
+#include "SphereEdgeSampler.h"
+#include "UndistortionGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+//-- constants -----
+// Enough for the hull of a bulb filling most of the frame
+static const size_t k_reserved_hull_points = 512;
+
+//-- public implementation -----
+SphereEdgeSampler::SphereEdgeSampler()
+	: m_convexHull()
+	, m_pointCount(0)
+{
+	m_convexHull.reserve(k_reserved_hull_points);
+}
+
+int SphereEdgeSampler::sampleContour(
+	const std::vector<cv::Point> &contour,
+	const cv::Mat &mask,
+	const UndistortionGrid &undistortion_grid)
+{
+	m_pointCount = 0;
+
+	// convexHull resizes the output vector, which keeps its capacity
+	cv::convexHull(contour, m_convexHull);
+
+	const int hull_count = static_cast<int>(m_convexHull.size());
+	if (hull_count < 3)
+	{
+		return 0;
+	}
+
+	// Hull centroid and perimeter
+	float center_x = 0.f, center_y = 0.f;
+	float perimeter = 0.f;
+	for (int index = 0; index < hull_count; ++index)
+	{
+		const cv::Point &a = m_convexHull[index];
+		const cv::Point &b = m_convexHull[(index + 1) % hull_count];
+
+		center_x += static_cast<float>(a.x);
+		center_y += static_cast<float>(a.y);
+		perimeter += sqrtf(static_cast<float>((b.x - a.x)*(b.x - a.x) + (b.y - a.y)*(b.y - a.y)));
+	}
+	center_x /= static_cast<float>(hull_count);
+	center_y /= static_cast<float>(hull_count);
+
+	// About one point per pixel of perimeter, but never fewer points than the hull had
+	const int max_edge_points = k_max_edge_points;
+	const int sample_count =
+		std::min(std::max(static_cast<int>(perimeter), std::min(hull_count, max_edge_points)), max_edge_points);
+	const float spacing = perimeter / static_cast<float>(sample_count);
+
+	// Contour points are in frame pixels, the mask may only be a view of the frame
+	cv::Size frame_size;
+	cv::Point mask_offset;
+	mask.locateROI(frame_size, mask_offset);
+
+	// Walk the hull, dropping a point every spacing pixels
+	int edge_index = 0;
+	float edge_start = 0.f; // Perimeter distance at the start of the current edge
+	for (int sample_index = 0; sample_index < sample_count; ++sample_index)
+	{
+		const float distance = (static_cast<float>(sample_index) + 0.5f)*spacing;
+
+		cv::Point2f a, b;
+		float edge_length;
+		for (;;)
+		{
+			a = cv::Point2f(m_convexHull[edge_index]);
+			b = cv::Point2f(m_convexHull[(edge_index + 1) % hull_count]);
+			edge_length = sqrtf((b - a).dot(b - a));
+
+			if (distance <= edge_start + edge_length || edge_index == hull_count - 1)
+			{
+				break;
+			}
+
+			edge_start += edge_length;
+			++edge_index;
+		}
+
+		const float u = (edge_length > 0.f) ? std::min((distance - edge_start) / edge_length, 1.f) : 0.f;
+		const cv::Point2f point = a + (b - a)*u;
+
+		// Edge normal, pointing away from the hull center
+		cv::Point2f normal(b.y - a.y, a.x - b.x);
+		if (edge_length > 0.f)
+		{
+			normal *= 1.f / edge_length;
+		}
+		if (normal.x*(point.x - center_x) + normal.y*(point.y - center_y) < 0.f)
+		{
+			normal = -normal;
+		}
+
+		m_edgePoints[sample_index] = refineEdgePoint(mask, mask_offset, point, normal);
+	}
+
+	undistortion_grid.undistortPoints(m_edgePoints, m_undistortedPoints, sample_count);
+
+	for (int index = 0; index < sample_count; ++index)
+	{
+		m_normalizedPoints[index] = Eigen::Vector2f(m_undistortedPoints[index].x, m_undistortedPoints[index].y);
+	}
+
+	m_pointCount = sample_count;
+
+	return m_pointCount;
+}
+
+//-- private implementation -----
+// Bilinear lookup of the mask as a 0-1 coverage, x and y are relative to the mask view.
+// Any non-zero mask pixel counts as inside, since some OpenCV versions
+// relabel the mask pixels while finding the contours.
+float SphereEdgeSampler::sampleMask(const cv::Mat &mask, float x, float y) const
+{
+	const int column = std::min(static_cast<int>(x), mask.cols - 2);
+	const int row = std::min(static_cast<int>(y), mask.rows - 2);
+	const float u = x - static_cast<float>(column);
+	const float v = y - static_cast<float>(row);
+
+	const unsigned char *upper = mask.ptr<unsigned char>(row) + column;
+	const unsigned char *lower = mask.ptr<unsigned char>(row + 1) + column;
+
+	const float upper_coverage = (upper[0] != 0 ? 1.f - u : 0.f) + (upper[1] != 0 ? u : 0.f);
+	const float lower_coverage = (lower[0] != 0 ? 1.f - u : 0.f) + (lower[1] != 0 ? u : 0.f);
+
+	return upper_coverage + (lower_coverage - upper_coverage)*v;
+}
+
+// Contour points sit on the centers of the outermost mask pixels, so the actual edge
+// is somewhere within a pixel of them. Summing the bilinear mask coverage at unit steps
+// along the normal gives the distance to a straight edge crossing the samples:
+// every sample fully inside the edge adds one and the sample the edge crosses adds its fraction.
+cv::Point2f SphereEdgeSampler::refineEdgePoint(
+	const cv::Mat &mask,
+	const cv::Point &mask_offset,
+	const cv::Point2f &point,
+	const cv::Point2f &normal) const
+{
+	const float radius = static_cast<float>(k_edge_search_radius);
+	const cv::Point2f local_point = point - cv::Point2f(mask_offset);
+	const cv::Point2f first_sample = local_point - normal*radius;
+	const cv::Point2f last_sample = local_point + normal*radius;
+
+	// Leave points near the ROI border alone, the mask isn't valid past it.
+	// The bilinear lookup also reads the next row and column.
+	const cv::Rect2f sample_bounds(0.f, 0.f, static_cast<float>(mask.cols - 1), static_cast<float>(mask.rows - 1));
+	if (!sample_bounds.contains(first_sample) || !sample_bounds.contains(last_sample))
+	{
+		return point;
+	}
+
+	const int sample_count = 2*k_edge_search_radius + 1;
+	float coverage_sum = 0.f;
+	for (int step = 0; step < sample_count; ++step)
+	{
+		const cv::Point2f sample = first_sample + normal*static_cast<float>(step);
+
+		coverage_sum += sampleMask(mask, sample.x, sample.y);
+	}
+
+	// No edge within the search window, e.g. the hull bridging an occluded part of the bulb
+	if (coverage_sum <= 0.f || coverage_sum >= static_cast<float>(sample_count))
+	{
+		return point;
+	}
+
+	const float edge_offset = coverage_sum - radius - 0.5f;
+
+	return point + normal*edge_offset;
+}
@@ -0,0 +1,54 @@
+#ifndef SPHERE_EDGE_SAMPLER_H
+#define SPHERE_EDGE_SAMPLER_H
+
+//-- includes -----
+#include <opencv2/core.hpp>
+#include <Eigen/Core>
+#include <vector>
+
+//-- pre-declarations -----
+class UndistortionGrid;
+
+//-- definitions -----
+/// Prepares the contour of a tracked sphere for the focal cone fit.
+/// Instead of handing every convex hull vertex to the fit, a fixed number of points
+/// are spread evenly along the hull and each one is moved to the sub-pixel edge
+/// of the segmentation mask along the hull normal.
+/// All of the per frame storage is allocated once, so sampling never allocates
+/// unless a hull is bigger than any seen before.
+class SphereEdgeSampler
+{
+public:
+	// Most points handed to the sphere fit, more barely changes the fit
+	static const int k_max_edge_points = 48;
+	// Mask pixels sampled on either side of a hull point when looking for the edge
+	static const int k_edge_search_radius = 2;
+
+	SphereEdgeSampler();
+
+	/// Samples the convex hull of a contour found in mask.
+	/// mask may be an ROI view into a bigger frame, contour points are in frame pixels
+	/// and only pixels inside the view are sampled.
+	/// Returns the number of points written to getNormalizedPoints(),
+	/// undistorted into normalized camera coordinates.
+	int sampleContour(
+		const std::vector<cv::Point> &contour,
+		const cv::Mat &mask,
+		const UndistortionGrid &undistortion_grid);
+
+	inline const std::vector<cv::Point> &getConvexHull() const { return m_convexHull; }
+	inline const Eigen::Vector2f *getNormalizedPoints() const { return m_normalizedPoints; }
+	inline int getPointCount() const { return m_pointCount; }
+
+private:
+	float sampleMask(const cv::Mat &mask, float x, float y) const;
+	cv::Point2f refineEdgePoint(const cv::Mat &mask, const cv::Point &mask_offset, const cv::Point2f &point, const cv::Point2f &normal) const;
+
+	std::vector<cv::Point> m_convexHull;
+	cv::Point2f m_edgePoints[k_max_edge_points]; // Refined edge points in frame pixels
+	cv::Point2f m_undistortedPoints[k_max_edge_points];
+	Eigen::Vector2f m_normalizedPoints[k_max_edge_points];
+	int m_pointCount;
+};
+
+#endif // SPHERE_EDGE_SAMPLER_H
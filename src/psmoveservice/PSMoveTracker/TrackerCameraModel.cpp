@@ -0,0 +1,93 @@
+//-- includes -----
+#include "TrackerCameraModel.h"
+#include "DeviceInterface.h"
+#include "MathUtility.h"
+
+#include <math.h>
+
+//-- public implementation -----
+TrackerCameraModel::TrackerCameraModel()
+	: cameraOrientation()
+	, cameraPosition(0.f)
+	, cameraTransform(1.f)
+	, invCameraTransform(1.f)
+	, intrinsicMatrix(cv::Matx33f::eye())
+	, distortionCoefficients(cv::Matx<float, 5, 1>::zeros())
+	, extrinsicMatrix(cv::Matx34f::eye())
+	, pinholeMatrix(cv::Matx34f::eye())
+{
+	for (int plane_index = 0; plane_index < k_frustum_plane_count; ++plane_index)
+	{
+		frustumPlanes[plane_index] = glm::vec4(0.f);
+	}
+}
+
+void TrackerCameraModel::rebuild(const ITrackerInterface *tracker_device)
+{
+	// Tracker pose
+	const CommonDevicePose pose = tracker_device->getTrackerPose();
+	const CommonDeviceQuaternion &quat = pose.Orientation;
+	const CommonDevicePosition &pos = pose.PositionCm;
+
+	cameraOrientation = glm::quat(quat.w, quat.x, quat.y, quat.z);
+	cameraPosition = glm::vec3(pos.x, pos.y, pos.z);
+	cameraTransform = glm_mat4_from_pose(cameraOrientation, cameraPosition);
+	invCameraTransform = glm::inverse(cameraTransform);
+
+	// Extrinsic matrix is the inverse of the camera pose matrix
+	const glm::mat4 &glm_mat = invCameraTransform;
+	cv::Matx34f &out = extrinsicMatrix;
+	out(0, 0) = glm_mat[0][0]; out(0, 1) = glm_mat[1][0]; out(0, 2) = glm_mat[2][0]; out(0, 3) = glm_mat[3][0];
+	out(1, 0) = glm_mat[0][1]; out(1, 1) = glm_mat[1][1]; out(1, 2) = glm_mat[2][1]; out(1, 3) = glm_mat[3][1];
+	out(2, 0) = glm_mat[0][2]; out(2, 1) = glm_mat[1][2]; out(2, 2) = glm_mat[2][2]; out(2, 3) = glm_mat[3][2];
+
+	// Intrinsic matrix
+	intrinsicMatrix = cv::Matx33f::zeros();
+	tracker_device->getCameraIntrinsics(
+		intrinsicMatrix(0, 0), intrinsicMatrix(1, 1),  //F_PX, F_PY
+		intrinsicMatrix(0, 2), intrinsicMatrix(1, 2), //PrincipalX, Y
+		distortionCoefficients(0, 0), distortionCoefficients(1, 0), distortionCoefficients(4, 0), //K1, K2, K3
+		distortionCoefficients(2, 0), distortionCoefficients(3, 0));  //P1, P2
+	intrinsicMatrix(1, 1) *= -1;  //Negate F_PY because the screen coordinate system has +Y down.
+	intrinsicMatrix(2, 2) = 1.f;
+
+	pinholeMatrix = intrinsicMatrix * extrinsicMatrix;
+
+	// Frustum planes in tracker space, the tracker looks down +Z
+	float hfov_degrees, vfov_degrees;
+	float z_near, z_far;
+	tracker_device->getFOV(hfov_degrees, vfov_degrees);
+	tracker_device->getZRange(z_near, z_far);
+
+	const float tan_half_hfov = tanf(hfov_degrees*k_degrees_to_radians*0.5f);
+	const float tan_half_vfov = tanf(vfov_degrees*k_degrees_to_radians*0.5f);
+	const glm::vec4 tracker_planes[k_frustum_plane_count] = {
+		glm::vec4(glm::normalize(glm::vec3(1.f, 0.f, tan_half_hfov)), 0.f), // left: x >= -z*tan
+		glm::vec4(glm::normalize(glm::vec3(-1.f, 0.f, tan_half_hfov)), 0.f), // right: x <= z*tan
+		glm::vec4(glm::normalize(glm::vec3(0.f, 1.f, tan_half_vfov)), 0.f), // bottom
+		glm::vec4(glm::normalize(glm::vec3(0.f, -1.f, tan_half_vfov)), 0.f), // top
+		glm::vec4(0.f, 0.f, 1.f, -z_near), // near
+	};
+
+	// Planes transform by the inverse transpose of the point transform
+	const glm::mat4 plane_transform = glm::transpose(invCameraTransform);
+	for (int plane_index = 0; plane_index < k_frustum_plane_count; ++plane_index)
+	{
+		frustumPlanes[plane_index] = plane_transform * tracker_planes[plane_index];
+	}
+}
+
+bool TrackerCameraModel::isWorldPointInFrustum(const glm::vec3 &world_point) const
+{
+	const glm::vec4 point(world_point, 1.f);
+
+	for (int plane_index = 0; plane_index < k_frustum_plane_count; ++plane_index)
+	{
+		if (glm::dot(frustumPlanes[plane_index], point) < 0.f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,48 @@
+#ifndef TRACKER_CAMERA_MODEL_H
+#define TRACKER_CAMERA_MODEL_H
+
+//-- includes -----
+#include "MathGLM.h"
+
+#include <opencv2/core.hpp>
+
+//-- pre-declarations -----
+class ITrackerInterface;
+
+//-- definitions -----
+/// Everything derived from a tracker's pose, intrinsics and field of view.
+/// Triangulation and projection run for every tracker (pair) of every tracked device
+/// on every frame, so instead of rebuilding these matrices from the tracker config
+/// each time, ServerTrackerView keeps one snapshot per tracker and only rebuilds it
+/// when the pose, the intrinsics or the frame size change.
+class TrackerCameraModel
+{
+public:
+	TrackerCameraModel();
+
+	/// Re-derives the model from the tracker's current pose, intrinsics, FOV and z range
+	void rebuild(const ITrackerInterface *tracker_device);
+
+	/// True if the world space point is in front of the near plane and inside the FOV
+	bool isWorldPointInFrustum(const glm::vec3 &world_point) const;
+
+	// Tracker pose
+	glm::quat cameraOrientation; // tracker -> world rotation
+	glm::vec3 cameraPosition; // world space, cm
+	glm::mat4 cameraTransform; // tracker -> world
+	glm::mat4 invCameraTransform; // world -> tracker
+
+	// OpenCV camera model, screen space has +Y down so F_PY is negated
+	cv::Matx33f intrinsicMatrix;
+	cv::Matx<float, 5, 1> distortionCoefficients; // K1, K2, P1, P2, K3
+	cv::Matx34f extrinsicMatrix; // world -> tracker
+	cv::Matx34f pinholeMatrix; // intrinsicMatrix * extrinsicMatrix
+
+	// World space planes of the viewing frustum (xyz = inward normal, w = offset):
+	// left, right, bottom, top and near.
+	// There is no far plane: zFar is only a display setting and trackers see past it.
+	static const int k_frustum_plane_count = 5;
+	glm::vec4 frustumPlanes[k_frustum_plane_count];
+};
+
+#endif // TRACKER_CAMERA_MODEL_H
@@ -0,0 +1,134 @@
+//-- includes -----
+#include "UndistortionGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "opencv2/calib3d/calib3d.hpp"
+
+//-- public implementation -----
+UndistortionGrid::UndistortionGrid()
+	: m_cameraMatrix(cv::Matx33f::zeros())
+	, m_distortions(cv::Matx<float, 5, 1>::zeros())
+	, m_frameWidth(0)
+	, m_frameHeight(0)
+	, m_nodeColumns(0)
+	, m_nodeRows(0)
+	, m_nodes()
+{
+}
+
+bool UndistortionGrid::update(
+	const cv::Matx33f &camera_matrix,
+	const cv::Matx<float, 5, 1> &distortions,
+	int frame_width,
+	int frame_height)
+{
+	if (getIsValid() &&
+		m_cameraMatrix == camera_matrix &&
+		m_distortions == distortions &&
+		m_frameWidth == frame_width &&
+		m_frameHeight == frame_height)
+	{
+		return false;
+	}
+
+	m_cameraMatrix = camera_matrix;
+	m_distortions = distortions;
+	m_frameWidth = frame_width;
+	m_frameHeight = frame_height;
+
+	// Nodes cover [0, width] x [0, height] so every pixel falls inside a cell
+	m_nodeColumns = (std::max(frame_width, 1) + k_cell_size - 1) / k_cell_size + 1;
+	m_nodeRows = (std::max(frame_height, 1) + k_cell_size - 1) / k_cell_size + 1;
+
+	std::vector<cv::Point2f> node_pixels;
+	node_pixels.reserve(m_nodeColumns*m_nodeRows);
+	for (int row = 0; row < m_nodeRows; ++row)
+	{
+		for (int column = 0; column < m_nodeColumns; ++column)
+		{
+			node_pixels.push_back(cv::Point2f(
+				static_cast<float>(column*k_cell_size),
+				static_cast<float>(row*k_cell_size)));
+		}
+	}
+
+	m_nodes.clear();
+	cv::undistortPoints(node_pixels, m_nodes, m_cameraMatrix, m_distortions);
+
+	return true;
+}
+
+void UndistortionGrid::undistortPoints(
+	const std::vector<cv::Point2f> &points,
+	std::vector<cv::Point2f> &out_normalized_points) const
+{
+	out_normalized_points.resize(points.size());
+
+	if (points.size() > 0)
+	{
+		lookupNormalizedPoints(points.data(), out_normalized_points.data(), points.size());
+	}
+}
+
+void UndistortionGrid::undistortPoints(
+	const cv::Point2f *points,
+	cv::Point2f *out_normalized_points,
+	size_t point_count) const
+{
+	lookupNormalizedPoints(points, out_normalized_points, point_count);
+}
+
+void UndistortionGrid::undistortPointsToPixels(
+	const std::vector<cv::Point2f> &points,
+	std::vector<cv::Point2f> &out_pixel_points) const
+{
+	undistortPoints(points, out_pixel_points);
+
+	const float focal_x = m_cameraMatrix(0, 0);
+	const float focal_y = m_cameraMatrix(1, 1);
+	const float principal_x = m_cameraMatrix(0, 2);
+	const float principal_y = m_cameraMatrix(1, 2);
+
+	for (cv::Point2f &point : out_pixel_points)
+	{
+		point.x = point.x*focal_x + principal_x;
+		point.y = point.y*focal_y + principal_y;
+	}
+}
+
+//-- private implementation -----
+void UndistortionGrid::lookupNormalizedPoints(
+	const cv::Point2f *points,
+	cv::Point2f *out_points,
+	size_t point_count) const
+{
+	const float inv_cell_size = 1.f / static_cast<float>(k_cell_size);
+	const int max_cell_column = m_nodeColumns - 2;
+	const int max_cell_row = m_nodeRows - 2;
+	const cv::Point2f *nodes = m_nodes.data();
+
+	for (size_t point_index = 0; point_index < point_count; ++point_index)
+	{
+		const float grid_x = points[point_index].x*inv_cell_size;
+		const float grid_y = points[point_index].y*inv_cell_size;
+
+		// Points off the frame extrapolate from the nearest border cell
+		const int cell_column = std::min(std::max(static_cast<int>(floorf(grid_x)), 0), max_cell_column);
+		const int cell_row = std::min(std::max(static_cast<int>(floorf(grid_y)), 0), max_cell_row);
+		const float u = grid_x - static_cast<float>(cell_column);
+		const float v = grid_y - static_cast<float>(cell_row);
+
+		const cv::Point2f *upper = nodes + cell_row*m_nodeColumns + cell_column;
+		const cv::Point2f *lower = upper + m_nodeColumns;
+
+		const float upper_x = upper[0].x + (upper[1].x - upper[0].x)*u;
+		const float upper_y = upper[0].y + (upper[1].y - upper[0].y)*u;
+		const float lower_x = lower[0].x + (lower[1].x - lower[0].x)*u;
+		const float lower_y = lower[0].y + (lower[1].y - lower[0].y)*u;
+
+		out_points[point_index].x = upper_x + (lower_x - upper_x)*v;
+		out_points[point_index].y = upper_y + (lower_y - upper_y)*v;
+	}
+}
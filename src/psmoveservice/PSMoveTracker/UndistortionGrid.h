@@ -0,0 +1,66 @@
+#ifndef UNDISTORTION_GRID_H
+#define UNDISTORTION_GRID_H
+
+//-- includes -----
+#include <opencv2/core.hpp>
+#include <vector>
+
+//-- definitions -----
+/// Cached lens undistortion for a single tracker.
+/// cv::undistortPoints solves iteratively for every point it is given, which adds up
+/// when run over every contour point of every tracked device on every frame.
+/// Instead the undistorted position of a coarse grid of pixel locations is solved once
+/// and contour points are bilinearly interpolated from it.
+/// The grid is rebuilt only when the intrinsics or the frame size change.
+class UndistortionGrid
+{
+public:
+	// Pixels between neighboring grid nodes
+	static const int k_cell_size = 4;
+
+	UndistortionGrid();
+
+	/// Rebuilds the grid if the camera matrix, distortion coefficients or frame size
+	/// differ from the ones it was built with. Returns true if the grid was rebuilt.
+	bool update(
+		const cv::Matx33f &camera_matrix,
+		const cv::Matx<float, 5, 1> &distortions,
+		int frame_width,
+		int frame_height);
+
+	inline bool getIsValid() const { return m_nodes.size() > 0; }
+
+	/// Same as cv::undistortPoints(points, out, K, D):
+	/// undistorted points in normalized camera coordinates
+	void undistortPoints(
+		const std::vector<cv::Point2f> &points,
+		std::vector<cv::Point2f> &out_normalized_points) const;
+
+	/// Pointer version of the above for fixed capacity buffers, never allocates
+	void undistortPoints(
+		const cv::Point2f *points,
+		cv::Point2f *out_normalized_points,
+		size_t point_count) const;
+
+	/// Same as cv::undistortPoints(points, out, K, D, cv::noArray(), K):
+	/// undistorted points reprojected into pixels
+	void undistortPointsToPixels(
+		const std::vector<cv::Point2f> &points,
+		std::vector<cv::Point2f> &out_pixel_points) const;
+
+private:
+	void lookupNormalizedPoints(const cv::Point2f *points, cv::Point2f *out_points, size_t point_count) const;
+
+	// Parameters the grid was built with
+	cv::Matx33f m_cameraMatrix;
+	cv::Matx<float, 5, 1> m_distortions;
+	int m_frameWidth;
+	int m_frameHeight;
+
+	// Normalized undistorted coordinates of every grid node, row major
+	int m_nodeColumns;
+	int m_nodeRows;
+	std::vector<cv::Point2f> m_nodes;
+};
+
+#endif // UNDISTORTION_GRID_H
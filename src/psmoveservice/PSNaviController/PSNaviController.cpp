@@ -545,7 +545,7 @@ void PSNaviController::close()
 }
 
 bool
-PSNaviController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id)
+PSNaviController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig)
 {
 	return false;
 }
@@ -90,7 +90,7 @@ public:
     virtual IDeviceInterface::ePollResult poll() override;
     virtual void close() override;
     virtual bool setHostBluetoothAddress(const std::string &address) override;
-	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id) override;
+	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig) override;
 	virtual void setControllerListener(IControllerListener *listener) override;
 
     // -- Getters
@@ -2,13 +2,17 @@
 #define BOOST_LIB_DIAGNOSTIC
 
 #include "PSMoveService.h"
+#include "ConfigFileWriter.h"
 #include "ServerNetworkManager.h"
 #include "ServerRequestHandler.h"
 #include "DeviceManager.h"
 #include "ProtocolVersion.h"
+#include "SensorSessionReplayer.h"
 #include "ServerLog.h"
+#include "ServiceMetrics.h"
 #include "SharedTrackerState.h"
 #include "TrackerManager.h"
+#include "TrackingBenchmark.h"
 #include "USBDeviceManager.h"
 
 #include <boost/asio.hpp>
@@ -50,6 +54,7 @@ public:
         , m_request_handler(&m_device_manager)
         , m_network_manager()
         , m_status()
+        , m_benchmark_aborted(false)
     {
         // Register to handle the signals that indicate when the server should exit.
         m_signals.add(SIGINT);
@@ -72,7 +77,7 @@ public:
             {
                 m_status = context.find<boost::application::status>();
 
-				const TrackerManagerConfig &cfg = DeviceManager::getInstance()->m_tracker_manager->getConfig();
+				const TrackerManager *tracker_manager = DeviceManager::getInstance()->m_tracker_manager;
 				//std::chrono::time_point<std::chrono::high_resolution_clock> m_lastSync;
 
                 while (m_status->state() != boost::application::status::stoped)
@@ -92,11 +97,11 @@ public:
                     {
                         update();
 
-						//printf("Thread FPS: %f\nSleep MS: %d\n", 1000.f / timeSinceLast.count(), cfg.thread_sleep_ms);
+						//printf("Thread FPS: %f\nSleep MS: %d\n", 1000.f / timeSinceLast.count(), tracker_manager->getTunables()->thread_sleep_ms);
 
                     }
 
-					std::this_thread::sleep_for(std::chrono::milliseconds(cfg.thread_sleep_ms));
+					std::this_thread::sleep_for(std::chrono::milliseconds(tracker_manager->getTunables()->thread_sleep_ms));
 #if defined(WIN32)
 					timeEndPeriod(1);
 #endif
@@ -125,6 +130,71 @@ public:
         return 0;
     }
 
+    /// Runs the synthetic tracking benchmark in place of the service loop
+    int run_tracking_benchmark(const TrackingBenchmarkSettings &settings)
+    {
+        TrackingBenchmark benchmark(settings);
+        bool bSuccess = false;
+
+        try
+        {
+            if (startup() && benchmark.startup())
+            {
+                const std::chrono::nanoseconds frame_period(
+                    (settings.frame_rate > 0.f) ? static_cast<long long>(1000000000.0 / settings.frame_rate) : 0);
+                std::chrono::time_point<std::chrono::high_resolution_clock> next_frame_time = std::chrono::high_resolution_clock::now();
+
+#if defined(WIN32)
+                // Pacing needs the 1ms timer resolution, same as the service loop
+                timeBeginPeriod(1);
+#endif
+
+                while (!benchmark.getIsComplete() && !benchmark.getHasFailed() && !m_benchmark_aborted)
+                {
+                    benchmark.beginFrame();
+
+                    const std::chrono::time_point<std::chrono::high_resolution_clock> update_start = std::chrono::high_resolution_clock::now();
+                    update();
+                    benchmark.endFrame(std::chrono::high_resolution_clock::now() - update_start);
+
+                    // Pace the scene like a camera would, otherwise run the updates back to back
+                    if (frame_period.count() > 0)
+                    {
+                        next_frame_time += frame_period;
+                        std::this_thread::sleep_until(next_frame_time);
+                    }
+                }
+
+#if defined(WIN32)
+                timeEndPeriod(1);
+#endif
+
+                bSuccess = benchmark.getIsComplete();
+            }
+            else
+            {
+                SERVER_LOG_FATAL("PSMoveService") << "Failed to startup the tracking benchmark";
+            }
+        }
+        catch (std::exception& e)
+        {
+            SERVER_LOG_FATAL("EXCEPTION - PSMoveService") << e.what();
+        }
+
+        // Report and stop tracking the benchmark controllers while the devices are still open
+        try
+        {
+            benchmark.shutdown();
+            shutdown();
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+
+        return bSuccess ? 0 : 1;
+    }
+
     bool stop(boost::application::context& context)
     {
         if (m_status->state() != boost::application::status::stoped)
@@ -178,6 +248,16 @@ private:
 		}
 		#endif // BOOST_INTERPROCESS_SHARED_DIR_PATH       
 
+        /** Start the config writer before anything loads or saves its config */
+        if (success)
+        {
+            if (!ConfigFileWriter::startup())
+            {
+                SERVER_LOG_FATAL("PSMoveService") << "Failed to start the config file writer";
+                success = false;
+            }
+        }
+
         /** Setup the usb async transfer thread before we attempt to initialize the trackers */
         if (success)
         {
@@ -226,6 +306,10 @@ private:
     /// Called in the application loop.
     void update()
     {
+        /** Roll the metrics window over when it's done, then time the whole update */
+        ServiceMetrics::update();
+        MetricTimerScope update_timer_scope(ServiceMetrics::getUpdateTimer());
+
         /** Update an async requests still waiting to complete */
         m_request_handler.update();
 
@@ -257,13 +341,26 @@ private:
         // Shutdown the usb async request thread
         // Must be after device manager since devices can have an active usb connection
         m_usb_device_manager.shutdown();
+
+        // Write out any config saves that are still pending
+        // Must be last since shutting down the managers above can save their configs
+        ConfigFileWriter::shutdown();
     }
 
     void handle_termination_signal()
     {
         // flag the service as stopped
         SERVER_LOG_WARNING("PSMoveService") << "Received termination signal. Stopping Service.";
-        m_status->state(boost::application::status::stoped);
+
+        // There is no application status when running the tracking benchmark
+        if (m_status)
+        {
+            m_status->state(boost::application::status::stoped);
+        }
+        else
+        {
+            m_benchmark_aborted = true;
+        }
     }
 
 private:   
@@ -287,6 +384,9 @@ private:
 
     // Whether the application should keep running or not
     std::shared_ptr<boost::application::status> m_status;
+
+    // Set when a termination signal arrives during the tracking benchmark
+    bool m_benchmark_aborted;
 };
 
 static void parse_program_settings(
@@ -319,6 +419,38 @@ static void parse_program_settings(
 	{
 		settings.working_directory.clear();
 	}
+
+	if (options_map.count("replay_session"))
+	{
+		settings.replay_session = options_map["replay_session"].as<std::string>();
+	}
+	else
+	{
+		settings.replay_session.clear();
+	}
+
+	if (options_map.count("replay_output"))
+	{
+		settings.replay_output = options_map["replay_output"].as<std::string>();
+	}
+	else
+	{
+		settings.replay_output.clear();
+	}
+
+	settings.tracking_benchmark = options_map["tracking_benchmark"].as<int>();
+	settings.benchmark_trackers = options_map["benchmark_trackers"].as<int>();
+	settings.benchmark_controllers = options_map["benchmark_controllers"].as<int>();
+	settings.benchmark_frame_rate = options_map["benchmark_frame_rate"].as<float>();
+
+	if (options_map.count("benchmark_output"))
+	{
+		settings.benchmark_output = options_map["benchmark_output"].as<std::string>();
+	}
+	else
+	{
+		settings.benchmark_output.clear();
+	}
 }
 
 #if defined(BOOST_WINDOWS_API) 
@@ -531,6 +663,13 @@ int PSMoveService::exec(int argc, char *argv[])
         ("log_level,l", boost::program_options::value<std::string>(), "The level of logging to use: trace, debug, info, warning, error, fatal")
         ("admin_password,p", boost::program_options::value<std::string>(), "Remember the admin password for this machine (optional)")
 		("working_directory", boost::program_options::value<std::string>(), "service working directory (optional)")
+		("replay_session", boost::program_options::value<std::string>(), "replay a recorded sensor session through the pose filters and exit (optional)")
+		("replay_output", boost::program_options::value<std::string>(), "csv file to write the replayed filter poses to (optional)")
+		("tracking_benchmark", boost::program_options::value<int>()->default_value(0), "run the synthetic tracking benchmark for this many frames and exit (optional)")
+		("benchmark_trackers", boost::program_options::value<int>()->default_value(4), "number of virtual trackers rendered by the tracking benchmark")
+		("benchmark_controllers", boost::program_options::value<int>()->default_value(2), "number of virtual controllers moved by the tracking benchmark")
+		("benchmark_frame_rate", boost::program_options::value<float>()->default_value(60.f), "tracking benchmark scene frame rate, 0 runs unpaced")
+		("benchmark_output", boost::program_options::value<std::string>(), "csv file to write the per frame benchmark results to (optional)")
 #if defined(BOOST_WINDOWS_API)
         (",i", "install service")
         (",u", "uninstall service")
@@ -597,8 +736,48 @@ int PSMoveService::exec(int argc, char *argv[])
     // initialize logging system
     log_init(this->getProgramSettings()->log_level, "PSMoveService.log");
 
+	// Replay a recorded sensor session offline instead of starting the service
+	if (!this->getProgramSettings()->replay_session.empty())
+	{
+		SensorSessionReplayer replayer;
+		bool bSuccess = false;
+
+		if (replayer.open(this->getProgramSettings()->replay_session))
+		{
+			bSuccess = replayer.replay(this->getProgramSettings()->replay_output);
+			replayer.close();
+		}
+
+		log_dispose();
+
+		return bSuccess ? 0 : 1;
+	}
+
+	// Run the synthetic tracking benchmark instead of the service
+	if (this->getProgramSettings()->tracking_benchmark > 0)
+	{
+		const ProgramSettings *program_settings = this->getProgramSettings();
+		TrackingBenchmarkSettings benchmark_settings;
+		benchmark_settings.frame_count = program_settings->tracking_benchmark;
+		benchmark_settings.tracker_count = program_settings->benchmark_trackers;
+		benchmark_settings.controller_count = program_settings->benchmark_controllers;
+		benchmark_settings.frame_rate = program_settings->benchmark_frame_rate;
+		benchmark_settings.output_filename = program_settings->benchmark_output;
+
+		int result = 1;
+		{
+			PSMoveServiceImpl app;
+			result = app.run_tracking_benchmark(benchmark_settings);
+		}
+
+		log_dispose();
+
+		return result;
+	}
+
     // Start the service app
     SERVER_LOG_INFO("main") << "Starting PSMoveService v" << PSM_RELEASE_VERSION_STRING << " (protocol v" << PSM_PROTOCOL_VERSION_STRING << ")";
+    int result = 0;
     try
     {
         PSMoveServiceImpl app;
@@ -639,33 +818,34 @@ int PSMoveService::exec(int argc, char *argv[])
 #if defined(BOOST_WINDOWS_API)
         if (options_map.count("-d"))
         {
-            return boost::application::launch<boost::application::server>(app, app_context);
+            result = boost::application::launch<boost::application::server>(app, app_context);
         }
         else
 #endif // defined(BOOST_WINDOWS_API)
         {
-            return boost::application::launch<boost::application::common>(app, app_context);
+            result = boost::application::launch<boost::application::common>(app, app_context);
         }
     }
     catch (boost::system::system_error& se)
     {
         SERVER_LOG_FATAL("main") << "Failed to start PSMoveService: " << se.what();
-        return 1;
+        result = 1;
     }
     catch (std::exception &e)
     {
         SERVER_LOG_FATAL("main") << "Failed to start PSMoveService: " <<  e.what();
-        return 1;
+        result = 1;
     }
     catch (...)
     {
         SERVER_LOG_FATAL("main") << "Failed to start PSMoveService: Unknown error.";
-        return 1;
+        result = 1;
     }
 
     SERVER_LOG_INFO("main") << "Exiting PSMoveService";
 
+	// Writes out any log lines still queued
 	log_dispose();
 
-    return 0;
+    return result;
 }
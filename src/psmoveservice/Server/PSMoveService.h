@@ -13,6 +13,13 @@ public:
         std::string log_level;
         std::string admin_password;
 		std::string working_directory;
+		std::string replay_session;
+		std::string replay_output;
+		int tracking_benchmark;
+		int benchmark_trackers;
+		int benchmark_controllers;
+		float benchmark_frame_rate;
+		std::string benchmark_output;
     };
 
     PSMoveService();
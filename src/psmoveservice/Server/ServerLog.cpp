@@ -1,22 +1,16 @@
 //-- includes -----
 #include "ServerLog.h"
+#include "AsyncLogWriter.h"
 
-#include <chrono>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
-#include <mutex>
 #include <ostream>
 
-#ifdef _MSC_VER
-#pragma warning (disable: 4996) // 'This function or variable may be unsafe': localtime
-#endif
-
 //-- globals -----
 e_log_severity_level g_min_log_level= _log_severity_level_info;
 std::ostream *g_console_stream= nullptr;
 std::ostream *g_file_stream = nullptr;
-std::mutex *g_logger_mutex = nullptr;
+AsyncLogWriter *g_log_writer = nullptr;
 
 //-- public implementation -----
 void log_init(const std::string &log_level, const std::string &log_filename)
@@ -55,11 +49,23 @@ void log_init(const std::string &log_level, const std::string &log_filename)
 	{
 		g_file_stream = new std::ofstream(log_filename, std::ofstream::out);
 	}
-	g_logger_mutex = new std::mutex();
+
+	g_log_writer = new AsyncLogWriter(true);
+	g_log_writer->addStream(g_console_stream);
+	g_log_writer->addStream(g_file_stream);
+	g_log_writer->start();
 }
 
 void log_dispose()
 {
+	// Write out any queued lines before the streams go away
+	if (g_log_writer != nullptr)
+	{
+		g_log_writer->stop();
+		delete g_log_writer;
+		g_log_writer = nullptr;
+	}
+
 	if (g_console_stream != nullptr)
 	{
 		g_console_stream->flush();
@@ -69,73 +75,32 @@ void log_dispose()
 
 	if (g_file_stream != nullptr)
 	{
-		g_console_stream->flush();
+		g_file_stream->flush();
 		delete g_file_stream;
 		g_file_stream = nullptr;
 	}
-
-	if (g_logger_mutex != nullptr)
-	{
-		delete g_logger_mutex;
-		g_logger_mutex = nullptr;
-	}
-}
-
-bool log_can_emit_level(e_log_severity_level level)
-{
-    return (level >= g_min_log_level);
 }
 
 std::string log_get_timestamp_prefix()
 {
-    auto now = std::chrono::system_clock::now();
-    auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(now);
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now - seconds);
-    time_t in_time_t = std::chrono::system_clock::to_time_t(now);
-
-    std::stringstream ss;
-    ss << "[" << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S") << "." << milliseconds.count() << "]: ";
-
-    return ss.str();
+    return AsyncLogWriter::formatTimestampPrefix(std::chrono::system_clock::now());
 }
 
 //-- member functions -----
-LoggerStream::LoggerStream(bool bEmit) :
-	m_bEmitLine(bEmit)
+LoggerStream::LoggerStream(e_log_severity_level level) 
+	: m_lineBuffer()
+	, m_timestamp(std::chrono::system_clock::now())
+	, m_level(level)
 {
 }
 
 LoggerStream::~LoggerStream()
 {
-	write_line();
-}
-
-void LoggerStream::write_line()
-{
-	if (m_bEmitLine)
+	// The timestamp gets formatted on the writer thread
+	if (g_log_writer != nullptr)
 	{
-		const std::string line = m_lineBuffer.str();
-
-		if (g_console_stream != nullptr)
-		{
-			*g_console_stream << line << std::endl;
-		}
+		std::string line = m_lineBuffer.str();
 
-		if (g_file_stream != nullptr)
-		{
-			*g_file_stream << line << std::endl;
-		}
+		g_log_writer->push(m_timestamp, line, m_level >= _log_severity_level_error);
 	}
 }
-
-ThreadSafeLoggerStream::ThreadSafeLoggerStream(bool bEmit) :
-	LoggerStream(bEmit)
-{
-}
-
-void ThreadSafeLoggerStream::write_line()
-{
-	std::lock_guard<std::mutex> lock(*g_logger_mutex);
-
-	LoggerStream::write_line();
-}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define SERVER_LOG_H
 
 //-- includes -----
+#include <chrono>
 #include <string>
 #include <sstream>
 
@@ -16,70 +17,82 @@ enum e_log_severity_level
     _log_severity_level_fatal
 };
 
-//-- includes -----
+//-- definitions -----
+/// Accumulates a single log line and hands it off to the asynchronous log writer when destroyed.
+/// Only ever constructed by the logging macros after the severity check passed,
+/// so disabled log lines never get formatted.
 class LoggerStream
 {
 protected:
 	std::ostringstream m_lineBuffer;
-	bool m_bEmitLine;
+	std::chrono::system_clock::time_point m_timestamp;
+	e_log_severity_level m_level;
 
 public:
-	LoggerStream(bool bEmit);
-	virtual ~LoggerStream();
+	LoggerStream(e_log_severity_level level);
+	~LoggerStream();
 
 	// accepts just about anything
 	template<class T>
 	LoggerStream &operator<<(const T &x)
 	{
-		if (m_bEmitLine)
-		{
-			m_lineBuffer << x;
-		}
+		m_lineBuffer << x;
 
 		return *this;
 	}
 
-protected:
-	virtual void write_line();
+	// stream manipulators like std::endl
+	LoggerStream &operator<<(std::ostream &(*manipulator)(std::ostream &))
+	{
+		m_lineBuffer << manipulator;
+
+		return *this;
+	}
 };
 
-class ThreadSafeLoggerStream : public LoggerStream
+// Turns a LoggerStream expression into void, so both sides of the macro's ?: match
+class LoggerStreamVoidify
 {
 public:
-	ThreadSafeLoggerStream(bool bEmit);
-
-protected:
-	void write_line() override;
+	void operator&(const LoggerStream &) {}
 };
 
+//-- globals -----
+extern e_log_severity_level g_min_log_level;
+
 //-- interface -----
 void log_init(const std::string &log_level, const std::string &log_filename="");
 void log_dispose();
-bool log_can_emit_level(e_log_severity_level level);
 std::string log_get_timestamp_prefix();
 
+inline bool log_can_emit_level(e_log_severity_level level)
+{
+    return (level >= g_min_log_level);
+}
+
 //-- macros -----
-#define SELECT_LOG_STREAM(level) LoggerStream(log_can_emit_level(level))
-#define SELECT_MT_LOG_STREAM(level) ThreadSafeLoggerStream(log_can_emit_level(level))
+// The severity check short-circuits the whole expression,
+// so none of the streamed arguments are evaluated for disabled levels.
+#define SELECT_LOG_STREAM(level, function_name) \
+	!log_can_emit_level(level) ? (void)0 : LoggerStreamVoidify() & LoggerStream(level) << function_name << " - "
 
-// Non Thread Safe Logger Macros
-// Almost everything is on the main thread, so you almost always want to use these
-#define SERVER_LOG_TRACE(function_name) SELECT_LOG_STREAM(_log_severity_level_trace) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_LOG_DEBUG(function_name) SELECT_LOG_STREAM(_log_severity_level_debug) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_LOG_INFO(function_name) SELECT_LOG_STREAM(_log_severity_level_info) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_LOG_WARNING(function_name) SELECT_LOG_STREAM(_log_severity_level_warning) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_LOG_ERROR(function_name) SELECT_LOG_STREAM(_log_severity_level_error) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_LOG_FATAL(function_name) SELECT_LOG_STREAM(_log_severity_level_fatal) << log_get_timestamp_prefix() << function_name << " - "
+// Logger Macros
+// Log lines are queued on a lock-free ring buffer and written out by a background thread
+#define SERVER_LOG_TRACE(function_name) SELECT_LOG_STREAM(_log_severity_level_trace, function_name)
+#define SERVER_LOG_DEBUG(function_name) SELECT_LOG_STREAM(_log_severity_level_debug, function_name)
+#define SERVER_LOG_INFO(function_name) SELECT_LOG_STREAM(_log_severity_level_info, function_name)
+#define SERVER_LOG_WARNING(function_name) SELECT_LOG_STREAM(_log_severity_level_warning, function_name)
+#define SERVER_LOG_ERROR(function_name) SELECT_LOG_STREAM(_log_severity_level_error, function_name)
+#define SERVER_LOG_FATAL(function_name) SELECT_LOG_STREAM(_log_severity_level_fatal, function_name)
 
 // Thread Safe Logger Macros
-// Uses thread safe locking before appending data to the logging stream
-// Only use this when logging from other threads
-#define SERVER_MT_LOG_TRACE(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_trace) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_MT_LOG_DEBUG(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_debug) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_MT_LOG_INFO(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_info) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_MT_LOG_WARNING(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_warning) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_MT_LOG_ERROR(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_error) << log_get_timestamp_prefix() << function_name << " - "
-#define SERVER_MT_LOG_FATAL(function_name) SELECT_MT_LOG_STREAM(_log_severity_level_fatal) << log_get_timestamp_prefix() << function_name << " - "
+// The log queue is safe to push to from any thread, so these are the same as the macros above.
+// Kept so that logging from other threads stays easy to spot.
+#define SERVER_MT_LOG_TRACE(function_name) SERVER_LOG_TRACE(function_name)
+#define SERVER_MT_LOG_DEBUG(function_name) SERVER_LOG_DEBUG(function_name)
+#define SERVER_MT_LOG_INFO(function_name) SERVER_LOG_INFO(function_name)
+#define SERVER_MT_LOG_WARNING(function_name) SERVER_LOG_WARNING(function_name)
+#define SERVER_MT_LOG_ERROR(function_name) SERVER_LOG_ERROR(function_name)
+#define SERVER_MT_LOG_FATAL(function_name) SERVER_LOG_FATAL(function_name)
  
 #endif  // SERVER_LOG_H
-
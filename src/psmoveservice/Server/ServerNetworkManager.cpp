@@ -248,6 +248,17 @@ public:
         return write_in_progress;
     }
     
+    void get_metrics(ClientConnectionMetrics &out_metrics) const
+    {
+        out_metrics.connection_id= m_connection_id;
+        m_udp_data_frame_counter.getStats(out_metrics.udp_data_frames_sent);
+        m_udp_byte_counter.getStats(out_metrics.udp_bytes_sent);
+        m_tcp_response_counter.getStats(out_metrics.tcp_responses_sent);
+        m_tcp_byte_counter.getStats(out_metrics.tcp_bytes_sent);
+        out_metrics.pending_data_frame_count= static_cast<int>(m_pending_dataframes.size());
+        out_metrics.pending_response_count= static_cast<int>(m_pending_responses.size());
+    }
+
     void add_device_data_frame_to_write_queue(DeviceOutputDataFramePtr data_frame)
     {
         m_pending_dataframes.push_back(data_frame);
@@ -326,6 +337,12 @@ private:
 
     deque<ResponsePtr> m_pending_responses;
     deque<DeviceOutputDataFramePtr> m_pending_dataframes;
+
+    // Only written from io_service::poll() callbacks
+    MetricCounter m_udp_data_frame_counter;
+    MetricCounter m_udp_byte_counter;
+    MetricCounter m_tcp_response_counter;
+    MetricCounter m_tcp_byte_counter;
     
     bool m_connection_started;
     bool m_connection_stopped;
@@ -351,6 +368,10 @@ private:
         , m_packed_output_dataframe()
         , m_pending_responses()
         , m_pending_dataframes()
+        , m_udp_data_frame_counter()
+        , m_udp_byte_counter()
+        , m_tcp_response_counter()
+        , m_tcp_byte_counter()
         , m_connection_started(false)
         , m_connection_stopped(false)
         , m_has_pending_tcp_write(false)
@@ -502,6 +523,9 @@ private:
             // no longer is there a pending write
             m_has_pending_tcp_write= false;
 
+            m_tcp_response_counter.add();
+            m_tcp_byte_counter.add(m_response_write_buffer.size());
+
             // Remove the response from the pending send queue now that it's sent
             m_pending_responses.pop_front();
 
@@ -529,6 +553,10 @@ private:
             // no longer is there a pending write
             m_has_pending_udp_write= false;
 
+            // The whole buffer goes out, not just the packed frame
+            m_udp_data_frame_counter.add();
+            m_udp_byte_counter.add(sizeof(m_output_dataframe_buffer));
+
             // Remove the dataframe from the pending send queue now that it's sent
             m_pending_dataframes.pop_front();
         }
@@ -732,6 +760,19 @@ public:
         }
     }
 
+    void gather_connection_metrics(std::vector<ClientConnectionMetrics> &out_metrics) const
+    {
+        out_metrics.clear();
+
+        for (t_client_connection_map::const_iterator iter= m_connections.begin(); iter != m_connections.end(); ++iter)
+        {
+            ClientConnectionMetrics metrics;
+
+            iter->second->get_metrics(metrics);
+            out_metrics.push_back(metrics);
+        }
+    }
+
     // -- IServerNetworkEventListener ----
 	virtual void handle_client_connection_stopped(int connection_id) override
     {
@@ -1042,3 +1083,15 @@ void ServerNetworkManager::send_device_data_frame(int connection_id, DeviceOutpu
 		implementation_ptr->send_device_data_frame(connection_id, data_frame);
 	}
 }
+
+void ServerNetworkManager::gather_connection_metrics(std::vector<ClientConnectionMetrics> &out_metrics) const
+{
+	if (implementation_ptr != nullptr)
+	{
+		implementation_ptr->gather_connection_metrics(out_metrics);
+	}
+	else
+	{
+		out_metrics.clear();
+	}
+}
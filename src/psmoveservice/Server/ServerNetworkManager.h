@@ -4,6 +4,9 @@
 //-- includes -----
 #include "PSMoveProtocolInterface.h"
 #include "PSMoveConfig.h"
+#include "ServiceMetrics.h"
+
+#include <vector>
 
 //-- pre-declarations -----
 class ServerRequestHandler;
@@ -29,6 +32,18 @@ public:
 	int server_port;
 };
 
+/// Traffic sent to a client and the writes still waiting to go out
+struct ClientConnectionMetrics
+{
+    int connection_id;
+    MetricCounterStats udp_data_frames_sent;
+    MetricCounterStats udp_bytes_sent;
+    MetricCounterStats tcp_responses_sent;
+    MetricCounterStats tcp_bytes_sent;
+    int pending_data_frame_count;
+    int pending_response_count;
+};
+
 // -Server Network Manager-
 /// Maintains TCP/UDP connection state with PSMoveClients.
 /// Routes requests to the given request handler.
@@ -69,6 +84,8 @@ public:
     
     void send_device_data_frame(int connection_id, DeviceOutputDataFramePtr data_frame);
 
+    void gather_connection_metrics(std::vector<ClientConnectionMetrics> &out_metrics) const;
+
 private:   
 	/// Configuration settings used by the network manager
 	NetworkManagerConfig m_cfg;
@@ -25,7 +25,10 @@
 #include "ServerHMDView.h"
 #include "ServerLog.h"
 #include "ServerUtility.h"
+#include "ServiceMetrics.h"
 #include "TrackerManager.h"
+#include "TrackerPoseCalibrator.h"
+#include "TrackingStageProfiler.h"
 #include "VirtualController.h"
 
 #include <cassert>
@@ -33,6 +36,9 @@
 #include <map>
 #include <boost/shared_ptr.hpp>
 
+//-- constants -----
+static const char *k_default_sensor_session_filename = "sensor_session.psmsession";
+
 //-- pre-declarations -----
 class ServerRequestHandlerImpl;
 typedef boost::shared_ptr<ServerRequestHandlerImpl> ServerRequestHandlerImplPtr;
@@ -390,6 +396,30 @@ public:
 				response = new PSMoveProtocol::Response;
 				handle_request__set_controller_psmove_emulation(context, response);
 				break;
+			case PSMoveProtocol::Request_RequestType_SET_SENSOR_SESSION_RECORDING:
+				response = new PSMoveProtocol::Response;
+				handle_request__set_sensor_session_recording(context, response);
+				break;
+			case PSMoveProtocol::Request_RequestType_SET_TRACKER_POSE_CALIBRATION:
+				response = new PSMoveProtocol::Response;
+				handle_request__set_tracker_pose_calibration(context, response);
+				break;
+			case PSMoveProtocol::Request_RequestType_GET_TRACKER_POSE_CALIBRATION_STATUS:
+				response = new PSMoveProtocol::Response;
+				handle_request__get_tracker_pose_calibration_status(context, response);
+				break;
+			case PSMoveProtocol::Request_RequestType_SET_TRACKER_COLOR_CALIBRATION:
+				response = new PSMoveProtocol::Response;
+				handle_request__set_tracker_color_calibration(context, response);
+				break;
+			case PSMoveProtocol::Request_RequestType_GET_CONTROLLER_IMU_QUEUE_STATS:
+				response = new PSMoveProtocol::Response;
+				handle_request__get_controller_imu_queue_stats(context, response);
+				break;
+			case PSMoveProtocol::Request_RequestType_GET_SERVICE_METRICS:
+				response = new PSMoveProtocol::Response;
+				handle_request__get_service_metrics(context, response);
+				break;
 
             default:
                 assert(0 && "Whoops, bad request!");
@@ -481,7 +511,8 @@ public:
                 // Halt any shared memory streams this connection has going
                 if (connection_state->active_tracker_stream_info[tracker_id].streaming_video_data)
                 {
-                    m_device_manager.getTrackerViewPtr(tracker_id)->stopSharedMemoryVideoStream();
+                    m_device_manager.getTrackerViewPtr(tracker_id)->stopSharedMemoryVideoStream(
+                        connection_state->active_tracker_stream_info[tracker_id].include_debug_overlay);
                 }
             }
 
@@ -1111,7 +1142,7 @@ protected:
                 if (m_device_manager.m_tracker_manager->claimTrackingColorID(ControllerView.get(), newColorID))
                 {
                     // Assign the new color to ourselves
-                    ControllerView->setTrackingColorID(newColorID);
+                    ControllerView->setTrackingColorID(newColorID, true);
                     response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
                 }
                 else 
@@ -1706,6 +1737,162 @@ protected:
 		}
 	}
 
+	void handle_request__set_tracker_pose_calibration(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		const PSMoveProtocol::Request_RequestSetTrackerPoseCalibration &request =
+			context.request->request_set_tracker_pose_calibration();
+
+		bool bSuccess = false;
+
+		switch (request.action())
+		{
+		case PSMoveProtocol::Request_RequestSetTrackerPoseCalibration_Action_START_SAMPLING:
+			if (ServerUtility::is_index_valid(request.controller_id(), m_device_manager.getControllerViewMaxCount()) &&
+				m_device_manager.getControllerViewPtr(request.controller_id())->getIsOpen())
+			{
+				bSuccess = m_device_manager.startTrackerPoseCalibration(request.controller_id(), request.optimize_intrinsics());
+			}
+			break;
+		case PSMoveProtocol::Request_RequestSetTrackerPoseCalibration_Action_SOLVE:
+			bSuccess = m_device_manager.solveTrackerPoseCalibration(request.apply_result());
+			break;
+		case PSMoveProtocol::Request_RequestSetTrackerPoseCalibration_Action_CANCEL:
+			m_device_manager.cancelTrackerPoseCalibration();
+			bSuccess = true;
+			break;
+		default:
+			break;
+		}
+
+		response->set_result_code(
+			bSuccess
+			? PSMoveProtocol::Response_ResultCode_RESULT_OK
+			: PSMoveProtocol::Response_ResultCode_RESULT_ERROR);
+	}
+
+	void handle_request__get_tracker_pose_calibration_status(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		PSMoveProtocol::Response_ResultTrackerPoseCalibrationStatus *status_info =
+			response->mutable_result_tracker_pose_calibration_status();
+
+		TrackerPoseCalibrationStatus status;
+		m_device_manager.getTrackerPoseCalibrationStatus(status);
+
+		response->set_type(PSMoveProtocol::Response_ResponseType_TRACKER_POSE_CALIBRATION_STATUS);
+
+		// eTrackerPoseCalibrationState matches the protocol state enum
+		status_info->set_state(
+			static_cast<PSMoveProtocol::Response_ResultTrackerPoseCalibrationStatus_State>(status.state));
+		status_info->set_sample_count(status.sample_count);
+		status_info->set_observation_count(status.observation_count);
+		status_info->set_iteration_count(status.iteration_count);
+		status_info->set_initial_rms_error_px(status.initial_rms_error_px);
+		status_info->set_final_rms_error_px(status.final_rms_error_px);
+		response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
+	}
+
+	void handle_request__set_tracker_color_calibration(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		const PSMoveProtocol::Request_RequestSetTrackerColorCalibration &request =
+			context.request->request_set_tracker_color_calibration();
+
+		bool bSuccess = false;
+
+		switch (request.action())
+		{
+		case PSMoveProtocol::Request_RequestSetTrackerColorCalibration_Action_START:
+			{
+				// Progress notifications go back to the connection that asked for the calibration
+				const std::vector<int> controller_ids(request.controller_ids().begin(), request.controller_ids().end());
+
+				bSuccess = m_device_manager.startTrackerColorCalibration(context.connection_state->connection_id, controller_ids);
+			} break;
+		case PSMoveProtocol::Request_RequestSetTrackerColorCalibration_Action_CANCEL:
+			m_device_manager.cancelTrackerColorCalibration();
+			bSuccess = true;
+			break;
+		default:
+			break;
+		}
+
+		response->set_result_code(
+			bSuccess
+			? PSMoveProtocol::Response_ResultCode_RESULT_OK
+			: PSMoveProtocol::Response_ResultCode_RESULT_ERROR);
+	}
+
+	void handle_request__get_controller_imu_queue_stats(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		const PSMoveProtocol::Request_RequestGetControllerIMUQueueStats &request =
+			context.request->request_get_controller_imu_queue_stats();
+		const int controller_id = request.controller_id();
+		const ServerControllerView *controller_view = get_controller_view_or_null(controller_id);
+
+		response->set_type(PSMoveProtocol::Response_ResponseType_CONTROLLER_IMU_QUEUE_STATS);
+
+		if (controller_view != nullptr)
+		{
+			PSMoveProtocol::Response_ResultControllerIMUQueueStats *stats_info =
+				response->mutable_result_controller_imu_queue_stats();
+
+			PoseSensorPacketQueueStats stats;
+			controller_view->getIMUPacketQueueStats(stats);
+
+			// ePoseSensorQueueOverflowPolicy matches the protocol overflow policy enum
+			stats_info->set_controller_id(controller_id);
+			stats_info->set_capacity(stats.capacity);
+			stats_info->set_depth(stats.depth);
+			stats_info->set_high_water_mark(stats.high_water_mark);
+			stats_info->set_overflow_count(stats.overflow_count);
+			stats_info->set_dropped_count(stats.dropped_count);
+			stats_info->set_merged_count(stats.merged_count);
+			stats_info->set_last_lag_ms(stats.last_lag_ms);
+			stats_info->set_max_lag_ms(stats.max_lag_ms);
+			stats_info->set_overflow_policy(
+				static_cast<PSMoveProtocol::Response_ResultControllerIMUQueueStats_OverflowPolicy>(stats.overflow_policy));
+			response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
+		}
+		else
+		{
+			response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_ERROR);
+		}
+	}
+
+	void handle_request__set_sensor_session_recording(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		const PSMoveProtocol::Request_RequestSetSensorSessionRecording &request =
+			context.request->request_set_sensor_session_recording();
+
+		bool bSuccess = true;
+
+		if (request.enabled())
+		{
+			const std::string filename =
+				request.filename().length() > 0 ? request.filename() : k_default_sensor_session_filename;
+
+			bSuccess = m_device_manager.startSensorSessionRecording(filename, request.include_video_frames());
+		}
+		else
+		{
+			m_device_manager.stopSensorSessionRecording();
+		}
+
+		response->set_result_code(
+			bSuccess
+			? PSMoveProtocol::Response_ResultCode_RESULT_OK
+			: PSMoveProtocol::Response_ResultCode_RESULT_ERROR);
+	}
+
     void handle_request__set_attached_controller(
         const RequestContext &context,
         PSMoveProtocol::Response *response)
@@ -2032,9 +2219,10 @@ protected:
 
                 // Set control flags for the stream
                 streamInfo.streaming_video_data = true;
+                streamInfo.include_debug_overlay = !request.disable_debug_overlay();
 
                 // Increment the number of stream listeners
-                tracker_view->startSharedMemoryVideoStream();
+                tracker_view->startSharedMemoryVideoStream(streamInfo.include_debug_overlay);
 
                 // Return the name of the shared memory block the video frames will be written to
                 response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
@@ -2063,6 +2251,9 @@ protected:
 
             if (tracker_view->getIsOpen())
             {
+                const bool bIncludedDebugOverlay =
+                    context.connection_state->active_tracker_stream_info[tracker_id].include_debug_overlay;
+
                 context.connection_state->active_tracker_streams.set(tracker_id, false);
                 context.connection_state->active_tracker_stream_info[tracker_id].Clear();
 
@@ -2073,7 +2264,7 @@ protected:
                 }
 
                 // Decrement the number of stream listeners
-                tracker_view->stopSharedMemoryVideoStream();
+                tracker_view->stopSharedMemoryVideoStream(bIncludedDebugOverlay);
 
                 response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
             }
@@ -2533,7 +2724,7 @@ protected:
                     context.request->request_set_tracker_pose().pose();
                 CommonDevicePose destPose = protocol_pose_to_common_device_pose(srcPose);
 
-                tracker_view->setTrackerPose(&destPose);
+                tracker_view->setTrackerPose(&destPose, true);
                 tracker_view->saveSettings();
 
                 response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
@@ -3222,6 +3413,111 @@ protected:
         response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
     }
 
+	void handle_request__get_service_metrics(
+		const RequestContext &context,
+		PSMoveProtocol::Response *response)
+	{
+		PSMoveProtocol::Response_ResultServiceMetrics *metrics_info = response->mutable_result_service_metrics();
+		MetricTimerStats timer_stats;
+		MetricCounterStats captured_frames, dropped_frames, imu_packets;
+
+		response->set_type(PSMoveProtocol::Response_ResponseType_SERVICE_METRICS);
+
+		metrics_info->set_window_seconds(ServiceMetrics::getWindowSeconds());
+
+		ServiceMetrics::getUpdateTimer().getStats(timer_stats);
+		set_timer_stats(timer_stats, metrics_info->mutable_update_time());
+
+		for (int stage_index = 0; stage_index < TrackingStage_COUNT; ++stage_index)
+		{
+			const eTrackingStage stage = static_cast<eTrackingStage>(stage_index);
+			PSMoveProtocol::Response_ResultServiceMetrics_StageMetrics *stage_info = metrics_info->add_stages();
+
+			TrackingStageProfiler::getTimerStats(stage, timer_stats);
+			stage_info->set_stage_name(TrackingStageProfiler::getStageName(stage));
+			set_timer_stats(timer_stats, stage_info->mutable_time());
+		}
+		metrics_info->set_segmented_pixel_count(TrackingStageProfiler::getSegmentedPixelCount());
+
+		for (int tracker_id = 0; tracker_id < m_device_manager.getTrackerViewMaxCount(); ++tracker_id)
+		{
+			ServerTrackerViewPtr tracker_view = m_device_manager.getTrackerViewPtr(tracker_id);
+
+			if (tracker_view->getIsOpen())
+			{
+				PSMoveProtocol::Response_ResultServiceMetrics_TrackerMetrics *tracker_info = metrics_info->add_trackers();
+
+				tracker_view->getCaptureMetrics(captured_frames, dropped_frames);
+				tracker_info->set_tracker_id(tracker_id);
+				set_counter_stats(captured_frames, tracker_info->mutable_captured_frames());
+				set_counter_stats(dropped_frames, tracker_info->mutable_dropped_frames());
+			}
+		}
+
+		for (int controller_id = 0; controller_id < m_device_manager.getControllerViewMaxCount(); ++controller_id)
+		{
+			const ServerControllerView *controller_view = get_controller_view_or_null(controller_id);
+
+			if (controller_view != nullptr)
+			{
+				PSMoveProtocol::Response_ResultServiceMetrics_ControllerMetrics *controller_info = metrics_info->add_controllers();
+				PoseSensorPacketQueueStats queue_stats;
+
+				controller_view->getIMUPacketMetrics(imu_packets);
+				controller_view->getIMUPacketQueueStats(queue_stats);
+				controller_info->set_controller_id(controller_id);
+				set_counter_stats(imu_packets, controller_info->mutable_imu_packets());
+				controller_info->set_imu_queue_depth(queue_stats.depth);
+				controller_info->set_imu_queue_high_water_mark(queue_stats.high_water_mark);
+			}
+		}
+
+		std::vector<ClientConnectionMetrics> connection_metrics;
+		ServerNetworkManager::get_instance()->gather_connection_metrics(connection_metrics);
+
+		for (const ClientConnectionMetrics &connection : connection_metrics)
+		{
+			PSMoveProtocol::Response_ResultServiceMetrics_ConnectionMetrics *connection_info = metrics_info->add_connections();
+
+			connection_info->set_connection_id(connection.connection_id);
+			set_counter_stats(connection.udp_data_frames_sent, connection_info->mutable_udp_data_frames());
+			set_counter_stats(connection.udp_bytes_sent, connection_info->mutable_udp_bytes());
+			set_counter_stats(connection.tcp_responses_sent, connection_info->mutable_tcp_responses());
+			set_counter_stats(connection.tcp_bytes_sent, connection_info->mutable_tcp_bytes());
+			connection_info->set_pending_data_frames(connection.pending_data_frame_count);
+			connection_info->set_pending_responses(connection.pending_response_count);
+		}
+
+		response->set_result_code(PSMoveProtocol::Response_ResultCode_RESULT_OK);
+	}
+
+	static void set_counter_stats(
+		const MetricCounterStats &stats,
+		PSMoveProtocol::Response_ResultServiceMetrics_CounterStats *counter_info)
+	{
+		counter_info->set_total(stats.total);
+		counter_info->set_rate_per_sec(stats.getWindowRatePerSecond());
+	}
+
+	static void set_timer_stats(
+		const MetricTimerStats &stats,
+		PSMoveProtocol::Response_ResultServiceMetrics_TimerStats *timer_info)
+	{
+		timer_info->set_total_count(stats.total_count);
+		timer_info->set_total_ms(static_cast<float>(static_cast<double>(stats.total_ns) / 1000000.0));
+		timer_info->set_max_ms(static_cast<float>(stats.max_ns) / 1000000.f);
+		timer_info->set_window_count(static_cast<int>(stats.window_count));
+		timer_info->set_window_mean_ms(stats.getWindowMeanMs());
+		timer_info->set_window_p50_ms(stats.getWindowPercentileMs(0.5f));
+		timer_info->set_window_p99_ms(stats.getWindowPercentileMs(0.99f));
+		timer_info->set_window_max_ms(static_cast<float>(stats.window_max_ns) / 1000000.f);
+
+		for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count; ++bucket_index)
+		{
+			timer_info->add_window_bucket_counts(static_cast<int>(stats.window_bucket_counts[bucket_index]));
+		}
+	}
+
     // -- Data Frame Updates -----
     void handle_data_frame__controller_packet(
         RequestConnectionStatePtr connection_state,
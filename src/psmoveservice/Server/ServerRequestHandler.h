@@ -41,11 +41,13 @@ struct ControllerStreamInfo
 struct TrackerStreamInfo
 {
     bool streaming_video_data;
+	bool include_debug_overlay;
 	bool has_temp_settings_override;
 
     inline void Clear()
     {
         streaming_video_data = false;
+		include_debug_overlay = false;
 		has_temp_settings_override = false;
     }
 };
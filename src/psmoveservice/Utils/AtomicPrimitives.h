@@ -2,91 +2,337 @@
 #define ATOMIC_PRIMITIVES_H
 
 #include <atomic>
-#include <assert.h>
+#include <vector>
+#include <stddef.h>
+
+//-- constants -----
+static const size_t k_atomic_primitives_cache_line_size = 64;
 
 // Triple buffered lock free atomic generic object
-// Inspired by: https://gist.github.com/andrewrk/03c369c82de4701625e3
+// For one writer thread and one reader thread. The writer fills a slot of its own and then swaps it
+// with the shared middle slot, the reader swaps the middle slot with its own slot whenever the writer
+// has put a newer object there. Neither side ever waits or touches the slot the other one owns.
+// The slots are stored inline and each one is padded out by a cache line, so the writer filling its
+// slot never shares a cache line with the reader reading its own.
+// (Padding rather than alignas, since the objects holding an AtomicObject are allocated
+// with a plain new, which doesn't honor over alignment before C++17.)
+// Every stored object gets a new generation number, so a reader can tell if anything changed.
 template<typename t_object_type>
 class AtomicObject 
 {
 public:
-    AtomicObject() 
+	// Read access to the newest stored object without copying it.
+	// The reader owns the viewed slot until it starts its next read,
+	// so a view stays valid for as long as it is in scope.
+	class ReadView
 	{
-        m_inUseIndex = 0;
-        m_activeIndex = 0;
-        m_write_index = -1;
-
-		for (int i = 0; i < 3; ++i)
+	public:
+		explicit ReadView(AtomicObject &atomic_object)
+			: m_slot(atomic_object.readBegin())
 		{
-			m_objects[i] = new t_object_type;
 		}
-    }
-    
-	virtual ~AtomicObject() 
+
+		inline const t_object_type &operator*() const { return m_slot->object; }
+		inline const t_object_type *operator->() const { return &m_slot->object; }
+
+		// 0 until the first store
+		inline unsigned int getGeneration() const { return m_slot->generation; }
+
+	private:
+		const typename AtomicObject::Slot *m_slot;
+	};
+
+    AtomicObject() 
+		: m_sharedIndex(1)
+		, m_writeIndex(0)
+		, m_nextGeneration(1)
+		, m_readIndex(2)
 	{
 		for (int i = 0; i < 3; ++i)
 		{
-			delete m_objects[i];
+			m_slots[i].generation = 0;
 		}
-	}
+    }
 
 	void storeValue(const t_object_type &object)
 	{
-		t_object_type *objectSlot= writeBegin();
-		*objectSlot= object;
-		writeEnd();
+		Slot &slot = m_slots[m_writeIndex];
+		slot.object = object;
+		slot.generation = m_nextGeneration;
+		++m_nextGeneration;
+
+		// Publish the filled slot and take over whichever one was in the middle
+		m_writeIndex = m_sharedIndex.exchange(m_writeIndex | k_fresh_flag, std::memory_order_acq_rel) & k_index_mask;
 	}
 
 	void fetchValue(t_object_type &out_object)
 	{
-		out_object= *getReadPtr();
+		out_object = *ReadView(*this);
+	}
+
+	// Only copies the object out if it is newer than the given generation.
+	// Returns true and updates in_out_generation if it was.
+	bool fetchValueIfNewer(t_object_type &out_object, unsigned int &in_out_generation)
+	{
+		ReadView view(*this);
+
+		if (view.getGeneration() != in_out_generation)
+		{
+			out_object = *view;
+			in_out_generation = view.getGeneration();
+			return true;
+		}
+
+		return false;
 	}
 
 protected:
-    t_object_type *writeBegin() 
+	struct Slot
 	{
-        assert(m_write_index == -1);
-        int in_use_index = m_inUseIndex.load();
-        int active_index = m_activeIndex.load();
+		t_object_type object;
+		unsigned int generation;
+		char padding[k_atomic_primitives_cache_line_size];
+	};
 
-		if (in_use_index != 0 && active_index != 0)
+	const Slot *readBegin()
+	{
+		// Only swap when the writer left something newer in the middle slot,
+		// otherwise the reader would hand its own slot back and get an older one
+		if ((m_sharedIndex.load(std::memory_order_relaxed) & k_fresh_flag) != 0)
 		{
-            m_write_index = 0;
+			m_readIndex = m_sharedIndex.exchange(m_readIndex, std::memory_order_acq_rel) & k_index_mask;
 		}
-		else if (in_use_index != 1 && active_index != 1)
+
+		return &m_slots[m_readIndex];
+	}
+
+private:
+	static const unsigned int k_index_mask = 0x3;
+	static const unsigned int k_fresh_flag = 0x4;
+
+	Slot m_slots[3];
+
+	// Shared State: middle slot index, plus the fresh flag when the writer put it there
+	std::atomic<unsigned int> m_sharedIndex;
+	char m_sharedPadding[k_atomic_primitives_cache_line_size];
+
+	// Writer State
+	unsigned int m_writeIndex;
+	unsigned int m_nextGeneration;
+	char m_writerPadding[k_atomic_primitives_cache_line_size];
+
+	// Reader State
+	unsigned int m_readIndex;
+
+    AtomicObject(const AtomicObject &copy) = delete;
+    AtomicObject &operator=(const AtomicObject &copy) = delete;
+};
+
+// Lock free published immutable snapshot
+// A single writer publishes a new snapshot with publish(), any number of readers
+// get the current one with one atomic load and never block, copy or allocate.
+// t_snapshot_type needs an unsigned int snapshot_version member, publish() numbers the snapshots.
+// A replaced snapshot is retired rather than freed, since a reader on another thread may
+// still be looking at it. Retired snapshots are only freed along with the AtomicSnapshot,
+// so publish() is meant for config changes and not for per frame data.
+template<typename t_snapshot_type>
+class AtomicSnapshot
+{
+public:
+	AtomicSnapshot()
+		: m_nextVersion(1)
+	{
+		t_snapshot_type *initial_snapshot = new t_snapshot_type;
+		initial_snapshot->snapshot_version = 0;
+
+		m_current.store(initial_snapshot);
+	}
+
+	virtual ~AtomicSnapshot()
+	{
+		delete m_current.load();
+
+		for (t_snapshot_type *retired_snapshot : m_retired)
 		{
-            m_write_index = 1;
+			delete retired_snapshot;
 		}
-		else
+	}
+
+	// Writer only
+	void publish(const t_snapshot_type &snapshot)
+	{
+		t_snapshot_type *next_snapshot = new t_snapshot_type(snapshot);
+		next_snapshot->snapshot_version = m_nextVersion;
+		++m_nextVersion;
+
+		m_retired.push_back(m_current.exchange(next_snapshot, std::memory_order_acq_rel));
+	}
+
+	// Any thread, the snapshot stays valid for the lifetime of the AtomicSnapshot
+	const t_snapshot_type *get() const
+	{
+		return m_current.load(std::memory_order_acquire);
+	}
+
+private:
+	std::atomic<t_snapshot_type *> m_current;
+
+	// Writer State
+	std::vector<t_snapshot_type *> m_retired;
+	unsigned int m_nextVersion;
+
+	AtomicSnapshot(const AtomicSnapshot &copy) = delete;
+	AtomicSnapshot &operator=(const AtomicSnapshot &copy) = delete;
+};
+
+// Fixed capacity lock free ring buffer
+// The cells are allocated once by allocate(), enqueuing and dequeuing never allocate.
+// There is one producer thread, which is the only one that may enqueue, and one consumer thread.
+// Every cell carries a sequence number that says whose turn it is, so dequeuing is also safe
+// from the producer thread, which lets a producer make room for new entries by taking the oldest
+// ones out itself when the consumer falls behind.
+template<typename t_element_type>
+class AtomicBoundedQueue
+{
+public:
+	AtomicBoundedQueue()
+		: m_cells(nullptr)
+		, m_capacityMask(0)
+		, m_dequeuePosition(0)
+		, m_enqueuePosition(0)
+	{
+	}
+
+	virtual ~AtomicBoundedQueue()
+	{
+		delete[] m_cells;
+	}
+
+	// Not thread safe, only call while neither the producer nor the consumer is using the queue.
+	// The capacity is rounded up to a power of two. Any queued entries are discarded.
+	void allocate(size_t min_capacity)
+	{
+		size_t capacity = 2;
+		while (capacity < min_capacity)
 		{
-            m_write_index = 2;
+			capacity <<= 1;
 		}
 
-        return m_objects[m_write_index];
-    }
+		if (m_cells == nullptr || capacity != getCapacity())
+		{
+			delete[] m_cells;
+			m_cells = new Cell[capacity];
+			m_capacityMask = capacity - 1;
+		}
+
+		for (size_t cell_index = 0; cell_index < capacity; ++cell_index)
+		{
+			m_cells[cell_index].sequence.store(cell_index, std::memory_order_relaxed);
+		}
+
+		m_dequeuePosition.store(0, std::memory_order_relaxed);
+		m_enqueuePosition.store(0, std::memory_order_relaxed);
+	}
 
-    void writeEnd() 
+	inline size_t getCapacity() const
 	{
-        assert(m_write_index != -1);
-        m_activeIndex.store(m_write_index);
-        m_write_index = -1;
-    }
+		return m_cells != nullptr ? m_capacityMask + 1 : 0;
+	}
 
-    t_object_type *getReadPtr() 
+	// Exact on the producer thread as far as its own enqueues go,
+	// an estimate anywhere else while the other thread is busy
+	inline size_t getSizeApprox() const
 	{
-        m_inUseIndex.store(m_activeIndex.load());
+		const size_t enqueue_position = m_enqueuePosition.load(std::memory_order_acquire);
+		const size_t dequeue_position = m_dequeuePosition.load(std::memory_order_acquire);
 
-        return m_objects[m_inUseIndex];
-    }
+		return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+	}
+
+	// Producer only. Returns false if the queue is full.
+	bool tryEnqueue(const t_element_type &element)
+	{
+		if (m_cells == nullptr)
+		{
+			return false;
+		}
+
+		const size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+		Cell &cell = m_cells[position & m_capacityMask];
+
+		// The cell is free once its last dequeue moved the sequence a lap ahead
+		if (cell.sequence.load(std::memory_order_acquire) != position)
+		{
+			return false;
+		}
+
+		cell.element = element;
+		cell.sequence.store(position + 1, std::memory_order_release);
+		m_enqueuePosition.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// Consumer, or the producer making room. Returns false if the queue is empty.
+	bool tryDequeue(t_element_type &out_element)
+	{
+		if (m_cells == nullptr)
+		{
+			return false;
+		}
+
+		size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Cell &cell = m_cells[position & m_capacityMask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const ptrdiff_t lag = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+			if (lag == 0)
+			{
+				// Claim the cell, unless the other dequeuing thread got to it first
+				if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					out_element = cell.element;
+					cell.sequence.store(position + m_capacityMask + 1, std::memory_order_release);
+
+					return true;
+				}
+			}
+			else if (lag < 0)
+			{
+				// Not filled yet
+				return false;
+			}
+			else
+			{
+				// Taken by the other dequeuing thread, move on to the next one
+				position = m_dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
 
 private:
-    t_object_type* m_objects[3];
-    std::atomic_int m_inUseIndex;
-    std::atomic_int m_activeIndex;
-    int m_write_index;
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		t_element_type element;
+	};
 
-    AtomicObject(const AtomicObject &copy) = delete;
-    AtomicObject &operator=(const AtomicObject &copy) = delete;
+	Cell *m_cells;
+	size_t m_capacityMask;
+	char m_cellsPadding[k_atomic_primitives_cache_line_size];
+
+	// Consumer State (shared with a producer making room)
+	std::atomic<size_t> m_dequeuePosition;
+	char m_dequeuePadding[k_atomic_primitives_cache_line_size];
+
+	// Producer State
+	std::atomic<size_t> m_enqueuePosition;
+
+	AtomicBoundedQueue(const AtomicBoundedQueue &copy) = delete;
+	AtomicBoundedQueue &operator=(const AtomicBoundedQueue &copy) = delete;
 };
 
 #endif // ATOMIC_PRIMITIVES_H
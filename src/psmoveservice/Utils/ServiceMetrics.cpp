@@ -0,0 +1,285 @@
+//-- includes -----
+#include "ServiceMetrics.h"
+
+#include <algorithm>
+
+//-- statics -----
+std::atomic<uint32_t> ServiceMetrics::m_windowIndex(0);
+
+//-- prototypes -----
+static int compute_histogram_bucket(int64_t duration_ns);
+static bool try_read_window_bank_index(uint32_t &out_window_index);
+
+//-- public implementation -----
+void MetricCounterStats::clear()
+{
+	total = 0;
+	window_count = 0;
+}
+
+void MetricCounterStats::accumulate(const MetricCounterStats &other)
+{
+	total += other.total;
+	window_count += other.window_count;
+}
+
+float MetricCounterStats::getWindowRatePerSecond() const
+{
+	return static_cast<float>(window_count) / ServiceMetrics::getWindowSeconds();
+}
+
+void MetricTimerStats::clear()
+{
+	total_count = 0;
+	total_ns = 0;
+	max_ns = 0;
+	window_count = 0;
+	window_total_ns = 0;
+	window_max_ns = 0;
+
+	for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count; ++bucket_index)
+	{
+		window_bucket_counts[bucket_index] = 0;
+	}
+}
+
+void MetricTimerStats::accumulate(const MetricTimerStats &other)
+{
+	total_count += other.total_count;
+	total_ns += other.total_ns;
+	max_ns = std::max(max_ns, other.max_ns);
+	window_count += other.window_count;
+	window_total_ns += other.window_total_ns;
+	window_max_ns = std::max(window_max_ns, other.window_max_ns);
+
+	for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count; ++bucket_index)
+	{
+		window_bucket_counts[bucket_index] += other.window_bucket_counts[bucket_index];
+	}
+}
+
+float MetricTimerStats::getWindowMeanMs() const
+{
+	return (window_count > 0)
+		? static_cast<float>(static_cast<double>(window_total_ns) / (1000000.0 * window_count))
+		: 0.f;
+}
+
+float MetricTimerStats::getWindowPercentileMs(float fraction) const
+{
+	if (window_count <= 0)
+	{
+		return 0.f;
+	}
+
+	const int64_t target_count = std::max<int64_t>(static_cast<int64_t>(fraction * window_count + 0.5f), 1);
+	int64_t sample_count = 0;
+
+	for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count - 1; ++bucket_index)
+	{
+		sample_count += window_bucket_counts[bucket_index];
+
+		if (sample_count >= target_count)
+		{
+			// Never claim more than the slowest sample actually took
+			const int64_t bucket_upper_ns = (static_cast<int64_t>(1) << bucket_index) * 1000;
+
+			return static_cast<float>(std::min(bucket_upper_ns, window_max_ns)) / 1000000.f;
+		}
+	}
+
+	// The last bucket has no upper bound
+	return static_cast<float>(window_max_ns) / 1000000.f;
+}
+
+void ServiceMetrics::update()
+{
+	static const std::chrono::time_point<std::chrono::steady_clock> k_start_time = std::chrono::steady_clock::now();
+
+	const std::chrono::milliseconds elapsed =
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - k_start_time);
+
+	// Window 0 never completes, so a bank still tagged with it reads as empty
+	m_windowIndex.store(static_cast<uint32_t>(elapsed.count() / k_metric_window_ms) + 1, std::memory_order_relaxed);
+}
+
+MetricTimer &ServiceMetrics::getUpdateTimer()
+{
+	static MetricTimer s_update_timer;
+
+	return s_update_timer;
+}
+
+//-- MetricCounter -----
+MetricCounter::MetricCounter()
+	: m_total(0)
+{
+	for (int bank_index = 0; bank_index < 2; ++bank_index)
+	{
+		m_banks[bank_index].window_index.store(0);
+		m_banks[bank_index].count.store(0);
+	}
+}
+
+void MetricCounter::reset()
+{
+	for (int bank_index = 0; bank_index < 2; ++bank_index)
+	{
+		m_banks[bank_index].count.store(0, std::memory_order_relaxed);
+		m_banks[bank_index].window_index.store(0, std::memory_order_release);
+	}
+
+	m_total.store(0, std::memory_order_relaxed);
+}
+
+void MetricCounter::getStats(MetricCounterStats &out_stats) const
+{
+	uint32_t window_index;
+
+	out_stats.total = m_total.load(std::memory_order_relaxed);
+	out_stats.window_count = 0;
+
+	if (try_read_window_bank_index(window_index))
+	{
+		const WindowBank &bank = m_banks[window_index & 1];
+
+		if (bank.window_index.load(std::memory_order_acquire) == window_index)
+		{
+			const int64_t count = bank.count.load(std::memory_order_relaxed);
+
+			// Throw the count away if the writer recycled the bank while it was read
+			if (bank.window_index.load(std::memory_order_acquire) == window_index)
+			{
+				out_stats.window_count = count;
+			}
+		}
+	}
+}
+
+//-- MetricTimer -----
+MetricTimer::MetricTimer()
+	: m_totalCount(0)
+	, m_totalNs(0)
+	, m_maxNs(0)
+{
+	for (int bank_index = 0; bank_index < 2; ++bank_index)
+	{
+		clear_bank(m_banks[bank_index]);
+		m_banks[bank_index].window_index.store(0);
+	}
+}
+
+void MetricTimer::addSample(int64_t duration_ns)
+{
+	const uint32_t window_index = ServiceMetrics::getWindowIndex();
+	WindowBank &bank = m_banks[window_index & 1];
+
+	// The first sample of a window recycles the bank of the window before last
+	if (bank.window_index.load(std::memory_order_relaxed) != window_index)
+	{
+		clear_bank(bank);
+		bank.window_index.store(window_index, std::memory_order_release);
+	}
+
+	std::atomic<int64_t> &bucket_count = bank.bucket_counts[compute_histogram_bucket(duration_ns)];
+
+	bank.count.store(bank.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	bank.total_ns.store(bank.total_ns.load(std::memory_order_relaxed) + duration_ns, std::memory_order_relaxed);
+	bucket_count.store(bucket_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (duration_ns > bank.max_ns.load(std::memory_order_relaxed))
+	{
+		bank.max_ns.store(duration_ns, std::memory_order_relaxed);
+	}
+
+	m_totalCount.store(m_totalCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	m_totalNs.store(m_totalNs.load(std::memory_order_relaxed) + duration_ns, std::memory_order_relaxed);
+	if (duration_ns > m_maxNs.load(std::memory_order_relaxed))
+	{
+		m_maxNs.store(duration_ns, std::memory_order_relaxed);
+	}
+}
+
+void MetricTimer::reset()
+{
+	for (int bank_index = 0; bank_index < 2; ++bank_index)
+	{
+		clear_bank(m_banks[bank_index]);
+		m_banks[bank_index].window_index.store(0, std::memory_order_release);
+	}
+
+	m_totalCount.store(0, std::memory_order_relaxed);
+	m_totalNs.store(0, std::memory_order_relaxed);
+	m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+void MetricTimer::getStats(MetricTimerStats &out_stats) const
+{
+	uint32_t window_index;
+
+	out_stats.clear();
+	out_stats.total_count = m_totalCount.load(std::memory_order_relaxed);
+	out_stats.total_ns = m_totalNs.load(std::memory_order_relaxed);
+	out_stats.max_ns = m_maxNs.load(std::memory_order_relaxed);
+
+	if (try_read_window_bank_index(window_index))
+	{
+		const WindowBank &bank = m_banks[window_index & 1];
+
+		if (bank.window_index.load(std::memory_order_acquire) == window_index)
+		{
+			MetricTimerStats window_stats;
+
+			window_stats.clear();
+			window_stats.window_count = bank.count.load(std::memory_order_relaxed);
+			window_stats.window_total_ns = bank.total_ns.load(std::memory_order_relaxed);
+			window_stats.window_max_ns = bank.max_ns.load(std::memory_order_relaxed);
+			for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count; ++bucket_index)
+			{
+				window_stats.window_bucket_counts[bucket_index] = bank.bucket_counts[bucket_index].load(std::memory_order_relaxed);
+			}
+
+			// Throw the window away if the writer recycled the bank while it was read
+			if (bank.window_index.load(std::memory_order_acquire) == window_index)
+			{
+				out_stats.accumulate(window_stats);
+			}
+		}
+	}
+}
+
+void MetricTimer::clear_bank(WindowBank &bank)
+{
+	bank.count.store(0, std::memory_order_relaxed);
+	bank.total_ns.store(0, std::memory_order_relaxed);
+	bank.max_ns.store(0, std::memory_order_relaxed);
+
+	for (int bucket_index = 0; bucket_index < k_metric_histogram_bucket_count; ++bucket_index)
+	{
+		bank.bucket_counts[bucket_index].store(0, std::memory_order_relaxed);
+	}
+}
+
+//-- private functions -----
+static int compute_histogram_bucket(int64_t duration_ns)
+{
+	int64_t duration_us = duration_ns / 1000;
+	int bucket_index = 0;
+
+	while (duration_us > 0 && bucket_index < k_metric_histogram_bucket_count - 1)
+	{
+		duration_us >>= 1;
+		++bucket_index;
+	}
+
+	return bucket_index;
+}
+
+// The last complete window is the one before the current one
+static bool try_read_window_bank_index(uint32_t &out_window_index)
+{
+	const uint32_t current_window_index = ServiceMetrics::getWindowIndex();
+
+	out_window_index = current_window_index - 1;
+
+	return current_window_index > 1;
+}
@@ -0,0 +1,172 @@
+#ifndef SERVICE_METRICS_H
+#define SERVICE_METRICS_H
+
+//-- includes -----
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+//-- constants -----
+// Histogram bucket i holds the durations in [2^(i-1), 2^i) microseconds, bucket 0 the ones under 1us
+// and the last bucket everything from about a quarter second up
+static const int k_metric_histogram_bucket_count = 20;
+
+// Length of the rolling window the rates and histograms are reported over
+static const int k_metric_window_ms = 1000;
+
+//-- definitions -----
+struct MetricCounterStats
+{
+	int64_t total;			// Since the service started
+	int64_t window_count;	// During the last complete window
+
+	void clear();
+	void accumulate(const MetricCounterStats &other);
+	float getWindowRatePerSecond() const;
+};
+
+struct MetricTimerStats
+{
+	// Since the service started
+	int64_t total_count;
+	int64_t total_ns;
+	int64_t max_ns;
+
+	// During the last complete window
+	int64_t window_count;
+	int64_t window_total_ns;
+	int64_t window_max_ns;
+	int64_t window_bucket_counts[k_metric_histogram_bucket_count];
+
+	void clear();
+	void accumulate(const MetricTimerStats &other);
+	float getWindowMeanMs() const;
+	// Upper bound of the histogram bucket the given fraction of the window's samples fall under
+	float getWindowPercentileMs(float fraction) const;
+};
+
+/// Hands out the rolling window index every counter and timer files its samples under.
+/// Only the main thread advances it, everyone else just reads it.
+class ServiceMetrics
+{
+public:
+	/// Main thread, once per update
+	static void update();
+
+	static inline uint32_t getWindowIndex()
+	{ return m_windowIndex.load(std::memory_order_relaxed); }
+
+	static inline float getWindowSeconds()
+	{ return static_cast<float>(k_metric_window_ms) / 1000.f; }
+
+	/// Main loop update times, owned by the main thread
+	static class MetricTimer &getUpdateTimer();
+
+private:
+	static std::atomic<uint32_t> m_windowIndex;
+};
+
+/// Event counter written by a single thread.
+/// The writer never does a read-modify-write, so counting costs a few plain loads and stores
+/// with nothing shared with the other writers. Readers on any thread see a value at most a few events behind.
+/// Anything counted from several threads gets a counter per thread, summed up when read.
+class MetricCounter
+{
+public:
+	MetricCounter();
+
+	/// Owning thread only
+	inline void add(int64_t amount = 1)
+	{
+		WindowBank &bank = getWriteBank();
+
+		bank.count.store(bank.count.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		m_total.store(m_total.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	/// Owning thread only
+	void reset();
+
+	void getStats(MetricCounterStats &out_stats) const;
+
+private:
+	struct WindowBank
+	{
+		std::atomic<uint32_t> window_index;
+		std::atomic<int64_t> count;
+	};
+
+	inline WindowBank &getWriteBank()
+	{
+		const uint32_t window_index = ServiceMetrics::getWindowIndex();
+		WindowBank &bank = m_banks[window_index & 1];
+
+		// The first sample of a window recycles the bank of the window before last
+		if (bank.window_index.load(std::memory_order_relaxed) != window_index)
+		{
+			bank.count.store(0, std::memory_order_relaxed);
+			bank.window_index.store(window_index, std::memory_order_release);
+		}
+
+		return bank;
+	}
+
+	std::atomic<int64_t> m_total;
+	WindowBank m_banks[2]; // The current window and the last complete one
+};
+
+/// Duration histogram written by a single thread, same rules as MetricCounter
+class MetricTimer
+{
+public:
+	MetricTimer();
+
+	/// Owning thread only
+	void addSample(int64_t duration_ns);
+
+	/// Owning thread only
+	void reset();
+
+	void getStats(MetricTimerStats &out_stats) const;
+
+private:
+	struct WindowBank
+	{
+		std::atomic<uint32_t> window_index;
+		std::atomic<int64_t> count;
+		std::atomic<int64_t> total_ns;
+		std::atomic<int64_t> max_ns;
+		std::atomic<int64_t> bucket_counts[k_metric_histogram_bucket_count];
+	};
+
+	static void clear_bank(WindowBank &bank);
+
+	std::atomic<int64_t> m_totalCount;
+	std::atomic<int64_t> m_totalNs;
+	std::atomic<int64_t> m_maxNs;
+	WindowBank m_banks[2]; // The current window and the last complete one
+};
+
+/// Times the enclosing scope as a sample of the given timer
+class MetricTimerScope
+{
+public:
+	explicit MetricTimerScope(MetricTimer &timer)
+		: m_timer(timer)
+		, m_startTime(std::chrono::high_resolution_clock::now())
+	{
+	}
+
+	~MetricTimerScope()
+	{
+		const std::chrono::nanoseconds duration = std::chrono::high_resolution_clock::now() - m_startTime;
+
+		m_timer.addSample(duration.count());
+	}
+
+private:
+	MetricTimer &m_timer;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
+};
+
+#endif // SERVICE_METRICS_H
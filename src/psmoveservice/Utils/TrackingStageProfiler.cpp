@@ -0,0 +1,145 @@
+//-- includes -----
+#include "TrackingStageProfiler.h"
+
+#include <algorithm>
+
+//-- statics -----
+std::atomic<bool> TrackingStageProfiler::m_bIsEnabled(true);
+std::atomic<uint32_t> TrackingStageProfiler::m_resetGeneration(0);
+std::atomic<int> TrackingStageProfiler::m_threadSlotCount(0);
+std::atomic<int64_t> TrackingStageProfiler::m_droppedSampleCount(0);
+TrackingStageProfiler::ThreadSlot TrackingStageProfiler::m_threadSlots[k_tracking_stage_profiler_max_threads];
+
+//-- public implementation -----
+void TrackingStageProfiler::setIsEnabled(bool bIsEnabled)
+{
+	m_bIsEnabled.store(bIsEnabled, std::memory_order_relaxed);
+}
+
+void TrackingStageProfiler::reset()
+{
+	m_resetGeneration.fetch_add(1);
+}
+
+void TrackingStageProfiler::addSample(eTrackingStage stage, int64_t duration_ns)
+{
+	ThreadSlot *slot = getThreadSlot();
+
+	if (slot != nullptr)
+	{
+		slot->stage_timers[stage].addSample(duration_ns);
+	}
+}
+
+TrackingStageStats TrackingStageProfiler::getStats(eTrackingStage stage)
+{
+	MetricTimerStats timer_stats;
+	getTimerStats(stage, timer_stats);
+
+	TrackingStageStats stats;
+	stats.sample_count = timer_stats.total_count;
+	stats.total_ns = timer_stats.total_ns;
+	stats.max_ns = timer_stats.max_ns;
+
+	return stats;
+}
+
+void TrackingStageProfiler::getTimerStats(eTrackingStage stage, MetricTimerStats &out_stats)
+{
+	const int slot_count = std::min(m_threadSlotCount.load(), k_tracking_stage_profiler_max_threads);
+
+	out_stats.clear();
+
+	for (int slot_index = 0; slot_index < slot_count; ++slot_index)
+	{
+		const ThreadSlot &slot = m_threadSlots[slot_index];
+
+		if (getIsSlotCurrent(slot))
+		{
+			MetricTimerStats slot_stats;
+
+			slot.stage_timers[stage].getStats(slot_stats);
+			out_stats.accumulate(slot_stats);
+		}
+	}
+}
+
+int64_t TrackingStageProfiler::getSegmentedPixelCount()
+{
+	const int slot_count = std::min(m_threadSlotCount.load(), k_tracking_stage_profiler_max_threads);
+	int64_t segmented_pixel_count = 0;
+
+	for (int slot_index = 0; slot_index < slot_count; ++slot_index)
+	{
+		const ThreadSlot &slot = m_threadSlots[slot_index];
+
+		if (getIsSlotCurrent(slot))
+		{
+			MetricCounterStats slot_stats;
+
+			slot.segmented_pixel_counter.getStats(slot_stats);
+			segmented_pixel_count += slot_stats.total;
+		}
+	}
+
+	return segmented_pixel_count;
+}
+
+int64_t TrackingStageProfiler::getDroppedSampleCount()
+{
+	return m_droppedSampleCount.load(std::memory_order_relaxed);
+}
+
+const char *TrackingStageProfiler::getStageName(eTrackingStage stage)
+{
+	static const char *k_stage_names[TrackingStage_COUNT] = {
+		"segmentation",
+		"contours",
+		"shape_fit",
+		"triangulation",
+		"filtering",
+		"publish"
+	};
+
+	return k_stage_names[stage];
+}
+
+//-- private implementation -----
+TrackingStageProfiler::ThreadSlot *TrackingStageProfiler::getThreadSlot()
+{
+	static thread_local int tls_slot_index = -1;
+
+	if (tls_slot_index < 0)
+	{
+		tls_slot_index = m_threadSlotCount.fetch_add(1);
+	}
+
+	// Each slot has a single writer, so threads past the last one don't get any
+	if (tls_slot_index >= k_tracking_stage_profiler_max_threads)
+	{
+		m_droppedSampleCount.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	ThreadSlot &slot = m_threadSlots[tls_slot_index];
+
+	// Only the owning thread clears its timers
+	const uint32_t reset_generation = m_resetGeneration.load(std::memory_order_relaxed);
+	if (slot.reset_generation.load(std::memory_order_relaxed) != reset_generation)
+	{
+		for (int stage_index = 0; stage_index < TrackingStage_COUNT; ++stage_index)
+		{
+			slot.stage_timers[stage_index].reset();
+		}
+
+		slot.segmented_pixel_counter.reset();
+		slot.reset_generation.store(reset_generation, std::memory_order_release);
+	}
+
+	return &slot;
+}
+
+bool TrackingStageProfiler::getIsSlotCurrent(const ThreadSlot &slot)
+{
+	return slot.reset_generation.load(std::memory_order_acquire) == m_resetGeneration.load(std::memory_order_relaxed);
+}
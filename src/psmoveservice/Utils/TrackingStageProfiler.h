@@ -0,0 +1,125 @@
+#ifndef TRACKING_STAGE_PROFILER_H
+#define TRACKING_STAGE_PROFILER_H
+
+//-- includes -----
+#include "ServiceMetrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+//-- constants -----
+// Threads that get their own stage timers, samples from any more are dropped
+static const int k_tracking_stage_profiler_max_threads = 16;
+
+//-- definitions -----
+enum eTrackingStage
+{
+	TrackingStage_Segmentation,		// BGR->HSV conversion and color thresholding
+	TrackingStage_Contours,			// Contour extraction and sorting
+	TrackingStage_ShapeFit,			// Fitting the tracking shape to the best contour
+	TrackingStage_Triangulation,	// Combining tracker projections into a world pose
+	TrackingStage_Filtering,		// Pose filter updates
+	TrackingStage_Publish,			// Publishing device state to clients
+
+	TrackingStage_COUNT
+};
+
+struct TrackingStageStats
+{
+	int64_t sample_count;
+	int64_t total_ns;
+	int64_t max_ns;
+};
+
+/// Accumulates how long each stage of the optical tracking pipeline takes,
+/// along with how many pixels went through color segmentation.
+/// Every thread that times a stage gets its own set of timers, so the stages timed on
+/// different threads never contend; the stats sum them all up.
+/// Threads past k_tracking_stage_profiler_max_threads get no timers, their samples are only counted as dropped.
+/// Enabled by default, the service metrics report these stats. A stage scope costs ~100ns enabled
+/// (two clock reads and the timer update) and ~2ns disabled (a relaxed atomic load).
+/// A frame times about four scopes per tracker and controller, so 4 trackers and 2 controllers
+/// come to ~4us per frame, well under 0.1% of a 60Hz frame.
+class TrackingStageProfiler
+{
+public:
+	static inline bool getIsEnabled()
+	{ return m_bIsEnabled.load(std::memory_order_relaxed); }
+	static void setIsEnabled(bool bIsEnabled);
+
+	/// Each thread clears its own timers the next time it times a stage,
+	/// until then the stats leave them out
+	static void reset();
+	static void addSample(eTrackingStage stage, int64_t duration_ns);
+	static TrackingStageStats getStats(eTrackingStage stage);
+	static void getTimerStats(eTrackingStage stage, MetricTimerStats &out_stats);
+
+	// Pixels converted to HSV and thresholded, full resolution and downscaled alike
+	static inline void addSegmentedPixels(int64_t pixel_count)
+	{
+		if (getIsEnabled())
+		{
+			ThreadSlot *slot = getThreadSlot();
+
+			if (slot != nullptr)
+			{
+				slot->segmented_pixel_counter.add(pixel_count);
+			}
+		}
+	}
+	static int64_t getSegmentedPixelCount();
+	// Samples from threads that didn't get a set of timers, since the service started
+	static int64_t getDroppedSampleCount();
+	static const char *getStageName(eTrackingStage stage);
+
+private:
+	struct ThreadSlot
+	{
+		std::atomic<uint32_t> reset_generation;
+		MetricTimer stage_timers[TrackingStage_COUNT];
+		MetricCounter segmented_pixel_counter;
+	};
+
+	// nullptr once all the slots are taken
+	static ThreadSlot *getThreadSlot();
+	static bool getIsSlotCurrent(const ThreadSlot &slot);
+
+	static std::atomic<bool> m_bIsEnabled;
+	static std::atomic<uint32_t> m_resetGeneration;
+	static std::atomic<int> m_threadSlotCount;
+	static std::atomic<int64_t> m_droppedSampleCount;
+	static ThreadSlot m_threadSlots[k_tracking_stage_profiler_max_threads];
+};
+
+/// Times the enclosing scope as a sample of the given stage
+class TrackingStageScope
+{
+public:
+	explicit TrackingStageScope(eTrackingStage stage)
+		: m_stage(stage)
+		, m_bIsActive(TrackingStageProfiler::getIsEnabled())
+	{
+		if (m_bIsActive)
+		{
+			m_startTime = std::chrono::high_resolution_clock::now();
+		}
+	}
+
+	~TrackingStageScope()
+	{
+		if (m_bIsActive)
+		{
+			const std::chrono::nanoseconds duration = std::chrono::high_resolution_clock::now() - m_startTime;
+
+			TrackingStageProfiler::addSample(m_stage, duration.count());
+		}
+	}
+
+private:
+	eTrackingStage m_stage;
+	bool m_bIsActive;
+	std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
+};
+
+#endif // TRACKING_STAGE_PROFILER_H
@@ -106,6 +106,7 @@ VirtualController::VirtualController()
     : cfg()
     , NextPollSequenceNumber(0)
     , bIsOpen(false)
+    , TrackingColorID(eCommonTrackingColorID::INVALID_COLOR)
     , bIsTracking(false)
 	, m_controllerListener(nullptr)
 {
@@ -160,6 +161,8 @@ bool VirtualController::open(
         // Save it back out again in case any defaults changed
         cfg.save();
 
+        TrackingColorID = cfg.tracking_color_id;
+
         // Reset the polling sequence counter
         NextPollSequenceNumber = 0;
 
@@ -191,14 +194,20 @@ VirtualController::setHostBluetoothAddress(const std::string &new_host_bt_addr)
 }
 
 bool
-VirtualController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id)
+VirtualController::setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig)
 {
 	bool bSuccess = false;
 
 	if (getIsOpen())
 	{
-		cfg.tracking_color_id = tracking_color_id;
-		cfg.save();
+		TrackingColorID = tracking_color_id;
+
+		if (bUpdateConfig)
+		{
+			cfg.tracking_color_id = tracking_color_id;
+			cfg.save();
+		}
+
 		bSuccess = true;
 	}
 
@@ -394,7 +403,7 @@ VirtualController::getTrackingColorID(eCommonTrackingColorID &out_tracking_color
 
 	if (getIsOpen())
 	{
-		out_tracking_color_id = cfg.tracking_color_id;
+		out_tracking_color_id = TrackingColorID;
 		bSuccess = true;
 	}
 
@@ -145,7 +145,7 @@ public:
     
     // -- IControllerInterface
     virtual bool setHostBluetoothAddress(const std::string &address) override;
-	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id) override;
+	virtual bool setTrackingColorID(const eCommonTrackingColorID tracking_color_id, bool bUpdateConfig) override;
 	virtual void setControllerListener(IControllerListener *listener) override;
     virtual bool getIsBluetooth() const override;
     virtual std::string getUSBDevicePath() const override;
@@ -181,6 +181,8 @@ private:
     int NextPollSequenceNumber;
     VirtualControllerState ControllerState;
 
+	// The tracking color in use, only the same as cfg.tracking_color_id while that is the last color set with bUpdateConfig
+	eCommonTrackingColorID TrackingColorID;
 	bool bIsTracking;
 	IControllerListener* m_controllerListener;
 };
@@ -0,0 +1,60 @@
+/* Global operator new counting shared by the allocation reporting benchmarks */
+#ifndef __ALLOCATION_COUNTER_H
+#define __ALLOCATION_COUNTER_H
+
+//-- includes -----
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+//-- allocation tracking -----
+// Replaces the global operator new/delete, so include this in exactly one source file of a benchmark.
+// Counts every operator new in the process: the count taken around a run is what the run allocated through new
+// (std::vector, std::function, ...). Heap blocks taken with malloc directly, like Eigen's dynamic matrices,
+// are NOT counted. Use EIGEN_RUNTIME_NO_MALLOC to catch those.
+static std::atomic<size_t> g_operator_new_count(0);
+
+inline size_t get_operator_new_count()
+{
+	return g_operator_new_count.load();
+}
+
+void *operator new(size_t size)
+{
+	++g_operator_new_count;
+
+	void *result = malloc(size > 0 ? size : 1);
+	if (result == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return result;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+#endif // __ALLOCATION_COUNTER_H
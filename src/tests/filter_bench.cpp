@@ -0,0 +1,399 @@
+#include "DeviceInterface.h"
+#include "KalmanPoseFilter.h"
+#include "CompoundPoseFilter.h"
+#include "MathAlignment.h"
+#include "controller_input_stream.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+//-- constants -----
+#define DEFAULT_ITERATION_COUNT 10
+
+// Filter names match the position_filter_type/orientation_filter_type strings
+// used in the controller configs (see pose_filter_factory() in ServerControllerView.cpp).
+// The "External" filter types are skipped since they follow another live device.
+struct OrientationFilterEntry
+{
+	OrientationFilterType type;
+	const char *name;
+};
+
+struct PositionFilterEntry
+{
+	PositionFilterType type;
+	const char *name;
+};
+
+static const OrientationFilterEntry k_orientation_filters[] = {
+	{OrientationFilterTypeNone, ""},
+	{OrientationFilterTypePassThru, "PassThru"},
+	{OrientationFilterTypeMadgwickARG, "MadgwickARG"},
+	{OrientationFilterTypeMadgwickMARG, "MadgwickMARG"},
+	{OrientationFilterTypeComplementaryOpticalARG, "ComplementaryOpticalARG"},
+	{OrientationFilterTypeComplementaryMARG, "ComplementaryMARG"},
+	{OrientationFilterTypeKalman, "OrientationKalman"}
+};
+static const int k_orientation_filter_count = sizeof(k_orientation_filters) / sizeof(OrientationFilterEntry);
+
+static const PositionFilterEntry k_position_filters[] = {
+	{PositionFilterTypeNone, ""},
+	{PositionFilterTypePassThru, "PassThru"},
+	{PositionFilterTypeLowPassOptical, "LowPassOptical"},
+	{PositionFilterTypeLowPassIMU, "LowPassIMU"},
+	{PositionFilterTypeComplimentaryOpticalIMU, "ComplimentaryOpticalIMU"},
+	{PositionFilterTypeLowPassExponential, "LowPassExponential"},
+	{PositionFilterTypeKalman, "PositionKalman"}
+};
+static const int k_position_filter_count = sizeof(k_position_filters) / sizeof(PositionFilterEntry);
+
+// The full pose kalman filter is selected when both filter types are set to this
+static const char *k_pose_kalman_filter_name = "PoseKalman";
+
+//-- definitions -----
+struct FilterBenchResults
+{
+	std::string orientation_filter_name;
+	std::string position_filter_name;
+	bool has_orientation;
+	bool has_position;
+
+	size_t update_count;
+	double total_update_ns;
+	double max_update_ns;
+	double total_position_error_cm;
+	double max_position_error_cm;
+	double total_orientation_error_deg;
+	double max_orientation_error_deg;
+
+	void clear()
+	{
+		orientation_filter_name.clear();
+		position_filter_name.clear();
+		has_orientation = false;
+		has_position = false;
+		update_count = 0;
+		total_update_ns = 0.0;
+		max_update_ns = 0.0;
+		total_position_error_cm = 0.0;
+		max_position_error_cm = 0.0;
+		total_orientation_error_deg = 0.0;
+		max_orientation_error_deg = 0.0;
+	}
+};
+
+//-- prototypes -----
+static IPoseFilter *create_pose_filter(
+	const CommonDeviceState::eDeviceType deviceType,
+	const OrientationFilterEntry *orientation_filter,
+	const PositionFilterEntry *position_filter,
+	const PoseFilterConstants &constants,
+	const Eigen::Vector3f &initial_position,
+	const Eigen::Quaternionf &initial_orientation);
+static bool run_filter_pass(
+	const OrientationFilterEntry *orientation_filter,
+	const PositionFilterEntry *position_filter,
+	ControllerInputStream &stationary_stream,
+	ControllerInputStream &movement_stream,
+	FilterBenchResults &results);
+static void print_results(const std::vector<FilterBenchResults> &all_results);
+static bool write_results(
+	const char *filename,
+	const ControllerInputStream &movement_stream,
+	const int iteration_count,
+	const std::vector<FilterBenchResults> &all_results);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	if (argc < 4)
+	{
+		printf("usage filter_bench <stationary_file.csv> <movement_file.csv> <results_file.csv> [iterations]");
+		return -1;
+	}
+
+	ControllerInputStream stationary_stream(argv[1]);
+	if (stationary_stream.getSampleCount() <= 1)
+	{
+		printf("Stationary file: %s, doesn't contain more than one sample", argv[1]);
+		return -1;
+	}
+
+	ControllerInputStream movement_stream(argv[2]);
+	if (movement_stream.getSampleCount() <= 1)
+	{
+		printf("Movement file: %s, doesn't contain more than one sample", argv[2]);
+		return -1;
+	}
+
+	const int iteration_count = (argc >= 5) ? std::max(atoi(argv[4]), 1) : DEFAULT_ITERATION_COUNT;
+
+	std::vector<FilterBenchResults> all_results;
+
+	// Every compound orientation x position filter combination,
+	// followed by the full pose kalman filter (null entries)
+	for (int orientation_index = 0; orientation_index <= k_orientation_filter_count; ++orientation_index)
+	{
+		for (int position_index = 0; position_index <= k_position_filter_count; ++position_index)
+		{
+			const bool bIsPoseKalman =
+				orientation_index == k_orientation_filter_count &&
+				position_index == k_position_filter_count;
+			const bool bIsCompound =
+				orientation_index < k_orientation_filter_count &&
+				position_index < k_position_filter_count;
+
+			if (!bIsPoseKalman && !bIsCompound)
+				continue;
+
+			const OrientationFilterEntry *orientation_filter = bIsCompound ? &k_orientation_filters[orientation_index] : nullptr;
+			const PositionFilterEntry *position_filter = bIsCompound ? &k_position_filters[position_index] : nullptr;
+
+			// Nothing to measure without either filter
+			if (bIsCompound &&
+				orientation_filter->type == OrientationFilterTypeNone &&
+				position_filter->type == PositionFilterTypeNone)
+				continue;
+
+			FilterBenchResults results;
+			results.clear();
+
+			bool bSuccess = true;
+			for (int iteration = 0; bSuccess && iteration < iteration_count; ++iteration)
+			{
+				bSuccess = run_filter_pass(orientation_filter, position_filter, stationary_stream, movement_stream, results);
+			}
+
+			if (bSuccess && results.update_count > 0)
+			{
+				all_results.push_back(results);
+			}
+		}
+	}
+
+	if (all_results.size() == 0)
+	{
+		printf("No filter updates were run");
+		return -1;
+	}
+
+	print_results(all_results);
+
+	if (!write_results(argv[3], movement_stream, iteration_count, all_results))
+	{
+		printf("Failed to write results file: %s", argv[3]);
+		return -1;
+	}
+
+	return 0;
+}
+
+//-- private functions -----
+static IPoseFilter *
+create_pose_filter(
+	const CommonDeviceState::eDeviceType deviceType,
+	const OrientationFilterEntry *orientation_filter,
+	const PositionFilterEntry *position_filter,
+	const PoseFilterConstants &constants,
+	const Eigen::Vector3f &initial_position,
+	const Eigen::Quaternionf &initial_orientation)
+{
+	IPoseFilter *filter = nullptr;
+
+	if (orientation_filter == nullptr || position_filter == nullptr)
+	{
+		switch (deviceType)
+		{
+		case CommonDeviceState::PSMove:
+			{
+				KalmanPoseFilterPSMove *kalmanFilter = new KalmanPoseFilterPSMove();
+				kalmanFilter->init(constants, initial_position, initial_orientation);
+				filter = kalmanFilter;
+			} break;
+		case CommonDeviceState::PSDualShock4:
+			{
+				KalmanPoseFilterDS4 *kalmanFilter = new KalmanPoseFilterDS4();
+				kalmanFilter->init(constants, initial_position, initial_orientation);
+				filter = kalmanFilter;
+			} break;
+		default:
+			break;
+		}
+	}
+	else
+	{
+		CompoundPoseFilter *compoundFilter = new CompoundPoseFilter();
+		compoundFilter->init(
+			deviceType,
+			orientation_filter->type, position_filter->type,
+			constants,
+			initial_position, initial_orientation);
+		filter = compoundFilter;
+	}
+
+	return filter;
+}
+
+static bool
+run_filter_pass(
+	const OrientationFilterEntry *orientation_filter,
+	const PositionFilterEntry *position_filter,
+	ControllerInputStream &stationary_stream,
+	ControllerInputStream &movement_stream,
+	FilterBenchResults &results)
+{
+	const CommonDeviceState::eDeviceType deviceType = movement_stream.getControllerType();
+
+	PoseFilterSpace *pose_filter_space = nullptr;
+	PoseFilterConstants constants;
+
+	switch (deviceType)
+	{
+	case CommonDeviceState::PSMove:
+		create_psmove_filter_space_and_constants(stationary_stream, &pose_filter_space, &constants);
+		break;
+	case CommonDeviceState::PSDualShock4:
+		create_psdualshock4_filter_space_and_constants(stationary_stream, &pose_filter_space, &constants);
+		break;
+	default:
+		return false;
+	}
+
+	// The input stream stores positions in meters
+	const ControllerSample &initialSample = movement_stream.getSample(0);
+	const Eigen::Vector3f initial_pos(initialSample.pos[0], initialSample.pos[1], initialSample.pos[2]);
+	const Eigen::Quaternionf initial_ori(initialSample.ori[0], initialSample.ori[1], initialSample.ori[2], initialSample.ori[3]);
+
+	IPoseFilter *pose_filter =
+		create_pose_filter(deviceType, orientation_filter, position_filter, constants, initial_pos, initial_ori);
+	if (pose_filter == nullptr)
+	{
+		delete pose_filter_space;
+		return false;
+	}
+
+	results.orientation_filter_name = (orientation_filter != nullptr) ? orientation_filter->name : k_pose_kalman_filter_name;
+	results.position_filter_name = (position_filter != nullptr) ? position_filter->name : k_pose_kalman_filter_name;
+	results.has_orientation = orientation_filter == nullptr || orientation_filter->type != OrientationFilterTypeNone;
+	results.has_position = position_filter == nullptr || position_filter->type != PositionFilterTypeNone;
+
+	replay_controller_input_stream(
+		stationary_stream, movement_stream, pose_filter_space, pose_filter,
+		[&results, pose_filter](
+			const ControllerSample &sample,
+			const Eigen::Vector3f &optical_position_cm,
+			const Eigen::Quaternionf &optical_orientation,
+			const double update_ns)
+	{
+		results.total_update_ns += update_ns;
+		results.max_update_ns = std::max(results.max_update_ns, update_ns);
+
+		// Error against the recorded optical pose
+		if (results.has_position)
+		{
+			const double position_error_cm = (pose_filter->getPositionCm() - optical_position_cm).norm();
+
+			results.total_position_error_cm += position_error_cm;
+			results.max_position_error_cm = std::max(results.max_position_error_cm, position_error_cm);
+		}
+
+		if (results.has_orientation)
+		{
+			const double orientation_error_deg =
+				eigen_quaternion_unsigned_angle_between(pose_filter->getOrientation(), optical_orientation)
+				* k_radians_to_degreees;
+
+			results.total_orientation_error_deg += orientation_error_deg;
+			results.max_orientation_error_deg = std::max(results.max_orientation_error_deg, orientation_error_deg);
+		}
+
+		++results.update_count;
+	});
+
+	delete pose_filter_space;
+	delete pose_filter;
+
+	return true;
+}
+
+static void
+print_results(const std::vector<FilterBenchResults> &all_results)
+{
+	printf("%-24s %-24s %14s %12s %12s %12s\n",
+		"ORIENTATION", "POSITION", "UPDATES/SEC", "MEAN_NS", "POS_ERR_CM", "ORI_ERR_DEG");
+
+	for (const FilterBenchResults &results : all_results)
+	{
+		const double update_count = static_cast<double>(results.update_count);
+		const double mean_update_ns = results.total_update_ns / update_count;
+		const double updates_per_sec = (mean_update_ns > 0.0) ? 1e9 / mean_update_ns : 0.0;
+
+		printf("%-24s %-24s %14.0f %12.1f ",
+			results.orientation_filter_name.empty() ? "None" : results.orientation_filter_name.c_str(),
+			results.position_filter_name.empty() ? "None" : results.position_filter_name.c_str(),
+			updates_per_sec, mean_update_ns);
+
+		if (results.has_position)
+			printf("%12.3f ", results.total_position_error_cm / update_count);
+		else
+			printf("%12s ", "-");
+
+		if (results.has_orientation)
+			printf("%12.3f\n", results.total_orientation_error_deg / update_count);
+		else
+			printf("%12s\n", "-");
+	}
+}
+
+static bool
+write_results(
+	const char *filename,
+	const ControllerInputStream &movement_stream,
+	const int iteration_count,
+	const std::vector<FilterBenchResults> &all_results)
+{
+	FILE *fp = fopen(filename, "wt");
+	if (fp == nullptr)
+	{
+		return false;
+	}
+
+	const char *device_name =
+		(movement_stream.getControllerType() == CommonDeviceState::PSDualShock4) ? "dualshock4" : "psmove";
+
+	// One row per filter combination.
+	// Error columns are left empty when the combination doesn't estimate that quantity.
+	fprintf(fp, "DEVICE, ORIENTATION_FILTER, POSITION_FILTER, SAMPLES, ITERATIONS, UPDATES_PER_SEC, MEAN_UPDATE_NS, MAX_UPDATE_NS, MEAN_POS_ERR_CM, MAX_POS_ERR_CM, MEAN_ORI_ERR_DEG, MAX_ORI_ERR_DEG\n");
+
+	for (const FilterBenchResults &results : all_results)
+	{
+		const double update_count = static_cast<double>(results.update_count);
+		const double mean_update_ns = results.total_update_ns / update_count;
+		const double updates_per_sec = (mean_update_ns > 0.0) ? 1e9 / mean_update_ns : 0.0;
+
+		fprintf(fp, "%s, %s, %s, %d, %d, %f, %f, %f, ",
+			device_name,
+			results.orientation_filter_name.c_str(),
+			results.position_filter_name.c_str(),
+			static_cast<int>(movement_stream.getSampleCount()),
+			iteration_count,
+			updates_per_sec, mean_update_ns, results.max_update_ns);
+
+		if (results.has_position)
+			fprintf(fp, "%f, %f, ", results.total_position_error_cm / update_count, results.max_position_error_cm);
+		else
+			fprintf(fp, ", , ");
+
+		if (results.has_orientation)
+			fprintf(fp, "%f, %f\n", results.total_orientation_error_deg / update_count, results.max_orientation_error_deg);
+		else
+			fprintf(fp, ", \n");
+	}
+
+	fclose(fp);
+
+	return true;
+}
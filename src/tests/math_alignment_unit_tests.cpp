@@ -7,15 +7,68 @@
 #include "MathUtility.h"
 #include "unit_test.h"
 
+#include <math.h>
+
 //-- public interface -----
 bool run_math_alignment_unit_tests()
 {
 	UNIT_TEST_MODULE_BEGIN("math_alignment")
 		UNIT_TEST_MODULE_CALL_TEST(math_alignment_test_best_fit_exponential);
+		UNIT_TEST_MODULE_CALL_TEST(math_alignment_test_min_volume_ellipsoid);
 	UNIT_TEST_MODULE_END()
 }
 
 //-- private functions -----
+// Khachiyan's algorithm written out with the dense NxN matrices,
+// the way eigen_alignment_fit_min_volume_ellipsoid used to compute it
+static void
+dense_fit_min_volume_ellipsoid(
+	const Eigen::Vector3f *points,
+	const int point_count,
+	const float tolerance,
+	Eigen::Vector3f &out_center,
+	Eigen::Vector3f &out_extents)
+{
+	const double d = 3.0;
+
+	Eigen::MatrixXd P(3, point_count);
+	Eigen::MatrixXd Q(4, point_count);
+	for (int point_index = 0; point_index < point_count; ++point_index)
+	{
+		P.col(point_index) = points[point_index].cast<double>();
+		Q.col(point_index) = points[point_index].cast<double>().homogeneous();
+	}
+
+	Eigen::VectorXd u = Eigen::VectorXd::Constant(point_count, 1.0 / static_cast<double>(point_count));
+	double error = k_real_max;
+	for (int iteration_count = 0; error > tolerance && iteration_count < 100; ++iteration_count)
+	{
+		const Eigen::Matrix4d X = Q*u.asDiagonal()*Q.transpose();
+		const Eigen::VectorXd M = (Q.transpose()*X.inverse()*Q).diagonal();
+
+		int max_element_index;
+		const double max_element = M.maxCoeff(&max_element_index);
+		const double step_size = (max_element - d - 1.0) / ((d + 1.0)*(max_element - 1.0));
+
+		Eigen::VectorXd new_u = (1.0 - step_size)*u;
+		new_u[max_element_index] += step_size;
+		error = (new_u - u).norm();
+		u = new_u;
+	}
+
+	const Eigen::Matrix3d PuP_trans = P*u.asDiagonal()*P.transpose();
+	const Eigen::Matrix3d PuPu_trans = (P*u)*(P*u).transpose();
+	const Eigen::Matrix3d A = (1.0 / d) * (PuP_trans - PuPu_trans).inverse();
+	const Eigen::JacobiSVD<Eigen::Matrix3d> svd(A);
+	const Eigen::Vector3d D = svd.singularValues();
+
+	out_center = (P*u).cast<float>();
+	out_extents = Eigen::Vector3f(
+		static_cast<float>(1.0 / sqrt(D(0))),
+		static_cast<float>(1.0 / sqrt(D(1))),
+		static_cast<float>(1.0 / sqrt(D(2))));
+}
+
 bool
 math_alignment_test_best_fit_exponential()
 {
@@ -46,4 +99,52 @@ math_alignment_test_best_fit_exponential()
 	assert(success);	
 	
 	UNIT_TEST_COMPLETE()
-}
\ No newline at end of file
+}
+
+bool
+math_alignment_test_min_volume_ellipsoid()
+{
+	UNIT_TEST_BEGIN("min_volume_ellipsoid")
+
+	const Eigen::Vector3f center(10.f, -5.f, 3.f);
+	const Eigen::Vector3f extents(3.f, 2.f, 1.f);
+	const Eigen::Matrix3f basis(
+		Eigen::AngleAxisf(0.5f, Eigen::Vector3f(1.f, 2.f, 3.f).normalized()).toRotationMatrix());
+
+	// Points spread over the surface of the ellipsoid along a spherical fibonacci spiral,
+	// with every other point pulled halfway towards the center
+	const int k_point_count = 500;
+	Eigen::Vector3f points[k_point_count];
+	for (int point_index = 0; point_index < k_point_count; ++point_index)
+	{
+		const float z = 1.f - 2.f*(static_cast<float>(point_index) + 0.5f) / static_cast<float>(k_point_count);
+		const float r = sqrtf(1.f - z*z);
+		const float theta = 2.39996323f*static_cast<float>(point_index);
+		const float scale = (point_index % 2 == 0) ? 1.f : 0.5f;
+		const Eigen::Vector3f unit_point(r*cosf(theta), r*sinf(theta), z);
+
+		points[point_index] = center + basis*(unit_point.cwiseProduct(extents)*scale);
+	}
+
+	const float tolerance = 0.0001f;
+	EigenFitEllipsoid ellipsoid;
+	eigen_alignment_fit_min_volume_ellipsoid(points, k_point_count, tolerance, ellipsoid);
+
+	Eigen::Vector3f dense_center, dense_extents;
+	dense_fit_min_volume_ellipsoid(points, k_point_count, tolerance, dense_center, dense_extents);
+
+	// Same fit as the dense version of the algorithm
+	success = ellipsoid.center.isApprox(dense_center, 0.001f);
+	assert(success);
+	success = ellipsoid.extents.isApprox(dense_extents, 0.001f);
+	assert(success);
+
+	// Close to the ellipsoid the points were sampled from, smallest extent first.
+	// The fit stops at the iteration cap before reaching the tolerance, so it's a little short.
+	success = (ellipsoid.center - center).norm() < 0.1f;
+	assert(success);
+	success = (ellipsoid.extents - Eigen::Vector3f(extents.z(), extents.y(), extents.x())).norm() < 0.1f;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
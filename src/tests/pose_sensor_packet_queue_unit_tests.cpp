@@ -0,0 +1,263 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+#include "PoseSensorPacketQueue.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const float k_gyro_epsilon = 0.0001f;
+static const float k_lag_epsilon_ms = 0.001f;
+
+//-- prototypes -----
+static PoseSensorPacket make_imu_packet(int sequence);
+static int get_packet_sequence(const PoseSensorPacket &packet);
+
+//-- public interface -----
+bool run_pose_sensor_packet_queue_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("pose_sensor_packet_queue")
+		UNIT_TEST_MODULE_CALL_TEST(pose_sensor_packet_queue_test_fifo);
+		UNIT_TEST_MODULE_CALL_TEST(pose_sensor_packet_queue_test_drop_oldest);
+		UNIT_TEST_MODULE_CALL_TEST(pose_sensor_packet_queue_test_merge_oldest);
+		UNIT_TEST_MODULE_CALL_TEST(pose_sensor_packet_queue_test_lag);
+		UNIT_TEST_MODULE_CALL_TEST(pose_sensor_packet_queue_test_policy_names);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+bool
+pose_sensor_packet_queue_test_fifo()
+{
+	UNIT_TEST_BEGIN("fifo")
+
+	PoseSensorPacketQueue queue;
+	queue.allocate(5, PoseSensorQueueOverflow_DropOldest);
+
+	// Rounded up to a power of two
+	success = queue.getCapacity() == 8;
+	assert(success);
+
+	for (int sequence = 0; success && sequence < 8; ++sequence)
+	{
+		queue.enqueue(make_imu_packet(sequence));
+	}
+
+	std::vector<PoseSensorPacket> packets;
+	PoseSensorPacketQueueStats stats;
+
+	success = success && queue.drain(std::chrono::high_resolution_clock::now(), packets) == 8;
+	assert(success);
+
+	for (int sequence = 0; success && sequence < 8; ++sequence)
+	{
+		success = get_packet_sequence(packets[sequence]) == sequence;
+		assert(success);
+	}
+
+	if (success)
+	{
+		queue.getStats(stats);
+
+		success =
+			stats.capacity == 8 && stats.depth == 0 && stats.high_water_mark == 8 &&
+			stats.overflow_count == 0 && stats.dropped_count == 0 && stats.merged_count == 0;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+pose_sensor_packet_queue_test_drop_oldest()
+{
+	UNIT_TEST_BEGIN("drop oldest")
+
+	PoseSensorPacketQueue queue;
+	queue.allocate(4, PoseSensorQueueOverflow_DropOldest);
+
+	for (int sequence = 0; sequence < 7; ++sequence)
+	{
+		queue.enqueue(make_imu_packet(sequence));
+	}
+
+	std::vector<PoseSensorPacket> packets;
+	PoseSensorPacketQueueStats stats;
+
+	// Only the newest four survive
+	success = queue.drain(std::chrono::high_resolution_clock::now(), packets) == 4;
+	assert(success);
+
+	for (int packet_index = 0; success && packet_index < 4; ++packet_index)
+	{
+		success = get_packet_sequence(packets[packet_index]) == packet_index + 3;
+		assert(success);
+	}
+
+	if (success)
+	{
+		queue.getStats(stats);
+
+		success =
+			stats.depth == 0 && stats.high_water_mark == 4 &&
+			stats.overflow_count == 3 && stats.dropped_count == 3 && stats.merged_count == 0;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+pose_sensor_packet_queue_test_merge_oldest()
+{
+	UNIT_TEST_BEGIN("merge oldest")
+
+	PoseSensorPacketQueue queue;
+	queue.allocate(4, PoseSensorQueueOverflow_MergeOldest);
+
+	for (int sequence = 0; sequence < 6; ++sequence)
+	{
+		queue.enqueue(make_imu_packet(sequence));
+	}
+
+	std::vector<PoseSensorPacket> packets;
+	PoseSensorPacketQueueStats stats;
+
+	// 0 and 1 merged when 4 arrived, then 2 and 3 when 5 arrived.
+	// Merged packets go to the back of the queue, the main thread sorts by time anyway.
+	success = queue.drain(std::chrono::high_resolution_clock::now(), packets) == 4;
+	assert(success);
+
+	if (success)
+	{
+		std::sort(
+			packets.begin(), packets.end(),
+			[](const PoseSensorPacket &a, const PoseSensorPacket &b) { return a.timestamp < b.timestamp; });
+
+		const int expected_sequences[4] = { 1, 3, 4, 5 };
+		// A merged gyro rate is the mean of the merged samples,
+		// so it integrates to the same rotation over their time span
+		const float expected_gyro_x[4] = { 0.5f, 2.5f, 4.f, 5.f };
+
+		for (int packet_index = 0; success && packet_index < 4; ++packet_index)
+		{
+			const PoseSensorPacket &packet = packets[packet_index];
+
+			success =
+				get_packet_sequence(packet) == expected_sequences[packet_index] &&
+				fabsf(packet.imu_gyroscope_rad_per_sec.x() - expected_gyro_x[packet_index]) <= k_gyro_epsilon &&
+				packet.has_gyroscope_measurement && packet.has_accelerometer_measurement;
+			assert(success);
+		}
+	}
+
+	if (success)
+	{
+		queue.getStats(stats);
+
+		success =
+			stats.overflow_count == 2 && stats.dropped_count == 0 && stats.merged_count == 2 &&
+			stats.overflow_policy == PoseSensorQueueOverflow_MergeOldest;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+pose_sensor_packet_queue_test_lag()
+{
+	UNIT_TEST_BEGIN("lag")
+
+	PoseSensorPacketQueue queue;
+	queue.allocate(4, PoseSensorQueueOverflow_MergeOldest);
+
+	// 0 and 1 merged when 4 arrived, leaving 2, 3, 1, 4 in the queue
+	for (int sequence = 0; sequence < 5; ++sequence)
+	{
+		queue.enqueue(make_imu_packet(sequence));
+	}
+
+	std::vector<PoseSensorPacket> packets;
+	PoseSensorPacketQueueStats stats;
+	const std::chrono::time_point<std::chrono::high_resolution_clock> now(std::chrono::milliseconds(10));
+
+	success = queue.drain(now, packets) == 4 && get_packet_sequence(packets[0]) == 2;
+	assert(success);
+
+	if (success)
+	{
+		// Measured from the merged packet rather than the first one drained
+		queue.getStats(stats);
+
+		success =
+			fabsf(stats.last_lag_ms - 9.f) <= k_lag_epsilon_ms &&
+			fabsf(stats.max_lag_ms - 9.f) <= k_lag_epsilon_ms;
+		assert(success);
+	}
+
+	if (success)
+	{
+		// An empty drain clears the last lag but keeps the max
+		success = queue.drain(now, packets) == 0;
+		assert(success);
+
+		queue.getStats(stats);
+
+		success = success && stats.last_lag_ms == 0.f && fabsf(stats.max_lag_ms - 9.f) <= k_lag_epsilon_ms;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+pose_sensor_packet_queue_test_policy_names()
+{
+	UNIT_TEST_BEGIN("policy names")
+
+	for (int policy_index = 0; success && policy_index < PoseSensorQueueOverflow_COUNT; ++policy_index)
+	{
+		const ePoseSensorQueueOverflowPolicy policy = static_cast<ePoseSensorQueueOverflowPolicy>(policy_index);
+		const char *name = PoseSensorPacketQueue::getOverflowPolicyName(policy);
+
+		success = PoseSensorPacketQueue::findOverflowPolicyByName(name, PoseSensorQueueOverflow_COUNT) == policy;
+		assert(success);
+	}
+
+	if (success)
+	{
+		success =
+			PoseSensorPacketQueue::findOverflowPolicyByName("bogus", PoseSensorQueueOverflow_MergeOldest)
+			== PoseSensorQueueOverflow_MergeOldest;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+static PoseSensorPacket
+make_imu_packet(int sequence)
+{
+	PoseSensorPacket packet;
+
+	// 1ms apart, with the sequence number in the raw accelerometer reading
+	packet.clear();
+	packet.timestamp = std::chrono::time_point<std::chrono::high_resolution_clock>(std::chrono::milliseconds(sequence));
+	packet.raw_imu_accelerometer.i = sequence;
+	packet.imu_accelerometer_g_units = Eigen::Vector3f(0.f, 1.f, 0.f);
+	packet.has_accelerometer_measurement = true;
+	packet.imu_gyroscope_rad_per_sec = Eigen::Vector3f(static_cast<float>(sequence), 0.f, 0.f);
+	packet.has_gyroscope_measurement = true;
+
+	return packet;
+}
+
+static int
+get_packet_sequence(const PoseSensorPacket &packet)
+{
+	return packet.raw_imu_accelerometer.i;
+}
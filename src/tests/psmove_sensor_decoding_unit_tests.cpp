@@ -0,0 +1,61 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "PSMoveSensorDecoding.h"
+#include "unit_test.h"
+
+//-- public interface -----
+bool run_psmove_sensor_decoding_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("psmove_sensor_decoding")
+		UNIT_TEST_MODULE_CALL_TEST(psmove_sensor_decoding_test_twos_complement);
+		UNIT_TEST_MODULE_CALL_TEST(psmove_sensor_decoding_test_offset_binary);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+bool
+psmove_sensor_decoding_test_twos_complement()
+{
+	UNIT_TEST_BEGIN("twos complement")
+
+	// Little endian, with a leading pad byte so the offset is exercised
+	char data[] = {
+		0x55,
+		0x00, 0x00,
+		(char)0xFF, 0x7F,
+		0x00, (char)0x80,
+		(char)0xFF, (char)0xFF
+	};
+
+	success =
+		decode16bitTwosCompliment(data, 1) == 0 &&
+		decode16bitTwosCompliment(data, 3) == 32767 &&
+		decode16bitTwosCompliment(data, 5) == -32768 &&
+		decode16bitTwosCompliment(data, 7) == -1;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+psmove_sensor_decoding_test_offset_binary()
+{
+	UNIT_TEST_BEGIN("offset binary")
+
+	char data[] = {
+		0x00, 0x00,
+		0x00, (char)0x80,
+		(char)0xFF, (char)0xFF
+	};
+
+	success =
+		decode16bitUnsignedToSigned(data, 0) == -32768 &&
+		decode16bitUnsignedToSigned(data, 2) == 0 &&
+		decode16bitUnsignedToSigned(data, 4) == 32767;
+	assert(success);
+
+	UNIT_TEST_COMPLETE()
+}
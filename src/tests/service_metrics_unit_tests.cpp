@@ -0,0 +1,192 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+
+#include "ServiceMetrics.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const float k_ms_epsilon = 0.0001f;
+
+//-- prototypes -----
+static bool wait_for_next_window();
+
+//-- public interface -----
+bool run_service_metrics_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("service_metrics")
+		UNIT_TEST_MODULE_CALL_TEST(service_metrics_test_totals);
+		UNIT_TEST_MODULE_CALL_TEST(service_metrics_test_percentiles);
+		UNIT_TEST_MODULE_CALL_TEST(service_metrics_test_windows);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+bool
+service_metrics_test_totals()
+{
+	UNIT_TEST_BEGIN("totals")
+
+	MetricCounter counter;
+	MetricTimer timer;
+	MetricCounterStats counter_stats;
+	MetricTimerStats timer_stats;
+
+	counter.add();
+	counter.add(4);
+	timer.addSample(2000);
+	timer.addSample(7000);
+
+	counter.getStats(counter_stats);
+	timer.getStats(timer_stats);
+
+	success =
+		counter_stats.total == 5 &&
+		timer_stats.total_count == 2 && timer_stats.total_ns == 9000 && timer_stats.max_ns == 7000;
+	assert(success);
+
+	if (success)
+	{
+		counter.reset();
+		timer.reset();
+
+		counter.getStats(counter_stats);
+		timer.getStats(timer_stats);
+
+		success =
+			counter_stats.total == 0 && counter_stats.window_count == 0 &&
+			timer_stats.total_count == 0 && timer_stats.max_ns == 0 && timer_stats.window_count == 0;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+service_metrics_test_percentiles()
+{
+	UNIT_TEST_BEGIN("percentiles")
+
+	MetricTimerStats stats;
+	stats.clear();
+
+	// 90 samples under 1us, 9 around 3us and a single 100us one
+	stats.window_count = 100;
+	stats.window_total_ns = 90 * 500 + 9 * 3000 + 100000;
+	stats.window_max_ns = 100000;
+	stats.window_bucket_counts[0] = 90;
+	stats.window_bucket_counts[2] = 9;
+	stats.window_bucket_counts[7] = 1;
+
+	success =
+		fabsf(stats.getWindowMeanMs() - 0.00172f) <= k_ms_epsilon &&
+		fabsf(stats.getWindowPercentileMs(0.5f) - 0.001f) <= k_ms_epsilon &&
+		fabsf(stats.getWindowPercentileMs(0.99f) - 0.004f) <= k_ms_epsilon &&
+		// Capped at the slowest sample rather than the 128us bucket bound
+		fabsf(stats.getWindowPercentileMs(1.f) - 0.1f) <= k_ms_epsilon;
+	assert(success);
+
+	if (success)
+	{
+		MetricTimerStats empty_stats;
+		empty_stats.clear();
+
+		success = empty_stats.getWindowMeanMs() == 0.f && empty_stats.getWindowPercentileMs(0.5f) == 0.f;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+service_metrics_test_windows()
+{
+	UNIT_TEST_BEGIN("windows")
+
+	MetricCounter counter;
+	MetricTimer timer;
+	MetricCounterStats counter_stats;
+	MetricTimerStats timer_stats;
+
+	// Start counting at the beginning of a window
+	success = wait_for_next_window();
+	assert(success);
+
+	if (success)
+	{
+		counter.add(3);
+		timer.addSample(500);
+		timer.addSample(1500);
+
+		// Nothing is reported until the window completes
+		counter.getStats(counter_stats);
+		timer.getStats(timer_stats);
+
+		success = counter_stats.window_count == 0 && timer_stats.window_count == 0;
+		assert(success);
+	}
+
+	if (success)
+	{
+		success = wait_for_next_window();
+		assert(success);
+	}
+
+	if (success)
+	{
+		counter.getStats(counter_stats);
+		timer.getStats(timer_stats);
+
+		success =
+			counter_stats.total == 3 && counter_stats.window_count == 3 &&
+			fabsf(counter_stats.getWindowRatePerSecond() - 3.f / ServiceMetrics::getWindowSeconds()) <= k_ms_epsilon &&
+			timer_stats.window_count == 2 && timer_stats.window_total_ns == 2000 && timer_stats.window_max_ns == 1500 &&
+			timer_stats.window_bucket_counts[0] == 1 && timer_stats.window_bucket_counts[1] == 1;
+		assert(success);
+	}
+
+	if (success)
+	{
+		// A window without samples reports nothing, the totals stay
+		success = wait_for_next_window();
+		assert(success);
+
+		if (success)
+		{
+			counter.getStats(counter_stats);
+			timer.getStats(timer_stats);
+
+			success =
+				counter_stats.total == 3 && counter_stats.window_count == 0 &&
+				timer_stats.total_count == 2 && timer_stats.window_count == 0;
+			assert(success);
+		}
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+static bool
+wait_for_next_window()
+{
+	ServiceMetrics::update();
+
+	const uint32_t start_window_index = ServiceMetrics::getWindowIndex();
+
+	for (int wait_count = 0; wait_count < 3 * k_metric_window_ms; ++wait_count)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		ServiceMetrics::update();
+
+		if (ServiceMetrics::getWindowIndex() != start_window_index)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
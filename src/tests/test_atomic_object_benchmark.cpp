@@ -0,0 +1,213 @@
+//-- includes -----
+#include "AtomicPrimitives.h"
+#include "allocation_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+
+//-- constants -----
+#define DEFAULT_RUN_TIME_MS 1000
+
+// About the size of PSMoveControllerInputState
+static const int k_payload_value_count = 48;
+
+//-- definitions -----
+// Every value is derived from the sequence number, so a read that mixes two stores shows up
+struct BenchmarkPayload
+{
+	int sequence;
+	int values[k_payload_value_count];
+};
+
+enum eReadMode
+{
+	ReadMode_Copy,
+	ReadMode_View,
+	ReadMode_ViewSkipUnchanged
+};
+
+struct BenchmarkResult
+{
+	size_t store_count;
+	size_t read_count;
+	size_t new_read_count;
+	size_t torn_read_count;
+	size_t allocation_count;
+	double run_ns;
+};
+
+//-- prototypes -----
+static void fill_payload(BenchmarkPayload &payload, const int sequence);
+static bool is_payload_consistent(const BenchmarkPayload &payload);
+static BenchmarkResult run_benchmark(const eReadMode read_mode, const int run_time_ms);
+static void print_result(const char *name, const BenchmarkResult &result);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	const int run_time_ms = (argc >= 2) ? std::max(atoi(argv[1]), 1) : DEFAULT_RUN_TIME_MS;
+
+	printf("AtomicObject contention benchmark (%d ms per run, %d byte payload)\n",
+		run_time_ms, static_cast<int>(sizeof(BenchmarkPayload)));
+	printf("  The writer stores back to back while the reader reads back to back\n");
+
+	print_result("fetchValue copies", run_benchmark(ReadMode_Copy, run_time_ms));
+	print_result("read views", run_benchmark(ReadMode_View, run_time_ms));
+	print_result("read views, skipping unchanged", run_benchmark(ReadMode_ViewSkipUnchanged, run_time_ms));
+
+	return 0;
+}
+
+//-- private functions -----
+static void fill_payload(BenchmarkPayload &payload, const int sequence)
+{
+	payload.sequence = sequence;
+
+	for (int value_index = 0; value_index < k_payload_value_count; ++value_index)
+	{
+		payload.values[value_index] = sequence * 31 + value_index;
+	}
+}
+
+static bool is_payload_consistent(const BenchmarkPayload &payload)
+{
+	for (int value_index = 0; value_index < k_payload_value_count; ++value_index)
+	{
+		if (payload.values[value_index] != payload.sequence * 31 + value_index)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static BenchmarkResult run_benchmark(const eReadMode read_mode, const int run_time_ms)
+{
+	AtomicObject<BenchmarkPayload> *atomic_payload = new AtomicObject<BenchmarkPayload>;
+	std::atomic<bool> stop_signaled(false);
+	size_t store_count = 0;
+
+	{
+		BenchmarkPayload initial_payload;
+		fill_payload(initial_payload, 0);
+		atomic_payload->storeValue(initial_payload);
+	}
+
+	BenchmarkResult result;
+	result.read_count = 0;
+	result.new_read_count = 0;
+	result.torn_read_count = 0;
+
+	const auto time_start = std::chrono::high_resolution_clock::now();
+
+	std::thread writer_thread([&]() {
+		BenchmarkPayload payload;
+		int sequence = 1;
+
+		while (!stop_signaled.load(std::memory_order_relaxed))
+		{
+			fill_payload(payload, sequence);
+			atomic_payload->storeValue(payload);
+
+			++sequence;
+			++store_count;
+		}
+	});
+
+	// Counted after starting the writer thread, which allocates its own state
+	const size_t allocations_start = get_operator_new_count();
+
+	const auto time_end_target = time_start + std::chrono::milliseconds(run_time_ms);
+	unsigned int last_generation = 0;
+	int last_sequence = 0;
+	BenchmarkPayload copied_payload;
+
+	while (std::chrono::high_resolution_clock::now() < time_end_target)
+	{
+		// Check the clock every so often, not on every read
+		for (int read_index = 0; read_index < 256; ++read_index)
+		{
+			switch (read_mode)
+			{
+			case ReadMode_Copy:
+				{
+					atomic_payload->fetchValue(copied_payload);
+
+					if (copied_payload.sequence != last_sequence)
+					{
+						last_sequence = copied_payload.sequence;
+						++result.new_read_count;
+					}
+
+					if (!is_payload_consistent(copied_payload))
+					{
+						++result.torn_read_count;
+					}
+				} break;
+			case ReadMode_View:
+				{
+					AtomicObject<BenchmarkPayload>::ReadView view(*atomic_payload);
+
+					if (view.getGeneration() != last_generation)
+					{
+						last_generation = view.getGeneration();
+						++result.new_read_count;
+					}
+
+					if (!is_payload_consistent(*view))
+					{
+						++result.torn_read_count;
+					}
+				} break;
+			case ReadMode_ViewSkipUnchanged:
+				{
+					AtomicObject<BenchmarkPayload>::ReadView view(*atomic_payload);
+
+					if (view.getGeneration() != last_generation)
+					{
+						last_generation = view.getGeneration();
+						++result.new_read_count;
+
+						if (!is_payload_consistent(*view))
+						{
+							++result.torn_read_count;
+						}
+					}
+				} break;
+			}
+
+			++result.read_count;
+		}
+	}
+
+	result.allocation_count = get_operator_new_count() - allocations_start;
+
+	stop_signaled = true;
+	writer_thread.join();
+
+	const auto time_end = std::chrono::high_resolution_clock::now();
+
+	result.store_count = store_count;
+	result.run_ns =
+		static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_start).count());
+
+	delete atomic_payload;
+
+	return result;
+}
+
+static void print_result(const char *name, const BenchmarkResult &result)
+{
+	printf("  %-32s %8.1f ns/store %8.1f ns/read %6.1f%% new reads %zu torn reads %zu allocations\n",
+		name,
+		result.run_ns / static_cast<double>(std::max<size_t>(result.store_count, 1)),
+		result.run_ns / static_cast<double>(std::max<size_t>(result.read_count, 1)),
+		100.0 * static_cast<double>(result.new_read_count) / static_cast<double>(std::max<size_t>(result.read_count, 1)),
+		result.torn_read_count,
+		result.allocation_count);
+}
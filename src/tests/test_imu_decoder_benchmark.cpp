@@ -0,0 +1,315 @@
+// Keeps the evidence for parsing IMU reports one channel at a time.
+// The batched structure of arrays decode below was tried in the HID parsers and dropped,
+// since it came out slower than the scalar loops it replaced.
+
+//-- includes -----
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+//-- constants -----
+#define DEFAULT_ITERATION_COUNT 1000000
+
+// Cycle through a handful of distinct reports so the decode can't be hoisted out of the loop
+static const int k_report_pool_size = 64;
+// Same as PSMOVE_BUFFER_SIZE
+static const int k_report_size = 49;
+// Where the accel and gyro samples start in a PSMove ZCM1 report
+static const int k_accel_offset = 13;
+static const int k_gyro_offset = 25;
+// The two frames of a ZCM1 report are 6 bytes apart
+static const int k_frame_stride = 6;
+
+// Accelerometer x/y/z followed by gyroscope x/y/z
+static const int k_imu_channel_count = 6;
+// Padded out to two 4-wide SIMD packets per sample
+static const int k_imu_padded_channel_count = 8;
+static const int k_imu_batch_max_samples = 2;
+
+//-- definitions -----
+enum eIMUChannel
+{
+	IMUChannel_AccelX,
+	IMUChannel_AccelY,
+	IMUChannel_AccelZ,
+	IMUChannel_GyroX,
+	IMUChannel_GyroY,
+	IMUChannel_GyroZ
+};
+
+// Where each channel of each sample sits in the report.
+// The PSMove, DS4 and Morpheus encodings are resolved into masks and shifts up front, so the decode doesn't branch on them.
+struct IMUReportLayout
+{
+	int sample_count;
+	int byte_offsets[k_imu_batch_max_samples][k_imu_channel_count];
+	int xor_masks[k_imu_batch_max_samples][k_imu_channel_count];
+	int shifts[k_imu_batch_max_samples][k_imu_channel_count];
+	int negate_masks[k_imu_batch_max_samples][k_imu_channel_count];
+};
+
+// calibrated= (raw - drift)*scale + offset
+struct IMUChannelCalibration
+{
+	float drift[k_imu_padded_channel_count];
+	float scale[k_imu_padded_channel_count];
+	float offset[k_imu_padded_channel_count];
+};
+
+// One padded array of channels per sample (the padding channels are always 0)
+struct IMUSampleBatch
+{
+	int sample_count;
+	int raw[k_imu_batch_max_samples][k_imu_padded_channel_count];
+	float raw_float[k_imu_batch_max_samples][k_imu_padded_channel_count];
+	float calibrated[k_imu_batch_max_samples][k_imu_padded_channel_count];
+};
+
+typedef Eigen::Array<float, k_imu_padded_channel_count, 1> t_imu_float_channels;
+
+struct ScalarCalibration
+{
+	float kbd[2][3][3]; // [accel, gyro][x, y, z][scale, offset, drift]
+};
+
+struct ScalarSamples
+{
+	int raw[2][2][3]; // [accel, gyro][frame][x, y, z]
+	float calibrated[2][2][3];
+};
+
+//-- prototypes -----
+static void build_reports(unsigned char reports[k_report_pool_size][k_report_size]);
+static void build_calibration(ScalarCalibration &scalar_calibration, IMUChannelCalibration &batch_calibration);
+static IMUReportLayout build_layout();
+static void decode_scalar(const ScalarCalibration &calibration, const unsigned char *report, ScalarSamples &out_samples);
+static void imu_decode_report(const IMUReportLayout &layout, const unsigned char *report, IMUSampleBatch &out_batch);
+static void imu_calibrate_batch(const IMUChannelCalibration &calibration, IMUSampleBatch &batch);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	const int iteration_count = (argc >= 2) ? std::max(atoi(argv[1]), 1) : DEFAULT_ITERATION_COUNT;
+
+	static unsigned char reports[k_report_pool_size][k_report_size];
+	ScalarCalibration scalar_calibration;
+	IMUChannelCalibration batch_calibration;
+	const IMUReportLayout layout = build_layout();
+
+	build_reports(reports);
+	build_calibration(scalar_calibration, batch_calibration);
+
+	// Both paths have to agree before their timings mean anything
+	int mismatch_count = 0;
+	for (int report_index = 0; report_index < k_report_pool_size; ++report_index)
+	{
+		ScalarSamples scalar_samples;
+		IMUSampleBatch batch;
+
+		decode_scalar(scalar_calibration, reports[report_index], scalar_samples);
+		imu_decode_report(layout, reports[report_index], batch);
+		imu_calibrate_batch(batch_calibration, batch);
+
+		for (int s_ix = 0; s_ix < 2; ++s_ix)
+		{
+			for (int f_ix = 0; f_ix < 2; ++f_ix)
+			{
+				for (int d_ix = 0; d_ix < 3; ++d_ix)
+				{
+					const int channel = 3 * s_ix + d_ix;
+
+					if (scalar_samples.raw[s_ix][f_ix][d_ix] != batch.raw[f_ix][channel] ||
+						fabsf(scalar_samples.calibrated[s_ix][f_ix][d_ix] - batch.calibrated[f_ix][channel]) > 0.0001f)
+					{
+						++mismatch_count;
+					}
+				}
+			}
+		}
+	}
+
+	printf("IMU report decoder benchmark (%d reports per run)\n", iteration_count);
+	printf("  %d mismatched channels between the scalar and batched decoders\n", mismatch_count);
+
+	// Scalar decode, one channel at a time (how the HID parsers used to do it)
+	{
+		float checksum = 0.f;
+		const auto time_start = std::chrono::high_resolution_clock::now();
+
+		for (int iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			ScalarSamples samples;
+
+			decode_scalar(scalar_calibration, reports[iteration % k_report_pool_size], samples);
+			checksum += samples.calibrated[0][1][0] + samples.calibrated[1][1][2];
+		}
+
+		const auto time_end = std::chrono::high_resolution_clock::now();
+		const double run_ns =
+			static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_start).count());
+
+		printf("  %-24s %8.1f ns/report (checksum %f)\n", "scalar", run_ns / iteration_count, checksum);
+	}
+
+	// Batched decode, then one vectorized calibration pass over both frames
+	{
+		float checksum = 0.f;
+		const auto time_start = std::chrono::high_resolution_clock::now();
+
+		for (int iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			IMUSampleBatch batch;
+
+			imu_decode_report(layout, reports[iteration % k_report_pool_size], batch);
+			imu_calibrate_batch(batch_calibration, batch);
+			checksum += batch.calibrated[1][IMUChannel_AccelX] + batch.calibrated[1][IMUChannel_GyroZ];
+		}
+
+		const auto time_end = std::chrono::high_resolution_clock::now();
+		const double run_ns =
+			static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_start).count());
+
+		printf("  %-24s %8.1f ns/report (checksum %f)\n", "batched", run_ns / iteration_count, checksum);
+	}
+
+	return mismatch_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//-- private functions -----
+static void build_reports(unsigned char reports[k_report_pool_size][k_report_size])
+{
+	srand(1234);
+
+	for (int report_index = 0; report_index < k_report_pool_size; ++report_index)
+	{
+		for (int byte_index = 0; byte_index < k_report_size; ++byte_index)
+		{
+			reports[report_index][byte_index] = static_cast<unsigned char>(rand() & 0xFF);
+		}
+	}
+}
+
+static void build_calibration(ScalarCalibration &scalar_calibration, IMUChannelCalibration &batch_calibration)
+{
+	for (int channel = 0; channel < k_imu_padded_channel_count; ++channel)
+	{
+		batch_calibration.drift[channel] = 0.f;
+		batch_calibration.scale[channel] = 0.f;
+		batch_calibration.offset[channel] = 0.f;
+	}
+
+	for (int s_ix = 0; s_ix < 2; ++s_ix)
+	{
+		for (int d_ix = 0; d_ix < 3; ++d_ix)
+		{
+			float *kbd = scalar_calibration.kbd[s_ix][d_ix];
+
+			kbd[0] = 1.f / (4096.f + 100.f * d_ix + 1000.f * s_ix);
+			kbd[1] = 0.01f * d_ix;
+			kbd[2] = 3.f * d_ix - 7.f * s_ix;
+
+			const int channel = 3 * s_ix + d_ix;
+			batch_calibration.drift[channel] = kbd[2];
+			batch_calibration.scale[channel] = kbd[0];
+			batch_calibration.offset[channel] = kbd[1];
+		}
+	}
+}
+
+static IMUReportLayout build_layout()
+{
+	IMUReportLayout layout;
+
+	layout.sample_count = 2;
+	for (int f_ix = 0; f_ix < 2; ++f_ix)
+	{
+		for (int d_ix = 0; d_ix < 3; ++d_ix)
+		{
+			layout.byte_offsets[f_ix][IMUChannel_AccelX + d_ix] = k_accel_offset + k_frame_stride * f_ix + 2 * d_ix;
+			layout.byte_offsets[f_ix][IMUChannel_GyroX + d_ix] = k_gyro_offset + k_frame_stride * f_ix + 2 * d_ix;
+			layout.xor_masks[f_ix][IMUChannel_AccelX + d_ix] = 0x8000;
+			layout.xor_masks[f_ix][IMUChannel_GyroX + d_ix] = 0x8000;
+			layout.shifts[f_ix][IMUChannel_AccelX + d_ix] = 0;
+			layout.shifts[f_ix][IMUChannel_GyroX + d_ix] = 0;
+			layout.negate_masks[f_ix][IMUChannel_AccelX + d_ix] = 0;
+			layout.negate_masks[f_ix][IMUChannel_GyroX + d_ix] = 0;
+		}
+	}
+
+	return layout;
+}
+
+static void decode_scalar(const ScalarCalibration &calibration, const unsigned char *report, ScalarSamples &out_samples)
+{
+	const int sensor_offsets[2] = { k_accel_offset, k_gyro_offset };
+
+	for (int s_ix = 0; s_ix < 2; s_ix++) //accel, gyro
+	{
+		for (int f_ix = 0; f_ix < 2; f_ix++) //older, newer
+		{
+			for (int d_ix = 0; d_ix < 3; d_ix++) //x, y, z
+			{
+				const int total_offset = sensor_offsets[s_ix] + k_frame_stride * f_ix + 2 * d_ix;
+				const int raw_val = (report[total_offset] | (report[total_offset + 1] << 8)) - 0x8000;
+
+				const float k = calibration.kbd[s_ix][d_ix][0];
+				const float b = calibration.kbd[s_ix][d_ix][1];
+				const float d = calibration.kbd[s_ix][d_ix][2];
+
+				out_samples.raw[s_ix][f_ix][d_ix] = raw_val;
+				out_samples.calibrated[s_ix][f_ix][d_ix] = (static_cast<float>(raw_val) - d)*k + b;
+			}
+		}
+	}
+}
+
+static void imu_decode_report(const IMUReportLayout &layout, const unsigned char *report, IMUSampleBatch &out_batch)
+{
+	out_batch.sample_count = layout.sample_count;
+
+	for (int sample_index = 0; sample_index < layout.sample_count; ++sample_index)
+	{
+		int *raw = out_batch.raw[sample_index];
+		float *raw_float = out_batch.raw_float[sample_index];
+
+		for (int channel = 0; channel < k_imu_channel_count; ++channel)
+		{
+			const unsigned char *bytes = report + layout.byte_offsets[sample_index][channel];
+			const int unsigned_value = static_cast<int>(bytes[0]) | (static_cast<int>(bytes[1]) << 8);
+			const int signed_value =
+				static_cast<int>(static_cast<short>(unsigned_value ^ layout.xor_masks[sample_index][channel]))
+				>> layout.shifts[sample_index][channel];
+			const int negate_mask = layout.negate_masks[sample_index][channel];
+			const int value = (signed_value ^ negate_mask) - negate_mask;
+
+			raw[channel] = value;
+			raw_float[channel] = static_cast<float>(value);
+		}
+
+		for (int channel = k_imu_channel_count; channel < k_imu_padded_channel_count; ++channel)
+		{
+			raw[channel] = 0;
+			raw_float[channel] = 0.f;
+		}
+	}
+}
+
+// All the samples of the batch at once (vectorized by Eigen)
+static void imu_calibrate_batch(const IMUChannelCalibration &calibration, IMUSampleBatch &batch)
+{
+	const Eigen::Map<const t_imu_float_channels> drift(calibration.drift);
+	const Eigen::Map<const t_imu_float_channels> scale(calibration.scale);
+	const Eigen::Map<const t_imu_float_channels> offset(calibration.offset);
+
+	for (int sample_index = 0; sample_index < batch.sample_count; ++sample_index)
+	{
+		const Eigen::Map<const t_imu_float_channels> raw(batch.raw_float[sample_index]);
+		Eigen::Map<t_imu_float_channels> calibrated(batch.calibrated[sample_index]);
+
+		calibrated = (raw - drift) * scale + offset;
+	}
+}
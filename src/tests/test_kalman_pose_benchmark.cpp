@@ -0,0 +1,146 @@
+#include "DeviceInterface.h"
+#include "KalmanPoseFilter.h"
+#include "MathAlignment.h"
+#include "controller_input_stream.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+//-- constants -----
+#if defined(KALMAN_POSE_FILTER_USE_GENERIC_SRUKF)
+#define SRUKF_LABEL "generic"
+#else
+#define SRUKF_LABEL "fixed-size"
+#endif
+
+#if defined(KALMAN_POSE_FILTER_USE_FLOAT)
+#define SCALAR_LABEL "float"
+#else
+#define SCALAR_LABEL "double"
+#endif
+
+#define DEFAULT_ITERATION_COUNT 10
+
+//-- definitions -----
+struct PoseBenchmarkResults
+{
+	size_t update_count;
+	double total_update_ns;
+	double max_update_ns;
+	double total_position_error_cm;
+	double total_orientation_error_deg;
+};
+
+//-- prototypes -----
+static void run_pose_filter_pass(
+	ControllerInputStream &stationary_stream,
+	ControllerInputStream &movement_stream,
+	PoseBenchmarkResults &results);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		printf("usage test_kalman_pose_benchmark <stationary_file.csv> <movement_file.csv> [iterations]");
+		return -1;
+	}
+
+	ControllerInputStream stationary_stream(argv[1]);
+	if (stationary_stream.getSampleCount() <= 1)
+	{
+		printf("Stationary file: %s, doesn't contain more than one sample", argv[1]);
+		return -1;
+	}
+
+	ControllerInputStream movement_stream(argv[2]);
+	if (movement_stream.getSampleCount() <= 1)
+	{
+		printf("Movement file: %s, doesn't contain more than one sample", argv[2]);
+		return -1;
+	}
+
+	const int iteration_count = (argc >= 4) ? std::max(atoi(argv[3]), 1) : DEFAULT_ITERATION_COUNT;
+
+	PoseBenchmarkResults results;
+	memset(&results, 0, sizeof(PoseBenchmarkResults));
+
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		run_pose_filter_pass(stationary_stream, movement_stream, results);
+	}
+
+	if (results.update_count == 0)
+	{
+		printf("No filter updates were run");
+		return -1;
+	}
+
+	const double update_count = static_cast<double>(results.update_count);
+
+	printf("Kalman pose filter benchmark (%s SRUKF, %s)\n", SRUKF_LABEL, SCALAR_LABEL);
+	printf("  Samples: %d x %d iterations\n", static_cast<int>(movement_stream.getSampleCount()), iteration_count);
+	printf("  Mean update: %.1f ns\n", results.total_update_ns / update_count);
+	printf("  Max update: %.1f ns\n", results.max_update_ns);
+	printf("  Mean position error: %.3f cm\n", results.total_position_error_cm / update_count);
+	printf("  Mean orientation error: %.3f deg\n", results.total_orientation_error_deg / update_count);
+
+	return 0;
+}
+
+//-- private functions -----
+static void
+run_pose_filter_pass(
+	ControllerInputStream &stationary_stream,
+	ControllerInputStream &movement_stream,
+	PoseBenchmarkResults &results)
+{
+	PoseFilterSpace *pose_filter_space = nullptr;
+	PoseFilterConstants constants;
+	KalmanPoseFilter *pose_filter = nullptr;
+
+	const ControllerSample &initialSample = movement_stream.getSample(0);
+	Eigen::Vector3f initial_pos(initialSample.pos[0], initialSample.pos[1], initialSample.pos[2]);
+	Eigen::Quaternionf initial_ori(initialSample.ori[0], initialSample.ori[1], initialSample.ori[2], initialSample.ori[3]);
+
+	switch (movement_stream.getControllerType())
+	{
+	case CommonDeviceState::PSMove:
+		create_psmove_filter_space_and_constants(stationary_stream, &pose_filter_space, &constants);
+		pose_filter = new KalmanPoseFilterPSMove();
+		break;
+	case CommonDeviceState::PSDualShock4:
+		create_psdualshock4_filter_space_and_constants(stationary_stream, &pose_filter_space, &constants);
+		pose_filter = new KalmanPoseFilterDS4();
+		break;
+	default:
+		return;
+	}
+
+	pose_filter->init(constants, initial_pos, initial_ori);
+
+	replay_controller_input_stream(
+		stationary_stream, movement_stream, pose_filter_space, pose_filter,
+		[&results, pose_filter](
+			const ControllerSample &sample,
+			const Eigen::Vector3f &optical_position_cm,
+			const Eigen::Quaternionf &optical_orientation,
+			const double update_ns)
+	{
+		results.total_update_ns += update_ns;
+		results.max_update_ns = std::max(results.max_update_ns, update_ns);
+
+		// Error against the recorded optical pose
+		const Eigen::Vector3f position_error_cm = pose_filter->getPositionCm() - optical_position_cm;
+		const float orientation_error_rad =
+			eigen_quaternion_unsigned_angle_between(pose_filter->getOrientation(), optical_orientation);
+		results.total_position_error_cm += position_error_cm.norm();
+		results.total_orientation_error_deg += orientation_error_rad * k_radians_to_degreees;
+
+		++results.update_count;
+	});
+
+	delete pose_filter_space;
+	delete pose_filter;
+}
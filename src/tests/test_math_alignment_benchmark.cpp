@@ -0,0 +1,161 @@
+//-- includes -----
+#include "MathAlignment.h"
+#include "MathUtility.h"
+#include "allocation_counter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+//-- constants -----
+#define DEFAULT_ITERATION_COUNT 100000
+
+// Same as SphereEdgeSampler::k_max_edge_points
+static const int k_contour_point_count = 48;
+// Lightbar quad vertices, see triangulateWorldPose
+static const int k_plane_point_count = 4;
+// Largest tracker count the pose averaging sees
+static const int k_quaternion_count = 8;
+
+//-- definitions -----
+struct BenchmarkInputs
+{
+	Eigen::Vector2f contour[k_contour_point_count];
+	Eigen::Vector3f plane_points[k_plane_point_count];
+	Eigen::Quaternionf quaternions[k_quaternion_count];
+	float quaternion_weights[k_quaternion_count];
+};
+
+//-- prototypes -----
+static void build_inputs(BenchmarkInputs &inputs);
+
+template <typename t_fit_function>
+static void run_benchmark(const char *name, const int iteration_count, const bool allocation_free, t_fit_function fit_function);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	const int iteration_count = (argc >= 2) ? std::max(atoi(argv[1]), 1) : DEFAULT_ITERATION_COUNT;
+
+	BenchmarkInputs inputs;
+	build_inputs(inputs);
+
+	// Normalized camera coordinates, so the focal length is one
+	const float sphere_radius = 2.25f;
+	const float focal_length = 1.f;
+
+	printf("psmovemath fitting benchmark (%d iterations)\n", iteration_count);
+	printf("  new/call only counts operator new, Eigen's own heap blocks aren't counted\n");
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+	printf("  EIGEN_RUNTIME_NO_MALLOC: the allocation free fits assert on any Eigen heap use in debug builds\n");
+#endif
+
+	// Reference fit, allocates its Nx3 system every call
+	run_benchmark("fit_focal_cone_to_sphere (QR)", iteration_count, false, [&]() {
+		Eigen::Vector3f sphere_center;
+		eigen_alignment_fit_focal_cone_to_sphere(
+			inputs.contour, k_contour_point_count, sphere_radius, focal_length, &sphere_center);
+		return sphere_center.z();
+	});
+
+	run_benchmark("fast_fit_focal_cone_to_sphere", iteration_count, true, [&]() {
+		Eigen::Vector3f sphere_center;
+		EigenFitEllipse ellipse;
+		eigen_alignment_fast_fit_focal_cone_to_sphere(
+			inputs.contour, k_contour_point_count, sphere_radius, focal_length, &sphere_center, &ellipse);
+		return sphere_center.z();
+	});
+
+	run_benchmark("fit_least_squares_ellipse", iteration_count, true, [&]() {
+		EigenFitEllipse ellipse;
+		eigen_alignment_fit_least_squares_ellipse(inputs.contour, k_contour_point_count, ellipse);
+		return ellipse.extents.x();
+	});
+
+	run_benchmark("fit_least_squares_plane", iteration_count, true, [&]() {
+		Eigen::Vector3f centroid, normal;
+		eigen_alignment_fit_least_squares_plane(inputs.plane_points, k_plane_point_count, &centroid, &normal);
+		return normal.z();
+	});
+
+	run_benchmark("quaternion_normalized_weighted_average", iteration_count, true, [&]() {
+		Eigen::Quaternionf average;
+		eigen_quaternion_compute_normalized_weighted_average(
+			inputs.quaternions, inputs.quaternion_weights, k_quaternion_count, &average);
+		return average.w();
+	});
+
+	return 0;
+}
+
+//-- private functions -----
+static void build_inputs(BenchmarkInputs &inputs)
+{
+	// Contour of a sphere 40cm in front of the camera, off the optical axis,
+	// as the projected ellipse sampled around its edge with a little noise
+	const float center_x = 0.2f;
+	const float center_y = -0.1f;
+	const float radius_x = 0.06f;
+	const float radius_y = 0.055f;
+	for (int point_index = 0; point_index < k_contour_point_count; ++point_index)
+	{
+		const float angle = 2.f*k_real_pi*static_cast<float>(point_index) / static_cast<float>(k_contour_point_count);
+		const float noise = 0.0005f*sinf(7.f*angle);
+
+		inputs.contour[point_index] =
+			Eigen::Vector2f(center_x + (radius_x + noise)*cosf(angle), center_y + (radius_y + noise)*sinf(angle));
+	}
+
+	// Slightly non-planar lightbar quad
+	inputs.plane_points[0] = Eigen::Vector3f(-2.f, 1.f, 30.f);
+	inputs.plane_points[1] = Eigen::Vector3f(2.f, 1.f, 30.1f);
+	inputs.plane_points[2] = Eigen::Vector3f(2.f, -1.f, 29.9f);
+	inputs.plane_points[3] = Eigen::Vector3f(-2.f, -1.f, 30.f);
+
+	// Per tracker orientations scattered around the same pose
+	const Eigen::Vector3f axis = Eigen::Vector3f(1.f, 2.f, 3.f).normalized();
+	for (int index = 0; index < k_quaternion_count; ++index)
+	{
+		const float jitter = 0.01f*static_cast<float>(index - k_quaternion_count / 2);
+
+		inputs.quaternions[index] = Eigen::Quaternionf(Eigen::AngleAxisf(0.7f + jitter, axis));
+		inputs.quaternion_weights[index] = 1.f + 0.1f*static_cast<float>(index);
+	}
+}
+
+template <typename t_fit_function>
+static void run_benchmark(const char *name, const int iteration_count, const bool allocation_free, t_fit_function fit_function)
+{
+	// Keeps the compiler from dropping the fits
+	volatile float sink = 0.f;
+
+	// Warm up
+	sink = sink + fit_function();
+
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+	Eigen::internal::set_is_malloc_allowed(!allocation_free);
+#endif
+	const size_t allocations_start = get_operator_new_count();
+	const auto time_start = std::chrono::high_resolution_clock::now();
+
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		sink = sink + fit_function();
+	}
+
+	const auto time_end = std::chrono::high_resolution_clock::now();
+	const size_t allocations_end = get_operator_new_count();
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+	Eigen::internal::set_is_malloc_allowed(true);
+#endif
+
+	const double total_ns =
+		static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_start).count());
+
+	printf("  %-40s %10.1f ns/call %8.2f new/call\n",
+		name,
+		total_ns / static_cast<double>(iteration_count),
+		static_cast<double>(allocations_end - allocations_start) / static_cast<double>(iteration_count));
+}
@@ -0,0 +1,339 @@
+//-- includes -----
+#include "MathAlignment.h"
+#include "SphereEdgeSampler.h"
+#include "UndistortionGrid.h"
+
+#include "opencv2/imgcodecs/imgcodecs.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+//-- constants -----
+#define FRAME_WIDTH		640
+#define FRAME_HEIGHT	480
+
+// PS3EyeTrackerConfig defaults
+#define FOCAL_LENGTH	554.2563f
+#define PRINCIPAL_X		320.f
+#define PRINCIPAL_Y		240.f
+
+#define SPHERE_RADIUS_CM		2.25f
+#define SUPERSAMPLE_COUNT		4 // Per axis, when rendering the synthetic frames
+#define DEFAULT_ITERATION_COUNT	20000
+
+//-- definitions -----
+struct TestSphere
+{
+	float x_cm, y_cm, z_cm;
+};
+
+// Tracker relative sphere positions, in the same frame as the fit output
+static const TestSphere k_test_spheres[] = {
+	{0.f, 0.f, 30.f},
+	{12.f, -8.f, 30.f},
+	{0.f, 5.f, 80.f},
+	{40.f, -25.f, 80.f},
+	{0.f, 0.f, 150.f},
+	{-80.f, 50.f, 150.f},
+	{0.f, 0.f, 300.f},
+	{150.f, -90.f, 300.f},
+};
+
+struct FitResult
+{
+	Eigen::Vector3f current_center;
+	Eigen::Vector3f sampled_center;
+	double current_ns;
+	double sampled_ns;
+};
+
+//-- prototypes -----
+static void build_opencv_intrinsics(cv::Matx33f &camera_matrix, cv::Matx<float, 5, 1> &distortions);
+static void render_sphere_mask(const UndistortionGrid &grid, const TestSphere &sphere, cv::Mat &out_mask);
+static bool find_biggest_contour(const cv::Mat &mask, std::vector<cv::Point> &out_contour);
+static void fit_current_path(const std::vector<cv::Point> &contour, const UndistortionGrid &grid, Eigen::Vector3f &out_center);
+static void fit_sampled_path(
+	const std::vector<cv::Point> &contour, const cv::Mat &mask, const UndistortionGrid &grid,
+	SphereEdgeSampler &sampler, Eigen::Vector3f &out_center);
+static void compare_fits(
+	const std::vector<cv::Point> &contour, const cv::Mat &mask, const UndistortionGrid &grid,
+	int iteration_count, FitResult &out_result);
+static bool run_synthetic_frames(const UndistortionGrid &grid, int iteration_count);
+static void run_recorded_frame(const UndistortionGrid &grid, const char *filename, int iteration_count);
+
+//-- entry point -----
+// Usage: test_sphere_fit [iteration_count] [recorded_frame.png ...]
+int main(int argc, char *argv[])
+{
+	const int iteration_count = (argc >= 2) ? std::max(atoi(argv[1]), 1) : DEFAULT_ITERATION_COUNT;
+
+	cv::Matx33f camera_matrix;
+	cv::Matx<float, 5, 1> distortions;
+	build_opencv_intrinsics(camera_matrix, distortions);
+
+	UndistortionGrid grid;
+	grid.update(camera_matrix, distortions, FRAME_WIDTH, FRAME_HEIGHT);
+
+	const bool bSuccess = run_synthetic_frames(grid, iteration_count);
+
+	for (int arg_index = 2; arg_index < argc; ++arg_index)
+	{
+		run_recorded_frame(grid, argv[arg_index], iteration_count);
+	}
+
+	return bSuccess ? 0 : -1;
+}
+
+//-- private functions -----
+static void build_opencv_intrinsics(
+	cv::Matx33f &camera_matrix,
+	cv::Matx<float, 5, 1> &distortions)
+{
+	// Same layout as computeOpenCVCameraIntrinsicMatrix in ServerTrackerView (F_PY negated)
+	camera_matrix = cv::Matx33f(
+		FOCAL_LENGTH, 0.f, PRINCIPAL_X,
+		0.f, -FOCAL_LENGTH, PRINCIPAL_Y,
+		0.f, 0.f, 1.f);
+	distortions = cv::Matx<float, 5, 1>(-0.10771770f, 0.12132627f, 0.00091733f, 0.00010589f, 0.04875476f);
+}
+
+// A pixel is inside the sphere's silhouette when more than half of its sub-samples
+// look down a ray that hits the sphere, which is about where an HSV threshold
+// would cut a blurred bulb edge
+static void render_sphere_mask(
+	const UndistortionGrid &grid,
+	const TestSphere &sphere,
+	cv::Mat &out_mask)
+{
+	const int sample_count = SUPERSAMPLE_COUNT*SUPERSAMPLE_COUNT;
+
+	std::vector<cv::Point2f> pixel_samples;
+	pixel_samples.reserve(FRAME_WIDTH*sample_count);
+
+	const double center_sq = sphere.x_cm*sphere.x_cm + sphere.y_cm*sphere.y_cm + sphere.z_cm*sphere.z_cm;
+	const double radius_sq = SPHERE_RADIUS_CM*SPHERE_RADIUS_CM;
+
+	out_mask = cv::Mat::zeros(FRAME_HEIGHT, FRAME_WIDTH, CV_8UC1);
+
+	std::vector<cv::Point2f> rays;
+
+	for (int y = 0; y < FRAME_HEIGHT; ++y)
+	{
+		pixel_samples.clear();
+		for (int x = 0; x < FRAME_WIDTH; ++x)
+		{
+			for (int sample = 0; sample < sample_count; ++sample)
+			{
+				const float offset_x = (static_cast<float>(sample % SUPERSAMPLE_COUNT) + 0.5f) / SUPERSAMPLE_COUNT - 0.5f;
+				const float offset_y = (static_cast<float>(sample / SUPERSAMPLE_COUNT) + 0.5f) / SUPERSAMPLE_COUNT - 0.5f;
+
+				pixel_samples.push_back(cv::Point2f(static_cast<float>(x) + offset_x, static_cast<float>(y) + offset_y));
+			}
+		}
+
+		// Rays in normalized camera coordinates
+		grid.undistortPoints(pixel_samples, rays);
+
+		unsigned char *mask_row = out_mask.ptr<unsigned char>(y);
+		for (int x = 0; x < FRAME_WIDTH; ++x)
+		{
+			int hit_count = 0;
+			for (int sample = 0; sample < sample_count; ++sample)
+			{
+				const cv::Point2f &ray = rays[x*sample_count + sample];
+				const double ray_dot_center = ray.x*sphere.x_cm + ray.y*sphere.y_cm + sphere.z_cm;
+				const double ray_sq = ray.x*ray.x + ray.y*ray.y + 1.0;
+
+				if (ray_dot_center > 0.0 && ray_dot_center*ray_dot_center >= ray_sq*(center_sq - radius_sq))
+				{
+					++hit_count;
+				}
+			}
+
+			mask_row[x] = (2*hit_count > sample_count) ? 255 : 0;
+		}
+	}
+}
+
+static bool find_biggest_contour(const cv::Mat &mask, std::vector<cv::Point> &out_contour)
+{
+	// findContours may modify its input
+	cv::Mat mask_copy = mask.clone();
+	std::vector<std::vector<cv::Point> > contours;
+	cv::findContours(mask_copy, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+	double biggest_area = 0.0;
+	for (const std::vector<cv::Point> &contour : contours)
+	{
+		const double area = cv::contourArea(contour);
+		if (area > biggest_area)
+		{
+			biggest_area = area;
+			out_contour = contour;
+		}
+	}
+
+	return biggest_area > 0.0;
+}
+
+// The sphere fit ServerTrackerView did before SphereEdgeSampler
+static void fit_current_path(
+	const std::vector<cv::Point> &contour,
+	const UndistortionGrid &grid,
+	Eigen::Vector3f &out_center)
+{
+	std::vector<cv::Point> convex_contour;
+	cv::convexHull(contour, convex_contour);
+
+	std::vector<cv::Point2f> convex_contour_f;
+	cv::Mat(convex_contour).convertTo(convex_contour_f, cv::Mat(convex_contour_f).type());
+
+	std::vector<cv::Point2f> undistort_contour;
+	grid.undistortPoints(convex_contour_f, undistort_contour);
+
+	std::vector<Eigen::Vector2f> eigen_contour;
+	std::for_each(undistort_contour.begin(),
+				  undistort_contour.end(),
+				  [&eigen_contour](cv::Point2f& p) {
+					  eigen_contour.push_back(Eigen::Vector2f(p.x, p.y));
+				  });
+
+	EigenFitEllipse ellipse_projection;
+	eigen_alignment_fit_focal_cone_to_sphere(
+		eigen_contour.data(), static_cast<int>(eigen_contour.size()), SPHERE_RADIUS_CM, 1, &out_center, &ellipse_projection);
+}
+
+static void fit_sampled_path(
+	const std::vector<cv::Point> &contour,
+	const cv::Mat &mask,
+	const UndistortionGrid &grid,
+	SphereEdgeSampler &sampler,
+	Eigen::Vector3f &out_center)
+{
+	const int point_count = sampler.sampleContour(contour, mask, grid);
+
+	EigenFitEllipse ellipse_projection;
+	eigen_alignment_fast_fit_focal_cone_to_sphere(
+		sampler.getNormalizedPoints(), point_count, SPHERE_RADIUS_CM, 1, &out_center, &ellipse_projection);
+}
+
+static void compare_fits(
+	const std::vector<cv::Point> &contour,
+	const cv::Mat &mask,
+	const UndistortionGrid &grid,
+	int iteration_count,
+	FitResult &out_result)
+{
+	SphereEdgeSampler sampler;
+	double checksum = 0.0;
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> current_start = std::chrono::high_resolution_clock::now();
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		fit_current_path(contour, grid, out_result.current_center);
+		checksum += out_result.current_center.z();
+	}
+	const std::chrono::duration<double, std::nano> current_time = std::chrono::high_resolution_clock::now() - current_start;
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> sampled_start = std::chrono::high_resolution_clock::now();
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		fit_sampled_path(contour, mask, grid, sampler, out_result.sampled_center);
+		checksum -= out_result.sampled_center.z();
+	}
+	const std::chrono::duration<double, std::nano> sampled_time = std::chrono::high_resolution_clock::now() - sampled_start;
+
+	out_result.current_ns = current_time.count() / static_cast<double>(iteration_count);
+	out_result.sampled_ns = sampled_time.count() / static_cast<double>(iteration_count);
+
+	// Keep the loops from being optimized away
+	if (checksum != checksum)
+	{
+		printf("NaN sphere fit\n");
+	}
+}
+
+static bool run_synthetic_frames(const UndistortionGrid &grid, int iteration_count)
+{
+	double current_error_sum = 0.0, sampled_error_sum = 0.0;
+	double current_ns_sum = 0.0, sampled_ns_sum = 0.0;
+	int frame_count = 0;
+
+	for (const TestSphere &sphere : k_test_spheres)
+	{
+		cv::Mat mask;
+		render_sphere_mask(grid, sphere, mask);
+
+		std::vector<cv::Point> contour;
+		if (!find_biggest_contour(mask, contour))
+		{
+			printf("sphere (%.0f, %.0f, %.0f): not visible\n", sphere.x_cm, sphere.y_cm, sphere.z_cm);
+			return false;
+		}
+
+		FitResult result;
+		compare_fits(contour, mask, grid, iteration_count, result);
+
+		const Eigen::Vector3f expected(sphere.x_cm, sphere.y_cm, sphere.z_cm);
+		const double current_error = (result.current_center - expected).norm();
+		const double sampled_error = (result.sampled_center - expected).norm();
+
+		printf("sphere (%.0f, %.0f, %.0f): current %.3fcm %.0fns, sampled %.3fcm %.0fns\n",
+			sphere.x_cm, sphere.y_cm, sphere.z_cm,
+			current_error, result.current_ns,
+			sampled_error, result.sampled_ns);
+
+		current_error_sum += current_error;
+		sampled_error_sum += sampled_error;
+		current_ns_sum += result.current_ns;
+		sampled_ns_sum += result.sampled_ns;
+		++frame_count;
+	}
+
+	const bool bSuccess = sampled_error_sum <= current_error_sum;
+
+	printf("synthetic frames: %s (mean error current %.3fcm, sampled %.3fcm; mean time current %.0fns, sampled %.0fns)\n",
+		bSuccess ? "PASS" : "FAIL",
+		current_error_sum / frame_count,
+		sampled_error_sum / frame_count,
+		current_ns_sum / frame_count,
+		sampled_ns_sum / frame_count);
+
+	return bSuccess;
+}
+
+// No ground truth for recorded frames, so just report how far apart the two fits land.
+// Assumes a dark room: the bulb is segmented by brightness alone.
+static void run_recorded_frame(const UndistortionGrid &grid, const char *filename, int iteration_count)
+{
+	const cv::Mat frame = cv::imread(filename, cv::IMREAD_GRAYSCALE);
+	if (frame.empty() || frame.cols != FRAME_WIDTH || frame.rows != FRAME_HEIGHT)
+	{
+		printf("%s: not a %dx%d image\n", filename, FRAME_WIDTH, FRAME_HEIGHT);
+		return;
+	}
+
+	cv::Mat mask;
+	cv::threshold(frame, mask, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+	std::vector<cv::Point> contour;
+	if (!find_biggest_contour(mask, contour))
+	{
+		printf("%s: no bulb found\n", filename);
+		return;
+	}
+
+	FitResult result;
+	compare_fits(contour, mask, grid, iteration_count, result);
+
+	printf("%s: current (%.2f, %.2f, %.2f) %.0fns, sampled (%.2f, %.2f, %.2f) %.0fns, difference %.3fcm\n",
+		filename,
+		result.current_center.x(), result.current_center.y(), result.current_center.z(), result.current_ns,
+		result.sampled_center.x(), result.sampled_center.y(), result.sampled_center.z(), result.sampled_ns,
+		(result.sampled_center - result.current_center).norm());
+}
@@ -0,0 +1,191 @@
+//-- includes -----
+#include "UndistortionGrid.h"
+
+#include "opencv2/calib3d/calib3d.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//-- constants -----
+#define FRAME_WIDTH		640
+#define FRAME_HEIGHT	480
+
+// Largest allowed difference from cv::undistortPoints, in pixels.
+// Contour points are whole pixels, so this is well below their quantization error.
+#define MAX_PIXEL_ERROR	0.05f
+
+// Roughly the size of a controller bulb's convex hull
+#define CONTOUR_POINT_COUNT		64
+#define DEFAULT_ITERATION_COUNT	20000
+
+//-- definitions -----
+struct TestIntrinsics
+{
+	const char *name;
+	float focal_x, focal_y;
+	float principal_x, principal_y;
+	float k1, k2, k3;
+	float p1, p2;
+};
+
+// The PS3EyeTrackerConfig defaults and a much stronger lens
+static const TestIntrinsics k_test_intrinsics[] = {
+	{"ps3eye_default", 554.2563f, 554.2563f, 320.f, 240.f, -0.10771770f, 0.12132627f, 0.04875476f, 0.00091733f, 0.00010589f},
+	{"strong_barrel", 520.f, 515.f, 316.f, 244.f, -0.35f, 0.15f, -0.02f, 0.002f, -0.001f},
+};
+
+//-- prototypes -----
+static void build_opencv_intrinsics(
+	const TestIntrinsics &intrinsics, cv::Matx33f &camera_matrix, cv::Matx<float, 5, 1> &distortions);
+static bool test_accuracy(const TestIntrinsics &intrinsics);
+static void run_benchmark(const TestIntrinsics &intrinsics, int iteration_count);
+
+//-- entry point -----
+int main(int argc, char *argv[])
+{
+	const int iteration_count = (argc >= 2) ? std::max(atoi(argv[1]), 1) : DEFAULT_ITERATION_COUNT;
+	bool bSuccess = true;
+
+	for (const TestIntrinsics &intrinsics : k_test_intrinsics)
+	{
+		bSuccess &= test_accuracy(intrinsics);
+		run_benchmark(intrinsics, iteration_count);
+	}
+
+	return bSuccess ? 0 : -1;
+}
+
+//-- private functions -----
+static void build_opencv_intrinsics(
+	const TestIntrinsics &intrinsics,
+	cv::Matx33f &camera_matrix,
+	cv::Matx<float, 5, 1> &distortions)
+{
+	// Same layout as computeOpenCVCameraIntrinsicMatrix in ServerTrackerView (F_PY negated)
+	camera_matrix = cv::Matx33f(
+		intrinsics.focal_x, 0.f, intrinsics.principal_x,
+		0.f, -intrinsics.focal_y, intrinsics.principal_y,
+		0.f, 0.f, 1.f);
+	distortions = cv::Matx<float, 5, 1>(intrinsics.k1, intrinsics.k2, intrinsics.p1, intrinsics.p2, intrinsics.k3);
+}
+
+static bool test_accuracy(const TestIntrinsics &intrinsics)
+{
+	cv::Matx33f camera_matrix;
+	cv::Matx<float, 5, 1> distortions;
+	build_opencv_intrinsics(intrinsics, camera_matrix, distortions);
+
+	UndistortionGrid grid;
+	if (!grid.update(camera_matrix, distortions, FRAME_WIDTH, FRAME_HEIGHT) ||
+		grid.update(camera_matrix, distortions, FRAME_WIDTH, FRAME_HEIGHT))
+	{
+		printf("%s: grid should only rebuild when the intrinsics change\n", intrinsics.name);
+		return false;
+	}
+
+	// Every pixel of the frame, plus sub-pixel offsets
+	std::vector<cv::Point2f> points;
+	points.reserve(FRAME_WIDTH*FRAME_HEIGHT);
+	for (int y = 0; y < FRAME_HEIGHT; ++y)
+	{
+		for (int x = 0; x < FRAME_WIDTH; ++x)
+		{
+			const float offset = static_cast<float>((x + y) % 4) * 0.25f;
+
+			points.push_back(cv::Point2f(static_cast<float>(x) + offset, static_cast<float>(y) + offset));
+		}
+	}
+
+	std::vector<cv::Point2f> expected_pixels, grid_pixels;
+	cv::undistortPoints(points, expected_pixels, camera_matrix, distortions, cv::noArray(), camera_matrix);
+	grid.undistortPointsToPixels(points, grid_pixels);
+
+	std::vector<cv::Point2f> expected_normalized, grid_normalized;
+	cv::undistortPoints(points, expected_normalized, camera_matrix, distortions);
+	grid.undistortPoints(points, grid_normalized);
+
+	double max_pixel_error = 0.0;
+	double total_pixel_error = 0.0;
+	double max_normalized_error_px = 0.0;
+	for (size_t index = 0; index < points.size(); ++index)
+	{
+		const cv::Point2f pixel_delta = grid_pixels[index] - expected_pixels[index];
+		const double pixel_error = sqrt(pixel_delta.dot(pixel_delta));
+
+		max_pixel_error = std::max(max_pixel_error, pixel_error);
+		total_pixel_error += pixel_error;
+
+		// Express the normalized error in pixels so the same tolerance applies
+		const cv::Point2f normalized_delta = grid_normalized[index] - expected_normalized[index];
+		const double normalized_error_px =
+			sqrt(normalized_delta.x*normalized_delta.x*intrinsics.focal_x*intrinsics.focal_x +
+				 normalized_delta.y*normalized_delta.y*intrinsics.focal_y*intrinsics.focal_y);
+
+		max_normalized_error_px = std::max(max_normalized_error_px, normalized_error_px);
+	}
+
+	const bool bSuccess = max_pixel_error <= MAX_PIXEL_ERROR && max_normalized_error_px <= MAX_PIXEL_ERROR;
+
+	printf("%s accuracy: %s (max %fpx, mean %fpx, normalized max %fpx, %d px cells)\n",
+		intrinsics.name,
+		bSuccess ? "PASS" : "FAIL",
+		max_pixel_error,
+		total_pixel_error / static_cast<double>(points.size()),
+		max_normalized_error_px,
+		UndistortionGrid::k_cell_size);
+
+	return bSuccess;
+}
+
+static void run_benchmark(const TestIntrinsics &intrinsics, int iteration_count)
+{
+	cv::Matx33f camera_matrix;
+	cv::Matx<float, 5, 1> distortions;
+	build_opencv_intrinsics(intrinsics, camera_matrix, distortions);
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> build_start = std::chrono::high_resolution_clock::now();
+	UndistortionGrid grid;
+	grid.update(camera_matrix, distortions, FRAME_WIDTH, FRAME_HEIGHT);
+	const std::chrono::duration<double, std::milli> build_time = std::chrono::high_resolution_clock::now() - build_start;
+
+	// A bulb sized circular contour near the corner of the frame where the distortion is strongest
+	std::vector<cv::Point2f> contour;
+	for (int index = 0; index < CONTOUR_POINT_COUNT; ++index)
+	{
+		const float angle = 6.2831853f * static_cast<float>(index) / static_cast<float>(CONTOUR_POINT_COUNT);
+
+		contour.push_back(cv::Point2f(floorf(80.f + 20.f*cosf(angle)), floorf(70.f + 20.f*sinf(angle))));
+	}
+
+	std::vector<cv::Point2f> undistorted;
+	double checksum = 0.0;
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> opencv_start = std::chrono::high_resolution_clock::now();
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		cv::undistortPoints(contour, undistorted, camera_matrix, distortions);
+		checksum += undistorted[iteration % CONTOUR_POINT_COUNT].x;
+	}
+	const std::chrono::duration<double, std::nano> opencv_time = std::chrono::high_resolution_clock::now() - opencv_start;
+
+	const std::chrono::time_point<std::chrono::high_resolution_clock> grid_start = std::chrono::high_resolution_clock::now();
+	for (int iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		grid.undistortPoints(contour, undistorted);
+		checksum += undistorted[iteration % CONTOUR_POINT_COUNT].x;
+	}
+	const std::chrono::duration<double, std::nano> grid_time = std::chrono::high_resolution_clock::now() - grid_start;
+
+	const double point_count = static_cast<double>(iteration_count) * CONTOUR_POINT_COUNT;
+
+	printf("%s benchmark: cv::undistortPoints %.1fns/point, grid %.1fns/point (%.1fx), grid build %.2fms [%g]\n",
+		intrinsics.name,
+		opencv_time.count() / point_count,
+		grid_time.count() / point_count,
+		opencv_time.count() / std::max(grid_time.count(), 1.0),
+		build_time.count(),
+		checksum);
+}
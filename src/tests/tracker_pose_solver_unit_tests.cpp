@@ -0,0 +1,264 @@
+//-- includes -----
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <random>
+
+#include "TrackerPoseSolver.h"
+#include "unit_test.h"
+
+//-- constants -----
+static const int k_tracker_count = 4;
+static const int k_sample_count = 60;
+static const double k_frame_width_px = 640.0;
+static const double k_frame_height_px = 480.0;
+static const double k_focal_length_px = 554.0;
+
+static const double k_max_rms_error_px = 0.05;
+static const double k_max_orientation_error_degrees = 0.1;
+static const double k_max_position_error_cm = 0.2;
+
+static const double k_radians_to_degrees = 180.0 / 3.14159265358979323846;
+
+//-- prototypes -----
+static void make_synthetic_cameras(TrackerPoseCalibrationCamera *out_cameras);
+static void make_synthetic_observations(
+	const TrackerPoseCalibrationCamera *cameras,
+	std::mt19937 &rng,
+	std::vector<Eigen::Vector3d> &out_sample_positions,
+	std::vector<TrackerPoseCalibrationObservation> &out_observations);
+static void perturb_cameras(
+	const TrackerPoseCalibrationCamera *cameras,
+	std::mt19937 &rng,
+	TrackerPoseCalibrationCamera *out_cameras);
+static bool is_pose_recovered(
+	const TrackerPoseCalibrationCamera *true_cameras,
+	const TrackerPoseCalibrationCamera *solved_cameras);
+
+//-- public interface -----
+bool run_tracker_pose_solver_unit_tests()
+{
+	UNIT_TEST_MODULE_BEGIN("tracker_pose_solver")
+		UNIT_TEST_MODULE_CALL_TEST(tracker_pose_solver_test_recover_poses);
+		UNIT_TEST_MODULE_CALL_TEST(tracker_pose_solver_test_cancel);
+	UNIT_TEST_MODULE_END()
+}
+
+//-- private functions -----
+bool
+tracker_pose_solver_test_recover_poses()
+{
+	UNIT_TEST_BEGIN("recover poses")
+
+	std::mt19937 rng(42);
+	TrackerPoseCalibrationCamera true_cameras[k_tracker_pose_calibration_max_trackers];
+	TrackerPoseCalibrationCamera initial_cameras[k_tracker_pose_calibration_max_trackers];
+	TrackerPoseCalibrationCamera solved_cameras[k_tracker_pose_calibration_max_trackers];
+	std::vector<Eigen::Vector3d> sample_positions;
+	std::vector<TrackerPoseCalibrationObservation> observations;
+
+	make_synthetic_cameras(true_cameras);
+	make_synthetic_observations(true_cameras, rng, sample_positions, observations);
+	perturb_cameras(true_cameras, rng, initial_cameras);
+
+	TrackerPoseSolverResult result;
+	const bool bSolved =
+		tracker_pose_solver_solve(
+			sample_positions, observations, initial_cameras, false, nullptr, solved_cameras, result);
+
+	success =
+		bSolved && !result.bCanceled && result.iteration_count > 0 &&
+		result.initial_rms_error_px > 1.f && result.final_rms_error_px <= k_max_rms_error_px;
+	assert(success);
+
+	if (success)
+	{
+		success = is_pose_recovered(true_cameras, solved_cameras);
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+bool
+tracker_pose_solver_test_cancel()
+{
+	UNIT_TEST_BEGIN("cancel")
+
+	std::mt19937 rng(7);
+	TrackerPoseCalibrationCamera true_cameras[k_tracker_pose_calibration_max_trackers];
+	TrackerPoseCalibrationCamera initial_cameras[k_tracker_pose_calibration_max_trackers];
+	TrackerPoseCalibrationCamera solved_cameras[k_tracker_pose_calibration_max_trackers];
+	std::vector<Eigen::Vector3d> sample_positions;
+	std::vector<TrackerPoseCalibrationObservation> observations;
+
+	make_synthetic_cameras(true_cameras);
+	make_synthetic_observations(true_cameras, rng, sample_positions, observations);
+	perturb_cameras(true_cameras, rng, initial_cameras);
+
+	// Already signaled, the initial poses are handed back untouched
+	std::atomic_bool exit_signaled(true);
+	TrackerPoseSolverResult result;
+	const bool bSolved =
+		tracker_pose_solver_solve(
+			sample_positions, observations, initial_cameras, false, &exit_signaled, solved_cameras, result);
+
+	success = !bSolved && result.bCanceled && result.iteration_count == 0;
+	assert(success);
+
+	for (int tracker_id = 0; success && tracker_id < k_tracker_count; ++tracker_id)
+	{
+		success =
+			solved_cameras[tracker_id].orientation.coeffs() == initial_cameras[tracker_id].orientation.coeffs() &&
+			solved_cameras[tracker_id].position == initial_cameras[tracker_id].position;
+		assert(success);
+	}
+
+	UNIT_TEST_COMPLETE()
+}
+
+// Trackers on a ring around the play space looking at its center,
+// set up the way TrackerPoseCalibrator reads them from a 640x480 TrackerCameraModel
+static void
+make_synthetic_cameras(TrackerPoseCalibrationCamera *out_cameras)
+{
+	const Eigen::Vector3d up(0.0, 1.0, 0.0);
+
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		TrackerPoseCalibrationCamera &camera = out_cameras[tracker_id];
+
+		camera.bIsOptimized = tracker_id < k_tracker_count;
+		camera.orientation = Eigen::Quaterniond::Identity();
+		camera.position = Eigen::Vector3d::Zero();
+		camera.focal_length_x = k_focal_length_px;
+		camera.focal_length_y = -k_focal_length_px;
+		camera.principal_x = k_frame_width_px / 2.0;
+		camera.principal_y = k_frame_height_px / 2.0;
+		camera.focal_scale = 1.0;
+
+		if (camera.bIsOptimized)
+		{
+			const double angle = 2.0 * 3.14159265358979323846 * tracker_id / k_tracker_count + 0.3;
+
+			camera.position = Eigen::Vector3d(250.0 * cos(angle), 120.0 + 20.0 * tracker_id, 250.0 * sin(angle));
+
+			// Tracker space +Z looks at the center of the play space
+			const Eigen::Vector3d z_axis = (Eigen::Vector3d(0.0, 100.0, 0.0) - camera.position).normalized();
+			const Eigen::Vector3d x_axis = up.cross(z_axis).normalized();
+			const Eigen::Vector3d y_axis = z_axis.cross(x_axis);
+			Eigen::Matrix3d tracker_to_world;
+			tracker_to_world << x_axis, y_axis, z_axis;
+
+			camera.orientation = Eigen::Quaterniond(tracker_to_world);
+		}
+	}
+}
+
+// Controller positions spread through the play space, each projected into every tracker that can see it
+static void
+make_synthetic_observations(
+	const TrackerPoseCalibrationCamera *cameras,
+	std::mt19937 &rng,
+	std::vector<Eigen::Vector3d> &out_sample_positions,
+	std::vector<TrackerPoseCalibrationObservation> &out_observations)
+{
+	std::uniform_real_distribution<double> horizontal_cm(-60.0, 60.0);
+	std::uniform_real_distribution<double> vertical_cm(60.0, 160.0);
+	std::uniform_real_distribution<double> triangulation_error_cm(-1.0, 1.0);
+
+	for (int sample_index = 0; sample_index < k_sample_count; ++sample_index)
+	{
+		const Eigen::Vector3d position(horizontal_cm(rng), vertical_cm(rng), horizontal_cm(rng));
+
+		for (int tracker_id = 0; tracker_id < k_tracker_count; ++tracker_id)
+		{
+			const TrackerPoseCalibrationCamera &camera = cameras[tracker_id];
+			const Eigen::Vector3d p = camera.orientation.conjugate() * (position - camera.position);
+
+			TrackerPoseCalibrationObservation observation;
+			observation.sample_index = sample_index;
+			observation.tracker_id = tracker_id;
+			observation.screen_x = camera.focal_length_x * p.x() / p.z() + camera.principal_x;
+			observation.screen_y = camera.focal_length_y * p.y() / p.z() + camera.principal_y;
+
+			if (p.z() > 0.0 &&
+				observation.screen_x >= 0.0 && observation.screen_x < k_frame_width_px &&
+				observation.screen_y >= 0.0 && observation.screen_y < k_frame_height_px)
+			{
+				out_observations.push_back(observation);
+			}
+		}
+
+		// The calibrator starts from positions triangulated with the old poses
+		out_sample_positions.push_back(
+			position + Eigen::Vector3d(triangulation_error_cm(rng), triangulation_error_cm(rng), triangulation_error_cm(rng)));
+	}
+}
+
+// A few degrees and centimeters off, well within the solver priors
+static void
+perturb_cameras(
+	const TrackerPoseCalibrationCamera *cameras,
+	std::mt19937 &rng,
+	TrackerPoseCalibrationCamera *out_cameras)
+{
+	std::uniform_real_distribution<double> unit(-1.0, 1.0);
+
+	for (int tracker_id = 0; tracker_id < k_tracker_pose_calibration_max_trackers; ++tracker_id)
+	{
+		out_cameras[tracker_id] = cameras[tracker_id];
+
+		if (cameras[tracker_id].bIsOptimized)
+		{
+			const Eigen::Vector3d axis = Eigen::Vector3d(unit(rng), unit(rng), unit(rng)).normalized();
+			const double angle = 2.0 / k_radians_to_degrees;
+
+			out_cameras[tracker_id].orientation =
+				(cameras[tracker_id].orientation * Eigen::Quaterniond(Eigen::AngleAxisd(angle, axis))).normalized();
+			out_cameras[tracker_id].position += 3.0 * Eigen::Vector3d(unit(rng), unit(rng), unit(rng));
+		}
+	}
+}
+
+// Reprojection errors can't tell apart tracking spaces that differ by a similarity transform,
+// and the solver only pins that down loosely with its priors.
+// So compare the poses after the best fitting similarity transform maps the solved tracker positions onto the true ones.
+static bool
+is_pose_recovered(
+	const TrackerPoseCalibrationCamera *true_cameras,
+	const TrackerPoseCalibrationCamera *solved_cameras)
+{
+	Eigen::Matrix<double, 3, k_tracker_count> true_positions;
+	Eigen::Matrix<double, 3, k_tracker_count> solved_positions;
+	for (int tracker_id = 0; tracker_id < k_tracker_count; ++tracker_id)
+	{
+		true_positions.col(tracker_id) = true_cameras[tracker_id].position;
+		solved_positions.col(tracker_id) = solved_cameras[tracker_id].position;
+	}
+
+	const Eigen::Matrix4d solved_to_true = Eigen::umeyama(solved_positions, true_positions, true);
+	const Eigen::Matrix3d scaled_rotation = solved_to_true.topLeftCorner<3, 3>();
+	const Eigen::Quaterniond rotation(scaled_rotation / cbrt(scaled_rotation.determinant()));
+
+	bool bRecovered = true;
+	for (int tracker_id = 0; tracker_id < k_tracker_count; ++tracker_id)
+	{
+		const Eigen::Quaterniond orientation = rotation * solved_cameras[tracker_id].orientation;
+		const Eigen::Vector3d position =
+			scaled_rotation * solved_cameras[tracker_id].position + solved_to_true.topRightCorner<3, 1>();
+
+		const double orientation_error_degrees =
+			orientation.angularDistance(true_cameras[tracker_id].orientation) * k_radians_to_degrees;
+		const double position_error_cm = (position - true_cameras[tracker_id].position).norm();
+
+		if (orientation_error_degrees > k_max_orientation_error_degrees || position_error_cm > k_max_position_error_cm)
+		{
+			printf("  Tracker %d off by %.3f degrees, %.3f cm\n", tracker_id, orientation_error_degrees, position_error_cm);
+			bRecovered = false;
+		}
+	}
+
+	return bRecovered;
+}
@@ -13,6 +13,10 @@ main(int argc, char* argv[])
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_alignment_unit_tests);
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_eigen_unit_tests);
 		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_math_utility_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_pose_sensor_packet_queue_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_psmove_sensor_decoding_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_service_metrics_unit_tests);
+		UNIT_TEST_SUITE_CALL_CPP_MODULE(run_tracker_pose_solver_unit_tests);
 	UNIT_TEST_SUITE_END()
 
 	return success ? EXIT_SUCCESS : EXIT_FAILURE;